@@ -1,11 +1,18 @@
 #include <jni.h>
 #include <android/log.h>
+#include <algorithm>
 #include <stdexcept>
 #include <string>
+#include <math.h>
+#include <vector>
 
 using namespace std;
 
 #include "soundtouch/SoundTouch.h"
+#include "soundtouch/BPMDetect.h"
+#include "soundtouch/SoundTouchBatch.h"
+#include "soundtouch/SoundTouchThread.h"
+#include "soundtouch/StretchAnalysis.h"
 #include "soundtouch/WavFile.h"
 
 #define LOGV(...)   __android_log_print((int)ANDROID_LOG_INFO, "SOUNDTOUCH", __VA_ARGS__)
@@ -285,6 +292,148 @@ Java_me_shetj_ndk_soundtouch_SoundTouch_setTempoChange(JNIEnv *env, jobject thiz
     pSoundTouch->setTempoChange(newTempo);
 }
 
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouch_rampTempoAndPitch(JNIEnv *env, jobject thiz,
+                                                          jlong handle, jfloat tempoChange,
+                                                          jfloat pitchSemiTones, jint rampFrames) {
+    SoundTouch *pSoundTouch = (SoundTouch*)handle;
+    if (pSoundTouch == NULL) {
+        _setErrmsg("SoundTouch is NULL , u should init first");
+        return;
+    }
+    // 与setTempoChange/setPitchSemiTones相同的单位：速度变化百分比、半音
+    double tempo = 1.0 + 0.01 * tempoChange;
+    double pitch = exp(0.69314718056 * pitchSemiTones / 12.0);
+    pSoundTouch->rampTempoAndPitch(tempo, pitch, (rampFrames > 0) ? (uint)rampFrames : 0);
+}
+
+extern "C" DLL_PUBLIC jboolean
+Java_me_shetj_ndk_soundtouch_SoundTouch_setSetting(JNIEnv *env, jobject thiz,
+                                                   jlong handle, jint settingId, jint value) {
+    SoundTouch *pSoundTouch = (SoundTouch*)handle;
+    if (pSoundTouch == NULL) {
+        _setErrmsg("SoundTouch is NULL , u should init first");
+        return JNI_FALSE;
+    }
+    return pSoundTouch->setSetting(settingId, value) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" DLL_PUBLIC jint
+Java_me_shetj_ndk_soundtouch_SoundTouch_getSetting(JNIEnv *env, jobject thiz,
+                                                   jlong handle, jint settingId) {
+    SoundTouch *pSoundTouch = (SoundTouch*)handle;
+    if (pSoundTouch == NULL) {
+        _setErrmsg("SoundTouch is NULL , u should init first");
+        return 0;
+    }
+    return pSoundTouch->getSetting(settingId);
+}
+
+extern "C" DLL_PUBLIC jboolean
+Java_me_shetj_ndk_soundtouch_SoundTouch_loadTuningProfile(JNIEnv *env, jobject thiz,
+                                                          jlong handle, jstring jprofile) {
+    SoundTouch *pSoundTouch = (SoundTouch*)handle;
+    if (pSoundTouch == NULL) {
+        _setErrmsg("SoundTouch is NULL , u should init first");
+        return JNI_FALSE;
+    }
+    // null 表示卸载配置
+    if (jprofile == NULL) {
+        return pSoundTouch->loadTuningProfile(NULL) ? JNI_TRUE : JNI_FALSE;
+    }
+    const char *profile = env->GetStringUTFChars(jprofile, 0);
+    bool ok = pSoundTouch->loadTuningProfile(profile);
+    env->ReleaseStringUTFChars(jprofile, profile);
+    if (!ok) {
+        _setErrmsg("SoundTouch : malformed tuning profile");
+    }
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" DLL_PUBLIC jint
+Java_me_shetj_ndk_soundtouch_SoundTouch_processBlock(JNIEnv *env, jobject thiz, jlong handle,
+                                                     jshortArray input, jshortArray output) {
+    SoundTouch *pSoundTouch = (SoundTouch*)handle;
+    if (pSoundTouch == NULL) {
+        _setErrmsg("SoundTouch is NULL , u should init first");
+        return -1;
+    }
+    // 先校验再锁定数组，持有Critical数组期间不能抛异常
+    int block = pSoundTouch->getSetting(SETTING_LOW_LATENCY);
+    int channel = pSoundTouch->numChannels();
+    if (block == 0) {
+        _setErrmsg("SoundTouch : low-latency mode not enabled");
+        return -1;
+    }
+    if (!pSoundTouch->canProcessBlock()) {
+        _setErrmsg("SoundTouch : processBlock requires tempo and rate 1.0");
+        return -1;
+    }
+    if (env->GetArrayLength(input) < block * channel || env->GetArrayLength(output) < block * channel) {
+        _setErrmsg("SoundTouch : processBlock arrays shorter than one block");
+        return -1;
+    }
+    // 实时监听线程上调用：不分配内存，不拷贝数组
+    jshort *in = (jshort *) env->GetPrimitiveArrayCritical(input, NULL);
+    jshort *out = (jshort *) env->GetPrimitiveArrayCritical(output, NULL);
+    uint padded = pSoundTouch->processBlock((SAMPLETYPE *) in, (SAMPLETYPE *) out);
+    env->ReleasePrimitiveArrayCritical(output, out, 0);
+    env->ReleasePrimitiveArrayCritical(input, in, JNI_ABORT);
+    return padded * channel;
+}
+
+extern "C" DLL_PUBLIC jboolean
+Java_me_shetj_ndk_soundtouch_SoundTouch_setClipAnalysis(JNIEnv *env, jobject thiz, jlong handle,
+                                                        jstring jclipId, jshortArray clip, jint size) {
+    SoundTouch *pSoundTouch = (SoundTouch*)handle;
+    if (pSoundTouch == NULL) {
+        _setErrmsg("SoundTouch is NULL , u should init first");
+        return JNI_FALSE;
+    }
+    if (clip != NULL && (size < 0 || env->GetArrayLength(clip) < size)) {
+        _setErrmsg("SoundTouch : clip array shorter than size");
+        return JNI_FALSE;
+    }
+    // clipId为null表示解除关联
+    if (jclipId == NULL) {
+        pSoundTouch->setClipAnalysis(NULL, NULL, 0);
+        return JNI_FALSE;
+    }
+    int channel = pSoundTouch->numChannels();
+    if (channel == 0) {
+        _setErrmsg("SoundTouch : Number of channels not defined");
+        return JNI_FALSE;
+    }
+    const char *clipId = env->GetStringUTFChars(jclipId, 0);
+    // 缓存未命中时才需要分析整段数据，耗时较长，不使用Critical数组
+    jshort *samples = (clip != NULL) ? env->GetShortArrayElements(clip, NULL) : NULL;
+    bool ok = false;
+    try {
+        ok = pSoundTouch->setClipAnalysis(clipId, (SAMPLETYPE *) samples, size / channel);
+    } catch (const runtime_error &e) {
+        const char *err = e.what();
+        LOGV("JNI exception in SoundTouch::setClipAnalysis: %s", err);
+        _setErrmsg(err);
+    }
+    // 出错时也要释放数组和字符串
+    if (samples != NULL) {
+        env->ReleaseShortArrayElements(clip, samples, JNI_ABORT);
+    }
+    env->ReleaseStringUTFChars(jclipId, clipId);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouch_removeClipAnalysis(JNIEnv *env, jobject thiz, jstring jclipId) {
+    if (jclipId == NULL) {
+        StretchAnalysisCache::clear();
+        return;
+    }
+    const char *clipId = env->GetStringUTFChars(jclipId, 0);
+    StretchAnalysisCache::remove(clipId);
+    env->ReleaseStringUTFChars(jclipId, clipId);
+}
+
 extern "C" DLL_PUBLIC jstring
 Java_me_shetj_ndk_soundtouch_SoundTouch_getErrorString(JNIEnv *env, jobject thiz) {
     jstring result = env->NewStringUTF(_errMsg.c_str());
@@ -401,3 +550,368 @@ Java_me_shetj_ndk_soundtouch_SoundTouch_processFile(JNIEnv *env, jobject thiz,
 
     return 0;
 }
+
+
+extern "C" DLL_PUBLIC jlong
+Java_me_shetj_ndk_soundtouch_BPMDetect_newInstance(JNIEnv *env, jobject thiz,
+                                                   jint channels, jint sampleRate) {
+    try {
+        BPMDetect *pBpm = new BPMDetect(channels, sampleRate);
+        return (jlong)(pBpm);
+    } catch (const runtime_error &e) {
+        const char *err = e.what();
+        LOGV("JNI exception in BPMDetect::BPMDetect: %s", err);
+        _setErrmsg(err);
+        return 0;
+    }
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_BPMDetect_deleteInstance(JNIEnv *env, jobject thiz, jlong handle) {
+    BPMDetect *pBpm = (BPMDetect*)handle;
+    delete pBpm;
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_BPMDetect_putSamples(JNIEnv *env, jobject thiz,
+                                                  jlong handle, jshortArray samples, jint size) {
+    BPMDetect *pBpm = (BPMDetect*)handle;
+    if (pBpm == NULL) {
+        _setErrmsg("BPMDetect is NULL , u should init first");
+        return;
+    }
+    if (samples == NULL || size < 0 || env->GetArrayLength(samples) < size) {
+        _setErrmsg("BPMDetect : samples array shorter than size");
+        return;
+    }
+    jshort *samplesArray = env->GetShortArrayElements(samples, NULL);
+    int channel = pBpm->numChannels();
+
+    // analysis only reads the input, so there's nothing to copy back
+    pBpm->inputSamples((SAMPLETYPE *) samplesArray, size / channel);
+
+    env->ReleaseShortArrayElements(samples, samplesArray, JNI_ABORT);
+}
+
+
+extern "C" DLL_PUBLIC jfloat
+Java_me_shetj_ndk_soundtouch_BPMDetect_getBpm(JNIEnv *env, jobject thiz, jlong handle) {
+    BPMDetect *pBpm = (BPMDetect*)handle;
+    if (pBpm == NULL) {
+        _setErrmsg("BPMDetect is NULL , u should init first");
+        return 0;
+    }
+    return pBpm->getBpm();
+}
+
+
+extern "C" DLL_PUBLIC jint
+Java_me_shetj_ndk_soundtouch_BPMDetect_getBeats(JNIEnv *env, jobject thiz, jlong handle,
+                                                jfloatArray pos, jfloatArray strength) {
+    BPMDetect *pBpm = (BPMDetect*)handle;
+    if (pBpm == NULL) {
+        _setErrmsg("BPMDetect is NULL , u should init first");
+        return -1;
+    }
+    if (pos == NULL || strength == NULL) {
+        // query only the number of detected beats
+        return pBpm->getBeats(NULL, NULL, 0);
+    }
+
+    jsize maxNum = env->GetArrayLength(pos);
+    if (env->GetArrayLength(strength) < maxNum) maxNum = env->GetArrayLength(strength);
+
+    jfloat *posArray = env->GetFloatArrayElements(pos, NULL);
+    jfloat *strengthArray = env->GetFloatArrayElements(strength, NULL);
+    int num = pBpm->getBeats(posArray, strengthArray, maxNum);
+    env->ReleaseFloatArrayElements(pos, posArray, 0);
+    env->ReleaseFloatArrayElements(strength, strengthArray, 0);
+
+    return (num < maxNum) ? num : maxNum;
+}
+
+
+extern "C" DLL_PUBLIC jlong
+Java_me_shetj_ndk_soundtouch_SoundTouchBatch_newInstance(JNIEnv *env, jobject thiz, jint numThreads) {
+    try {
+        SoundTouchBatch *pBatch = new SoundTouchBatch(numThreads);
+        return (jlong)(pBatch);
+    } catch (const runtime_error &e) {
+        const char *err = e.what();
+        LOGV("JNI exception in SoundTouchBatch::SoundTouchBatch: %s", err);
+        _setErrmsg(err);
+        return 0;
+    }
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouchBatch_deleteInstance(JNIEnv *env, jobject thiz, jlong handle) {
+    SoundTouchBatch *pBatch = (SoundTouchBatch*)handle;
+    delete pBatch;
+}
+
+
+extern "C" DLL_PUBLIC jint
+Java_me_shetj_ndk_soundtouch_SoundTouchBatch_process(JNIEnv *env, jobject thiz, jlong handle,
+                                                     jlongArray voices, jshortArray input,
+                                                     jintArray inputLengths, jshortArray output,
+                                                     jintArray outputCapacities, jintArray outputLengths) {
+    SoundTouchBatch *pBatch = (SoundTouchBatch*)handle;
+    if (pBatch == NULL) {
+        _setErrmsg("SoundTouchBatch is NULL , u should init first");
+        return -1;
+    }
+
+    const jsize numVoices = env->GetArrayLength(voices);
+    if (env->GetArrayLength(inputLengths) < numVoices ||
+        env->GetArrayLength(outputCapacities) < numVoices ||
+        env->GetArrayLength(outputLengths) < numVoices) {
+        _setErrmsg("SoundTouchBatch: length arrays shorter than voices array");
+        return -1;
+    }
+
+    vector<jlong> handles(numVoices);
+    vector<jint> inLen(numVoices), outCap(numVoices);
+    env->GetLongArrayRegion(voices, 0, numVoices, handles.data());
+    env->GetIntArrayRegion(inputLengths, 0, numVoices, inLen.data());
+    env->GetIntArrayRegion(outputCapacities, 0, numVoices, outCap.data());
+
+    // java 侧长度以采样点为单位，引擎以帧（每声道一个采样）为单位
+    vector<SoundTouch *> pVoices(numVoices);
+    vector<uint> inFrames(numVoices), outFrames(numVoices), outCapFrames(numVoices);
+    jlong inTotal = 0, outTotal = 0;
+    for (jsize i = 0; i < numVoices; i ++) {
+        SoundTouch *pSoundTouch = (SoundTouch*)handles[i];
+        if (pSoundTouch == NULL) {
+            _setErrmsg("SoundTouch is NULL , u should init first");
+            return -1;
+        }
+        int channel = pSoundTouch->numChannels();
+        if (channel <= 0 || inLen[i] < 0 || outCap[i] < 0 ||
+            inLen[i] % channel != 0 || outCap[i] % channel != 0) {
+            _setErrmsg("SoundTouchBatch: lengths must be multiples of the channel count");
+            return -1;
+        }
+        pVoices[i] = pSoundTouch;
+        inFrames[i] = inLen[i] / channel;
+        outCapFrames[i] = outCap[i] / channel;
+        inTotal += inLen[i];
+        outTotal += outCap[i];
+    }
+    // 同一实例出现两次会被两个线程同时处理
+    vector<SoundTouch *> sorted(pVoices);
+    sort(sorted.begin(), sorted.end());
+    if (adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+        _setErrmsg("SoundTouchBatch: the same SoundTouch instance appears twice in voices");
+        return -1;
+    }
+    if (inTotal > env->GetArrayLength(input) || outTotal > env->GetArrayLength(output)) {
+        _setErrmsg("SoundTouchBatch: packed buffer shorter than the sum of lengths");
+        return -1;
+    }
+
+    jshort *inputArray = env->GetShortArrayElements(input, NULL);
+    jshort *outputArray = env->GetShortArrayElements(output, NULL);
+    jint result = 0;
+    try {
+        pBatch->process(pVoices.data(), numVoices, (SAMPLETYPE *) inputArray, inFrames.data(),
+                        (SAMPLETYPE *) outputArray, outCapFrames.data(), outFrames.data());
+    } catch (const runtime_error &e) {
+        const char *err = e.what();
+        LOGV("JNI exception in SoundTouchBatch::process: %s", err);
+        _setErrmsg(err);
+        result = -1;
+    }
+    env->ReleaseShortArrayElements(input, inputArray, JNI_ABORT);
+    env->ReleaseShortArrayElements(output, outputArray, 0);
+
+    // 即使部分声音处理失败，其余声音的输出也有效
+    vector<jint> outLen(numVoices);
+    jint total = 0;
+    for (jsize i = 0; i < numVoices; i ++) {
+        outLen[i] = outFrames[i] * pVoices[i]->numChannels();
+        total += outLen[i];
+    }
+    env->SetIntArrayRegion(outputLengths, 0, numVoices, outLen.data());
+
+    return (result < 0) ? result : total;
+}
+
+
+extern "C" DLL_PUBLIC jlong
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_newInstance(JNIEnv *env, jobject thiz,
+                                                          jlong soundTouchHandle, jint ringFrames) {
+    SoundTouch *pSoundTouch = (SoundTouch*)soundTouchHandle;
+    if (pSoundTouch == NULL) {
+        _setErrmsg("SoundTouch is NULL , u should init first");
+        return 0;
+    }
+    try {
+        SoundTouchThread *pThread = new SoundTouchThread(pSoundTouch, ringFrames);
+        return (jlong)(pThread);
+    } catch (const runtime_error &e) {
+        const char *err = e.what();
+        LOGV("JNI exception in SoundTouchThread::SoundTouchThread: %s", err);
+        _setErrmsg(err);
+        return 0;
+    }
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_deleteInstance(JNIEnv *env, jobject thiz, jlong handle) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    delete pThread;
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_start(JNIEnv *env, jobject thiz, jlong handle) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return;
+    }
+    try {
+        pThread->start();
+    } catch (const runtime_error &e) {
+        const char *err = e.what();
+        LOGV("JNI exception in SoundTouchThread::start: %s", err);
+        _setErrmsg(err);
+    }
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_stop(JNIEnv *env, jobject thiz, jlong handle) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return;
+    }
+    pThread->stop();
+}
+
+
+extern "C" DLL_PUBLIC jint
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_putSamples(JNIEnv *env, jobject thiz, jlong handle,
+                                                         jshortArray samples, jint size) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return -1;
+    }
+    // 必须在锁定数组之前检查，持有 critical 数组期间不能再调用 JNI
+    if (samples == NULL || size < 0 || env->GetArrayLength(samples) < size) {
+        _setErrmsg("SoundTouchThread : samples array shorter than size");
+        return -1;
+    }
+    // 处理线程出错退出后不再接受输入，错误信息通过 getErrorString(handle) 获取
+    if (pThread->hasFailed()) return -1;
+    // 音频线程上调用：只做一次内存拷贝，不分配内存
+    int channel = pThread->numChannels();
+    jshort *samplesArray = (jshort *) env->GetPrimitiveArrayCritical(samples, NULL);
+    uint n = pThread->putSamples((SAMPLETYPE *) samplesArray, size / channel);
+    env->ReleasePrimitiveArrayCritical(samples, samplesArray, JNI_ABORT);
+    return n * channel;
+}
+
+
+extern "C" DLL_PUBLIC jint
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_receiveSamples(JNIEnv *env, jobject thiz, jlong handle,
+                                                             jshortArray output) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return -1;
+    }
+    if (pThread->hasFailed()) return -1;
+    int channel = pThread->numChannels();
+    const jsize buf_size = env->GetArrayLength(output);
+    jshort *samplesArray = (jshort *) env->GetPrimitiveArrayCritical(output, NULL);
+    uint n = pThread->receiveSamples((SAMPLETYPE *) samplesArray, buf_size / channel);
+    env->ReleasePrimitiveArrayCritical(output, samplesArray, 0);
+    return n * channel;
+}
+
+
+extern "C" DLL_PUBLIC jint
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_numSamples(JNIEnv *env, jobject thiz, jlong handle) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return -1;
+    }
+    return pThread->numSamples() * pThread->numChannels();
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_setTempoAndPitch(JNIEnv *env, jobject thiz, jlong handle,
+                                                               jfloat tempoChange, jfloat pitchSemiTones,
+                                                               jint rampFrames) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return;
+    }
+    double tempo = 1.0 + 0.01 * tempoChange;
+    double pitch = exp(0.69314718056 * pitchSemiTones / 12.0);
+    pThread->setTempoAndPitch(tempo, pitch, (rampFrames > 0) ? (uint)rampFrames : 0);
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_flush(JNIEnv *env, jobject thiz, jlong handle) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return;
+    }
+    pThread->flush();
+}
+
+
+extern "C" DLL_PUBLIC jint
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_getStatistics(JNIEnv *env, jobject thiz, jlong handle,
+                                                            jdoubleArray stats) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return -1;
+    }
+    SoundTouchThread::Statistics s;
+    pThread->getStatistics(&s);
+
+    // 顺序与 SoundTouchThread.STAT_* 常量一致
+    jdouble values[4] = { (jdouble)s.underruns, (jdouble)s.overflows, 1.0 - s.load, s.peakLoad };
+    jsize num = env->GetArrayLength(stats);
+    if (num > 4) num = 4;
+    env->SetDoubleArrayRegion(stats, 0, num, values);
+    return num;
+}
+
+
+extern "C" DLL_PUBLIC void
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_resetStatistics(JNIEnv *env, jobject thiz, jlong handle) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return;
+    }
+    pThread->resetStatistics();
+}
+
+
+extern "C" DLL_PUBLIC jstring
+Java_me_shetj_ndk_soundtouch_SoundTouchThread_getErrorString(JNIEnv *env, jobject thiz, jlong handle) {
+    SoundTouchThread *pThread = (SoundTouchThread*)handle;
+    if (pThread == NULL) {
+        _setErrmsg("SoundTouchThread is NULL , u should init first");
+        return env->NewStringUTF("");
+    }
+    return env->NewStringUTF(pThread->getErrorString());
+}
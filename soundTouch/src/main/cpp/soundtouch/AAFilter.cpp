@@ -37,6 +37,9 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <map>
+#include <mutex>
+#include <vector>
 #include "AAFilter.h"
 #include "FIRFilter.h"
 
@@ -45,13 +48,17 @@ using namespace soundtouch;
 #define PI       3.14159265358979323846
 #define TWOPI    (2 * PI)
 
+/// Number of quantized cut-off frequencies in a filter bank over range 0 .. 0.5,
+/// i.e. cut-off resolution is 0.5 / AA_BANK_STEPS of the sampling frequency
+#define AA_BANK_STEPS   512
+
 // define this to save AA filter coefficients to a file
 // #define _DEBUG_SAVE_AAFILTER_COEFFICIENTS   1
 
 #ifdef _DEBUG_SAVE_AAFILTER_COEFFICIENTS
     #include <stdio.h>
 
-    static void _DEBUG_SAVE_AAFIR_COEFFS(SAMPLETYPE *coeffs, int len)
+    static void _DEBUG_SAVE_AAFIR_COEFFS(const SAMPLETYPE *coeffs, int len)
     {
         FILE *fptr = fopen("aa_filter_coeffs.txt", "wt");
         if (fptr == NULL) return;
@@ -68,62 +75,20 @@ using namespace soundtouch;
     #define _DEBUG_SAVE_AAFIR_COEFFS(x, y)
 #endif
 
-/*****************************************************************************
- *
- * Implementation of the class 'AAFilter'
- *
- *****************************************************************************/
-
-AAFilter::AAFilter(uint len)
-{
-    pFIR = FIRFilter::newInstance();
-    cutoffFreq = 0.5;
-    setLength(len);
-}
-
-
-AAFilter::~AAFilter()
-{
-    delete pFIR;
-}
-
-
-// Sets new anti-alias filter cut-off edge frequency, scaled to
-// sampling frequency (nyquist frequency = 0.5).
-// The filter will cut frequencies higher than the given frequency.
-void AAFilter::setCutoffFreq(double newCutoffFreq)
-{
-    cutoffFreq = newCutoffFreq;
-    calculateCoeffs();
-}
-
-
-// Sets number of FIR filter taps
-void AAFilter::setLength(uint newLength)
-{
-    length = newLength;
-    calculateCoeffs();
-}
-
 
 // Calculates coefficients for a low-pass FIR filter using Hamming window
-void AAFilter::calculateCoeffs()
+static void designCoeffs(double cutoffFreq, uint length, double *work, SAMPLETYPE *coeffs)
 {
     uint i;
     double cntTemp, temp, tempCoeff,h, w;
     double wc;
     double scaleCoeff, sum;
-    double *work;
-    SAMPLETYPE *coeffs;
 
     assert(length >= 2);
     assert(length % 4 == 0);
     assert(cutoffFreq >= 0);
     assert(cutoffFreq <= 0.5);
 
-    work = new double[length];
-    coeffs = new SAMPLETYPE[length];
-
     wc = 2.0 * PI * cutoffFreq;
     tempCoeff = TWOPI / (double)length;
 
@@ -171,14 +136,94 @@ void AAFilter::calculateCoeffs()
         assert(temp >= -32768 && temp <= 32767);
         coeffs[i] = (SAMPLETYPE)temp;
     }
+}
 
-    // Set coefficients. Use divide factor 14 => divide result by 2^14 = 16384
-    pFIR->setCoefficients(coeffs, length, 14);
 
-    _DEBUG_SAVE_AAFIR_COEFFS(coeffs, length);
+/// Returns the filter bank for filters of 'length' taps: coefficients for the
+/// AA_BANK_STEPS + 1 quantized cut-off frequencies, 'length' items each. Banks
+/// are designed once per filter length and shared by all AAFilter instances,
+/// so that changing the cut-off frequency during processing is only a lookup.
+static const SAMPLETYPE *getFilterBank(uint length)
+{
+    static std::mutex bankMutex;
+    static std::map<uint, std::vector<SAMPLETYPE> > banks;
+
+    std::lock_guard<std::mutex> lock(bankMutex);
+
+    std::vector<SAMPLETYPE> &bank = banks[length];
+    if (bank.empty())
+    {
+        std::vector<double> work(length);
+
+        bank.resize((AA_BANK_STEPS + 1) * (size_t)length);
+        for (uint i = 0; i <= AA_BANK_STEPS; i ++)
+        {
+            designCoeffs(0.5 * i / AA_BANK_STEPS, length, &work[0], &bank[i * (size_t)length]);
+        }
+    }
+    return &bank[0];
+}
+
+
+/*****************************************************************************
+ *
+ * Implementation of the class 'AAFilter'
+ *
+ *****************************************************************************/
+
+AAFilter::AAFilter(uint len)
+{
+    pFIR = FIRFilter::newInstance();
+    cutoffFreq = 0.5;
+    bank = NULL;
+    bankIndex = -1;
+    setLength(len);
+}
+
+
+AAFilter::~AAFilter()
+{
+    delete pFIR;
+}
+
+
+// Sets new anti-alias filter cut-off edge frequency, scaled to
+// sampling frequency (nyquist frequency = 0.5).
+// The filter will cut frequencies higher than the given frequency.
+void AAFilter::setCutoffFreq(double newCutoffFreq)
+{
+    cutoffFreq = newCutoffFreq;
+    calculateCoeffs();
+}
+
+
+// Sets number of FIR filter taps
+void AAFilter::setLength(uint newLength)
+{
+    length = newLength;
+    bank = getFilterBank(length);
+    bankIndex = -1;
+    calculateCoeffs();
+}
+
+
+// Sets the FIR coefficients for the cut-off frequency quantized to the nearest
+// filter of the filter bank. Doesn't allocate memory if filter length is unchanged.
+void AAFilter::calculateCoeffs()
+{
+    int index;
+
+    assert(cutoffFreq >= 0);
+    assert(cutoffFreq <= 0.5);
+
+    index = (int)(cutoffFreq * 2 * AA_BANK_STEPS + 0.5);
+    if (index == bankIndex) return;
+    bankIndex = index;
+
+    // Set coefficients. Use divide factor 14 => divide result by 2^14 = 16384
+    pFIR->setCoefficients(bank + (size_t)index * length, length, 14);
 
-    delete[] work;
-    delete[] coeffs;
+    _DEBUG_SAVE_AAFIR_COEFFS(bank + (size_t)index * length, length);
 }
 
 
@@ -54,7 +54,13 @@ protected:
     /// num of filter taps
     uint length;
 
-    /// Calculate the FIR coefficients realizing the given cutoff-frequency
+    /// Precomputed filters of 'length' taps for quantized cut-off frequencies
+    const SAMPLETYPE *bank;
+
+    /// Index of the filter of 'bank' currently in use, negative = none
+    int bankIndex;
+
+    /// Set the FIR coefficients realizing the given cutoff-frequency
     void calculateCoeffs();
 public:
     AAFilter(uint length);
@@ -63,10 +69,13 @@ public:
 
     /// Sets new anti-alias filter cut-off edge frequency, scaled to sampling 
     /// frequency (nyquist frequency = 0.5). The filter will cut off the 
-    /// frequencies than that.
+    /// frequencies than that. The cut-off is quantized to steps of 1/1024 of
+    /// sampling frequency, and the filter taken from a precomputed filter bank,
+    /// so this is cheap and doesn't allocate memory.
     void setCutoffFreq(double newCutoffFreq);
 
-    /// Sets number of FIR filter taps, i.e. ~filter complexity
+    /// Sets number of FIR filter taps, i.e. ~filter complexity. Designs the
+    /// filter bank for this length, if not done before.
     void setLength(uint newLength);
 
     uint getLength() const;
@@ -57,6 +57,7 @@
 #include "FIFOSampleBuffer.h"
 #include "PeakFinder.h"
 #include "BPMDetect.h"
+#include "STSimd.h"
 
 using namespace soundtouch;
 
@@ -154,16 +155,15 @@ IIR2_filter::IIR2_filter(const double *lpf_coeffs)
 
 float IIR2_filter::update(float x)
 {
-    prev[0] = x;
-    double y = x * coeffs[0];
-
-    for (int i = 4; i >= 1; i--)
-    {
-        y += coeffs[i] * prev[i];
-        prev[i] = prev[i - 1];
-    }
+    // prev[1], prev[2] hold the two previous inputs, prev[3], prev[4] the two
+    // previous outputs
+    double y = x * coeffs[0] + coeffs[4] * prev[4] + coeffs[3] * prev[3] +
+               coeffs[2] * prev[2] + coeffs[1] * prev[1];
 
+    prev[4] = prev[3];
     prev[3] = y;
+    prev[2] = prev[1];
+    prev[1] = x;
     return (float)y;
 }
 
@@ -180,6 +180,10 @@ BPMDetect::BPMDetect(int numChannels, int aSampleRate) :
 
     this->sampleRate = aSampleRate;
     this->channels = numChannels;
+    if ((numChannels <= 0) || (numChannels > SOUNDTOUCH_MAX_CHANNELS))
+    {
+        ST_THROW_RT_ERROR("Error: Illegal number of channels");
+    }
 
     decimateSum = 0;
     decimateCount = 0;
@@ -215,11 +219,22 @@ BPMDetect::BPMDetect(int numChannels, int aSampleRate) :
     buffer->setChannels(1);
     buffer->clear();
 
-    // calculate hamming windows
+    // calculate hamming windows, squared as applied to the data
     hamw = new float[XCORR_UPDATE_SEQUENCE];
     hamming(hamw, XCORR_UPDATE_SEQUENCE);
     hamw2 = new float[XCORR_UPDATE_SEQUENCE / 2];
     hamming(hamw2, XCORR_UPDATE_SEQUENCE / 2);
+    for (int i = 0; i < XCORR_UPDATE_SEQUENCE; i ++)
+    {
+        hamw[i] *= hamw[i];
+        if (i < XCORR_UPDATE_SEQUENCE / 2) hamw2[i] *= hamw2[i];
+    }
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    floatBuffer = new float[windowLen + XCORR_UPDATE_SEQUENCE];
+#else
+    floatBuffer = NULL;
+#endif
 }
 
 
@@ -229,6 +244,7 @@ BPMDetect::~BPMDetect()
     delete[] beatcorr_ringbuff;
     delete[] hamw;
     delete[] hamw2;
+    delete[] floatBuffer;
     delete buffer;
 }
 
@@ -244,6 +260,9 @@ BPMDetect::~BPMDetect()
 /// poor-man's anti-alias filtering, but it's not so critical in this kind of application
 /// (it'd also be difficult to design a high-quality filter with steep cut-off at very 
 /// narrow band)
+///
+/// The samples of all channels averaged into one output sample are consecutive in
+/// the interleaved input, so they're summed up as one vector.
 int BPMDetect::decimate(SAMPLETYPE *dest, const SAMPLETYPE *src, int numsamples)
 {
     int count, outcount;
@@ -252,18 +271,17 @@ int BPMDetect::decimate(SAMPLETYPE *dest, const SAMPLETYPE *src, int numsamples)
     assert(channels > 0);
     assert(decimateBy > 0);
     outcount = 0;
-    for (count = 0; count < numsamples; count ++) 
+    while (numsamples > 0)
     {
-        int j;
+        // convert to mono and accumulate up to the next output sample
+        count = decimateBy - decimateCount;
+        if (count > numsamples) count = numsamples;
 
-        // convert to mono and accumulate
-        for (j = 0; j < channels; j ++)
-        {
-            decimateSum += src[j];
-        }
-        src += j;
+        decimateSum += simdSum(src, count * channels);
+        src += count * channels;
+        numsamples -= count;
 
-        decimateCount ++;
+        decimateCount += count;
         if (decimateCount >= decimateBy) 
         {
             // Store every Nth sample only
@@ -289,17 +307,42 @@ int BPMDetect::decimate(SAMPLETYPE *dest, const SAMPLETYPE *src, int numsamples)
 }
 
 
+// Returns the beginning of the sample history buffer as float. Converting the
+// integer samples once here is cheaper than converting them again for every
+// correlation offset.
+const float *BPMDetect::getFloatSamples(int count)
+{
+    assert(buffer->numSamples() >= (uint)count);
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    const SAMPLETYPE *src = buffer->ptrBegin();
+    int i = 0;
+
+    assert(count <= windowLen + XCORR_UPDATE_SEQUENCE);
+    for (; i + 4 <= count; i += 4)
+    {
+        simdStore(floatBuffer + i, simdLoad(src + i));
+    }
+    for (; i < count; i ++)
+    {
+        floatBuffer[i] = (float)src[i];
+    }
+    return floatBuffer;
+#else
+    (void)count;    // only checked by the assert
+    return buffer->ptrBegin();
+#endif
+}
+
+
 // Calculates autocorrelation function of the sample history buffer
-void BPMDetect::updateXCorr(int process_samples)
+void BPMDetect::updateXCorr(const float *pBuffer, int process_samples)
 {
     int offs;
-    SAMPLETYPE *pBuffer;
-    
+
     assert(buffer->numSamples() >= (uint)(process_samples + windowLen));
     assert(process_samples == XCORR_UPDATE_SEQUENCE);
 
-    pBuffer = buffer->ptrBegin();
-
     // calculate decay factor for xcorr filtering
     float xcorr_decay = (float)pow(0.5, 1.0 / (XCORR_DECAY_TIME_CONSTANT * TARGET_SRATE / process_samples));
 
@@ -307,20 +350,16 @@ void BPMDetect::updateXCorr(int process_samples)
     float tmp[XCORR_UPDATE_SEQUENCE];
     for (int i = 0; i < process_samples; i++)
     {
-        tmp[i] = hamw[i] * hamw[i] * pBuffer[i];
+        tmp[i] = hamw[i] * pBuffer[i];
     }
 
     #pragma omp parallel for
     for (offs = windowStart; offs < windowLen; offs ++) 
     {
         float sum;
-        int i;
 
-        sum = 0;
-        for (i = 0; i < process_samples; i ++) 
-        {
-            sum += tmp[i] * pBuffer[i + offs];  // scaling the sub-result shouldn't be necessary
-        }
+        // scaling the sub-result shouldn't be necessary
+        sum = simdDotProduct(tmp, pBuffer + offs, process_samples);
         xcorr[offs] *= xcorr_decay;   // decay 'xcorr' here with suitable time constant.
 
         xcorr[offs] += (float)fabs(sum);
@@ -329,13 +368,9 @@ void BPMDetect::updateXCorr(int process_samples)
 
 
 // Detect individual beat positions
-void BPMDetect::updateBeatPos(int process_samples)
+void BPMDetect::updateBeatPos(const float *pBuffer, int process_samples)
 {
-    SAMPLETYPE *pBuffer;
-
     assert(buffer->numSamples() >= (uint)(process_samples + windowLen));
-
-    pBuffer = buffer->ptrBegin();
     assert(process_samples == XCORR_UPDATE_SEQUENCE / 2);
 
     //    static double thr = 0.0003;
@@ -346,17 +381,13 @@ void BPMDetect::updateBeatPos(int process_samples)
     float tmp[XCORR_UPDATE_SEQUENCE / 2];
     for (int i = 0; i < process_samples; i++)
     {
-        tmp[i] = hamw2[i] * hamw2[i] * pBuffer[i];
+        tmp[i] = hamw2[i] * pBuffer[i];
     }
 
     #pragma omp parallel for
     for (int offs = windowStart; offs < windowLen; offs++)
     {
-        float sum = 0;
-        for (int i = 0; i < process_samples; i++)
-        {
-            sum += tmp[i] * pBuffer[offs + i];
-        }
+        float sum = simdDotProduct(tmp, pBuffer + offs, process_samples);
         beatcorr_ringbuff[(beatcorr_ringbuffpos + offs) % windowLen] += (float)((sum > 0) ? sum : 0); // accumulate only positive correlations
     }
 
@@ -435,10 +466,12 @@ void BPMDetect::inputSamples(const SAMPLETYPE *samples, int numSamples)
     int req = max(windowLen + XCORR_UPDATE_SEQUENCE, 2 * XCORR_UPDATE_SEQUENCE);
     while ((int)buffer->numSamples() >= req) 
     {
+        const float *pBuffer = getFloatSamples(windowLen + XCORR_UPDATE_SEQUENCE);
+
         // ... update autocorrelations...
-        updateXCorr(XCORR_UPDATE_SEQUENCE);
+        updateXCorr(pBuffer, XCORR_UPDATE_SEQUENCE);
         // ...update beat position calculation...
-        updateBeatPos(XCORR_UPDATE_SEQUENCE / 2);
+        updateBeatPos(pBuffer, XCORR_UPDATE_SEQUENCE / 2);
         // ... and remove proceessed samples from the buffer
         int n = XCORR_UPDATE_SEQUENCE / OVERLAP_FACTOR;
         buffer->receiveSamples(n);
@@ -446,7 +479,7 @@ void BPMDetect::inputSamples(const SAMPLETYPE *samples, int numSamples)
 }
 
 
-void BPMDetect::removeBias()
+void BPMDetect::removeBias(float *data) const
 {
     int i;
 
@@ -456,7 +489,7 @@ void BPMDetect::removeBias()
     double mean_x = 0;
     for (i = windowStart; i < windowLen; i++)
     {
-        mean_x += xcorr[i];
+        mean_x += data[i];
     }
     mean_x /= (windowLen - windowStart);
     mean_i = 0.5 * (windowLen - 1 + windowStart);
@@ -466,7 +499,7 @@ void BPMDetect::removeBias()
     double div = 0;
     for (i = windowStart; i < windowLen; i++)
     {
-        double xt = xcorr[i] - mean_x;
+        double xt = data[i] - mean_x;
         double xi = i - mean_i;
         b += xt * xi;
         div += xi * xi;
@@ -477,35 +510,43 @@ void BPMDetect::removeBias()
     float minval = FLT_MAX;   // arbitrary large number
     for (i = windowStart; i < windowLen; i ++)
     {
-        xcorr[i] -= (float)(b * i);
-        if (xcorr[i] < minval)
+        data[i] -= (float)(b * i);
+        if (data[i] < minval)
         {
-            minval = xcorr[i];
+            minval = data[i];
         }
     }
 
     // subtract min.value
     for (i = windowStart; i < windowLen; i ++)
     {
-        xcorr[i] -= minval;
+        data[i] -= minval;
     }
 }
 
 
-// Calculate N-point moving average for "source" values
+// Calculate N-point moving average for "source" values, as a running sum
+// over the averaging window [i1, i2)
 void MAFilter(float *dest, const float *source, int start, int end, int N)
 {
+    int i1 = start;
+    int i2 = start;
+    double sum = 0;
+
     for (int i = start; i < end; i++)
     {
-        int i1 = i - N / 2;
-        int i2 = i + N / 2 + 1;
-        if (i1 < start) i1 = start;
-        if (i2 > end)   i2 = end;
-
-        double sum = 0;
-        for (int j = i1; j < i2; j ++)
-        { 
-            sum += source[j];
+        int first = i - N / 2;
+        int last = i + N / 2 + 1;
+        if (first < start) first = start;
+        if (last > end)    last = end;
+
+        for (; i2 < last; i2 ++)
+        {
+            sum += source[i2];
+        }
+        for (; i1 < first; i1 ++)
+        {
+            sum -= source[i1];
         }
         dest[i] = (float)(sum / (i2 - i1));
     }
@@ -518,18 +559,22 @@ float BPMDetect::getBpm()
     double coeff;
     PeakFinder peakFinder;
 
-    // remove bias from xcorr data
-    removeBias();
+    // remove bias from a copy of xcorr data, so that the accumulated xcorr
+    // stays intact and analysis can continue after reading intermediate result
+    float *unbiased = new float[windowLen];
+    memcpy(unbiased, xcorr, sizeof(float) * windowLen);
+    removeBias(unbiased);
 
     coeff = 60.0 * ((double)sampleRate / (double)decimateBy);
 
     // save bpm debug data if debug data writing enabled
-    _SaveDebugData("soundtouch-bpm-xcorr.txt", xcorr, windowStart, windowLen, coeff);
+    _SaveDebugData("soundtouch-bpm-xcorr.txt", unbiased, windowStart, windowLen, coeff);
 
     // Smoothen by N-point moving-average
     float *data = new float[windowLen];
     memset(data, 0, sizeof(float) * windowLen);
-    MAFilter(data, xcorr, windowStart, windowLen, MOVING_AVERAGE_N);
+    MAFilter(data, unbiased, windowStart, windowLen, MOVING_AVERAGE_N);
+    delete[] unbiased;
 
     // find peak position
     peakPos = peakFinder.detectPeak(data, windowStart, windowLen);
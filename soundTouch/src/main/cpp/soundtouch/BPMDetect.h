@@ -115,10 +115,14 @@ namespace soundtouch
         /// the first these many correlation bins.
         int windowStart;
 
-        /// window functions for data preconditioning
+        /// window functions for data preconditioning, squared
         float *hamw;
         float *hamw2;
 
+        /// Decimated samples converted to float for the correlation updates,
+        /// used in integer sample builds only
+        float *floatBuffer;
+
         // beat detection variables
         int pos;
         int peakPos;
@@ -137,10 +141,14 @@ namespace soundtouch
         // 2nd order low-pass-filter
         IIR2_filter beat_lpf;
 
-        /// Updates auto-correlation function for given number of decimated samples that 
-        /// are read from the internal 'buffer' pipe (samples aren't removed from the pipe 
-        /// though).
-        void updateXCorr(int process_samples      /// How many samples are processed.
+        /// Returns the first 'count' decimated samples of the internal 'buffer' pipe
+        /// as float.
+        const float *getFloatSamples(int count);
+
+        /// Updates auto-correlation function for given number of decimated samples
+        /// from 'samples', the beginning of the internal 'buffer' pipe.
+        void updateXCorr(const float *samples,    ///< Decimated samples as float
+            int process_samples                   ///< How many samples are processed.
         );
 
         /// Decimates samples to approx. 500 Hz.
@@ -151,17 +159,12 @@ namespace soundtouch
             int numsamples                     ///< Number of source samples.
         );
 
-        /// Calculates amplitude envelope for the buffer of samples.
-        /// Result is output to 'samples'.
-        void calcEnvelope(soundtouch::SAMPLETYPE *samples,  ///< Pointer to input/output data buffer
-            int numsamples                    ///< Number of samples in buffer
-        );
-
-        /// remove constant bias from xcorr data
-        void removeBias();
+        /// remove constant bias from xcorr data. Operates on 'data' that holds
+        /// a copy of the 'xcorr' bins.
+        void removeBias(float *data) const;
 
         // Detect individual beat positions
-        void updateBeatPos(int process_samples);
+        void updateBeatPos(const float *samples, int process_samples);
 
 
     public:
@@ -185,7 +188,8 @@ namespace soundtouch
 
         /// Analyzes the results and returns the BPM rate. Use this function to read result
         /// after whole song data has been input to the class by consecutive calls of
-        /// 'inputSamples' function.
+        /// 'inputSamples' function. Reading the result doesn't alter the analysis state,
+        /// so this can also be called in middle of a stream for an intermediate estimate.
         ///
         /// \return Beats-per-minute rate, or zero if detection failed.
         float getBpm();
@@ -200,6 +204,12 @@ namespace soundtouch
         ///
         /// \return number of beats in the arrays.
         int getBeats(float *pos, float *strength, int max_num);
+
+        /// Return number of channels
+        int numChannels() const
+        {
+            return channels;
+        }
     };
 }
 #endif // _BPMDetect_H_
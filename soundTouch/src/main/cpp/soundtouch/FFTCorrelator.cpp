@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// FFT based cross-correlation, see FFTCorrelator.h
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include "FFTCorrelator.h"
+
+using namespace soundtouch;
+
+/// Smallest FFT size used
+#define MIN_FFT_BITS    6
+
+
+FFTCorrelator::FFTCorrelator()
+{
+    fftSize = 0;
+    fftBits = 0;
+    templateLen = 0;
+    resultCapacity = 0;
+
+    twiddleRe = twiddleIm = NULL;
+    bitRev = NULL;
+    tmplRe = tmplIm = NULL;
+    workRe = workIm = NULL;
+    result = NULL;
+}
+
+
+FFTCorrelator::~FFTCorrelator()
+{
+    clearBuffers();
+    delete[] result;
+}
+
+
+void FFTCorrelator::clearBuffers()
+{
+    delete[] twiddleRe;
+    delete[] twiddleIm;
+    delete[] bitRev;
+    delete[] tmplRe;
+    delete[] tmplIm;
+    delete[] workRe;
+    delete[] workIm;
+
+    twiddleRe = twiddleIm = NULL;
+    bitRev = NULL;
+    tmplRe = tmplIm = NULL;
+    workRe = workIm = NULL;
+}
+
+
+// Chooses FFT size so that each overlap-save block yields at least as many
+// valid lags as the template is long, and precalculates the FFT tables.
+void FFTCorrelator::setup(int newTemplateLen)
+{
+    int bits;
+
+    assert(newTemplateLen > 0);
+    if (newTemplateLen == templateLen) return;
+    templateLen = newTemplateLen;
+
+    bits = MIN_FFT_BITS;
+    while ((1 << bits) < 2 * templateLen) bits ++;
+    if (bits == fftBits) return;
+
+    clearBuffers();
+    fftBits = bits;
+    fftSize = 1 << bits;
+
+    twiddleRe = new float[fftSize / 2];
+    twiddleIm = new float[fftSize / 2];
+    for (int k = 0; k < fftSize / 2; k ++)
+    {
+        double phase = 2.0 * M_PI * k / fftSize;
+        twiddleRe[k] = (float)cos(phase);
+        twiddleIm[k] = (float)sin(phase);
+    }
+
+    bitRev = new int[fftSize];
+    for (int i = 0; i < fftSize; i ++)
+    {
+        int rev = 0;
+        for (int b = 0; b < fftBits; b ++)
+        {
+            rev |= ((i >> b) & 1) << (fftBits - 1 - b);
+        }
+        bitRev[i] = rev;
+    }
+
+    tmplRe = new float[fftSize];
+    tmplIm = new float[fftSize];
+    workRe = new float[fftSize];
+    workIm = new float[fftSize];
+}
+
+
+// Allocates tables & buffers for given lengths; nothing if they're already there
+void FFTCorrelator::reserve(int signalLen, int templLen)
+{
+    const int numLags = signalLen - templLen + 1;
+
+    setup(templLen);
+
+    if (numLags > resultCapacity)
+    {
+        delete[] result;
+        resultCapacity = numLags;
+        result = new float[resultCapacity];
+    }
+}
+
+
+// Iterative radix-2 decimation-in-time FFT. Forward transform uses
+// exp(-2*pi*i*k/N) kernel, inverse exp(+2*pi*i*k/N), neither is scaled.
+void FFTCorrelator::fft(float *re, float *im, bool inverse) const
+{
+    const int n = fftSize;
+    const float sign = inverse ? 1.0f : -1.0f;
+
+    for (int i = 0; i < n; i ++)
+    {
+        int j = bitRev[i];
+        if (i < j)
+        {
+            float t;
+            t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        const int half = len >> 1;
+        const int tstep = n / len;
+
+        for (int k = 0; k < half; k ++)
+        {
+            const float wr = twiddleRe[k * tstep];
+            const float wi = sign * twiddleIm[k * tstep];
+
+            for (int a = k; a < n; a += len)
+            {
+                const int b = a + half;
+                const float tr = re[b] * wr - im[b] * wi;
+                const float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+
+const float *FFTCorrelator::correlate(const SAMPLETYPE *signal, int signalLen,
+                                      const SAMPLETYPE *templ, int templLen)
+{
+    const int numLags = signalLen - templLen + 1;
+
+    assert(numLags > 0);
+    reserve(signalLen, templLen);
+
+    // spectrum of the template, stored conjugated for correlation
+    for (int k = 0; k < fftSize; k ++)
+    {
+        tmplRe[k] = (k < templLen) ? (float)templ[k] : 0.0f;
+        tmplIm[k] = 0.0f;
+    }
+    fft(tmplRe, tmplIm, false);
+    for (int k = 0; k < fftSize; k ++)
+    {
+        tmplIm[k] = -tmplIm[k];
+    }
+
+    // overlap-save: each block of 'fftSize' signal items gives 'step' valid lags.
+    // Two consecutive blocks are transformed at once in real & imaginary parts.
+    const int step = fftSize - templLen + 1;
+    const float scale = 1.0f / (float)fftSize;
+
+    for (int start = 0; start < numLags; start += 2 * step)
+    {
+        const int start2 = start + step;
+
+        for (int k = 0; k < fftSize; k ++)
+        {
+            int i1 = start + k;
+            int i2 = start2 + k;
+            workRe[k] = (i1 < signalLen) ? (float)signal[i1] : 0.0f;
+            workIm[k] = (i2 < signalLen) ? (float)signal[i2] : 0.0f;
+        }
+
+        fft(workRe, workIm, false);
+        for (int k = 0; k < fftSize; k ++)
+        {
+            const float re = workRe[k] * tmplRe[k] - workIm[k] * tmplIm[k];
+            const float im = workRe[k] * tmplIm[k] + workIm[k] * tmplRe[k];
+            workRe[k] = re;
+            workIm[k] = im;
+        }
+        fft(workRe, workIm, true);
+
+        for (int t = 0; t < step; t ++)
+        {
+            if (start + t < numLags) result[start + t] = workRe[t] * scale;
+            if (start2 + t < numLags) result[start2 + t] = workIm[t] * scale;
+        }
+    }
+
+    return result;
+}
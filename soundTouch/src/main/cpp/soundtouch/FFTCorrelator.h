@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// FFT based cross-correlation for evaluating the correlation of a short
+/// template against every lag position of a longer signal at once.
+///
+/// Uses overlap-save block convolution with a radix-2 complex FFT. As both
+/// the signal and the template are real, two signal blocks are packed into
+/// the real & imaginary parts of one complex transform.
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FFTCorrelator_H
+#define FFTCorrelator_H
+
+#include "STTypes.h"
+
+namespace soundtouch
+{
+
+class FFTCorrelator
+{
+protected:
+    /// FFT size, power of 2
+    int fftSize;
+
+    /// log2 of 'fftSize'
+    int fftBits;
+
+    /// Length of the correlation template the transform was set up for
+    int templateLen;
+
+    /// Capacity of 'result' buffer
+    int resultCapacity;
+
+    /// Twiddle factors: cos & sin of 2*pi*k/fftSize, k = 0 .. fftSize/2-1
+    float *twiddleRe;
+    float *twiddleIm;
+
+    /// Bit-reversal permutation for 'fftSize'
+    int *bitRev;
+
+    /// Spectrum of the current template (conjugated)
+    float *tmplRe;
+    float *tmplIm;
+
+    /// Work buffers for a signal block
+    float *workRe;
+    float *workIm;
+
+    /// Correlation result buffer
+    float *result;
+
+    void clearBuffers();
+
+    /// (Re)allocates FFT tables & work buffers for given template length
+    void setup(int newTemplateLen);
+
+    /// In-place complex FFT of size 'fftSize'. Unscaled in both directions.
+    void fft(float *re, float *im, bool inverse) const;
+
+public:
+    FFTCorrelator();
+    ~FFTCorrelator();
+
+    /// Allocates the FFT tables & buffers for correlating a template of
+    /// 'templLen' items against signals of up to 'signalLen' items, so that
+    /// the correlate() calls with these lengths don't allocate memory.
+    void reserve(int signalLen,   ///< Longest signal length in items
+                 int templLen     ///< Template length in items
+                 );
+
+    /// Calculates cross-correlation of 'templ' against 'signal' for every lag:
+    ///
+    ///     result[lag] = sum(k = 0 .. templLen-1) signal[lag + k] * templ[k]
+    ///
+    /// for lag = 0 .. signalLen - templLen. Reallocates internal buffers only
+    /// if the lengths differ from those given to reserve() or grow beyond
+    /// those of the previous calls.
+    ///
+    /// \return Pointer to the correlation result. Valid until the next call.
+    const float *correlate(const SAMPLETYPE *signal,  ///< Signal to scan
+                           int signalLen,             ///< Signal length in items
+                           const SAMPLETYPE *templ,   ///< Template to match
+                           int templLen               ///< Template length in items
+                           );
+};
+
+}
+
+#endif
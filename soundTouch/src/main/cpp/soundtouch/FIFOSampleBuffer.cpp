@@ -40,11 +40,16 @@
 #include <memory.h>
 #include <string.h>
 #include <assert.h>
+#include <atomic>
 
 #include "FIFOSampleBuffer.h"
 
 using namespace soundtouch;
 
+// Process-wide profiling counters, see FIFOSampleBuffer::getStatistics
+static std::atomic<unsigned long long> statAllocations(0);
+static std::atomic<unsigned long long> statMovedBytes(0);
+
 // Constructor
 FIFOSampleBuffer::FIFOSampleBuffer(int numChannels)
 {
@@ -75,6 +80,8 @@ void FIFOSampleBuffer::setChannels(int numChannels)
 
     if (!verifyNumberOfChannels(numChannels)) return;
 
+    // 'bufferPos' is counted in samples of the old channel count
+    rewind();
     usedBytes = channels * samplesInBuffer;
     channels = (uint)numChannels;
     samplesInBuffer = usedBytes / channels;
@@ -88,7 +95,9 @@ void FIFOSampleBuffer::rewind()
 {
     if (buffer && bufferPos) 
     {
-        memmove(buffer, ptrBegin(), sizeof(SAMPLETYPE) * channels * samplesInBuffer);
+        uint bytes = sizeof(SAMPLETYPE) * channels * samplesInBuffer;
+        memmove(buffer, ptrBegin(), bytes);
+        statMovedBytes.fetch_add(bytes, std::memory_order_relaxed);
         bufferPos = 0;
     }
 }
@@ -134,7 +143,7 @@ void FIFOSampleBuffer::putSamples(uint nSamples)
 SAMPLETYPE *FIFOSampleBuffer::ptrEnd(uint slackCapacity) 
 {
     ensureCapacity(samplesInBuffer + slackCapacity);
-    return buffer + samplesInBuffer * channels;
+    return buffer + (bufferPos + samplesInBuffer) * channels;
 }
 
 
@@ -153,9 +162,11 @@ SAMPLETYPE *FIFOSampleBuffer::ptrBegin()
 
 
 // Ensures that the buffer has enough capacity, i.e. space for _at least_
-// 'capacityRequirement' number of samples. The buffer is grown in steps of
-// 4 kilobytes to eliminate the need for frequently growing up the buffer,
-// as well as to round the buffer size up to the virtual memory page size.
+// 'capacityRequirement' number of samples from the current 'ptrBegin' position.
+// The buffer is grown in steps of 4 kilobytes to eliminate the need for
+// frequently growing up the buffer, as well as to round the buffer size up to
+// the virtual memory page size. If the capacity is sufficient but the space
+// after 'bufferPos' isn't, the samples are rewound to the buffer beginning.
 void FIFOSampleBuffer::ensureCapacity(uint capacityRequirement)
 {
     SAMPLETYPE *tempUnaligned, *temp;
@@ -172,6 +183,7 @@ void FIFOSampleBuffer::ensureCapacity(uint capacityRequirement)
         }
         // Align the buffer to begin at 16byte cache line boundary for optimal performance
         temp = (SAMPLETYPE *)SOUNDTOUCH_ALIGN_POINTER_16(tempUnaligned);
+        statAllocations.fetch_add(1, std::memory_order_relaxed);
         if (samplesInBuffer)
         {
             memcpy(temp, ptrBegin(), samplesInBuffer * channels * sizeof(SAMPLETYPE));
@@ -181,9 +193,9 @@ void FIFOSampleBuffer::ensureCapacity(uint capacityRequirement)
         bufferUnaligned = tempUnaligned;
         bufferPos = 0;
     } 
-    else 
+    else if (bufferPos + capacityRequirement > getCapacity())
     {
-        // simply rewind the buffer (if necessary)
+        // rewind the buffer only when the samples don't fit after 'bufferPos'
         rewind();
     }
 }
@@ -230,6 +242,8 @@ uint FIFOSampleBuffer::receiveSamples(uint maxSamples)
 
         temp = samplesInBuffer;
         samplesInBuffer = 0;
+        // buffer is empty, restart from beginning without moving anything
+        bufferPos = 0;
         return temp;
     }
 
@@ -273,3 +287,29 @@ void FIFOSampleBuffer::addSilent(uint nSamples)
     memset(ptrEnd(nSamples), 0, sizeof(SAMPLETYPE) * nSamples * channels);
     samplesInBuffer += nSamples;
 }
+
+
+/// Preallocates storage for at least 'numSamples' samples
+void FIFOSampleBuffer::reserve(uint numSamples)
+{
+    if (numSamples > getCapacity())
+    {
+        ensureCapacity(numSamples);
+    }
+}
+
+
+/// Reads process-wide counters of allocations and bytes moved when rewinding
+void FIFOSampleBuffer::getStatistics(unsigned long long *allocations, unsigned long long *movedBytes)
+{
+    if (allocations) *allocations = statAllocations.load(std::memory_order_relaxed);
+    if (movedBytes) *movedBytes = statMovedBytes.load(std::memory_order_relaxed);
+}
+
+
+/// Resets the profiling counters
+void FIFOSampleBuffer::resetStatistics()
+{
+    statAllocations.store(0, std::memory_order_relaxed);
+    statMovedBytes.store(0, std::memory_order_relaxed);
+}
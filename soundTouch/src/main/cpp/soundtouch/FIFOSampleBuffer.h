@@ -9,6 +9,12 @@
 /// output samples from the buffer as well as grows the storage size 
 /// whenever necessary.
 ///
+/// Received samples are only skipped over, the remaining samples are moved to
+/// the beginning of the storage when the free space after them runs out. With
+/// storage reserved for a few times the typical fill level this is rare and
+/// moves only a few samples, so the buffer works much like a ring buffer that
+/// still provides contiguous spans for 'ptrBegin' and 'ptrEnd'.
+///
 /// Author        : Copyright (c) Olli Parviainen
 /// Author e-mail : oparviai 'at' iki.fi
 /// SoundTouch WWW: http://www.surina.net/soundtouch
@@ -44,6 +50,17 @@
 namespace soundtouch
 {
 
+/// Typical number of sample frames given to the processing pipeline at a time.
+/// Pipeline stages reserve their buffers for this block size on top of their own
+/// processing requirement, so that steady state processing doesn't reallocate.
+#define FIFO_TYPICAL_BLOCK_SIZE     4096
+
+/// Range of tempo and rate values the pipeline stages reserve their buffers for,
+/// so that parameter changes within this range don't allocate memory. Covers
+/// -50 .. +100 % tempo and rate changes combined with one octave pitch shift.
+#define FIFO_RESERVE_RATE_MIN       0.25
+#define FIFO_RESERVE_RATE_MAX       4.0
+
 /// Sample buffer working in FIFO (first-in-first-out) principle. The class takes
 /// care of storage size adjustment and data moving during input/output operations.
 ///
@@ -77,7 +94,8 @@ private:
     /// beginning of the buffer.
     void rewind();
 
-    /// Ensures that the buffer has capacity for at least this many samples.
+    /// Ensures that the buffer has capacity for at least this many samples after
+    /// 'ptrBegin'. Rewinds the buffer only if the samples don't fit as they are.
     void ensureCapacity(uint capacityRequirement);
 
     /// Returns current capacity.
@@ -173,6 +191,17 @@ public:
 
     /// Add silence to end of buffer
     void addSilent(uint nSamples);
+
+    /// Preallocates storage for at least 'numSamples' samples, to avoid reallocation
+    /// during processing. Never shrinks the storage.
+    void reserve(uint numSamples);
+
+    /// Reads process-wide counters of storage allocations and of bytes moved when
+    /// rewinding the buffers, for profiling. Either pointer can be NULL.
+    static void getStatistics(unsigned long long *allocations, unsigned long long *movedBytes);
+
+    /// Resets the counters read by 'getStatistics'.
+    static void resetStatistics();
 };
 
 }
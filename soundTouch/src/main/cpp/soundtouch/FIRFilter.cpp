@@ -43,6 +43,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include "FIRFilter.h"
+#include "STSimd.h"
 #include "cpu_detect.h"
 
 using namespace soundtouch;
@@ -158,59 +159,124 @@ uint FIRFilter::evaluateFilterMono(SAMPLETYPE *dest, const SAMPLETYPE *src, uint
 
 uint FIRFilter::evaluateFilterMulti(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples, uint numChannels)
 {
-    int j, end;
+    // common layouts get kernels with the channel count known at compile time,
+    // so that the channel loops unroll and vectorize
+    switch (numChannels)
+    {
+        case 4:
+            return evaluateFilterMultiCh<4>(dest, src, numSamples, 4);
+        case 6:
+            return evaluateFilterMultiCh<6>(dest, src, numSamples, 6);
+        case 8:
+            return evaluateFilterMultiCh<8>(dest, src, numSamples, 8);
+        default:
+            return evaluateFilterMultiCh<0>(dest, src, numSamples, numChannels);
+    }
+}
+
 
+/// Output frames evaluated at once by the multichannel routine: enough to fill
+/// the vector registers with 32bit integer sums, but not to spill the float
+/// vector accumulators of 8 channels
 #ifdef SOUNDTOUCH_FLOAT_SAMPLES
-    // when using floating point samples, use a scaler instead of a divider
-    // because division is much slower operation than multiplying.
-    double dScaler = 1.0 / (double)resultDivider;
+    #define MULTI_FRAMES    4
+#else
+    #define MULTI_FRAMES    8
 #endif
 
+
+/// Evaluates 'NF' consecutive output frames of 'channels' channels. Several
+/// frames at once hide the latency of the accumulations, while each output
+/// still sums its taps in the same order as a plain loop.
+template <int CH, int NF>
+static inline void _evaluateFrames(SAMPLETYPE *dest, const SAMPLETYPE *src, int channels,
+                                   const SAMPLETYPE *coeffs, int ilength, uint resultDivFactor)
+{
+    int c, i;
+    int n = NF * channels;
+
+#ifdef SOUNDTOUCH_FLOAT_SAMPLES
+    // The samples of the frames are consecutive, so sum them four at a time
+    // regardless of the channel layout, and the remaining ones one by one
+    simd4f sums[NF * (CH ? CH : 16) / 4 + 1];
+    float tail[3] = {0, 0, 0};
+    int nv = n / 4;
+
+    for (c = 0; c < nv; c ++) sums[c] = simdZero();
+    for (i = 0; i < ilength; i ++)
+    {
+        simd4f coef = simdSet1(coeffs[i]);
+        const float *ptr = src + i * channels;
+        for (c = 0; c < nv; c ++)
+        {
+            sums[c] = simdMulAdd(sums[c], simdLoad(ptr + 4 * c), coef);
+        }
+        for (c = 4 * nv; c < n; c ++)
+        {
+            tail[c - 4 * nv] += ptr[c] * coeffs[i];
+        }
+    }
+    for (c = 0; c < nv; c ++) simdStore(dest + 4 * c, sums[c]);
+    for (c = 4 * nv; c < n; c ++) dest[c] = tail[c - 4 * nv];
+    (void)resultDivFactor;
+#else
+    // 32bit sums, unlike the LONG_SAMPLETYPE sums of the mono & stereo
+    // routines, but with the same result: setCoefficients() ensures that the
+    // sum can't overflow. Half as wide sums fill the vector registers twice as
+    // well, and with a fixed channel count the loops over the consecutive
+    // samples turn into vector operations.
+    int sums[NF * (CH ? CH : 16)];
+
+    for (c = 0; c < n; c ++)
+    {
+        sums[c] = 0;
+    }
+    for (i = 0; i < ilength; i ++)
+    {
+        int coef = coeffs[i];
+        const short *ptr = src + i * channels;
+        for (c = 0; c < n; c ++)
+        {
+            sums[c] += ptr[c] * coef;
+        }
+    }
+    for (c = 0; c < n; c ++)
+    {
+        dest[c] = (SAMPLETYPE)(sums[c] >> resultDivFactor);
+    }
+#endif // SOUNDTOUCH_FLOAT_SAMPLES
+}
+
+
+template <int CH>
+uint FIRFilter::evaluateFilterMultiCh(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples, uint numChannels) const
+{
+    int j, end;
+    const int channels = CH ? CH : (int)numChannels;
+
     assert(length != 0);
     assert(src != NULL);
     assert(dest != NULL);
     assert(filterCoeffs != NULL);
-    assert(numChannels < 16);
+    assert(channels < 16);
 
     // hint compiler autovectorization that loop length is divisible by 8
     int ilength = length & -8;
 
-    end = numChannels * (numSamples - ilength);
+    end = numSamples - ilength;
 
     #pragma omp parallel for
-    for (j = 0; j < end; j += numChannels)
+    for (j = 0; j < (end & -MULTI_FRAMES); j += MULTI_FRAMES)
     {
-        const SAMPLETYPE *ptr;
-        LONG_SAMPLETYPE sums[16];
-        uint c;
-        int i;
-
-        for (c = 0; c < numChannels; c ++)
-        {
-            sums[c] = 0;
-        }
-
-        ptr = src + j;
-
-        for (i = 0; i < ilength; i ++)
-        {
-            SAMPLETYPE coef=filterCoeffs[i];
-            for (c = 0; c < numChannels; c ++)
-            {
-                sums[c] += ptr[0] * coef;
-                ptr ++;
-            }
-        }
-        
-        for (c = 0; c < numChannels; c ++)
-        {
-#ifdef SOUNDTOUCH_INTEGER_SAMPLES
-            sums[c] >>= resultDivFactor;
-#endif // SOUNDTOUCH_INTEGER_SAMPLES
-            dest[j+c] = (SAMPLETYPE)sums[c];
-        }
+        _evaluateFrames<CH, MULTI_FRAMES>(dest + j * channels, src + j * channels, channels,
+                                          filterCoeffs, ilength, resultDivFactor);
     }
-    return numSamples - ilength;
+    for (j = end & -MULTI_FRAMES; j < end; j ++)
+    {
+        _evaluateFrames<CH, 1>(dest + j * channels, src + j * channels, channels,
+                               filterCoeffs, ilength, resultDivFactor);
+    }
+    return end;
 }
 
 
@@ -222,12 +288,9 @@ void FIRFilter::setCoefficients(const SAMPLETYPE *coeffs, uint newLength, uint u
     assert(newLength > 0);
     if (newLength % 8) ST_THROW_RT_ERROR("FIR filter length not divisible by 8");
 
-    #ifdef SOUNDTOUCH_FLOAT_SAMPLES
-        // scale coefficients already here if using floating samples
-        double scale = 1.0 / resultDivider;
-    #else
-        short scale = 1;
-    #endif
+    // reallocate only if filter length changes, so that updating coefficients
+    // of a same-length filter during processing doesn't allocate memory
+    bool bResize = (newLength != length) || (filterCoeffs == NULL);
 
     lengthDiv8 = newLength / 8;
     length = lengthDiv8 * 8;
@@ -236,10 +299,30 @@ void FIRFilter::setCoefficients(const SAMPLETYPE *coeffs, uint newLength, uint u
     resultDivFactor = uResultDivFactor;
     resultDivider = (SAMPLETYPE)::pow(2.0, (int)resultDivFactor);
 
-    delete[] filterCoeffs;
-    filterCoeffs = new SAMPLETYPE[length];
-    delete[] filterCoeffsStereo;
-    filterCoeffsStereo = new SAMPLETYPE[length*2];
+    #ifdef SOUNDTOUCH_FLOAT_SAMPLES
+        // scale coefficients already here if using floating samples. Use the
+        // new divider: the previous one is 0 on the first call.
+        double scale = 1.0 / resultDivider;
+    #else
+        short scale = 1;
+    #endif
+
+#if defined(SOUNDTOUCH_INTEGER_SAMPLES) && !defined(NDEBUG)
+    // the multichannel routine sums in 32 bits: full scale input times the
+    // absolute coefficient sum must fit. The AA filter designs stay below
+    // 46000, i.e. 1.5e9 at most.
+    long long absSum = 0;
+    for (uint i = 0; i < length; i ++) absSum += (coeffs[i] < 0) ? -coeffs[i] : coeffs[i];
+    assert(absSum * 32768 <= 0x7fffffffLL);
+#endif
+
+    if (bResize)
+    {
+        delete[] filterCoeffs;
+        filterCoeffs = new SAMPLETYPE[length];
+        delete[] filterCoeffsStereo;
+        filterCoeffsStereo = new SAMPLETYPE[length*2];
+    }
     for (uint i = 0; i < length; i ++)
     {
         filterCoeffs[i] = (SAMPLETYPE)(coeffs[i] * scale);
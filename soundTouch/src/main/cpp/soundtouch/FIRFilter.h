@@ -67,6 +67,10 @@ protected:
                                     uint numSamples) const;
     virtual uint evaluateFilterMulti(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples, uint numChannels);
 
+    /// evaluateFilterMulti() for CH channels, or for 'numChannels' if CH is 0
+    template <int CH>
+    uint evaluateFilterMultiCh(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples, uint numChannels) const;
+
 public:
     FIRFilter();
     virtual ~FIRFilter();
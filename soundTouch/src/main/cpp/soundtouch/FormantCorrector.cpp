@@ -0,0 +1,374 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Formant correction for pitch shifted sound, see FormantCorrector.h
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <string.h>
+
+#include "FormantCorrector.h"
+#include "STSimd.h"
+
+using namespace soundtouch;
+
+/// Analysis window length in milliseconds, rounded to a power of 2 in frames
+#define FORMANT_WINDOW_MS       15.0
+
+/// Bandwidth of the autocorrelation lag window in Hz. Smooths the envelope
+/// so that it follows the formants rather than single harmonics.
+#define FORMANT_LAG_BW          60.0
+
+/// White noise correction of the autocorrelation, -40 dB
+#define FORMANT_NOISE_FLOOR     1.0001
+
+/// Offset against denormal numbers in the all-pole filter state
+#define FORMANT_DENORMAL        1e-18f
+
+
+// Solves LPC coefficients 'a' (a[0] = 1) of order FORMANT_ORDER from the
+// autocorrelation 'r' with the Levinson-Durbin recursion. Returns the
+// prediction error power. Stops at a lower order if the error vanishes.
+static double _levinson(const double *r, double *a)
+{
+    double err = r[0];
+
+    a[0] = 1.0;
+    for (int i = 1; i <= FORMANT_ORDER; i ++) a[i] = 0;
+
+    for (int i = 1; i <= FORMANT_ORDER; i ++)
+    {
+        double acc = r[i];
+        for (int j = 1; j < i; j ++) acc += a[j] * r[i - j];
+
+        double k = -acc / err;
+        double newErr = err * (1.0 - k * k);
+        if (newErr <= 1e-9 * r[0]) break;
+
+        for (int j = 1; j <= i / 2; j ++)
+        {
+            double aj = a[j];
+            double aij = a[i - j];
+            a[j] = aj + k * aij;
+            if (j != i - j) a[i - j] = aij + k * aj;
+        }
+        a[i] = k;
+        err = newErr;
+    }
+    return err;
+}
+
+
+// Converts a filtered value to the sample type, rounding & saturating in
+// integer builds
+static inline SAMPLETYPE _toSample(float value)
+{
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    value = (value < -32768.0f) ? -32768.0f : (value > 32767.0f) ? 32767.0f : value;
+    return (SAMPLETYPE)(value + ((value >= 0) ? 0.5f : -0.5f));
+#else
+    return (SAMPLETYPE)value;
+#endif
+}
+
+
+FormantCorrector::FormantCorrector()
+{
+    channels = 0;
+    sampleRate = 0;
+    windowLength = hopLength = hopPos = 0;
+    shift = 1.0;
+    restart = false;
+    window = history = frame = NULL;
+    envCos = envSin = autoCos = NULL;
+    inputHistory = outputHistory = NULL;
+    gain = prevGain = 1.0f;
+    resetFilters();
+}
+
+
+FormantCorrector::~FormantCorrector()
+{
+    release();
+}
+
+
+void FormantCorrector::release()
+{
+    delete[] window;
+    delete[] history;
+    delete[] frame;
+    delete[] envCos;
+    delete[] envSin;
+    delete[] autoCos;
+    delete[] inputHistory;
+    delete[] outputHistory;
+    window = history = frame = NULL;
+    envCos = envSin = autoCos = NULL;
+    inputHistory = outputHistory = NULL;
+}
+
+
+void FormantCorrector::allocate()
+{
+    release();
+
+    window = new float[windowLength];
+    history = new float[windowLength];
+    frame = new float[windowLength];
+    envCos = new float[FORMANT_BANDS * (FORMANT_ORDER + 1)];
+    envSin = new float[FORMANT_BANDS * (FORMANT_ORDER + 1)];
+    autoCos = new float[(FORMANT_ORDER + 1) * FORMANT_BANDS];
+    inputHistory = new float[channels * (FORMANT_ORDER + hopLength)];
+    outputHistory = new float[channels * (FORMANT_ORDER + hopLength)];
+
+    for (int i = 0; i < windowLength; i ++)
+    {
+        window[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * (i + 0.5) / windowLength));
+    }
+
+    for (int k = 0; k < FORMANT_BANDS; k ++)
+    {
+        double w = M_PI * (k + 0.5) / FORMANT_BANDS;
+        for (int i = 0; i <= FORMANT_ORDER; i ++)
+        {
+            envCos[k * (FORMANT_ORDER + 1) + i] = (float)cos(w * i);
+            envSin[k * (FORMANT_ORDER + 1) + i] = (float)sin(w * i);
+            autoCos[i * FORMANT_BANDS + k] = (float)(cos(w * i) / FORMANT_BANDS);
+        }
+    }
+
+    for (int m = 0; m <= FORMANT_ORDER; m ++)
+    {
+        double x = 2.0 * M_PI * FORMANT_LAG_BW * m / sampleRate;
+        lagWindow[m] = (float)exp(-0.5 * x * x);
+    }
+}
+
+
+void FormantCorrector::setFormat(int numChannels, int newSampleRate)
+{
+    if ((numChannels == channels) && (newSampleRate == sampleRate)) return;
+
+    channels = numChannels;
+    sampleRate = newSampleRate;
+
+    // power of 2 closest to the window length in milliseconds, hop a quarter of it
+    double frames = 0.001 * FORMANT_WINDOW_MS * sampleRate;
+    windowLength = 1 << (int)(log(frames) / log(2.0) + 0.5);
+    if (windowLength < 64) windowLength = 64;
+    hopLength = windowLength / 4;
+
+    allocate();
+    clear();
+}
+
+
+void FormantCorrector::setShift(double newShift)
+{
+    // analyse right away when the correction starts, the filters are stale
+    if ((shift == 1.0) && (newShift != 1.0)) restart = true;
+    shift = newShift;
+}
+
+
+void FormantCorrector::resetFilters()
+{
+    memset(analysisCoefs, 0, sizeof(analysisCoefs));
+    memset(synthesisCoefs, 0, sizeof(synthesisCoefs));
+    analysisCoefs[FORMANT_ORDER] = 1.0f;
+    gain = prevGain = 1.0f;
+}
+
+
+void FormantCorrector::clear()
+{
+    if (window == NULL) return;
+
+    memset(history, 0, windowLength * sizeof(float));
+    memset(inputHistory, 0, channels * (FORMANT_ORDER + hopLength) * sizeof(float));
+    memset(outputHistory, 0, channels * (FORMANT_ORDER + hopLength) * sizeof(float));
+    resetFilters();
+    hopPos = hopLength;
+    restart = false;
+}
+
+
+void FormantCorrector::analyse()
+{
+    double r[FORMANT_ORDER + 1];
+    double a[FORMANT_ORDER + 1];
+    double b[FORMANT_ORDER + 1];
+    float af[FORMANT_ORDER + 1];
+    float env[FORMANT_BANDS];
+    float warped[FORMANT_BANDS];
+
+    prevGain = gain;
+
+    for (int i = 0; i < windowLength; i ++) frame[i] = history[i] * window[i];
+    for (int m = 0; m <= FORMANT_ORDER; m ++)
+    {
+        r[m] = simdDotProduct(frame, frame + m, windowLength - m) * lagWindow[m];
+    }
+    if (r[0] <= 0)
+    {
+        // silence, pass through
+        resetFilters();
+        return;
+    }
+    r[0] *= FORMANT_NOISE_FLOOR;
+    double errA = _levinson(r, a);
+
+    // envelope of the shifted sound at the band centres
+    for (int i = 0; i <= FORMANT_ORDER; i ++) af[i] = (float)a[i];
+    for (int k = 0; k < FORMANT_BANDS; k ++)
+    {
+        float re = simdDotProduct(af, envCos + k * (FORMANT_ORDER + 1), FORMANT_ORDER + 1);
+        float im = simdDotProduct(af, envSin + k * (FORMANT_ORDER + 1), FORMANT_ORDER + 1);
+        env[k] = (float)errA / (re * re + im * im + 1e-20f);
+    }
+
+    // the envelope at frequency w is moved to w * shift, so the original
+    // envelope at w is found at w * shift
+    for (int k = 0; k < FORMANT_BANDS; k ++)
+    {
+        double pos = (k + 0.5) * shift - 0.5;
+        if (pos <= 0)
+        {
+            warped[k] = env[0];
+        }
+        else if (pos >= FORMANT_BANDS - 1)
+        {
+            warped[k] = env[FORMANT_BANDS - 1];
+        }
+        else
+        {
+            int i = (int)pos;
+            float frac = (float)(pos - i);
+            warped[k] = env[i] + frac * (env[i + 1] - env[i]);
+        }
+    }
+
+    // keep the power of the envelope so that the loudness doesn't change
+    double power = 0, warpedPower = 0;
+    for (int k = 0; k < FORMANT_BANDS; k ++)
+    {
+        power += env[k];
+        warpedPower += warped[k];
+    }
+    double norm = power / warpedPower;
+
+    for (int m = 0; m <= FORMANT_ORDER; m ++)
+    {
+        r[m] = norm * simdDotProduct(warped, autoCos + m * FORMANT_BANDS, FORMANT_BANDS) * lagWindow[m];
+    }
+    r[0] *= FORMANT_NOISE_FLOOR;
+    double errB = _levinson(r, b);
+
+    gain = (float)sqrt(errB / errA);
+    for (int i = 0; i <= FORMANT_ORDER; i ++) analysisCoefs[i] = (float)a[FORMANT_ORDER - i];
+    for (int i = 0; i < FORMANT_ORDER; i ++) synthesisCoefs[i] = (float)b[FORMANT_ORDER - i];
+}
+
+
+void FormantCorrector::filter(SAMPLETYPE *samples, int numFrames)
+{
+    const int stride = FORMANT_ORDER + hopLength;
+    const float gainStep = (gain - prevGain) / hopLength;
+
+    for (int c = 0; c < channels; c ++)
+    {
+        float *xh = inputHistory + c * stride + hopPos;
+        float *yh = outputHistory + c * stride + hopPos;
+        SAMPLETYPE *ptr = samples + c;
+
+        if (shift == 1.0)
+        {
+            for (int j = 0; j < numFrames; j ++)
+            {
+                xh[FORMANT_ORDER + j] = yh[FORMANT_ORDER + j] = (float)ptr[j * channels];
+            }
+            continue;
+        }
+
+        float g = prevGain + gainStep * hopPos;
+        for (int j = 0; j < numFrames; j ++)
+        {
+            xh[FORMANT_ORDER + j] = (float)ptr[j * channels];
+            float e = simdDotProduct(analysisCoefs, xh + j, FORMANT_ORDER + 1);
+            float y = g * e - simdDotProduct(synthesisCoefs, yh + j, FORMANT_ORDER) + FORMANT_DENORMAL;
+            yh[FORMANT_ORDER + j] = y;
+            ptr[j * channels] = _toSample(y);
+            g += gainStep;
+        }
+    }
+}
+
+
+void FormantCorrector::updateHistory(const SAMPLETYPE *samples, int numFrames)
+{
+    const float scale = 1.0f / channels;
+
+    memmove(history, history + numFrames, (windowLength - numFrames) * sizeof(float));
+    float *dest = history + windowLength - numFrames;
+    for (int j = 0; j < numFrames; j ++)
+    {
+        float sum = 0;
+        for (int c = 0; c < channels; c ++) sum += (float)samples[j * channels + c];
+        dest[j] = sum * scale;
+    }
+}
+
+
+void FormantCorrector::process(SAMPLETYPE *samples, uint numFrames)
+{
+    const int stride = FORMANT_ORDER + hopLength;
+
+    if (window == NULL) return;
+
+    while (numFrames > 0)
+    {
+        if ((hopPos == hopLength) || restart)
+        {
+            // keep the last FORMANT_ORDER frames of the filter histories
+            for (int c = 0; c < channels; c ++)
+            {
+                memmove(inputHistory + c * stride, inputHistory + c * stride + hopPos, FORMANT_ORDER * sizeof(float));
+                memmove(outputHistory + c * stride, outputHistory + c * stride + hopPos, FORMANT_ORDER * sizeof(float));
+            }
+            hopPos = 0;
+            restart = false;
+            if (shift != 1.0) analyse();
+        }
+
+        int n = hopLength - hopPos;
+        if (n > (int)numFrames) n = (int)numFrames;
+
+        updateHistory(samples, n);
+        filter(samples, n);
+
+        hopPos += n;
+        samples += n * channels;
+        numFrames -= n;
+    }
+}
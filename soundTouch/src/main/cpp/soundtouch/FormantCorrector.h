@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Formant correction for pitch shifted sound. Transposing the rate shifts
+/// the spectral envelope, i.e. the formants of voices, together with the
+/// pitch. This class moves the envelope back to the original frequencies:
+///
+/// - Every hop, a linear prediction (LPC) envelope is estimated from the
+///   latest processed sound, warped in frequency by the inverse of the pitch
+///   shift, and converted to an all-pole model again.
+/// - The sound is whitened with the analysis filter of the shifted envelope
+///   and resynthesized with the all-pole filter of the warped envelope.
+///
+/// The analysis is causal and the filters run sample by sample, so the
+/// correction adds no latency. Autocorrelation, envelope evaluation and the
+/// filters use the SIMD dot product kernels of STSimd.h.
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FormantCorrector_H
+#define FormantCorrector_H
+
+#include "STTypes.h"
+
+namespace soundtouch
+{
+
+/// Order of the LPC envelope model
+#define FORMANT_ORDER       24
+
+/// Number of frequencies the envelope is evaluated at for warping
+#define FORMANT_BANDS       128
+
+class FormantCorrector
+{
+private:
+    int channels;
+    int sampleRate;
+
+    /// Analysis window length and hop between analyses in frames
+    int windowLength;
+    int hopLength;
+
+    /// Frames filtered with the current filters, and whether to start a new
+    /// hop before the current one is complete
+    int hopPos;
+    bool restart;
+
+    /// Formant shift to undo, i.e. the transposing rate
+    double shift;
+
+    /// Analysis window, mono history of the latest 'windowLength' frames
+    /// and the windowed frame
+    float *window;
+    float *history;
+    float *frame;
+
+    /// cos & sin(w_k * i) for evaluating the envelope at the band centres
+    /// w_k, [FORMANT_BANDS][FORMANT_ORDER + 1], and cos(w_k * m) / FORMANT_BANDS
+    /// for transforming the warped envelope to autocorrelation,
+    /// [FORMANT_ORDER + 1][FORMANT_BANDS]
+    float *envCos;
+    float *envSin;
+    float *autoCos;
+
+    /// Lag window of the autocorrelation
+    float lagWindow[FORMANT_ORDER + 1];
+
+    /// Analysis filter coefficients of the shifted envelope and synthesis
+    /// coefficients of the warped envelope, both in reverse order so that
+    /// a dot product with the history gives the filter output. The analysis
+    /// filter includes the unity coefficient of the current sample last.
+    float analysisCoefs[FORMANT_ORDER + 1];
+    float synthesisCoefs[FORMANT_ORDER];
+
+    /// Gain of the current and of the previous hop, interpolated over the hop
+    float gain;
+    float prevGain;
+
+    /// Per-channel input & output histories for the filters, each
+    /// FORMANT_ORDER + hopLength frames
+    float *inputHistory;
+    float *outputHistory;
+
+    void allocate();
+    void release();
+    void resetFilters();
+
+    /// Estimates envelopes from 'history' and updates the filters
+    void analyse();
+
+    /// Filters 'numFrames' <= hopLength - hopPos interleaved frames in place
+    void filter(SAMPLETYPE *samples, int numFrames);
+
+    /// Appends the mono mix of 'numFrames' frames to the analysis history
+    void updateHistory(const SAMPLETYPE *samples, int numFrames);
+
+public:
+    FormantCorrector();
+    ~FormantCorrector();
+
+    /// Sets the number of channels and the sample rate. Allocates the buffers.
+    void setFormat(int numChannels, int sampleRate);
+
+    /// Sets the formant shift to undo, i.e. the rate by which the sound has
+    /// been transposed. 1.0 bypasses the correction.
+    void setShift(double newShift);
+
+    /// Corrects 'numFrames' interleaved frames in place
+    void process(SAMPLETYPE *samples, uint numFrames);
+
+    /// Clears the histories & filter states
+    void clear();
+};
+
+}
+
+#endif
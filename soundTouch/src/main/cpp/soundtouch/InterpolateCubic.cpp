@@ -85,7 +85,7 @@ int InterpolateCubic::transposeMono(SAMPLETYPE *pdest,
 
         out = y0 * psrc[0] + y1 * psrc[1] + y2 * psrc[2] + y3 * psrc[3];
 
-        pdest[i] = (SAMPLETYPE)out;
+        pdest[i] = toSampleType(out);
         i ++;
 
         // update position fraction
@@ -131,8 +131,8 @@ int InterpolateCubic::transposeStereo(SAMPLETYPE *pdest,
         out0 = y0 * psrc[0] + y1 * psrc[2] + y2 * psrc[4] + y3 * psrc[6];
         out1 = y0 * psrc[1] + y1 * psrc[3] + y2 * psrc[5] + y3 * psrc[7];
 
-        pdest[2*i]   = (SAMPLETYPE)out0;
-        pdest[2*i+1] = (SAMPLETYPE)out1;
+        pdest[2*i]   = toSampleType(out0);
+        pdest[2*i+1] = toSampleType(out1);
         i ++;
 
         // update position fraction
@@ -154,6 +154,27 @@ int InterpolateCubic::transposeMulti(SAMPLETYPE *pdest,
                     const SAMPLETYPE *psrc, 
                     int &srcSamples)
 {
+    // common layouts get kernels with the channel count known at compile time
+    switch (numChannels)
+    {
+        case 4:
+            return transposeMultiCh<4>(pdest, psrc, srcSamples);
+        case 6:
+            return transposeMultiCh<6>(pdest, psrc, srcSamples);
+        case 8:
+            return transposeMultiCh<8>(pdest, psrc, srcSamples);
+        default:
+            return transposeMultiCh<0>(pdest, psrc, srcSamples);
+    }
+}
+
+
+template <int CH>
+int InterpolateCubic::transposeMultiCh(SAMPLETYPE *pdest, 
+                    const SAMPLETYPE *psrc, 
+                    int &srcSamples)
+{
+    const int channels = CH ? CH : numChannels;
     int i;
     int srcSampleEnd = srcSamples - 4;
     int srcCount = 0;
@@ -174,11 +195,11 @@ int InterpolateCubic::transposeMulti(SAMPLETYPE *pdest,
         y2 =  _coeffs[8] * x0 +  _coeffs[9] * x1 + _coeffs[10] * x2 + _coeffs[11] * x3;
         y3 = _coeffs[12] * x0 + _coeffs[13] * x1 + _coeffs[14] * x2 + _coeffs[15] * x3;
 
-        for (int c = 0; c < numChannels; c ++)
+        for (int c = 0; c < channels; c ++)
         {
             float out;
-            out = y0 * psrc[c] + y1 * psrc[c + numChannels] + y2 * psrc[c + 2 * numChannels] + y3 * psrc[c + 3 * numChannels];
-            pdest[0] = (SAMPLETYPE)out;
+            out = y0 * psrc[c] + y1 * psrc[c + channels] + y2 * psrc[c + 2 * channels] + y3 * psrc[c + 3 * channels];
+            pdest[0] = toSampleType(out);
             pdest ++;
         }
         i ++;
@@ -188,7 +209,7 @@ int InterpolateCubic::transposeMulti(SAMPLETYPE *pdest,
         // update whole positions
         int whole = (int)fract;
         fract -= whole;
-        psrc += numChannels*whole;
+        psrc += channels*whole;
         srcCount += whole;
     }
     srcSamples = srcCount;
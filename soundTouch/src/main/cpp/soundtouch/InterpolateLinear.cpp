@@ -132,6 +132,25 @@ int InterpolateLinearInteger::transposeStereo(SAMPLETYPE *dest, const SAMPLETYPE
 
 int InterpolateLinearInteger::transposeMulti(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples)
 {
+    // common layouts get kernels with the channel count known at compile time
+    switch (numChannels)
+    {
+        case 4:
+            return transposeMultiCh<4>(dest, src, srcSamples);
+        case 6:
+            return transposeMultiCh<6>(dest, src, srcSamples);
+        case 8:
+            return transposeMultiCh<8>(dest, src, srcSamples);
+        default:
+            return transposeMultiCh<0>(dest, src, srcSamples);
+    }
+}
+
+
+template <int CH>
+int InterpolateLinearInteger::transposeMultiCh(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples)
+{
+    const int channels = CH ? CH : numChannels;
     int i;
     int srcSampleEnd = srcSamples - 1;
     int srcCount = 0;
@@ -143,9 +162,9 @@ int InterpolateLinearInteger::transposeMulti(SAMPLETYPE *dest, const SAMPLETYPE
     
         assert(iFract < SCALE);
         vol1 = (LONG_SAMPLETYPE)(SCALE - iFract);
-        for (int c = 0; c < numChannels; c ++)
+        for (int c = 0; c < channels; c ++)
         {
-            temp = vol1 * src[c] + iFract * src[c + numChannels];
+            temp = vol1 * src[c] + iFract * src[c + channels];
             dest[0] = (SAMPLETYPE)(temp / SCALE);
             dest ++;
         }
@@ -156,7 +175,7 @@ int InterpolateLinearInteger::transposeMulti(SAMPLETYPE *dest, const SAMPLETYPE
         int iWhole = iFract / SCALE;
         iFract -= iWhole * SCALE;
         srcCount += iWhole;
-        src += iWhole * numChannels;
+        src += iWhole * channels;
     }
     srcSamples = srcCount;
 
@@ -264,6 +283,25 @@ int InterpolateLinearFloat::transposeStereo(SAMPLETYPE *dest, const SAMPLETYPE *
 
 int InterpolateLinearFloat::transposeMulti(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples)
 {
+    // common layouts get kernels with the channel count known at compile time
+    switch (numChannels)
+    {
+        case 4:
+            return transposeMultiCh<4>(dest, src, srcSamples);
+        case 6:
+            return transposeMultiCh<6>(dest, src, srcSamples);
+        case 8:
+            return transposeMultiCh<8>(dest, src, srcSamples);
+        default:
+            return transposeMultiCh<0>(dest, src, srcSamples);
+    }
+}
+
+
+template <int CH>
+int InterpolateLinearFloat::transposeMultiCh(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples)
+{
+    const int channels = CH ? CH : numChannels;
     int i;
     int srcSampleEnd = srcSamples - 1;
     int srcCount = 0;
@@ -275,9 +313,9 @@ int InterpolateLinearFloat::transposeMulti(SAMPLETYPE *dest, const SAMPLETYPE *s
     
         vol1 = (float)(1.0 - fract);
 		fract_float = (float)fract;
-        for (int c = 0; c < numChannels; c ++)
+        for (int c = 0; c < channels; c ++)
         {
-			temp = vol1 * src[c] + fract_float * src[c + numChannels];
+			temp = vol1 * src[c] + fract_float * src[c + channels];
             *dest = (SAMPLETYPE)temp;
             dest ++;
         }
@@ -288,7 +326,7 @@ int InterpolateLinearFloat::transposeMulti(SAMPLETYPE *dest, const SAMPLETYPE *s
         int iWhole = (int)fract;
         fract -= iWhole;
         srcCount += iWhole;
-        src += iWhole * numChannels;
+        src += iWhole * channels;
     }
     srcSamples = srcCount;
 
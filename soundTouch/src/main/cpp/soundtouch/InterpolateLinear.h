@@ -52,6 +52,10 @@ protected:
                          const SAMPLETYPE *src, 
                          int &srcSamples);
     virtual int transposeMulti(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples);
+
+    /// transposeMulti() for CH channels, or for 'numChannels' if CH is 0
+    template <int CH>
+    int transposeMultiCh(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples);
 public:
     InterpolateLinearInteger();
 
@@ -82,6 +86,10 @@ protected:
                          int &srcSamples);
     virtual int transposeMulti(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples);
 
+    /// transposeMulti() for CH channels, or for 'numChannels' if CH is 0
+    template <int CH>
+    int transposeMultiCh(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples);
+
 public:
     InterpolateLinearFloat();
 
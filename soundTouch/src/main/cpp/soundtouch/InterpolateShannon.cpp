@@ -3,9 +3,11 @@
 /// Sample interpolation routine using 8-tap band-limited Shannon interpolation 
 /// with kaiser window.
 ///
-/// Notice. This algorithm is remarkably much heavier than linear or cubic
-/// interpolation, and not remarkably better than cubic algorithm. Thus mostly
-/// for experimental purposes
+/// The tap weights are read from a precomputed polyphase table with linear
+/// interpolation between the table phases, instead of evaluating the sinc
+/// function for every output sample, and the dot products use SIMD. This makes
+/// the algorithm cheap enough for real-time use, at the cost of a small
+/// deviation (within 2 LSB at 16bit resolution) from the exact sinc weights.
 ///
 /// Author        : Copyright (c) Olli Parviainen
 /// Author e-mail : oparviai 'at' iki.fi
@@ -37,6 +39,7 @@
 #include <math.h>
 #include "InterpolateShannon.h"
 #include "STTypes.h"
+#include "STSimd.h"
 
 using namespace soundtouch;
 
@@ -56,9 +59,71 @@ static const double _kaiser8[8] =
 };
 
 
+#define PI 3.1415926536
+#define sinc(x) (sin(PI * (x)) / (PI * (x)))
+
+/// Number of fractional phases in the coefficient table. Weights between two
+/// phases are interpolated linearly, the resulting weight error is below 1e-5.
+#define SHANNON_PHASES  256
+
+
+/// Polyphase coefficient table: row 'p' has the 8 tap weights for fractional
+/// position p / SHANNON_PHASES, and the difference to the weights of the next
+/// phase for interpolating between the rows.
+struct ShannonTable
+{
+    float coeff[SHANNON_PHASES][8];
+    float delta[SHANNON_PHASES][8];
+
+    ShannonTable()
+    {
+        double w[SHANNON_PHASES + 1][8];
+
+        for (int p = 0; p <= SHANNON_PHASES; p ++)
+        {
+            double fract = (double)p / SHANNON_PHASES;
+            for (int k = 0; k < 8; k ++)
+            {
+                double x = (double)(k - 3) - fract;
+                w[p][k] = ((x == 0) ? 1.0 : sinc(x)) * _kaiser8[k];     // sinc(0) = 1
+            }
+        }
+        for (int p = 0; p < SHANNON_PHASES; p ++)
+        {
+            for (int k = 0; k < 8; k ++)
+            {
+                coeff[p][k] = (float)w[p][k];
+                delta[p][k] = (float)(w[p + 1][k] - w[p][k]);
+            }
+        }
+    }
+};
+
+
+/// Returns the coefficient table, built once at first use
+static const ShannonTable &shannonTable()
+{
+    static const ShannonTable table;
+    return table;
+}
+
+
+/// Interpolates tap weights for position 'fract' (0 <= fract < 1) from the table
+static inline void shannonWeights(const ShannonTable &table, double fract, simd4f &w0, simd4f &w1)
+{
+    double pos = fract * SHANNON_PHASES;
+    int p = (int)pos;
+    simd4f t = simdSet1((float)(pos - p));
+
+    w0 = simdMulAdd(simdLoad(table.coeff[p]), t, simdLoad(table.delta[p]));
+    w1 = simdMulAdd(simdLoad(table.coeff[p] + 4), t, simdLoad(table.delta[p] + 4));
+}
+
+
 InterpolateShannon::InterpolateShannon()
 {
     fract = 0;
+    shannonTable();
 }
 
 
@@ -68,9 +133,6 @@ void InterpolateShannon::resetRegisters()
 }
 
 
-#define PI 3.1415926536
-#define sinc(x) (sin(PI * (x)) / (PI * (x)))
-
 /// Transpose mono audio. Returns number of produced output samples, and 
 /// updates "srcSamples" to amount of consumed source samples
 int InterpolateShannon::transposeMono(SAMPLETYPE *pdest, 
@@ -80,30 +142,18 @@ int InterpolateShannon::transposeMono(SAMPLETYPE *pdest,
     int i;
     int srcSampleEnd = srcSamples - 8;
     int srcCount = 0;
+    const ShannonTable &table = shannonTable();
 
     i = 0;
     while (srcCount < srcSampleEnd)
     {
-        double out;
+        simd4f w0, w1;
         assert(fract < 1.0);
 
-        out  = psrc[0] * sinc(-3.0 - fract) * _kaiser8[0];
-        out += psrc[1] * sinc(-2.0 - fract) * _kaiser8[1];
-        out += psrc[2] * sinc(-1.0 - fract) * _kaiser8[2];
-        if (fract < 1e-6)
-        {
-            out += psrc[3] * _kaiser8[3];     // sinc(0) = 1
-        }
-        else
-        {
-            out += psrc[3] * sinc(- fract) * _kaiser8[3];
-        }
-        out += psrc[4] * sinc( 1.0 - fract) * _kaiser8[4];
-        out += psrc[5] * sinc( 2.0 - fract) * _kaiser8[5];
-        out += psrc[6] * sinc( 3.0 - fract) * _kaiser8[6];
-        out += psrc[7] * sinc( 4.0 - fract) * _kaiser8[7];
+        shannonWeights(table, fract, w0, w1);
+        simd4f sum = simdMulAdd(simdMul(w0, simdLoad(psrc)), w1, simdLoad(psrc + 4));
 
-        pdest[i] = (SAMPLETYPE)out;
+        pdest[i] = toSampleType(simdHsum(sum));
         i ++;
 
         // update position fraction
@@ -128,32 +178,27 @@ int InterpolateShannon::transposeStereo(SAMPLETYPE *pdest,
     int i;
     int srcSampleEnd = srcSamples - 8;
     int srcCount = 0;
+    const ShannonTable &table = shannonTable();
 
     i = 0;
     while (srcCount < srcSampleEnd)
     {
-        double out0, out1, w;
+        simd4f w0, w1, sum;
+        float out[4];
         assert(fract < 1.0);
 
-        w = sinc(-3.0 - fract) * _kaiser8[0];
-        out0 = psrc[0] * w; out1 = psrc[1] * w;
-        w = sinc(-2.0 - fract) * _kaiser8[1];
-        out0 += psrc[2] * w; out1 += psrc[3] * w;
-        w = sinc(-1.0 - fract) * _kaiser8[2];
-        out0 += psrc[4] * w; out1 += psrc[5] * w;
-        w = _kaiser8[3] * ((fract < 1e-5) ? 1.0 : sinc(- fract));   // sinc(0) = 1
-        out0 += psrc[6] * w; out1 += psrc[7] * w;
-        w = sinc( 1.0 - fract) * _kaiser8[4];
-        out0 += psrc[8] * w; out1 += psrc[9] * w;
-        w = sinc( 2.0 - fract) * _kaiser8[5];
-        out0 += psrc[10] * w; out1 += psrc[11] * w;
-        w = sinc( 3.0 - fract) * _kaiser8[6];
-        out0 += psrc[12] * w; out1 += psrc[13] * w;
-        w = sinc( 4.0 - fract) * _kaiser8[7];
-        out0 += psrc[14] * w; out1 += psrc[15] * w;
-
-        pdest[2*i]   = (SAMPLETYPE)out0;
-        pdest[2*i+1] = (SAMPLETYPE)out1;
+        shannonWeights(table, fract, w0, w1);
+
+        // duplicate each weight for the left & right channel of interleaved
+        // source frames, 'sum' collects (left, right, left, right) partial sums
+        sum = simdMul(simdInterleaveLo(w0, w0), simdLoad(psrc));
+        sum = simdMulAdd(sum, simdInterleaveHi(w0, w0), simdLoad(psrc + 4));
+        sum = simdMulAdd(sum, simdInterleaveLo(w1, w1), simdLoad(psrc + 8));
+        sum = simdMulAdd(sum, simdInterleaveHi(w1, w1), simdLoad(psrc + 12));
+        simdStore(out, sum);
+
+        pdest[2*i]   = toSampleType(out[0] + out[2]);
+        pdest[2*i+1] = toSampleType(out[1] + out[3]);
         i ++;
 
         // update position fraction
@@ -169,13 +214,85 @@ int InterpolateShannon::transposeStereo(SAMPLETYPE *pdest,
 }
 
 
-/// Transpose stereo audio. Returns number of produced output samples, and 
+/// Transpose multi-channel audio. Returns number of produced output samples, and 
 /// updates "srcSamples" to amount of consumed source samples
 int InterpolateShannon::transposeMulti(SAMPLETYPE *pdest, 
                     const SAMPLETYPE *psrc, 
                     int &srcSamples)
 {
-    // not implemented
-    assert(false);
-    return 0;
+    // common layouts get kernels with the channel count known at compile time
+    switch (numChannels)
+    {
+        case 4:
+            return transposeMultiCh<4>(pdest, psrc, srcSamples);
+        case 6:
+            return transposeMultiCh<6>(pdest, psrc, srcSamples);
+        case 8:
+            return transposeMultiCh<8>(pdest, psrc, srcSamples);
+        default:
+            return transposeMultiCh<0>(pdest, psrc, srcSamples);
+    }
+}
+
+
+template <int CH>
+int InterpolateShannon::transposeMultiCh(SAMPLETYPE *pdest, 
+                    const SAMPLETYPE *psrc, 
+                    int &srcSamples)
+{
+    const int channels = CH ? CH : numChannels;
+    int i;
+    int srcSampleEnd = srcSamples - 8;
+    int srcCount = 0;
+    const ShannonTable &table = shannonTable();
+
+    i = 0;
+    while (srcCount < srcSampleEnd)
+    {
+        simd4f w0, w1;
+        float w[8];
+        float out[4];
+        int c;
+        assert(fract < 1.0);
+
+        shannonWeights(table, fract, w0, w1);
+        simdStore(w, w0);
+        simdStore(w + 4, w1);
+
+        // four channels at a time, then the remaining channels one by one
+        for (c = 0; c + 4 <= channels; c += 4)
+        {
+            simd4f sum = simdZero();
+            for (int k = 0; k < 8; k ++)
+            {
+                sum = simdMulAdd(sum, simdSet1(w[k]), simdLoad(psrc + k * channels + c));
+            }
+            simdStore(out, sum);
+            for (int j = 0; j < 4; j ++)
+            {
+                pdest[c + j] = toSampleType(out[j]);
+            }
+        }
+        for (; c < channels; c ++)
+        {
+            float sum = 0;
+            for (int k = 0; k < 8; k ++)
+            {
+                sum += w[k] * psrc[k * channels + c];
+            }
+            pdest[c] = toSampleType(sum);
+        }
+        pdest += channels;
+        i ++;
+
+        // update position fraction
+        fract += rate;
+        // update whole positions
+        int whole = (int)fract;
+        fract -= whole;
+        psrc += channels * whole;
+        srcCount += whole;
+    }
+    srcSamples = srcCount;
+    return i;
 }
@@ -56,6 +56,10 @@ protected:
                         const SAMPLETYPE *src, 
                         int &srcSamples);
 
+    /// transposeMulti() for CH channels, or for 'numChannels' if CH is 0
+    template <int CH>
+    int transposeMultiCh(SAMPLETYPE *dest, const SAMPLETYPE *src, int &srcSamples);
+
     double fract;
 
 public:
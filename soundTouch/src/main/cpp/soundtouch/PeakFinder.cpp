@@ -132,38 +132,38 @@ int PeakFinder::findGround(const float *data, int peakpos, int direction) const
 }
 
 
-// Find offset where the value crosses the given level, when starting from 'peakpos' and
-// proceeds to direction defined in 'direction'
-int PeakFinder::findCrossingLevel(const float *data, float level, int peakpos, int direction) const
+// Calculates the center of mass location of the 'data' array items around 'peakpos'
+// that are at or above 'level'. Proceeds from 'peakpos' to both directions until the
+// next item is below 'level', summing up the items on the way.
+double PeakFinder::calcMassCenter(const float *data, float level, int peakpos) const
 {
-    float peaklevel;
     int pos;
+    double sum;
+    double wsum;
 
-    peaklevel = data[peakpos];
-    assert(peaklevel >= level);
+    assert(data[peakpos] >= level);
+    sum = (double)peakpos * data[peakpos];
+    wsum = data[peakpos];
+
+    // left-hand side
     pos = peakpos;
-    while ((pos >= minPos) && (pos + direction < maxPos))
+    while (data[pos - 1] >= level)
     {
-        if (data[pos + direction] < level) return pos;   // crossing found
-        pos += direction;
+        pos --;
+        if (pos < minPos) return 0;     // no crossing, no peak..
+        sum += (double)pos * data[pos];
+        wsum += data[pos];
     }
-    return -1;  // not found
-}
-
-
-// Calculates the center of mass location of 'data' array items between 'firstPos' and 'lastPos'
-double PeakFinder::calcMassCenter(const float *data, int firstPos, int lastPos) const
-{
-    int i;
-    float sum;
-    float wsum;
 
-    sum = 0;
-    wsum = 0;
-    for (i = firstPos; i <= lastPos; i ++)
+    // right-hand side
+    pos = peakpos;
+    while (true)
     {
-        sum += (float)i * data[i];
-        wsum += data[i];
+        if (pos + 1 >= maxPos) return 0;
+        if (data[pos + 1] < level) break;
+        pos ++;
+        sum += (double)pos * data[pos];
+        wsum += data[pos];
     }
 
     if (wsum < 1e-6) return 0;
@@ -175,7 +175,6 @@ double PeakFinder::calcMassCenter(const float *data, int firstPos, int lastPos)
 double PeakFinder::getPeakCenter(const float *data, int peakpos) const
 {
     float peakLevel;            // peak level
-    int crosspos1, crosspos2;   // position where the peak 'hump' crosses cutting level
     float cutLevel;             // cutting value
     float groundLevel;          // ground level of the peak
     int gp1, gp2;               // bottom positions of the peak 'hump'
@@ -199,14 +198,8 @@ double PeakFinder::getPeakCenter(const float *data, int peakpos) const
         cutLevel = 0.70f * peakLevel + 0.30f * groundLevel;
     }
 
-    // find mid-level crossings
-    crosspos1 = findCrossingLevel(data, cutLevel, peakpos, -1);
-    crosspos2 = findCrossingLevel(data, cutLevel, peakpos, 1);
-
-    if ((crosspos1 < 0) || (crosspos2 < 0)) return 0;   // no crossing, no peak..
-
-    // calculate mass center of the peak surroundings
-    return calcMassCenter(data, crosspos1, crosspos2);
+    // calculate mass center of the peak surroundings above the cutting level
+    return calcMassCenter(data, cutLevel, peakpos);
 }
 
 
@@ -42,20 +42,17 @@ protected:
     /// Min, max allowed peak positions within the data vector
     int minPos, maxPos;
 
-    /// Calculates the mass center between given vector items.
+    /// Calculates the mass center of the vector items around the peak that are above
+    /// the given level, i.e. between the positions where the signal decreasing from
+    /// the peak crosses the level on either side. Finds the crossings and sums up
+    /// the mass in the same pass.
+    ///
+    /// \return The mass center, or 0 if no crossing within the allowed range.
     double calcMassCenter(const float *data, ///< Data vector.
-                         int firstPos,      ///< Index of first vector item belonging to the peak.
-                         int lastPos        ///< Index of last vector item belonging to the peak.
+                         float level,       ///< Crossing level.
+                         int peakpos        ///< Peak position index within the data vector.
                          ) const;
 
-    /// Finds the data vector index where the monotoniously decreasing signal crosses the
-    /// given level.
-    int   findCrossingLevel(const float *data,  ///< Data vector.
-                            float level,        ///< Goal crossing level.
-                            int peakpos,        ///< Peak position index within the data vector.
-                            int direction       /// Direction where to proceed from the peak: 1 = right, -1 = left.
-                            ) const;
-
     // Finds real 'top' of a peak hump from neighnourhood of the given 'peakpos'.
     int findTop(const float *data, int peakpos) const;
 
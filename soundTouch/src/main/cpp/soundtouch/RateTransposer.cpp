@@ -43,10 +43,6 @@
 
 using namespace soundtouch;
 
-// Define default interpolation algorithm here
-TransposerBase::ALGORITHM TransposerBase::algorithm = TransposerBase::CUBIC;
-
-
 // Constructor
 RateTransposer::RateTransposer() : FIFOProcessor(&outputBuffer)
 {
@@ -60,7 +56,8 @@ RateTransposer::RateTransposer() : FIFOProcessor(&outputBuffer)
 
     // Instantiates the anti-alias filter
     pAAFilter = new AAFilter(64);
-    pTransposer = TransposerBase::newInstance();
+    algorithm = TransposerBase::defaultAlgorithm();
+    pTransposer = TransposerBase::newInstance(algorithm);
     clear();
 }
 
@@ -96,6 +93,29 @@ AAFilter *RateTransposer::getAAFilter()
 }
 
 
+/// Sets the interpolation algorithm
+void RateTransposer::setAlgorithm(TransposerBase::ALGORITHM a)
+{
+    if (a == algorithm) return;
+
+    TransposerBase *pNew = TransposerBase::newInstance(a);
+    if (pNew == NULL) return;
+
+    pNew->setRate(pTransposer->rate);
+    pNew->setChannels(pTransposer->numChannels);
+    delete pTransposer;
+    pTransposer = pNew;
+    algorithm = a;
+}
+
+
+/// Returns the interpolation algorithm in use
+TransposerBase::ALGORITHM RateTransposer::getAlgorithm() const
+{
+    return algorithm;
+}
+
+
 // Sets new target iRate. Normal iRate = 1.0, smaller values represent slower 
 // iRate, larger faster iRates.
 void RateTransposer::setRate(double newRate)
@@ -117,6 +137,19 @@ void RateTransposer::setRate(double newRate)
 }
 
 
+// Preallocates the sample buffers for a typical input block at the lowest rate
+// FIFO_RESERVE_RATE_MIN, i.e. the largest output, so that rate changes during
+// processing don't allocate memory
+void RateTransposer::reserveBuffers()
+{
+    uint maxBlock = (uint)(FIFO_TYPICAL_BLOCK_SIZE / FIFO_RESERVE_RATE_MIN);
+
+    inputBuffer.reserve(2 * FIFO_TYPICAL_BLOCK_SIZE);
+    midBuffer.reserve(maxBlock + FIFO_TYPICAL_BLOCK_SIZE);
+    outputBuffer.reserve(maxBlock + FIFO_TYPICAL_BLOCK_SIZE);
+}
+
+
 // Adds 'nSamples' pcs of samples from the 'samples' memory position into
 // the input of the object.
 void RateTransposer::putSamples(const SAMPLETYPE *samples, uint nSamples)
@@ -185,6 +218,7 @@ void RateTransposer::setChannels(int nChannels)
     inputBuffer.setChannels(nChannels);
     midBuffer.setChannels(nChannels);
     outputBuffer.setChannels(nChannels);
+    reserveBuffers();
 }
 
 
@@ -226,10 +260,14 @@ int RateTransposer::getLatency() const
 // TransposerBase - Base class for interpolation
 // 
 
-// static function to set interpolation algorithm
-void TransposerBase::setAlgorithm(TransposerBase::ALGORITHM a)
+// Default interpolation algorithm
+TransposerBase::ALGORITHM TransposerBase::defaultAlgorithm()
 {
-    TransposerBase::algorithm = a;
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    return LINEAR;
+#else
+    return CUBIC;
+#endif
 }
 
 
@@ -290,16 +328,17 @@ void TransposerBase::setRate(double newRate)
 
 
 // static factory function
-TransposerBase *TransposerBase::newInstance()
+TransposerBase *TransposerBase::newInstance(ALGORITHM a)
 {
-#ifdef SOUNDTOUCH_INTEGER_SAMPLES
-    // Notice: For integer arithmetic support only linear algorithm (due to simplest calculus)
-    return ::new InterpolateLinearInteger;
-#else
-    switch (algorithm)
+    switch (a)
     {
         case LINEAR:
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+            // integer builds use fixed-point arithmetic for the linear algorithm
+            return new InterpolateLinearInteger;
+#else
             return new InterpolateLinearFloat;
+#endif
 
         case CUBIC:
             return new InterpolateCubic;
@@ -308,8 +347,6 @@ TransposerBase *TransposerBase::newInstance()
             return new InterpolateShannon;
 
         default:
-            assert(false);
             return NULL;
     }
-#endif
 }
@@ -69,7 +69,15 @@ protected:
                         const SAMPLETYPE *src, 
                         int &srcSamples) = 0;
 
-    static ALGORITHM algorithm;
+    /// Converts an interpolated value to the sample type. Integer builds saturate
+    /// to 16 bit limits, as interpolators with overshoot may exceed them.
+    static inline SAMPLETYPE toSampleType(float value)
+    {
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+        value = (value < -32768.0f) ? -32768.0f : (value > 32767.0f) ? 32767.0f : value;
+#endif
+        return (SAMPLETYPE)value;
+    }
 
 public:
     double rate;
@@ -85,11 +93,11 @@ public:
 
     virtual void resetRegisters() = 0;
 
-    // static factory function
-    static TransposerBase *newInstance();
+    /// Default interpolation algorithm: LINEAR in integer builds, CUBIC in float builds
+    static ALGORITHM defaultAlgorithm();
 
-    // static function to set interpolation algorithm
-    static void setAlgorithm(ALGORITHM a);
+    // static factory function
+    static TransposerBase *newInstance(ALGORITHM a = defaultAlgorithm());
 };
 
 
@@ -114,6 +122,12 @@ protected:
 
     bool bUseAAFilter;
 
+    /// Preallocates the sample buffers, see FIFO_RESERVE_RATE_MIN
+    void reserveBuffers();
+
+    /// Interpolation algorithm of 'pTransposer'
+    TransposerBase::ALGORITHM algorithm;
+
 
     /// Transposes sample rate by applying anti-alias filter to prevent folding. 
     /// Returns amount of samples returned in the "dest" buffer.
@@ -138,6 +152,14 @@ public:
     /// Returns nonzero if anti-alias filter is enabled.
     bool isAAFilterEnabled() const;
 
+    /// Sets the interpolation algorithm. Intended to be set before processing;
+    /// changing it mid-stream keeps buffered samples but restarts interpolation
+    /// from the current input position, shifting output by a few samples.
+    void setAlgorithm(TransposerBase::ALGORITHM a);
+
+    /// Returns the interpolation algorithm in use
+    TransposerBase::ALGORITHM getAlgorithm() const;
+
     /// Sets new target rate. Normal rate = 1.0, smaller values represent slower 
     /// rate, larger faster rates.
     virtual void setRate(double newRate);
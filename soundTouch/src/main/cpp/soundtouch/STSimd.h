@@ -0,0 +1,286 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Small inline SIMD kernels shared by the analysis and processing routines.
+///
+/// Each kernel has a NEON variant (enabled with SOUNDTOUCH_USE_NEON, set by the
+/// Android build for ARM ABIs), an SSE2 variant (enabled together with the other
+/// x86 optimizations, see SOUNDTOUCH_ALLOW_X86_OPTIMIZATIONS in STTypes.h) and
+/// a plain C++ fallback. The SIMD variants sum in a different order than the
+/// scalar loop, so results may differ in the last bits of float precision.
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef STSimd_H
+#define STSimd_H
+
+#include "STTypes.h"
+
+#if defined(SOUNDTOUCH_USE_NEON)
+    #include <arm_neon.h>
+    #define ST_SIMD_NEON    1
+#elif defined(SOUNDTOUCH_ALLOW_X86_OPTIMIZATIONS) && (defined(__SSE2__) || defined(_M_X64))
+    #include <emmintrin.h>
+    #define ST_SIMD_SSE2    1
+#endif
+
+namespace soundtouch
+{
+
+#if ST_SIMD_SSE2
+    /// Horizontal sum of the four lanes of an SSE register
+    static inline float _hsum_ps(__m128 v)
+    {
+        __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sums = _mm_add_ps(v, shuf);
+        shuf = _mm_movehl_ps(shuf, sums);
+        sums = _mm_add_ss(sums, shuf);
+        return _mm_cvtss_f32(sums);
+    }
+#endif
+
+#if ST_SIMD_NEON
+    /// Horizontal sum of the four lanes of a NEON register
+    static inline float _hsum_f32(float32x4_t v)
+    {
+    #if defined(__aarch64__)
+        return vaddvq_f32(v);
+    #else
+        float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(s, s), 0);
+    #endif
+    }
+#endif
+
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    // 4-lane float vector helpers, for writing a kernel once for all targets.
+    // The plain C++ fallback uses a struct that compilers can autovectorize.
+    // simdInterleaveLo/Hi return (a0, b0, a1, b1) and (a2, b2, a3, b3).
+
+#if ST_SIMD_NEON
+    typedef float32x4_t simd4f;
+
+    static inline simd4f simdZero()                         { return vdupq_n_f32(0); }
+    static inline simd4f simdSet1(float x)                  { return vdupq_n_f32(x); }
+    static inline simd4f simdLoad(const float *p)           { return vld1q_f32(p); }
+    static inline simd4f simdLoad(const short *p)           { return vcvtq_f32_s32(vmovl_s16(vld1_s16(p))); }
+    static inline void   simdStore(float *p, simd4f v)      { vst1q_f32(p, v); }
+    static inline simd4f simdAdd(simd4f a, simd4f b)        { return vaddq_f32(a, b); }
+    static inline simd4f simdMul(simd4f a, simd4f b)        { return vmulq_f32(a, b); }
+    static inline simd4f simdMulAdd(simd4f acc, simd4f a, simd4f b) { return vmlaq_f32(acc, a, b); }
+    static inline float  simdHsum(simd4f v)                 { return _hsum_f32(v); }
+    static inline simd4f simdInterleaveLo(simd4f a, simd4f b) { return vzipq_f32(a, b).val[0]; }
+    static inline simd4f simdInterleaveHi(simd4f a, simd4f b) { return vzipq_f32(a, b).val[1]; }
+#elif ST_SIMD_SSE2
+    typedef __m128 simd4f;
+
+    static inline simd4f simdZero()                         { return _mm_setzero_ps(); }
+    static inline simd4f simdSet1(float x)                  { return _mm_set1_ps(x); }
+    static inline simd4f simdLoad(const float *p)           { return _mm_loadu_ps(p); }
+    static inline simd4f simdLoad(const short *p)
+    {
+        __m128i v = _mm_loadl_epi64((const __m128i *)p);
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+    }
+    static inline void   simdStore(float *p, simd4f v)      { _mm_storeu_ps(p, v); }
+    static inline simd4f simdAdd(simd4f a, simd4f b)        { return _mm_add_ps(a, b); }
+    static inline simd4f simdMul(simd4f a, simd4f b)        { return _mm_mul_ps(a, b); }
+    static inline simd4f simdMulAdd(simd4f acc, simd4f a, simd4f b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+    static inline float  simdHsum(simd4f v)                 { return _hsum_ps(v); }
+    static inline simd4f simdInterleaveLo(simd4f a, simd4f b) { return _mm_unpacklo_ps(a, b); }
+    static inline simd4f simdInterleaveHi(simd4f a, simd4f b) { return _mm_unpackhi_ps(a, b); }
+#else
+    struct simd4f
+    {
+        float v[4];
+    };
+
+    static inline simd4f simdSet1(float x)                  { simd4f r = {{x, x, x, x}}; return r; }
+    static inline simd4f simdZero()                         { return simdSet1(0); }
+    static inline simd4f simdLoad(const float *p)           { simd4f r = {{p[0], p[1], p[2], p[3]}}; return r; }
+    static inline simd4f simdLoad(const short *p)           { simd4f r = {{(float)p[0], (float)p[1], (float)p[2], (float)p[3]}}; return r; }
+    static inline void   simdStore(float *p, simd4f v)      { for (int i = 0; i < 4; i ++) p[i] = v.v[i]; }
+    static inline simd4f simdAdd(simd4f a, simd4f b)        { for (int i = 0; i < 4; i ++) a.v[i] += b.v[i]; return a; }
+    static inline simd4f simdMul(simd4f a, simd4f b)        { for (int i = 0; i < 4; i ++) a.v[i] *= b.v[i]; return a; }
+    static inline simd4f simdMulAdd(simd4f acc, simd4f a, simd4f b) { for (int i = 0; i < 4; i ++) acc.v[i] += a.v[i] * b.v[i]; return acc; }
+    static inline float  simdHsum(simd4f v)                 { return (v.v[0] + v.v[1]) + (v.v[2] + v.v[3]); }
+    static inline simd4f simdInterleaveLo(simd4f a, simd4f b) { simd4f r = {{a.v[0], b.v[0], a.v[1], b.v[1]}}; return r; }
+    static inline simd4f simdInterleaveHi(simd4f a, simd4f b) { simd4f r = {{a.v[2], b.v[2], a.v[3], b.v[3]}}; return r; }
+#endif
+
+
+    /// Dot product of two float vectors of 'count' items.
+    static inline float simdDotProduct(const float *a, const float *b, int count)
+    {
+        int i = 0;
+        float sum = 0;
+
+#if ST_SIMD_NEON
+        float32x4_t vSum0 = vdupq_n_f32(0);
+        float32x4_t vSum1 = vdupq_n_f32(0);
+        for (; i + 8 <= count; i += 8)
+        {
+            vSum0 = vmlaq_f32(vSum0, vld1q_f32(a + i), vld1q_f32(b + i));
+            vSum1 = vmlaq_f32(vSum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        for (; i + 4 <= count; i += 4)
+        {
+            vSum0 = vmlaq_f32(vSum0, vld1q_f32(a + i), vld1q_f32(b + i));
+        }
+        sum = _hsum_f32(vaddq_f32(vSum0, vSum1));
+#elif ST_SIMD_SSE2
+        __m128 vSum0 = _mm_setzero_ps();
+        __m128 vSum1 = _mm_setzero_ps();
+        for (; i + 8 <= count; i += 8)
+        {
+            vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            vSum1 = _mm_add_ps(vSum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        for (; i + 4 <= count; i += 4)
+        {
+            vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+        sum = _hsum_ps(_mm_add_ps(vSum0, vSum1));
+#endif
+        for (; i < count; i ++)
+        {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+
+    /// Dot product of a float vector and a 16bit integer vector of 'count' items.
+    /// The integer items are converted to float before multiplication.
+    static inline float simdDotProduct(const float *a, const short *b, int count)
+    {
+        int i = 0;
+        float sum = 0;
+
+#if ST_SIMD_NEON
+        float32x4_t vSum0 = vdupq_n_f32(0);
+        float32x4_t vSum1 = vdupq_n_f32(0);
+        for (; i + 8 <= count; i += 8)
+        {
+            int16x8_t vb = vld1q_s16(b + i);
+            float32x4_t vbLo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(vb)));
+            float32x4_t vbHi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(vb)));
+            vSum0 = vmlaq_f32(vSum0, vld1q_f32(a + i), vbLo);
+            vSum1 = vmlaq_f32(vSum1, vld1q_f32(a + i + 4), vbHi);
+        }
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t vb = vcvtq_f32_s32(vmovl_s16(vld1_s16(b + i)));
+            vSum0 = vmlaq_f32(vSum0, vld1q_f32(a + i), vb);
+        }
+        sum = _hsum_f32(vaddq_f32(vSum0, vSum1));
+#elif ST_SIMD_SSE2
+        __m128 vSum0 = _mm_setzero_ps();
+        __m128 vSum1 = _mm_setzero_ps();
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+            // sign-extend 16bit items to 32bit by unpacking to the high half & shifting back
+            __m128 vbLo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(vb, vb), 16));
+            __m128 vbHi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(vb, vb), 16));
+            vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(_mm_loadu_ps(a + i), vbLo));
+            vSum1 = _mm_add_ps(vSum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), vbHi));
+        }
+        sum = _hsum_ps(_mm_add_ps(vSum0, vSum1));
+#endif
+        for (; i < count; i ++)
+        {
+            sum += a[i] * (float)b[i];
+        }
+        return sum;
+    }
+
+
+    /// Sum of a float vector of 'count' items.
+    static inline float simdSum(const float *a, int count)
+    {
+        int i = 0;
+        float sum = 0;
+
+#if ST_SIMD_NEON || ST_SIMD_SSE2
+        simd4f vSum0 = simdZero();
+        simd4f vSum1 = simdZero();
+        for (; i + 8 <= count; i += 8)
+        {
+            vSum0 = simdAdd(vSum0, simdLoad(a + i));
+            vSum1 = simdAdd(vSum1, simdLoad(a + i + 4));
+        }
+        sum = simdHsum(simdAdd(vSum0, vSum1));
+#endif
+        for (; i < count; i ++)
+        {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+
+    /// Sum of a 16bit integer vector of 'count' items. The sum is exact.
+    static inline long simdSum(const short *a, int count)
+    {
+        int i = 0;
+        long sum = 0;
+
+#if ST_SIMD_NEON || ST_SIMD_SSE2
+        // the 32bit lanes can't overflow within 65536 items
+        while (i + 8 <= count)
+        {
+            int end = (count - i > 65536) ? i + 65536 : count;
+    #if ST_SIMD_NEON
+            int32x4_t vSum = vdupq_n_s32(0);
+            for (; i + 8 <= end; i += 8)
+            {
+                vSum = vpadalq_s16(vSum, vld1q_s16(a + i));
+            }
+            int32_t lanes[4];
+            vst1q_s32(lanes, vSum);
+    #else
+            const __m128i ones = _mm_set1_epi16(1);
+            __m128i vSum = _mm_setzero_si128();
+            for (; i + 8 <= end; i += 8)
+            {
+                vSum = _mm_add_epi32(vSum, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)), ones));
+            }
+            int lanes[4];
+            _mm_storeu_si128((__m128i *)lanes, vSum);
+    #endif
+            sum += (long)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+#endif
+        for (; i < count; i ++)
+        {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+}
+
+#endif
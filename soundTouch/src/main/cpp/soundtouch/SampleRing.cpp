@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Lock-free single-producer/single-consumer sample ring, see SampleRing.h
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "SampleRing.h"
+
+using namespace soundtouch;
+
+
+SampleRing::SampleRing(uint numChannels, uint minFrames)
+{
+    if (numChannels == 0) ST_THROW_RT_ERROR("SampleRing : illegal number of channels");
+
+    capacity = 1;
+    while (capacity < minFrames) capacity <<= 1;
+    channels = numChannels;
+    buffer = new SAMPLETYPE[(size_t)capacity * channels];
+    writePos = 0;
+    readPos = 0;
+}
+
+
+SampleRing::~SampleRing()
+{
+    delete[] buffer;
+}
+
+
+uint SampleRing::numFrames() const
+{
+    return (uint)(writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_relaxed));
+}
+
+
+uint SampleRing::numFree() const
+{
+    return capacity - (uint)(writePos.load(std::memory_order_relaxed) - readPos.load(std::memory_order_acquire));
+}
+
+
+uint SampleRing::write(const SAMPLETYPE *samples, uint numFrames)
+{
+    unsigned long pos = writePos.load(std::memory_order_relaxed);
+    uint space = capacity - (uint)(pos - readPos.load(std::memory_order_acquire));
+    if (numFrames > space) numFrames = space;
+
+    // copy in at most two parts, wrapping around the end of the buffer
+    uint start = (uint)(pos & (capacity - 1));
+    uint first = (numFrames < capacity - start) ? numFrames : capacity - start;
+    memcpy(buffer + (size_t)start * channels, samples, (size_t)first * channels * sizeof(SAMPLETYPE));
+    memcpy(buffer, samples + (size_t)first * channels, (size_t)(numFrames - first) * channels * sizeof(SAMPLETYPE));
+
+    writePos.store(pos + numFrames, std::memory_order_release);
+    return numFrames;
+}
+
+
+uint SampleRing::read(SAMPLETYPE *samples, uint maxFrames)
+{
+    unsigned long pos = readPos.load(std::memory_order_relaxed);
+    uint avail = (uint)(writePos.load(std::memory_order_acquire) - pos);
+    if (maxFrames > avail) maxFrames = avail;
+
+    uint start = (uint)(pos & (capacity - 1));
+    uint first = (maxFrames < capacity - start) ? maxFrames : capacity - start;
+    memcpy(samples, buffer + (size_t)start * channels, (size_t)first * channels * sizeof(SAMPLETYPE));
+    memcpy(samples + (size_t)first * channels, buffer, (size_t)(maxFrames - first) * channels * sizeof(SAMPLETYPE));
+
+    readPos.store(pos + maxFrames, std::memory_order_release);
+    return maxFrames;
+}
+
+
+void SampleRing::clear()
+{
+    readPos.store(writePos.load());
+}
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Lock-free single-producer/single-consumer ring buffer of interleaved
+/// sample frames, for passing audio between an audio callback thread and a
+/// processing thread without locks or allocations.
+///
+/// Exactly one thread may write and exactly one thread may read at a time;
+/// neither side ever blocks.
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SampleRing_H
+#define SampleRing_H
+
+#include <atomic>
+
+#include "STTypes.h"
+
+namespace soundtouch
+{
+
+class SampleRing
+{
+private:
+    SAMPLETYPE *buffer;
+
+    /// Capacity in frames, power of 2
+    uint capacity;
+
+    uint channels;
+
+    /// Total frames written & read. Only the producer stores 'writePos', and
+    /// only the consumer stores 'readPos'. Kept on separate cache lines.
+    std::atomic<unsigned long> writePos;
+    char pad0[64];
+    std::atomic<unsigned long> readPos;
+    char pad1[64];
+
+public:
+    /// Constructor. Rounds 'minFrames' up to a power of 2.
+    SampleRing(uint numChannels, uint minFrames);
+    ~SampleRing();
+
+    /// Returns capacity in frames
+    uint getCapacity() const
+    {
+        return capacity;
+    }
+
+    /// Returns frames available for reading. Exact when called by the consumer.
+    uint numFrames() const;
+
+    /// Returns free space in frames. Exact when called by the producer.
+    uint numFree() const;
+
+    /// Writes at most 'numFrames' frames, producer side only.
+    ///
+    /// \return Number of frames written, less than 'numFrames' if the ring is full.
+    uint write(const SAMPLETYPE *samples, uint numFrames);
+
+    /// Reads at most 'maxFrames' frames, consumer side only.
+    ///
+    /// \return Number of frames read.
+    uint read(SAMPLETYPE *samples, uint maxFrames);
+
+    /// Discards all frames. Only allowed while neither side is active.
+    void clear();
+};
+
+}
+
+#endif
@@ -71,6 +71,9 @@
 #include "SoundTouch.h"
 #include "TDStretch.h"
 #include "RateTransposer.h"
+#include "TuningProfile.h"
+#include "FormantCorrector.h"
+#include "StretchAnalysis.h"
 #include "cpu_detect.h"
 
 using namespace soundtouch;
@@ -78,6 +81,20 @@ using namespace soundtouch;
 /// test if two floating point numbers are equal
 #define TEST_FLOAT_EQUAL(a, b)  (fabs(a - b) < 1e-10)
 
+/// Interval in samples for updating tempo & pitch during a parameter ramp
+#define RAMP_INTERVAL   64
+
+/// Low-latency mode block size limits in frames
+#define LOW_LATENCY_MIN_BLOCK       64
+#define LOW_LATENCY_MAX_BLOCK       256
+
+/// Time-stretch settings of the low-latency mode. The sequence is about the
+/// shortest that still overlaps by a couple of milliseconds.
+#define LOW_LATENCY_SEQUENCE_MS     10
+#define LOW_LATENCY_SEEKWINDOW_MS   4
+#define LOW_LATENCY_OVERLAP_MS      2
+#define LOW_LATENCY_AA_LENGTH       16
+
 
 /// Print library version string for autoconf
 extern "C" void soundtouch_ac_test()
@@ -97,12 +114,24 @@ SoundTouch::SoundTouch()
 
     rate = tempo = 0;
 
+    pTuning = NULL;
+    pFormant = NULL;
+    tuningEntry = -1;
+    tuningContent = CONTENT_MUSIC;
+    tuningQuality = 0;
+
+    liveBlock = liveLatency = livePrefill = 0;
+
     virtualPitch = 
     virtualRate = 
     virtualTempo = 1.0;
 
     calcEffectiveRateAndTempo();
 
+    rampRemaining = 0;
+    rampTempoStep = rampOctaveStep = 0;
+    rampTempoTarget = rampPitchTarget = 1.0;
+
     samplesExpectedOut = 0;
     samplesOutput = 0;
 
@@ -115,6 +144,8 @@ SoundTouch::~SoundTouch()
 {
     delete pRateTransposer;
     delete pTDStretch;
+    delete pTuning;
+    delete pFormant;
 }
 
 
@@ -139,9 +170,11 @@ void SoundTouch::setChannels(uint numChannels)
 {
     if (!verifyNumberOfChannels(numChannels)) return;
 
+    if (channels != numChannels) detachAnalysis();
     channels = numChannels;
     pRateTransposer->setChannels((int)numChannels);
     pTDStretch->setChannels((int)numChannels);
+    updateFormantFormat();
 }
 
 
@@ -167,6 +200,7 @@ void SoundTouch::setRateChange(double newRate)
 // represent slower tempo, larger faster tempo.
 void SoundTouch::setTempo(double newTempo)
 {
+    rampRemaining = 0;
     virtualTempo = newTempo;
     calcEffectiveRateAndTempo();
 }
@@ -176,6 +210,7 @@ void SoundTouch::setTempo(double newTempo)
 // to the original tempo (-50 .. +100 %)
 void SoundTouch::setTempoChange(double newTempo)
 {
+    rampRemaining = 0;
     virtualTempo = 1.0 + 0.01 * newTempo;
     calcEffectiveRateAndTempo();
 }
@@ -185,6 +220,7 @@ void SoundTouch::setTempoChange(double newTempo)
 // represent lower pitches, larger values higher pitch.
 void SoundTouch::setPitch(double newPitch)
 {
+    rampRemaining = 0;
     virtualPitch = newPitch;
     calcEffectiveRateAndTempo();
 }
@@ -194,6 +230,7 @@ void SoundTouch::setPitch(double newPitch)
 // (-1.00 .. +1.00)
 void SoundTouch::setPitchOctaves(double newPitch)
 {
+    rampRemaining = 0;
     virtualPitch = exp(0.69314718056 * newPitch);
     calcEffectiveRateAndTempo();
 }
@@ -213,6 +250,251 @@ void SoundTouch::setPitchSemiTones(double newPitch)
 }
 
 
+// Ramps tempo and pitch linearly from the current values to the new values
+// over the next 'rampSamples' input samples. Pitch is ramped linearly in octaves.
+void SoundTouch::rampTempoAndPitch(double newTempo, double newPitch, uint rampSamples)
+{
+    if (rampSamples == 0)
+    {
+        rampRemaining = 0;
+        virtualTempo = newTempo;
+        virtualPitch = newPitch;
+        calcEffectiveRateAndTempo();
+        return;
+    }
+
+    rampTempoTarget = newTempo;
+    rampPitchTarget = newPitch;
+    rampTempoStep = (newTempo - virtualTempo) / rampSamples;
+    rampOctaveStep = log(newPitch / virtualPitch) / rampSamples;
+    rampRemaining = rampSamples;
+}
+
+
+/// Returns true if a tempo & pitch ramp is in progress
+bool SoundTouch::isRamping() const
+{
+    return rampRemaining > 0;
+}
+
+
+// Loads a tuning profile for choosing the time-stretch settings by tempo,
+// content type and quality target
+bool SoundTouch::loadTuningProfile(const char *text)
+{
+    int sequenceMs, seekWindowMs, overlapMs;
+
+    if ((text == NULL) || (*text == 0))
+    {
+        delete pTuning;
+        pTuning = NULL;
+        tuningEntry = -1;
+        if (liveBlock != 0)
+        {
+            // restored when the low-latency mode is disabled
+            liveSaved[0] = DEFAULT_SEQUENCE_MS;
+            liveSaved[1] = DEFAULT_SEEKWINDOW_MS;
+            liveSaved[2] = DEFAULT_OVERLAP_MS;
+            liveSaved[4] = 0;
+            return true;
+        }
+        pTDStretch->setParameters(0, DEFAULT_SEQUENCE_MS, DEFAULT_SEEKWINDOW_MS, DEFAULT_OVERLAP_MS);
+        pTDStretch->enableQuickSeek(false);
+        return true;
+    }
+
+    TuningProfile *profile = new TuningProfile();
+    if (!profile->parse(text))
+    {
+        delete profile;
+        return false;
+    }
+    delete pTuning;
+    pTuning = profile;
+    tuningEntry = -1;
+
+    // go through all settings of the profile once to grow the buffers to the
+    // largest requirement, then restore the current settings
+    pTDStretch->getParameters(NULL, &sequenceMs, &seekWindowMs, &overlapMs);
+    for (int i = 0; i < pTuning->size(); i ++)
+    {
+        const TuningProfile::Entry &e = pTuning->getEntry(i);
+        pTDStretch->setParameters(0, e.sequenceMs, e.seekWindowMs, e.overlapMs);
+    }
+    pTDStretch->setParameters(0, sequenceMs, seekWindowMs, overlapMs);
+
+    applyTuning();
+    return true;
+}
+
+
+// Prepares rendering a clip with the help of its cached analysis
+bool SoundTouch::setClipAnalysis(const char *clipId, const SAMPLETYPE *clip, uint numFrames)
+{
+    if (channels == 0)
+    {
+        ST_THROW_RT_ERROR("SoundTouch : Number of channels not defined");
+    }
+
+    detachAnalysis();
+    clear();
+    if (clipId == NULL) return false;
+
+#ifndef SOUNDTOUCH_PREVENT_CLICK_AT_RATE_CROSSOVER
+    // the tempo changer gets the clip transposed if the rate is below 1.0. At
+    // rate 1.0 the transposer runs first too, but clear() prefills it with
+    // silence of its latency, so its output frame n is the clip frame n passed
+    // through the anti-alias filter, and the analysis stays aligned without an
+    // offset (see the rate 1.0 check of analysis_benchmark).
+    if (rate < 1.0) return false;
+#endif
+
+    pAnalysis = StretchAnalysisCache::get(clipId, clip, numFrames, (int)channels);
+    if (!pAnalysis) return false;
+
+    pTDStretch->setAnalysis(pAnalysis.get());
+    return true;
+}
+
+
+// Detaches the clip analysis
+void SoundTouch::detachAnalysis()
+{
+    if (!pAnalysis) return;
+    pTDStretch->setAnalysis(NULL);
+    pAnalysis.reset();
+}
+
+
+// Applies the tuning profile entry for the current tempo, if it changed
+void SoundTouch::applyTuning()
+{
+    // the low-latency mode keeps its own short windows; the profile applies
+    // again once the mode is disabled
+    if ((pTuning == NULL) || (liveBlock != 0)) return;
+
+    const TuningProfile::Entry *e = pTuning->select(tuningContent, tempo, 0.1 * tuningQuality);
+    if (e == NULL) return;
+
+    int index = (int)(e - &pTuning->getEntry(0));
+    if (index == tuningEntry) return;
+    tuningEntry = index;
+
+    pTDStretch->setParameters(0, e->sequenceMs, e->seekWindowMs, e->overlapMs);
+    pTDStretch->enableQuickSeek(e->quickSeek != 0);
+}
+
+
+// Enables the low-latency mode with 'blockFrames' frame blocks, or disables it
+void SoundTouch::setLowLatency(uint blockFrames)
+{
+    if (blockFrames == 0)
+    {
+        if (liveBlock == 0) return;
+        pTDStretch->setParameters(0, liveSaved[0], liveSaved[1], liveSaved[2]);
+        pRateTransposer->getAAFilter()->setLength(liveSaved[3]);
+        pTDStretch->enableQuickSeek(liveSaved[4] != 0);
+        liveBlock = liveLatency = livePrefill = 0;
+        // the tempo may have moved to another range of the profile meanwhile
+        tuningEntry = -1;
+        applyTuning();
+        return;
+    }
+
+    if (liveBlock == 0)
+    {
+        pTDStretch->getParameters(NULL, &liveSaved[0], &liveSaved[1], &liveSaved[2]);
+        liveSaved[3] = (int)pRateTransposer->getAAFilter()->getLength();
+        liveSaved[4] = pTDStretch->isQuickSeekEnabled() ? 1 : 0;
+    }
+    liveBlock = blockFrames;
+    pTDStretch->setParameters(0, LOW_LATENCY_SEQUENCE_MS, LOW_LATENCY_SEEKWINDOW_MS, LOW_LATENCY_OVERLAP_MS);
+    pRateTransposer->getAAFilter()->setLength(LOW_LATENCY_AA_LENGTH);
+    pTDStretch->enableQuickSeek(false);
+
+    // largest latency over the pitch range of +-1 octave in 1/4 octave steps
+    int worst = 0;
+    for (int i = -4; i <= 4; i ++)
+    {
+        double p = pow(2.0, 0.25 * i);
+        pTDStretch->setTempo(1.0 / p);
+        int latency = pipelineLatency(p, pTDStretch->getLatency());
+        if (latency > worst) worst = latency;
+    }
+    pTDStretch->setTempo(tempo);
+
+    liveLatency = (uint)worst;
+    livePrefill = liveLatency;
+}
+
+
+// Returns the initial latency of the pipeline at transposer rate 'r' when the
+// tempo changer needs 'tdLatency' input samples before output
+int SoundTouch::pipelineLatency(double r, int tdLatency) const
+{
+    double latency = tdLatency;
+    int latency_tr = pRateTransposer->getLatency();
+
+#ifndef SOUNDTOUCH_PREVENT_CLICK_AT_RATE_CROSSOVER
+    if (r <= 1.0)
+    {
+        // transposing done before timestretch, which impacts latency
+        latency = (latency + latency_tr) * r;
+    }
+    else
+#endif
+    {
+        latency += (double)latency_tr / r;
+    }
+
+    return (int)(latency + 0.5);
+}
+
+
+// Returns true if the low-latency mode is enabled and the settings keep the
+// output as long as the input
+bool SoundTouch::canProcessBlock() const
+{
+    if (liveBlock == 0) return false;
+    if (!TEST_FLOAT_EQUAL(virtualTempo, 1.0) || !TEST_FLOAT_EQUAL(virtualRate, 1.0)) return false;
+    return (rampRemaining == 0) || TEST_FLOAT_EQUAL(rampTempoTarget, 1.0);
+}
+
+
+// Processes one block in the low-latency mode, the output delayed by the
+// constant 'liveLatency'
+uint SoundTouch::processBlock(const SAMPLETYPE *input, SAMPLETYPE *output)
+{
+    uint n = 0;
+
+    if (liveBlock == 0)
+    {
+        ST_THROW_RT_ERROR("SoundTouch : low-latency mode not enabled");
+    }
+    if (!canProcessBlock())
+    {
+        ST_THROW_RT_ERROR("SoundTouch : processBlock requires tempo and rate 1.0");
+    }
+
+    putSamples(input, liveBlock);
+
+    // silence until the stream has been delayed by 'liveLatency' frames
+    if (livePrefill > 0)
+    {
+        n = (livePrefill < liveBlock) ? livePrefill : liveBlock;
+        memset(output, 0, n * channels * sizeof(SAMPLETYPE));
+        livePrefill -= n;
+    }
+    n += receiveSamples(output + n * channels, liveBlock - n);
+
+    if (n < liveBlock)
+    {
+        memset(output + n * channels, 0, (liveBlock - n) * channels * sizeof(SAMPLETYPE));
+    }
+    return liveBlock - n;
+}
+
+
 // Calculates 'effective' rate and tempo values from the
 // nominal control values.
 void SoundTouch::calcEffectiveRateAndTempo()
@@ -223,8 +505,19 @@ void SoundTouch::calcEffectiveRateAndTempo()
     tempo = virtualTempo / virtualPitch;
     rate = virtualPitch * virtualRate;
 
-    if (!TEST_FLOAT_EQUAL(rate,oldRate)) pRateTransposer->setRate(rate);
-    if (!TEST_FLOAT_EQUAL(tempo, oldTempo)) pTDStretch->setTempo(tempo);
+    if (!TEST_FLOAT_EQUAL(rate,oldRate))
+    {
+        pRateTransposer->setRate(rate);
+        if (pFormant) pFormant->setShift(rate);
+        // changing the rate moves samples between the pipeline stages, after
+        // which the tempo changer input no longer follows the clip frames
+        detachAnalysis();
+    }
+    if (!TEST_FLOAT_EQUAL(tempo, oldTempo))
+    {
+        pTDStretch->setTempo(tempo);
+        applyTuning();
+    }
 
 #ifndef SOUNDTOUCH_PREVENT_CLICK_AT_RATE_CROSSOVER
     if (rate <= 1.0f) 
@@ -269,6 +562,18 @@ void SoundTouch::setSampleRate(uint srate)
     // set sample rate, leave other tempo changer parameters as they are.
     pTDStretch->setParameters((int)srate);
     bSrateSet = true;
+    updateFormantFormat();
+}
+
+
+// Sets the channels & sample rate of the formant corrector when both are known
+void SoundTouch::updateFormantFormat()
+{
+    int sampleRate;
+
+    if ((pFormant == NULL) || (channels == 0) || !bSrateSet) return;
+    pTDStretch->getParameters(&sampleRate, NULL, NULL, NULL);
+    pFormant->setFormat((int)channels, sampleRate);
 }
 
 
@@ -285,10 +590,48 @@ void SoundTouch::putSamples(const SAMPLETYPE *samples, uint nSamples)
         ST_THROW_RT_ERROR("SoundTouch : Number of channels not defined");
     }
 
+    // during a parameter ramp, process in short steps and update tempo & pitch
+    // before each step
+    while ((rampRemaining > 0) && (nSamples > 0))
+    {
+        uint n = (nSamples < RAMP_INTERVAL) ? nSamples : RAMP_INTERVAL;
+
+        if (n >= rampRemaining)
+        {
+            n = rampRemaining;
+            virtualTempo = rampTempoTarget;
+            virtualPitch = rampPitchTarget;
+        }
+        else
+        {
+            virtualTempo += rampTempoStep * n;
+            virtualPitch *= exp(rampOctaveStep * n);
+        }
+        rampRemaining -= n;
+        calcEffectiveRateAndTempo();
+
+        processSamples(samples, n);
+        samples += n * channels;
+        nSamples -= n;
+    }
+
+    if (nSamples > 0)
+    {
+        processSamples(samples, nSamples);
+    }
+}
+
+
+// Feeds samples to the processing pipeline with the current settings
+void SoundTouch::processSamples(const SAMPLETYPE *samples, uint nSamples)
+{
     // accumulate how many samples are expected out from processing, given the current 
     // processing setting
     samplesExpectedOut += (double)nSamples / ((double)rate * (double)tempo);
 
+    // output samples before this batch have been formant corrected already
+    uint corrected = pFormant ? output->numSamples() : 0;
+
 #ifndef SOUNDTOUCH_PREVENT_CLICK_AT_RATE_CROSSOVER
     if (rate <= 1.0f) 
     {
@@ -305,6 +648,11 @@ void SoundTouch::putSamples(const SAMPLETYPE *samples, uint nSamples)
         pTDStretch->putSamples(samples, nSamples);
         pRateTransposer->moveSamples(*pTDStretch);
     }
+
+    if (pFormant)
+    {
+        pFormant->process(output->ptrBegin() + corrected * channels, output->numSamples() - corrected);
+    }
 }
 
 
@@ -372,6 +720,17 @@ bool SoundTouch::setSetting(int settingId, int value)
             pTDStretch->enableQuickSeek((value != 0) ? true : false);
             return true;
 
+        case SETTING_USE_FFTSEEK :
+            // enables / disables tempo routine FFT seeking algorithm
+            pTDStretch->enableFFTSeek((value != 0) ? true : false);
+            return true;
+
+        case SETTING_INTERPOLATION_ALGORITHM :
+            // selects rate transposer interpolation algorithm
+            if (value < TransposerBase::LINEAR || value > TransposerBase::SHANNON) return false;
+            pRateTransposer->setAlgorithm((TransposerBase::ALGORITHM)value);
+            return true;
+
         case SETTING_SEQUENCE_MS:
             // change time-stretch sequence duration parameter
             pTDStretch->setParameters(sampleRate, value, seekWindowMs, overlapMs);
@@ -387,6 +746,40 @@ bool SoundTouch::setSetting(int settingId, int value)
             pTDStretch->setParameters(sampleRate, sequenceMs, seekWindowMs, value);
             return true;
 
+        case SETTING_CONTENT_TYPE:
+            // selects the tuning profile entries by content type
+            if (value < 0 || value >= NUM_CONTENT_TYPES) return false;
+            tuningContent = value;
+            applyTuning();
+            return true;
+
+        case SETTING_QUALITY_TARGET:
+            // selects the tuning profile entries by quality
+            tuningQuality = value;
+            applyTuning();
+            return true;
+
+        case SETTING_LOW_LATENCY:
+            // enables / disables the low-latency mode
+            if ((value != 0) && ((value < LOW_LATENCY_MIN_BLOCK) || (value > LOW_LATENCY_MAX_BLOCK))) return false;
+            setLowLatency((uint)value);
+            return true;
+
+        case SETTING_FORMANT_PRESERVE:
+            // enables / disables the formant correction of the output
+            if ((value != 0) && (pFormant == NULL))
+            {
+                pFormant = new FormantCorrector();
+                pFormant->setShift(rate);
+                updateFormantFormat();
+            }
+            else if ((value == 0) && (pFormant != NULL))
+            {
+                delete pFormant;
+                pFormant = NULL;
+            }
+            return true;
+
         default :
             return false;
     }
@@ -412,6 +805,12 @@ int SoundTouch::getSetting(int settingId) const
         case SETTING_USE_QUICKSEEK :
             return (uint)pTDStretch->isQuickSeekEnabled();
 
+        case SETTING_USE_FFTSEEK :
+            return (uint)pTDStretch->isFFTSeekEnabled();
+
+        case SETTING_INTERPOLATION_ALGORITHM :
+            return (int)pRateTransposer->getAlgorithm();
+
         case SETTING_SEQUENCE_MS:
             pTDStretch->getParameters(NULL, &temp, NULL, NULL);
             return temp;
@@ -424,6 +823,12 @@ int SoundTouch::getSetting(int settingId) const
             pTDStretch->getParameters(NULL, NULL, NULL, &temp);
             return temp;
 
+        case SETTING_CONTENT_TYPE:
+            return tuningContent;
+
+        case SETTING_QUALITY_TARGET:
+            return tuningQuality;
+
         case SETTING_NOMINAL_INPUT_SEQUENCE :
         {
             int size = pTDStretch->getInputSampleReq();
@@ -451,24 +856,16 @@ int SoundTouch::getSetting(int settingId) const
         }
 
         case SETTING_INITIAL_LATENCY:
-        {
-            double latency = pTDStretch->getLatency();
-            int latency_tr = pRateTransposer->getLatency();
+            return pipelineLatency(rate, pTDStretch->getLatency());
 
-#ifndef SOUNDTOUCH_PREVENT_CLICK_AT_RATE_CROSSOVER
-            if (rate <= 1.0)
-            {
-                // transposing done before timestretch, which impacts latency
-                latency = (latency + latency_tr) * rate;
-            }
-            else
-#endif
-            {
-                latency += (double)latency_tr / rate;
-            }
+        case SETTING_LOW_LATENCY:
+            return (int)liveBlock;
 
-            return (int)(latency + 0.5);
-        }
+        case SETTING_LIVE_LATENCY:
+            return (int)liveLatency;
+
+        case SETTING_FORMANT_PRESERVE:
+            return (pFormant != NULL) ? 1 : 0;
 
         default :
             return 0;
@@ -482,6 +879,8 @@ void SoundTouch::clear()
 {
     samplesExpectedOut = 0;
     samplesOutput = 0;
+    livePrefill = liveLatency;
+    if (pFormant) pFormant->clear();
     pRateTransposer->clear();
     pTDStretch->clear();
 }
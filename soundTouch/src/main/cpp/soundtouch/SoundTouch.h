@@ -65,6 +65,8 @@
 #ifndef SoundTouch_H
 #define SoundTouch_H
 
+#include <memory>
+
 #include "FIFOSamplePipe.h"
 #include "STTypes.h"
 
@@ -165,6 +167,55 @@ namespace soundtouch
 #define SETTING_INITIAL_LATENCY             8
 
 
+/// Enable/disable FFT based seeking algorithm in tempo changer routine. Finds the 
+/// same overlapping positions as the default full seeking, but computes the 
+/// cross-correlation of the whole seek window at once with FFT, lowering CPU 
+/// utilization especially at high sample rates. Quick seeking takes precedence 
+/// if SETTING_USE_QUICKSEEK is also enabled.
+#define SETTING_USE_FFTSEEK                 9
+
+
+/// Rate transposer interpolation algorithm: 0 = linear, 1 = cubic, 2 = shannon
+/// (see TransposerBase::ALGORITHM). Linear is cheapest, shannon gives the best
+/// quality. Default is linear in integer builds and cubic in float builds.
+/// The setting is per SoundTouch instance; set it before processing.
+#define SETTING_INTERPOLATION_ALGORITHM     10
+
+
+/// Content type for choosing time-stretch settings from a tuning profile, see
+/// loadTuningProfile(): 0 = music, 1 = speech, 2 = percussive (see TuningContent).
+/// Default is music.
+#define SETTING_CONTENT_TYPE                11
+
+
+/// Quality target for choosing time-stretch settings from a tuning profile, in
+/// tenths of the profile's quality score (dB in profiles of tuning_benchmark).
+/// The cheapest settings reaching the target are used, or the best ones if no
+/// settings reach it. Default is 0, i.e. the cheapest settings.
+#define SETTING_QUALITY_TARGET              12
+
+
+/// Low-latency mode for live monitoring: the value is the block size in frames
+/// (64 .. 256) for processBlock(), 0 disables the mode. Enabling the mode sets
+/// short sequence, seek window and overlap lengths and a short anti-alias
+/// filter; disabling it restores the previous settings. Enable the mode after
+/// setting the sample rate and the channels. A loaded tuning profile is
+/// suspended while the mode is enabled.
+#define SETTING_LOW_LATENCY                 13
+
+
+/// Read-only: constant end-to-end latency of processBlock() in frames, 0 if the
+/// low-latency mode isn't enabled. It's the largest initial latency within the
+/// pitch range of +-1 octave, so it doesn't change with the pitch setting.
+#define SETTING_LIVE_LATENCY                14
+
+
+/// Enable/disable formant preservation, i.e. correcting the spectral envelope
+/// moved by transposing the pitch so that voices keep their natural timbre.
+/// Adds no latency. Default = 0 (disabled)
+#define SETTING_FORMANT_PRESERVE            15
+
+
 class SoundTouch : public FIFOProcessor
 {
 private:
@@ -193,10 +244,65 @@ private:
     /// Accumulator for how many samples in total have been read out from the processing so far
     long   samplesOutput;
 
+    /// Tuning profile loaded with loadTuningProfile(), NULL if none
+    class TuningProfile *pTuning;
+
+    /// Index of the profile entry currently applied to 'pTDStretch', -1 if none
+    int tuningEntry;
+
+    /// SETTING_CONTENT_TYPE and SETTING_QUALITY_TARGET values
+    int tuningContent;
+    int tuningQuality;
+
+    /// Applies the tuning profile entry for the current tempo, if it changed
+    void applyTuning();
+
+    /// Formant corrector applied to the output, NULL if SETTING_FORMANT_PRESERVE
+    /// is disabled
+    class FormantCorrector *pFormant;
+
+    /// Sets the channels & sample rate of 'pFormant' when both are known
+    void updateFormantFormat();
+
+    /// Clip analysis attached with setClipAnalysis(), empty if none
+    std::shared_ptr<const class StretchAnalysis> pAnalysis;
+
+    /// Detaches the clip analysis
+    void detachAnalysis();
+
+    /// Low-latency mode state: block size in frames (0 = mode disabled), the
+    /// constant latency in frames, frames of silence still to output before
+    /// the processed stream, and the settings to restore when disabling the
+    /// mode (sequence, seek window & overlap ms, AA filter length, quick seek)
+    uint liveBlock;
+    uint liveLatency;
+    uint livePrefill;
+    int liveSaved[5];
+
+    /// Enables the low-latency mode with 'blockFrames' frame blocks, or
+    /// disables it if 'blockFrames' is 0
+    void setLowLatency(uint blockFrames);
+
+    /// Returns the initial latency of the pipeline at transposer rate 'r' when
+    /// the tempo changer needs 'tdLatency' input samples before output
+    int pipelineLatency(double r, int tdLatency) const;
+
+    /// Tempo & pitch ramp state, see rampTempoAndPitch(): number of input samples
+    /// left in the ramp, change of 'virtualTempo' and of pitch in octaves per
+    /// sample, and the values at end of the ramp
+    uint   rampRemaining;
+    double rampTempoStep;
+    double rampOctaveStep;
+    double rampTempoTarget;
+    double rampPitchTarget;
+
     /// Calculates effective rate & tempo valuescfrom 'virtualRate', 'virtualTempo' and 
     /// 'virtualPitch' parameters.
     void calcEffectiveRateAndTempo();
 
+    /// Feeds samples to the processing pipeline with the current settings
+    void processSamples(const SAMPLETYPE *samples, uint numSamples);
+
 protected :
     /// Number of channels
     uint  channels;
@@ -246,6 +352,81 @@ public:
     void setPitchSemiTones(int newPitch);
     void setPitchSemiTones(double newPitch);
 
+    /// Changes tempo and pitch smoothly: ramps the tempo and pitch control values
+    /// linearly (pitch in octaves) from the current values to 'newTempo' and 
+    /// 'newPitch' over the next 'rampSamples' input samples. The values are 
+    /// updated every 64 samples inside putSamples(). 
+    ///
+    /// Parameter changes within the tempo & rate range FIFO_RESERVE_RATE_MIN .. 
+    /// _MAX don't allocate memory, so this is safe to call from an audio callback.
+    /// A new ramp replaces an ongoing one, and the setTempo / setPitch functions 
+    /// cancel it.
+    void rampTempoAndPitch(double newTempo,     ///< Tempo at end of ramp, normal = 1.0
+                           double newPitch,     ///< Pitch at end of ramp, original = 1.0
+                           uint rampSamples     ///< Ramp duration in input samples
+                           );
+
+    /// Returns true if a tempo & pitch ramp is in progress
+    bool isRamping() const;
+
+    /// Returns true if processBlock() can be called: the low-latency mode is
+    /// enabled, the tempo and rate are 1.0 and no ramp changes the tempo
+    bool canProcessBlock() const;
+
+    /// Loads a tuning profile (see TuningProfile.h) for choosing the time-stretch
+    /// settings SETTING_SEQUENCE_MS, _SEEKWINDOW_MS, _OVERLAP_MS and _USE_QUICKSEEK
+    /// automatically by tempo, SETTING_CONTENT_TYPE and SETTING_QUALITY_TARGET.
+    /// While a profile is loaded it overrides these settings whenever the tempo
+    /// moves to another range of the profile. NULL or an empty text unloads the
+    /// profile and restores the default settings.
+    ///
+    /// Load the profile before processing: loading preallocates the buffers for
+    /// all of its settings, so that switching between them later doesn't
+    /// allocate memory.
+    ///
+    /// \return false if the text is malformed; the previous profile is then kept.
+    bool loadTuningProfile(const char *text);
+
+    /// Processes one block of SETTING_LOW_LATENCY frames in the low-latency mode:
+    /// puts 'input' into the pipeline and writes the same number of frames to
+    /// 'output'. The output is the processed stream delayed by the constant
+    /// SETTING_LIVE_LATENCY frames, starting with silence. Requires tempo and
+    /// rate 1.0, i.e. only the pitch can be changed. Doesn't allocate memory
+    /// within the pitch range of +-1 octave.
+    ///
+    /// Throws runtime_error if the low-latency mode isn't enabled, or if the
+    /// tempo or rate isn't 1.0 or a ramp is moving the tempo away from 1.0:
+    /// these would change the length of the processed stream, which a block
+    /// in / block out call can't deliver. Check canProcessBlock() first where
+    /// exceptions can't be handled.
+    ///
+    /// \return Number of output frames padded with silence because processing
+    /// fell behind, 0 at a constant pitch. Fast pitch ramps can shorten the
+    /// processed stream by a few frames, which are padded to keep the latency.
+    uint processBlock(const SAMPLETYPE *input,  ///< SETTING_LOW_LATENCY frames to process
+                      SAMPLETYPE *output        ///< Buffer for SETTING_LOW_LATENCY frames
+                      );
+
+    /// Prepares rendering the clip 'clipId' of 'numFrames' frames with the help
+    /// of its cached analysis (see StretchAnalysis.h), for rendering the same
+    /// clip repeatedly at different tempos. Analyses 'clip' and caches the
+    /// result if the clip isn't in the cache yet; with 'clip' NULL only looks
+    /// up the cache. The analysis doesn't depend on the tempo or the stretch
+    /// settings, so one analysis serves all renders of the clip.
+    ///
+    /// Clears the pipeline: the clip is expected to be put from its first
+    /// frame on after this call, and again from the first frame after each
+    /// clear() or flush(). The analysis is used while the rate & pitch stay at
+    /// the values they have now and the rate is 1.0 or higher, i.e. changing
+    /// them detaches the clip. NULL 'clipId' detaches the clip.
+    ///
+    /// \return true if the analysis is attached; false if 'clip' is NULL and the
+    /// clip isn't cached, or the rate is below 1.0.
+    bool setClipAnalysis(const char *clipId,      ///< Clip ID, e.g. file path & edit version
+                         const SAMPLETYPE *clip,  ///< Clip samples, or NULL for a cache lookup only
+                         uint numFrames           ///< Clip length in frames
+                         );
+
     /// Sets the number of channels, 1 = mono, 2 = stereo
     void setChannels(uint numChannels);
 
@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Batched processing of many SoundTouch instances, see SoundTouchBatch.h
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdexcept>
+
+#include "SoundTouchBatch.h"
+
+using namespace soundtouch;
+
+
+SoundTouchBatch::SoundTouchBatch(int numThreads)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = (int)std::thread::hardware_concurrency();
+        if (numThreads <= 0) numThreads = 1;
+    }
+    threads = numThreads;
+    slices = new Slice[threads];
+
+    generation = 0;
+    activeThreads = 0;
+    pending = 0;
+    quit = false;
+
+    voices = NULL;
+    input = NULL;
+    inputFrames = NULL;
+    output = NULL;
+    outputCapacity = NULL;
+    outputFrames = NULL;
+
+    for (int i = 1; i < threads; i ++)
+    {
+        workers.push_back(std::thread(&SoundTouchBatch::workerLoop, this, i));
+    }
+}
+
+
+SoundTouchBatch::~SoundTouchBatch()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wakeCond.notify_all();
+    for (size_t i = 0; i < workers.size(); i ++)
+    {
+        workers[i].join();
+    }
+    delete[] slices;
+}
+
+
+void SoundTouchBatch::workerLoop(int id)
+{
+    unsigned long seen = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!quit && generation == seen)
+            {
+                wakeCond.wait(lock);
+            }
+            if (quit) return;
+            seen = generation;
+            // small batches don't use all threads
+            if (id >= activeThreads) continue;
+        }
+
+        runSlices(id);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (-- pending == 0)
+        {
+            doneCond.notify_one();
+        }
+    }
+}
+
+
+void SoundTouchBatch::runSlices(int id)
+{
+    for (int k = 0; k < activeThreads; k ++)
+    {
+        Slice &slice = slices[(id + k) % activeThreads];
+        while (true)
+        {
+            uint i = slice.next.fetch_add(1);
+            if (i >= slice.end) break;
+            processVoice(i);
+        }
+    }
+}
+
+
+void SoundTouchBatch::processVoice(uint i)
+{
+    SoundTouch *voice = voices[i];
+
+    try
+    {
+        if (inputFrames[i] > 0)
+        {
+            voice->putSamples(input + inputOffset[i], inputFrames[i]);
+        }
+        outputFrames[i] = voice->receiveSamples(output + outputOffset[i], outputCapacity[i]);
+    }
+    catch (const std::runtime_error &e)
+    {
+        outputFrames[i] = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty()) error = e.what();
+    }
+}
+
+
+uint SoundTouchBatch::process(SoundTouch *const *voices, uint numVoices,
+                              const SAMPLETYPE *input, const uint *inputFrames,
+                              SAMPLETYPE *output, const uint *outputCapacity, uint *outputFrames)
+{
+    if (numVoices == 0) return 0;
+
+    if (inputOffset.size() < numVoices)
+    {
+        inputOffset.resize(numVoices);
+        outputOffset.resize(numVoices);
+    }
+
+    size_t inPos = 0, outPos = 0;
+    for (uint i = 0; i < numVoices; i ++)
+    {
+        if (voices[i] == NULL || voices[i]->numChannels() == 0)
+        {
+            ST_THROW_RT_ERROR("SoundTouchBatch : voice not initialized");
+        }
+        inputOffset[i] = inPos;
+        outputOffset[i] = outPos;
+        inPos += (size_t)inputFrames[i] * voices[i]->numChannels();
+        outPos += (size_t)outputCapacity[i] * voices[i]->numChannels();
+    }
+
+    int active = ((uint)threads < numVoices) ? threads : (int)numVoices;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->voices = voices;
+        this->input = input;
+        this->inputFrames = inputFrames;
+        this->output = output;
+        this->outputCapacity = outputCapacity;
+        this->outputFrames = outputFrames;
+        error.clear();
+
+        for (int t = 0; t < active; t ++)
+        {
+            slices[t].next = (uint)((unsigned long long)numVoices * t / active);
+            slices[t].end = (uint)((unsigned long long)numVoices * (t + 1) / active);
+        }
+        activeThreads = active;
+        pending = active - 1;
+        if (active > 1) generation ++;
+    }
+
+    if (active > 1) wakeCond.notify_all();
+
+    runSlices(0);
+
+    std::string err;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (pending > 0)
+        {
+            doneCond.wait(lock);
+        }
+        err.swap(error);
+    }
+    if (!err.empty())
+    {
+        ST_THROW_RT_ERROR(err.c_str());
+    }
+
+    uint total = 0;
+    for (uint i = 0; i < numVoices; i ++)
+    {
+        total += outputFrames[i];
+    }
+    return total;
+}
@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Batched processing of many independent SoundTouch instances ("voices") in
+/// one call, e.g. voice effects of dozens of chat streams at once.
+///
+/// The inputs of all voices are passed packed into one buffer, and the outputs
+/// are written packed into another one. The voices are processed in parallel
+/// on an internal thread pool: each thread first processes its own slice of
+/// the voices and then steals unprocessed voices from the slices of the
+/// other threads, so that a few long voices don't leave threads idle.
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SoundTouchBatch_H
+#define SoundTouchBatch_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SoundTouch.h"
+#include "STTypes.h"
+
+namespace soundtouch
+{
+
+class SoundTouchBatch
+{
+private:
+    /// Range of voice indices assigned to one thread. Padded to a cache line
+    /// so that threads claiming voices from different slices don't contend.
+    struct Slice
+    {
+        std::atomic<uint> next;
+        uint end;
+        char pad[64 - sizeof(std::atomic<uint>) - sizeof(uint)];
+    };
+
+    /// Worker threads. The thread calling process() works as thread #0.
+    std::vector<std::thread> workers;
+
+    /// Voice slices, one per thread
+    Slice *slices;
+
+    /// Number of threads including the calling thread
+    int threads;
+
+    std::mutex mutex;
+    std::condition_variable wakeCond;
+    std::condition_variable doneCond;
+
+    /// Incremented for every batch dispatched to the workers
+    unsigned long generation;
+
+    /// Number of threads working on the current batch
+    int activeThreads;
+
+    /// Number of workers that haven't finished the current batch yet
+    int pending;
+
+    bool quit;
+
+    /// Error message of the first voice that failed in the current batch
+    std::string error;
+
+    // Parameters of the current batch
+    SoundTouch *const *voices;
+    const SAMPLETYPE *input;
+    const uint *inputFrames;
+    SAMPLETYPE *output;
+    const uint *outputCapacity;
+    uint *outputFrames;
+
+    /// Offsets of the voices in the packed 'input' and 'output' buffers, in items
+    std::vector<size_t> inputOffset;
+    std::vector<size_t> outputOffset;
+
+    /// Thread function of the worker threads
+    void workerLoop(int id);
+
+    /// Processes voices of own slice, then steals from the other slices
+    void runSlices(int id);
+
+    /// Puts the input of voice 'i' and receives its output
+    void processVoice(uint i);
+
+public:
+    /// Constructor.
+    ///
+    /// \param numThreads Number of threads processing the voices, including
+    ///        the thread calling process(). If 0, uses the number of CPU cores.
+    SoundTouchBatch(int numThreads = 0);
+
+    /// Destructor, stops the worker threads.
+    ~SoundTouchBatch();
+
+    /// Returns number of threads processing the voices, including the
+    /// thread calling process().
+    int numThreads() const
+    {
+        return threads;
+    }
+
+    /// Processes one batch of voices, and returns when all voices are done.
+    ///
+    /// Every voice must be a configured SoundTouch instance, and may appear
+    /// only once in the batch: two threads would process a duplicate voice at
+    /// the same time. This isn't checked here; the JNI wrapper rejects
+    /// duplicates before calling. Each voice puts 'inputFrames[i]' frames of its
+    /// input and then receives at most 'outputCapacity[i]' frames of output;
+    /// output beyond the capacity stays in the voice for the next batch.
+    ///
+    /// The inputs are packed one voice after another, voice #i taking
+    /// inputFrames[i] * numChannels() items of 'input'. Likewise voice #i owns
+    /// outputCapacity[i] * numChannels() items of 'output', starting where
+    /// the area of the previous voice ends.
+    ///
+    /// Throws std::runtime_error if any voice fails; the other voices of the
+    /// batch are processed nevertheless.
+    ///
+    /// \return Total number of output frames received from all voices.
+    uint process(SoundTouch *const *voices,  ///< Voices to process
+                 uint numVoices,             ///< Number of voices in the batch
+                 const SAMPLETYPE *input,    ///< Packed input samples
+                 const uint *inputFrames,    ///< Input frames per voice
+                 SAMPLETYPE *output,         ///< Packed output buffer
+                 const uint *outputCapacity, ///< Output capacity per voice, in frames
+                 uint *outputFrames          ///< Receives output frames per voice
+                 );
+};
+
+}
+
+#endif
@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// SoundTouch processing thread, see SoundTouchThread.h
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <stdexcept>
+#include <string.h>
+
+#include "SoundTouchThread.h"
+
+using namespace soundtouch;
+
+/// Frames moved between the rings and SoundTouch at a time
+#define CHUNK_FRAMES        256
+
+/// Sleep time of the processing thread when there's nothing to do
+#define IDLE_SLEEP_US       500
+
+/// Period for measuring the peak load
+#define LOAD_WINDOW_MS      100
+
+typedef std::chrono::steady_clock Clock;
+
+
+static unsigned long long _nanos(Clock::duration d)
+{
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+
+SoundTouchThread::SoundTouchThread(SoundTouch *soundTouch, uint ringFrames) :
+    pSoundTouch(soundTouch),
+    inputRing(soundTouch->numChannels(), ringFrames),
+    outputRing(soundTouch->numChannels(), ringFrames)
+{
+    chunk = new SAMPLETYPE[CHUNK_FRAMES * soundTouch->numChannels()];
+    running = false;
+    flushRequested = false;
+    failed = false;
+    errorMsg[0] = 0;
+
+    targetTempo = 1.0;
+    targetPitch = 1.0;
+    targetRampFrames = 0;
+    paramSeq = 0;
+
+    outputPrimed = false;
+    resetStatistics();
+}
+
+
+SoundTouchThread::~SoundTouchThread()
+{
+    stop();
+    delete[] chunk;
+}
+
+
+void SoundTouchThread::start()
+{
+    if (running.load()) return;
+    // the worker may have stopped on its own after an error; assigning over a
+    // joinable thread would terminate
+    if (worker.joinable()) worker.join();
+    failed = false;
+    errorMsg[0] = 0;
+    running = true;
+    worker = std::thread(&SoundTouchThread::run, this);
+}
+
+
+void SoundTouchThread::stop()
+{
+    running = false;
+    if (worker.joinable()) worker.join();
+}
+
+
+void SoundTouchThread::run()
+{
+    uint appliedSeq = 0;
+    Clock::time_point last = Clock::now();
+    Clock::time_point windowStart = last;
+    unsigned long long windowBusy = 0;
+
+    while (running.load(std::memory_order_acquire))
+    {
+        Clock::time_point t0 = Clock::now();
+        bool busy = false;
+
+        wallNanos += _nanos(t0 - last);
+        last = t0;
+
+        try
+        {
+            uint seq = paramSeq.load(std::memory_order_acquire);
+            if (seq != appliedSeq)
+            {
+                appliedSeq = seq;
+                pSoundTouch->rampTempoAndPitch(targetTempo.load(), targetPitch.load(), targetRampFrames.load());
+            }
+
+            // pass ready output on first, and don't take more input while the
+            // output ring is full
+            while (pSoundTouch->numSamples() > 0 && outputRing.numFree() > 0)
+            {
+                uint n = outputRing.numFree();
+                if (n > CHUNK_FRAMES) n = CHUNK_FRAMES;
+                n = pSoundTouch->receiveSamples(chunk, n);
+                outputRing.write(chunk, n);
+                busy = true;
+            }
+            if (pSoundTouch->numSamples() == 0)
+            {
+                uint n = inputRing.read(chunk, CHUNK_FRAMES);
+                if (n > 0)
+                {
+                    pSoundTouch->putSamples(chunk, n);
+                    busy = true;
+                }
+                else if (flushRequested.exchange(false))
+                {
+                    pSoundTouch->flush();
+                    busy = true;
+                }
+            }
+        }
+        catch (const std::runtime_error &e)
+        {
+            // e.g. sample rate not set; nothing sensible to continue with,
+            // leave the error for the audio thread to find
+            strncpy(errorMsg, e.what(), sizeof(errorMsg) - 1);
+            errorMsg[sizeof(errorMsg) - 1] = 0;
+            failed.store(true, std::memory_order_release);
+            running = false;
+            break;
+        }
+
+        Clock::time_point t1 = Clock::now();
+        if (busy)
+        {
+            unsigned long long ns = _nanos(t1 - t0);
+            busyNanos += ns;
+            windowBusy += ns;
+        }
+        if (t1 - windowStart >= std::chrono::milliseconds(LOAD_WINDOW_MS))
+        {
+            double load = (double)windowBusy / (double)_nanos(t1 - windowStart);
+            if (load > peakLoad.load()) peakLoad = load;
+            windowStart = t1;
+            windowBusy = 0;
+        }
+        if (!busy)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(IDLE_SLEEP_US));
+        }
+    }
+}
+
+
+uint SoundTouchThread::putSamples(const SAMPLETYPE *samples, uint numFrames)
+{
+    // nothing would consume the input, don't count it as overflows
+    if (hasFailed()) return 0;
+
+    uint n = inputRing.write(samples, numFrames);
+    if (n < numFrames)
+    {
+        overflows.fetch_add(numFrames - n, std::memory_order_relaxed);
+    }
+    return n;
+}
+
+
+uint SoundTouchThread::receiveSamples(SAMPLETYPE *output, uint maxFrames)
+{
+    uint n = outputRing.read(output, maxFrames);
+    if (n == maxFrames)
+    {
+        outputPrimed = true;
+    }
+    else if (outputPrimed)
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return n;
+}
+
+
+void SoundTouchThread::setTempoAndPitch(double newTempo, double newPitch, uint rampFrames)
+{
+    targetTempo = newTempo;
+    targetPitch = newPitch;
+    targetRampFrames = rampFrames;
+    paramSeq.fetch_add(1, std::memory_order_release);
+}
+
+
+void SoundTouchThread::flush()
+{
+    flushRequested = true;
+}
+
+
+void SoundTouchThread::getStatistics(Statistics *stats) const
+{
+    unsigned long long wall = wallNanos.load();
+
+    stats->underruns = underruns.load();
+    stats->overflows = overflows.load();
+    stats->load = (wall > 0) ? (double)busyNanos.load() / (double)wall : 0.0;
+    stats->peakLoad = peakLoad.load();
+}
+
+
+void SoundTouchThread::resetStatistics()
+{
+    underruns = 0;
+    overflows = 0;
+    busyNanos = 0;
+    wallNanos = 0;
+    peakLoad = 0.0;
+}
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Runs a SoundTouch instance on a dedicated processing thread, decoupling
+/// the audio callback thread from the processing cost.
+///
+/// The audio thread writes input into a lock-free ring and reads processed
+/// output from another one (see SampleRing.h), so that its own cost per
+/// callback is two memory copies regardless of the SoundTouch settings. The
+/// processing thread polls the input ring and sleeps briefly when idle.
+///
+/// Reports output underruns, input overflows and the share of time the
+/// processing thread is busy, i.e. how much processing headroom is left.
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SoundTouchThread_H
+#define SoundTouchThread_H
+
+#include <atomic>
+#include <thread>
+
+#include "SoundTouch.h"
+#include "SampleRing.h"
+#include "STTypes.h"
+
+namespace soundtouch
+{
+
+class SoundTouchThread
+{
+public:
+    /// Processing statistics, see getStatistics()
+    struct Statistics
+    {
+        /// Number of receiveSamples() calls that got fewer frames than requested,
+        /// not counting the calls before the first complete one
+        unsigned long long underruns;
+
+        /// Number of input frames dropped because the input ring was full
+        unsigned long long overflows;
+
+        /// Share of time the processing thread has been busy, 0..1. The
+        /// processing headroom is 1 - load.
+        double load;
+
+        /// Highest load over any 100 ms period
+        double peakLoad;
+    };
+
+private:
+    SoundTouch *pSoundTouch;
+    SampleRing inputRing;
+    SampleRing outputRing;
+
+    /// Work buffer of the processing thread
+    SAMPLETYPE *chunk;
+
+    std::thread worker;
+    std::atomic<bool> running;
+    std::atomic<bool> flushRequested;
+
+    /// Set when the processing thread has stopped on an error. 'errorMsg' is
+    /// written before the flag is set, and not allocated, so that the audio
+    /// thread can check the state.
+    std::atomic<bool> failed;
+    char errorMsg[256];
+
+    // Pending tempo & pitch change, applied by the processing thread when
+    // 'paramSeq' changes
+    std::atomic<double> targetTempo;
+    std::atomic<double> targetPitch;
+    std::atomic<uint> targetRampFrames;
+    std::atomic<uint> paramSeq;
+
+    // Statistics. Counters of the audio thread and of the processing thread
+    // are each written by one thread only.
+    bool outputPrimed;
+    std::atomic<unsigned long long> underruns;
+    std::atomic<unsigned long long> overflows;
+    std::atomic<unsigned long long> busyNanos;
+    std::atomic<unsigned long long> wallNanos;
+    std::atomic<double> peakLoad;
+
+    /// Thread function of the processing thread
+    void run();
+
+public:
+    /// Constructor. The SoundTouch instance must have its channels and sample
+    /// rate set, and must not be used directly while the thread is running.
+    SoundTouchThread(SoundTouch *soundTouch,  ///< Instance to run, not owned
+                     uint ringFrames          ///< Minimum capacity of both rings in frames
+                     );
+
+    /// Destructor, stops the processing thread.
+    ~SoundTouchThread();
+
+    /// Starts the processing thread. Does nothing if it's running already.
+    /// Clears the error of a processing thread that has stopped on an error.
+    void start();
+
+    /// Stops the processing thread. Samples in the rings and in the SoundTouch
+    /// instance are kept, so processing can continue with start().
+    void stop();
+
+    /// Returns nonzero if the processing thread is running.
+    bool isRunning() const
+    {
+        return running.load();
+    }
+
+    /// Returns nonzero if the processing thread has stopped on an error, e.g.
+    /// because the sample rate of the SoundTouch instance isn't set. See
+    /// getErrorString().
+    bool hasFailed() const
+    {
+        return failed.load(std::memory_order_acquire);
+    }
+
+    /// Returns the message of the error that stopped the processing thread,
+    /// or an empty string if there's none.
+    const char *getErrorString() const
+    {
+        return hasFailed() ? errorMsg : "";
+    }
+
+    /// Writes input samples to the input ring; never blocks. Call from one
+    /// thread only. Frames that don't fit in the ring are dropped and counted
+    /// as overflows.
+    ///
+    /// \return Number of frames accepted; 0 once the processing thread has
+    /// stopped on an error.
+    uint putSamples(const SAMPLETYPE *samples,  ///< Interleaved input samples
+                    uint numFrames              ///< Number of frames in 'samples'
+                    );
+
+    /// Reads processed samples from the output ring; never blocks. Call from
+    /// one thread only. Getting fewer frames than requested after the first
+    /// complete read counts as an underrun.
+    ///
+    /// \return Number of frames read.
+    uint receiveSamples(SAMPLETYPE *output,  ///< Buffer for interleaved output
+                        uint maxFrames       ///< Number of frames to read
+                        );
+
+    /// Returns number of channels of the SoundTouch instance
+    uint numChannels() const
+    {
+        return pSoundTouch->numChannels();
+    }
+
+    /// Returns number of processed frames ready in the output ring.
+    uint numSamples() const
+    {
+        return outputRing.numFrames();
+    }
+
+    /// Ramps tempo and pitch to new values in the processing thread, see
+    /// SoundTouch::rampTempoAndPitch(). May be called from any thread.
+    void setTempoAndPitch(double newTempo, double newPitch, uint rampFrames);
+
+    /// Requests the processing thread to flush the SoundTouch instance once
+    /// the input ring has been processed, e.g. at the end of a stream.
+    void flush();
+
+    /// Reads the processing statistics.
+    void getStatistics(Statistics *stats) const;
+
+    /// Resets the processing statistics.
+    void resetStatistics();
+};
+
+}
+
+#endif
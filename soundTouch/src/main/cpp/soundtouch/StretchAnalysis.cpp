@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Reusable analysis of a clip for the time-stretch overlap position search,
+/// and the process-wide cache of the analyses.
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <list>
+#include <mutex>
+#include <string>
+
+#include "StretchAnalysis.h"
+
+using namespace soundtouch;
+
+// Half length of the triangular lowpass filter applied before decimation. The
+// filter has zeros at multiples of samplerate / ANALYSIS_DECIMATION.
+#define LOWPASS_HALF    ANALYSIS_DECIMATION
+
+
+StretchAnalysis::StretchAnalysis(const SAMPLETYPE *clip, uint aNumFrames, int aChannels)
+{
+    numFrames = aNumFrames;
+    channels = aChannels;
+    coarseLength = (int)((numFrames + ANALYSIS_DECIMATION - 1) / ANALYSIS_DECIMATION);
+    coarse = new float[(size_t)coarseLength * channels];
+    energy = new double[coarseLength + 1];
+
+    // the filter taps sum up to LOWPASS_HALF^2; frames outside the clip are 0
+    const float scale = 1.0f / (float)(LOWPASS_HALF * LOWPASS_HALF);
+
+    energy[0] = 0;
+    for (int m = 0; m < coarseLength; m ++)
+    {
+        const long centre = (long)m * ANALYSIS_DECIMATION;
+        float *dest = coarse + (size_t)m * channels;
+        double e = 0;
+
+        for (int c = 0; c < channels; c ++)
+        {
+            dest[c] = 0;
+        }
+        for (int t = 1 - LOWPASS_HALF; t < LOWPASS_HALF; t ++)
+        {
+            const long i = centre + t;
+            if ((i < 0) || (i >= (long)numFrames)) continue;
+
+            const SAMPLETYPE *frame = clip + i * channels;
+            const float weight = (float)(LOWPASS_HALF - (t < 0 ? -t : t)) * scale;
+            for (int c = 0; c < channels; c ++)
+            {
+                dest[c] += weight * (float)frame[c];
+            }
+        }
+        for (int c = 0; c < channels; c ++)
+        {
+            e += (double)dest[c] * (double)dest[c];
+        }
+        energy[m + 1] = energy[m] + e;
+    }
+}
+
+
+StretchAnalysis::~StretchAnalysis()
+{
+    delete[] coarse;
+    delete[] energy;
+}
+
+
+size_t StretchAnalysis::getSize() const
+{
+    return sizeof(StretchAnalysis) + (size_t)coarseLength * channels * sizeof(float) +
+           (coarseLength + 1) * sizeof(double);
+}
+
+
+/*****************************************************************************
+ *
+ * StretchAnalysisCache
+ *
+ *****************************************************************************/
+
+namespace
+{
+    struct CacheEntry
+    {
+        std::string clipId;
+        std::shared_ptr<const StretchAnalysis> analysis;
+    };
+
+    // Entries in order of use, the most recently used first
+    std::list<CacheEntry> cacheEntries;
+    size_t cacheSize = 0;
+    size_t cacheCapacity = ANALYSIS_CACHE_BYTES;
+    std::mutex cacheMutex;
+
+    // Drops the least recently used entries until within the capacity. Keeps
+    // the most recently used entry even if it alone exceeds the capacity.
+    void evict()
+    {
+        while ((cacheSize > cacheCapacity) && (cacheEntries.size() > 1))
+        {
+            cacheSize -= cacheEntries.back().analysis->getSize();
+            cacheEntries.pop_back();
+        }
+    }
+
+    std::list<CacheEntry>::iterator find(const char *clipId)
+    {
+        std::list<CacheEntry>::iterator it;
+        for (it = cacheEntries.begin(); it != cacheEntries.end(); ++ it)
+        {
+            if (it->clipId == clipId) break;
+        }
+        return it;
+    }
+}
+
+
+std::shared_ptr<const StretchAnalysis> StretchAnalysisCache::get(const char *clipId,
+                                                                 const SAMPLETYPE *clip,
+                                                                 uint numFrames,
+                                                                 int channels)
+{
+    if ((clipId == NULL) || (numFrames == 0) || (channels <= 0))
+    {
+        return std::shared_ptr<const StretchAnalysis>();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        std::list<CacheEntry>::iterator it = find(clipId);
+
+        if (it != cacheEntries.end())
+        {
+            if ((it->analysis->getLength() == numFrames) && (it->analysis->getChannels() == channels))
+            {
+                // hit: move to the front
+                cacheEntries.splice(cacheEntries.begin(), cacheEntries, it);
+                return cacheEntries.front().analysis;
+            }
+            // the clip has changed since it was analysed
+            cacheSize -= it->analysis->getSize();
+            cacheEntries.erase(it);
+        }
+    }
+
+    if (clip == NULL)
+    {
+        return std::shared_ptr<const StretchAnalysis>();
+    }
+
+    // analyse without holding the lock, so that other clips can be looked up
+    // meanwhile. If another thread analysed the same clip meanwhile, its
+    // result is replaced by an identical one.
+    std::shared_ptr<const StretchAnalysis> analysis(new StretchAnalysis(clip, numFrames, channels));
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::list<CacheEntry>::iterator it = find(clipId);
+    if (it != cacheEntries.end())
+    {
+        cacheSize -= it->analysis->getSize();
+        cacheEntries.erase(it);
+    }
+
+    CacheEntry entry;
+    entry.clipId = clipId;
+    entry.analysis = analysis;
+    cacheEntries.push_front(entry);
+    cacheSize += analysis->getSize();
+    evict();
+
+    return analysis;
+}
+
+
+void StretchAnalysisCache::remove(const char *clipId)
+{
+    if (clipId == NULL) return;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::list<CacheEntry>::iterator it = find(clipId);
+    if (it != cacheEntries.end())
+    {
+        cacheSize -= it->analysis->getSize();
+        cacheEntries.erase(it);
+    }
+}
+
+
+void StretchAnalysisCache::clear()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheEntries.clear();
+    cacheSize = 0;
+}
+
+
+void StretchAnalysisCache::setCapacity(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheCapacity = bytes;
+    evict();
+}
+
+
+size_t StretchAnalysisCache::getSize()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cacheSize;
+}
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Reusable analysis of a clip for the time-stretch overlap position search,
+/// for rendering the same clip repeatedly at different tempos.
+///
+/// The analysis holds the lowpass filtered, decimated clip and the prefix sums
+/// of its energy. With an analysis attached, TDStretch first ranks all seek
+/// positions by correlating the decimated signal, which costs a fraction of
+/// the full seek, and then evaluates the exact correlation only around the few
+/// best candidates.
+///
+/// The analysis depends only on the clip and its channel count, not on the
+/// tempo or the sequence, seek window & overlap settings, so one analysis
+/// serves every render of the clip. StretchAnalysisCache keeps the analyses of
+/// recently used clips by clip ID within a memory limit.
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef StretchAnalysis_H
+#define StretchAnalysis_H
+
+#include <stddef.h>
+#include <memory>
+
+#include "STTypes.h"
+
+namespace soundtouch
+{
+
+/// Decimation factor of the analysis signal
+#define ANALYSIS_DECIMATION     4
+
+/// Default memory limit of StretchAnalysisCache in bytes
+#define ANALYSIS_CACHE_BYTES    (64 * 1024 * 1024)
+
+class StretchAnalysis
+{
+private:
+    uint numFrames;
+    int channels;
+
+    /// Decimated signal, 'coarseLength' interleaved frames
+    float *coarse;
+    int coarseLength;
+
+    /// Prefix sums of the energy of the decimated frames, 'coarseLength' + 1 items
+    double *energy;
+
+public:
+    /// Analyses 'numFrames' interleaved frames of 'clip'
+    StretchAnalysis(const SAMPLETYPE *clip, uint numFrames, int channels);
+    ~StretchAnalysis();
+
+    /// Length of the analysed clip in frames
+    uint getLength() const { return numFrames; }
+
+    /// Number of channels of the analysed clip
+    int getChannels() const { return channels; }
+
+    /// Decimated interleaved signal; frame 'm' corresponds to clip frame
+    /// m * ANALYSIS_DECIMATION
+    const float *getCoarse() const { return coarse; }
+
+    /// Number of frames in getCoarse()
+    int getCoarseLength() const { return coarseLength; }
+
+    /// Energy of the decimated frames 'pos' .. 'pos' + 'count' - 1
+    double getEnergy(int pos, int count) const
+    {
+        return energy[pos + count] - energy[pos];
+    }
+
+    /// Memory used by the analysis in bytes
+    size_t getSize() const;
+};
+
+
+/// Process-wide cache of clip analyses, safe to use from several threads.
+/// When the analyses exceed the memory limit, the least recently used ones
+/// are dropped; processors using a dropped analysis keep it until detached.
+class StretchAnalysisCache
+{
+public:
+    /// Returns the analysis of the clip 'clipId' with 'numFrames' interleaved
+    /// frames of 'channels' channels. Analyses 'clip' and stores the result if
+    /// the cache has no such analysis yet. 'clip' may be NULL for a lookup only.
+    ///
+    /// \return the analysis, or an empty pointer if not cached and 'clip' is NULL
+    static std::shared_ptr<const StretchAnalysis> get(const char *clipId,
+                                                      const SAMPLETYPE *clip,
+                                                      uint numFrames,
+                                                      int channels);
+
+    /// Drops the analysis of 'clipId', e.g. after the clip has been edited
+    static void remove(const char *clipId);
+
+    /// Drops all analyses
+    static void clear();
+
+    /// Sets the memory limit in bytes, default ANALYSIS_CACHE_BYTES
+    static void setCapacity(size_t bytes);
+
+    /// Memory used by the cached analyses in bytes
+    static size_t getSize();
+};
+
+}
+
+#endif
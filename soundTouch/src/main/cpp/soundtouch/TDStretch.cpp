@@ -49,6 +49,9 @@
 #include "STTypes.h"
 #include "cpu_detect.h"
 #include "TDStretch.h"
+#include "FFTCorrelator.h"
+#include "StretchAnalysis.h"
+#include "STSimd.h"
 
 using namespace soundtouch;
 
@@ -83,10 +86,14 @@ const short _scanOffsets[5][24]={
 TDStretch::TDStretch() : FIFOProcessor(&outputBuffer)
 {
     bQuickSeek = false;
+    bFFTSeek = false;
+    pFFTCorr = NULL;
+    pAnalysis = NULL;
     channels = 2;
 
     pMidBuffer = NULL;
     pMidBufferUnaligned = NULL;
+    midBufferSize = 0;
     overlapLength = 0;
 
     bAutoSeqSetting = true;
@@ -104,6 +111,7 @@ TDStretch::TDStretch() : FIFOProcessor(&outputBuffer)
 TDStretch::~TDStretch()
 {
     delete[] pMidBufferUnaligned;
+    delete pFFTCorr;
 }
 
 
@@ -157,6 +165,8 @@ void TDStretch::setParameters(int aSampleRate, int aSequenceMS,
 
     // set tempo to recalculate 'sampleReq'
     setTempo(tempo);
+
+    reserveBuffers();
 }
 
 
@@ -221,6 +231,8 @@ void TDStretch::clearInput()
     maxnorm = 0;
     maxnormf = 1e8;
     skipFract = 0;
+    analysisPos = 0;
+    analysisRef = -1;
 }
 
 
@@ -248,13 +260,45 @@ bool TDStretch::isQuickSeekEnabled() const
 }
 
 
+// Enables/disables the FFT based seeking algorithm. Zero to disable, nonzero
+// to enable
+void TDStretch::enableFFTSeek(bool enable)
+{
+    bFFTSeek = enable;
+    if (enable) reserveBuffers();
+}
+
+
+// Returns nonzero if the FFT seeking algorithm is enabled.
+bool TDStretch::isFFTSeekEnabled() const
+{
+    return bFFTSeek;
+}
+
+
+// Attaches the analysis of the clip being processed
+void TDStretch::setAnalysis(const StretchAnalysis *analysis)
+{
+    pAnalysis = analysis;
+}
+
+
 // Seeks for the optimal overlap-mixing position.
 int TDStretch::seekBestOverlapPosition(const SAMPLETYPE *refPos)
 {
-    if (bQuickSeek) 
+    if ((pAnalysis != NULL) && (analysisRef >= 0) &&
+        (analysisPos + seekLength + overlapLength <= (long)pAnalysis->getLength()))
+    {
+        return seekBestOverlapPositionAnalysed(refPos);
+    }
+    else if (bQuickSeek) 
     {
         return seekBestOverlapPositionQuick(refPos);
     }
+    else if (bFFTSeek)
+    {
+        return seekBestOverlapPositionFFT(refPos);
+    }
     else 
     {
         return seekBestOverlapPositionFull(refPos);
@@ -475,6 +519,192 @@ int TDStretch::seekBestOverlapPositionQuick(const SAMPLETYPE *refPos)
 
 
 
+// FFT seek algorithm: Evaluates the same correlation measure as the full seek
+// algorithm, but calculates the cross-correlation of all seek positions at once
+// with FFT. The normalizing energy term is updated as a sliding sum.
+//
+// The complexity is O(seekLength * log(overlapLength)) instead of
+// O(seekLength * overlapLength) of the full seek algorithm.
+int TDStretch::seekBestOverlapPositionFFT(const SAMPLETYPE *refPos)
+{
+    const int ovlItems = channels * overlapLength;
+    const float *corr;
+    double bestCorr;
+    double norm;
+    double scale;
+    int bestOffs;
+    int i;
+
+    // allocated by reserveBuffers() off the processing path
+    assert(pFFTCorr != NULL);
+
+    // correlate over all interleaved sample positions; every 'channels'th lag
+    // corresponds to a seek offset
+    corr = pFFTCorr->correlate(refPos, channels * (seekLength - 1) + ovlItems, pMidBuffer, ovlItems);
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    // integer calcCrossCorr scales products down by 'overlapDividerBitsNorm' bits
+    scale = 1.0 / (double)(1L << overlapDividerBitsNorm);
+#else
+    scale = 1.0;
+#endif
+
+    norm = 0;
+    for (i = 0; i < ovlItems; i ++)
+    {
+        norm += (double)refPos[i] * (double)refPos[i];
+    }
+
+    bestCorr = -FLT_MAX;
+    bestOffs = 0;
+
+    for (i = 0; i < seekLength; i ++)
+    {
+        double c, n;
+
+        if (i > 0)
+        {
+            // slide the normalizer window by one sample
+            const SAMPLETYPE *pOld = refPos + channels * (i - 1);
+            for (int ch = 0; ch < channels; ch ++)
+            {
+                norm -= (double)pOld[ch] * (double)pOld[ch];
+                norm += (double)pOld[ovlItems + ch] * (double)pOld[ovlItems + ch];
+            }
+        }
+
+        n = norm * scale;
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+        if (n > maxnorm)
+        {
+            maxnorm = (unsigned long)n;
+        }
+#endif
+        c = (double)corr[channels * i] * scale / sqrt((n < 1e-9) ? 1.0 : n);
+
+        // heuristic rule to slightly favour values close to mid of the range
+        double tmp = (double)(2 * i - seekLength) / (double)seekLength;
+        c = ((c + 0.1) * (1.0 - 0.25 * tmp * tmp));
+
+        if (c > bestCorr)
+        {
+            bestCorr = c;
+            bestOffs = i;
+        }
+    }
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    adaptNormalizer();
+#endif
+
+    return bestOffs;
+}
+
+
+// Seek algorithm using the clip analysis: Ranks every seek position by the
+// correlation of the decimated signal of the analysis, and then evaluates the
+// same correlation measure as the full seek algorithm around the best
+// candidates. The scan of the decimated signal costs about
+// 1 / ANALYSIS_DECIMATION^2 of the full seek.
+int TDStretch::seekBestOverlapPositionAnalysed(const SAMPLETYPE *refPos)
+{
+#define CANDIDATES  3
+
+    const int step = ANALYSIS_DECIMATION;
+    const float *coarse = pAnalysis->getCoarse();
+    const int coarseLength = pAnalysis->getCoarseLength();
+    const int len = (overlapLength / step > 0) ? overlapLength / step : 1;
+    const long ref = (analysisRef + step / 2) / step;
+    const long first = (analysisPos + step - 1) / step;
+    const long last = (analysisPos + seekLength - 1) / step;
+    int cand[CANDIDATES];
+    double candCorr[CANDIDATES];
+    double bestCorr;
+    double norm;
+    int bestOffs;
+    int c, i;
+
+    if (ref + len > coarseLength)
+    {
+        return seekBestOverlapPositionFull(refPos);
+    }
+
+    for (c = 0; c < CANDIDATES; c ++)
+    {
+        cand[c] = seekLength / 2;
+        candCorr[c] = -FLT_MAX;
+    }
+
+    // rank the positions on the decimated grid, keep the best in 'cand' in
+    // order of the correlation
+    for (long m = first; (m <= last) && (m + len <= coarseLength); m ++)
+    {
+        double e = pAnalysis->getEnergy((int)m, len);
+        double corr = simdDotProduct(coarse + channels * ref, coarse + channels * m, channels * len) /
+                      sqrt((e < 1e-9) ? 1.0 : e);
+
+        // heuristic rule to slightly favour values close to mid of the range
+        i = (int)(m * step - analysisPos);
+        double tmp = (double)(2 * i - seekLength) / (double)seekLength;
+        corr = ((corr + 0.1) * (1.0 - 0.25 * tmp * tmp));
+
+        for (c = CANDIDATES - 1; (c >= 0) && (corr > candCorr[c]); c --)
+        {
+            if (c < CANDIDATES - 1)
+            {
+                cand[c + 1] = cand[c];
+                candCorr[c + 1] = candCorr[c];
+            }
+            cand[c] = i;
+            candCorr[c] = corr;
+        }
+    }
+
+    // refine around the candidates with full precision. The grid step and
+    // the rounding of the reference position are both covered by +-'step'.
+    bestCorr = -FLT_MAX;
+    bestOffs = cand[0];
+
+    for (c = 0; c < CANDIDATES; c ++)
+    {
+        int begin = (cand[c] - step < 0) ? 0 : cand[c] - step;
+        int end = (cand[c] + step + 1 > seekLength) ? seekLength : cand[c] + step + 1;
+
+        for (i = begin; i < end; i ++)
+        {
+            // skip positions already evaluated around the better candidates
+            int prev;
+            for (prev = 0; prev < c; prev ++)
+            {
+                if ((i >= cand[prev] - step) && (i <= cand[prev] + step)) break;
+            }
+            if (prev < c) continue;
+
+            double corr = calcCrossCorr(refPos + channels * i, pMidBuffer, norm);
+
+            // heuristic rule to slightly favour values close to mid of the range
+            double tmp = (double)(2 * i - seekLength) / (double)seekLength;
+            corr = ((corr + 0.1) * (1.0 - 0.25 * tmp * tmp));
+
+            if (corr > bestCorr)
+            {
+                bestCorr = corr;
+                bestOffs = i;
+            }
+        }
+    }
+
+    // clear cross correlation routine state if necessary (is so e.g. in MMX routines).
+    clearCrossCorrState();
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    adaptNormalizer();
+#endif
+
+    return bestOffs;
+}
+
+
 /// For integer algorithm: adapt normalization factor divider with music so that 
 /// it'll not be pessimistically restrictive that can degrade quality on quieter sections
 /// yet won't cause integer overflows either
@@ -559,6 +789,30 @@ void TDStretch::calcSeqParameters()
 }
 
 
+/// Preallocates the sample buffers for a typical input block on top of the largest
+/// processing requirement within the tempo range FIFO_RESERVE_RATE_MIN .. _MAX, and
+/// the FFT tables of the FFT seek mode, so that tempo changes during processing
+/// don't allocate memory
+void TDStretch::reserveBuffers()
+{
+    int seqMs = bAutoSeqSetting ? (int)AUTOSEQ_AT_MIN : sequenceMs;
+    int seekMs = bAutoSeekSetting ? (int)AUTOSEEK_AT_MIN : seekWindowMs;
+    int maxWindowLength = max((sampleRate * seqMs) / 1000, 2 * overlapLength);
+    int maxSampleReq = (int)(FIFO_RESERVE_RATE_MAX * maxWindowLength) + overlapLength + (sampleRate * seekMs) / 1000;
+
+    inputBuffer.reserve(maxSampleReq + 2 * FIFO_TYPICAL_BLOCK_SIZE);
+    outputBuffer.reserve((uint)(FIFO_TYPICAL_BLOCK_SIZE / FIFO_RESERVE_RATE_MIN) + maxWindowLength);
+
+    if (bFFTSeek && (overlapLength > 0))
+    {
+        // FFT tables for the current overlap and the longest seek window
+        int maxSeekLength = max((sampleRate * seekMs) / 1000, 1);
+        if (pFFTCorr == NULL) pFFTCorr = new FFTCorrelator();
+        pFFTCorr->reserve(channels * (maxSeekLength - 1 + overlapLength), channels * overlapLength);
+    }
+}
+
+
 
 // Sets new target tempo. Normal tempo = 'SCALE', smaller values represent slower 
 // tempo, larger faster tempo.
@@ -711,6 +965,7 @@ void TDStretch::processSamples()
         assert((offset + temp + overlapLength) <= (int)inputBuffer.numSamples());
         memcpy(pMidBuffer, inputBuffer.ptrBegin() + channels * (offset + temp), 
             channels * sizeof(SAMPLETYPE) * overlapLength);
+        analysisRef = analysisPos + offset + temp;
 
         // Remove the processed samples from the input buffer. Update
         // the difference between integer & nominal skip step to 'skipFract'
@@ -719,6 +974,7 @@ void TDStretch::processSamples()
         ovlSkip = (int)skipFract;   // rounded to integer skip
         skipFract -= ovlSkip;       // maintain the fraction part, i.e. real vs. integer skip
         inputBuffer.receiveSamples((uint)ovlSkip);
+        analysisPos += ovlSkip;
     }
 }
 
@@ -736,6 +992,8 @@ void TDStretch::putSamples(const SAMPLETYPE *samples, uint nSamples)
 
 
 /// Set new overlap length parameter & reallocate RefMidBuffer if necessary.
+/// The buffer is only grown, so that going back to a shorter overlap and then
+/// to the longer one again doesn't allocate memory.
 void TDStretch::acceptNewOverlapLength(int newOverlapLength)
 {
     int prevOvl;
@@ -746,11 +1004,15 @@ void TDStretch::acceptNewOverlapLength(int newOverlapLength)
 
     if (overlapLength > prevOvl)
     {
-        delete[] pMidBufferUnaligned;
+        if (overlapLength * channels > midBufferSize)
+        {
+            delete[] pMidBufferUnaligned;
 
-        pMidBufferUnaligned = new SAMPLETYPE[overlapLength * channels + 16 / sizeof(SAMPLETYPE)];
-        // ensure that 'pMidBuffer' is aligned to 16 byte boundary for efficiency
-        pMidBuffer = (SAMPLETYPE *)SOUNDTOUCH_ALIGN_POINTER_16(pMidBufferUnaligned);
+            midBufferSize = overlapLength * channels;
+            pMidBufferUnaligned = new SAMPLETYPE[midBufferSize + 16 / sizeof(SAMPLETYPE)];
+            // ensure that 'pMidBuffer' is aligned to 16 byte boundary for efficiency
+            pMidBuffer = (SAMPLETYPE *)SOUNDTOUCH_ALIGN_POINTER_16(pMidBufferUnaligned);
+        }
 
         clearMidBuffer();
     }
@@ -831,15 +1093,44 @@ void TDStretch::overlapStereo(short *poutput, const short *input) const
 // version of the routine.
 void TDStretch::overlapMulti(short *poutput, const short *input) const
 {
+    // common layouts get kernels with the channel count known at compile time
+    switch (channels)
+    {
+        case 4:
+            overlapMultiCh<4>(poutput, input);
+            break;
+        case 6:
+            overlapMultiCh<6>(poutput, input);
+            break;
+        case 8:
+            overlapMultiCh<8>(poutput, input);
+            break;
+        default:
+            overlapMultiCh<0>(poutput, input);
+            break;
+    }
+}
+
+
+template <int CH>
+void TDStretch::overlapMultiCh(short *poutput, const short *input) const
+{
+    const int ch = CH ? CH : channels;
+    // overlapLength is a power of 2, see calculateOverlapLength(); divide by
+    // shifting, rounding negative values towards zero like the '/' operator
+    const int shift = overlapDividerBitsPure + 1;
+    const int round = overlapLength - 1;
     short m1;
     int i = 0;
 
+    assert(overlapLength == (1 << shift));
     for (m1 = 0; m1 < overlapLength; m1 ++)
     {
         short m2 = (short)(overlapLength - m1);
-        for (int c = 0; c < channels; c ++)
+        for (int c = 0; c < ch; c ++)
         {
-            poutput[i] = (input[i] * m1 + pMidBuffer[i] * m2)  / overlapLength;
+            int temp = input[i] * m1 + pMidBuffer[i] * m2;
+            poutput[i] = (short)((temp + ((temp >> 31) & round)) >> shift);
             i++;
         }
     }
@@ -1000,6 +1291,29 @@ void TDStretch::overlapStereo(float *pOutput, const float *pInput) const
 // Overlaps samples in 'midBuffer' with the samples in 'input'. 
 void TDStretch::overlapMulti(float *pOutput, const float *pInput) const
 {
+    // common layouts get kernels with the channel count known at compile time
+    switch (channels)
+    {
+        case 4:
+            overlapMultiCh<4>(pOutput, pInput);
+            break;
+        case 6:
+            overlapMultiCh<6>(pOutput, pInput);
+            break;
+        case 8:
+            overlapMultiCh<8>(pOutput, pInput);
+            break;
+        default:
+            overlapMultiCh<0>(pOutput, pInput);
+            break;
+    }
+}
+
+
+template <int CH>
+void TDStretch::overlapMultiCh(float *pOutput, const float *pInput) const
+{
+    const int ch = CH ? CH : channels;
     int i;
     float fScale;
     float f1;
@@ -1013,8 +1327,7 @@ void TDStretch::overlapMulti(float *pOutput, const float *pInput) const
     i=0;
     for (int i2 = 0; i2 < overlapLength; i2 ++)
     {
-        // note: Could optimize this slightly by taking into account that always channels > 2
-        for (int c = 0; c < channels; c ++)
+        for (int c = 0; c < ch; c ++)
         {
             pOutput[i] = pInput[i] * f1 + pMidBuffer[i] * f2;
             i++;
@@ -125,16 +125,29 @@ protected:
     double skipFract;
 
     bool bQuickSeek;
+    bool bFFTSeek;
     bool bAutoSeqSetting;
     bool bAutoSeekSetting;
     bool isBeginning;
 
     SAMPLETYPE *pMidBuffer;
     SAMPLETYPE *pMidBufferUnaligned;
+    int midBufferSize;      ///< Allocated size of 'pMidBuffer' in samples
 
     FIFOSampleBuffer outputBuffer;
     FIFOSampleBuffer inputBuffer;
 
+    /// FFT cross-correlation engine for the FFT seek mode, allocated with the
+    /// other buffers in reserveBuffers() when the mode is enabled
+    class FFTCorrelator *pFFTCorr;
+
+    /// Analysis of the clip being processed, NULL if none. 'analysisPos' is the
+    /// clip frame at the beginning of 'inputBuffer', 'analysisRef' the clip
+    /// frame of the samples in 'pMidBuffer', -1 if not known.
+    const class StretchAnalysis *pAnalysis;
+    long analysisPos;
+    long analysisRef;
+
     void acceptNewOverlapLength(int newOverlapLength);
 
     virtual void clearCrossCorrState();
@@ -145,16 +158,23 @@ protected:
 
     virtual int seekBestOverlapPositionFull(const SAMPLETYPE *refPos);
     virtual int seekBestOverlapPositionQuick(const SAMPLETYPE *refPos);
+    virtual int seekBestOverlapPositionFFT(const SAMPLETYPE *refPos);
+    virtual int seekBestOverlapPositionAnalysed(const SAMPLETYPE *refPos);
     virtual int seekBestOverlapPosition(const SAMPLETYPE *refPos);
 
     virtual void overlapStereo(SAMPLETYPE *output, const SAMPLETYPE *input) const;
     virtual void overlapMono(SAMPLETYPE *output, const SAMPLETYPE *input) const;
     virtual void overlapMulti(SAMPLETYPE *output, const SAMPLETYPE *input) const;
 
+    /// overlapMulti() for CH channels, or for 'channels' if CH is 0
+    template <int CH>
+    void overlapMultiCh(SAMPLETYPE *output, const SAMPLETYPE *input) const;
+
     void clearMidBuffer();
     void overlap(SAMPLETYPE *output, const SAMPLETYPE *input, uint ovlPos) const;
 
     void calcSeqParameters();
+    void reserveBuffers();
     void adaptNormalizer();
 
     /// Changes the tempo of the given sound samples.
@@ -202,6 +222,22 @@ public:
     /// Returns nonzero if the quick seeking algorithm is enabled.
     bool isQuickSeekEnabled() const;
 
+    /// Enables/disables the FFT based full seeking algorithm. It finds the same
+    /// best overlap position as the default full seek, but evaluates correlation
+    /// of all positions at once with FFT, which is faster with long overlap & seek
+    /// windows (high sample rates). Quick seek takes precedence if both are enabled.
+    void enableFFTSeek(bool enable);
+
+    /// Returns nonzero if the FFT seeking algorithm is enabled.
+    bool isFFTSeekEnabled() const;
+
+    /// Attaches the analysis of the clip whose first frame is the next input
+    /// after clear() or clearInput(). While the input stays within the clip,
+    /// the overlap position is sought with the help of the analysis instead
+    /// of the quick, FFT or full seek. NULL detaches the analysis. The caller
+    /// keeps the analysis alive while attached.
+    void setAnalysis(const class StretchAnalysis *analysis);
+
     /// Sets routine control parameters. These control are certain time constants
     /// defining how the sound is stretched to the desired duration.
     //
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Tuning profile of time-stretch settings, see TuningProfile.h
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+
+#include "TuningProfile.h"
+
+using namespace soundtouch;
+
+static const char *_contentNames[NUM_CONTENT_TYPES] = { "music", "speech", "percussive" };
+
+
+TuningProfile::TuningProfile()
+{
+    numEntries = 0;
+}
+
+
+bool TuningProfile::parse(const char *text)
+{
+    numEntries = 0;
+    if (text == NULL) return true;
+
+    while (*text)
+    {
+        char line[256];
+        const char *end = strchr(text, '\n');
+        size_t len = end ? (size_t)(end - text) : strlen(text);
+
+        if (len >= sizeof(line))
+        {
+            numEntries = 0;
+            return false;
+        }
+        memcpy(line, text, len);
+        line[len] = 0;
+        text += end ? len + 1 : len;
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = 0;
+
+        char name[32];
+        char extra[2];
+        if (sscanf(line, " %1s", name) != 1) continue;     // empty line
+
+        Entry e;
+        if ((numEntries == TUNING_MAX_ENTRIES) ||
+            (sscanf(line, " %31s %f %f %d %d %d %d %f %f %1s", name, &e.tempoMin, &e.tempoMax,
+                    &e.sequenceMs, &e.seekWindowMs, &e.overlapMs, &e.quickSeek,
+                    &e.quality, &e.cost, extra) != 9) ||
+            ((e.content = contentFromName(name)) < 0) ||
+            (e.tempoMin >= e.tempoMax) || (e.sequenceMs <= 0) || (e.seekWindowMs <= 0) ||
+            (e.overlapMs <= 0))
+        {
+            numEntries = 0;
+            return false;
+        }
+        entries[numEntries ++] = e;
+    }
+    return true;
+}
+
+
+const TuningProfile::Entry *TuningProfile::select(int content, double tempo, double minQuality) const
+{
+    float low = 0, high = 0;
+    bool found = false;
+
+    // clamp tempo into the range covered for this content
+    for (int i = 0; i < numEntries; i ++)
+    {
+        const Entry &e = entries[i];
+        if (e.content != content) continue;
+        if (!found || e.tempoMin < low) low = e.tempoMin;
+        if (!found || e.tempoMax > high) high = e.tempoMax;
+        found = true;
+    }
+    if (!found) return NULL;
+    if (tempo < low) tempo = low;
+    if (tempo >= high) tempo = high - 1e-6;
+
+    const Entry *cheapest = NULL;
+    const Entry *best = NULL;
+    for (int i = 0; i < numEntries; i ++)
+    {
+        const Entry &e = entries[i];
+        if ((e.content != content) || (tempo < e.tempoMin) || (tempo >= e.tempoMax)) continue;
+
+        if ((e.quality >= minQuality) && (!cheapest || e.cost < cheapest->cost)) cheapest = &e;
+        if (!best || e.quality > best->quality) best = &e;
+    }
+    return cheapest ? cheapest : best;
+}
+
+
+const char *TuningProfile::contentName(int content)
+{
+    return ((content >= 0) && (content < NUM_CONTENT_TYPES)) ? _contentNames[content] : "";
+}
+
+
+int TuningProfile::contentFromName(const char *name)
+{
+    for (int i = 0; i < NUM_CONTENT_TYPES; i ++)
+    {
+        if (strcmp(name, _contentNames[i]) == 0) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Table of measured time-stretch settings for choosing the cheapest settings
+/// that meet a quality target, per content type and tempo range.
+///
+/// The table is text, one entry per line, '#' starts a comment:
+///
+///     content tempo_min tempo_max sequence_ms seekwindow_ms overlap_ms quickseek quality cost
+///
+/// where 'content' is "music", "speech" or "percussive", the entry applies to
+/// tempo_min <= tempo < tempo_max, 'quality' is an objective quality score
+/// (higher is better) and 'cost' the processing time in CPU milliseconds per
+/// second of audio. Such tables are produced by the host benchmark
+/// "tuning_benchmark" from a corpus of recordings.
+///
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TuningProfile_H
+#define TuningProfile_H
+
+#include "STTypes.h"
+
+namespace soundtouch
+{
+
+/// Maximum number of entries in a tuning profile
+#define TUNING_MAX_ENTRIES      256
+
+/// Content types of tuning profile entries, see SETTING_CONTENT_TYPE
+enum TuningContent
+{
+    CONTENT_MUSIC = 0,
+    CONTENT_SPEECH,
+    CONTENT_PERCUSSIVE,
+    NUM_CONTENT_TYPES
+};
+
+class TuningProfile
+{
+public:
+    /// One measured combination of time-stretch settings
+    struct Entry
+    {
+        int content;            ///< TuningContent
+        float tempoMin;         ///< Lowest tempo the entry applies to
+        float tempoMax;         ///< Tempo above the range the entry applies to
+        int sequenceMs;         ///< SETTING_SEQUENCE_MS
+        int seekWindowMs;       ///< SETTING_SEEKWINDOW_MS
+        int overlapMs;          ///< SETTING_OVERLAP_MS
+        int quickSeek;          ///< SETTING_USE_QUICKSEEK
+        float quality;          ///< Quality score, higher is better
+        float cost;             ///< CPU milliseconds per second of audio
+    };
+
+private:
+    Entry entries[TUNING_MAX_ENTRIES];
+    int numEntries;
+
+public:
+    TuningProfile();
+
+    /// Replaces the table with one parsed from 'text'.
+    ///
+    /// \return false if a line is malformed or the table is too large, in
+    /// which case the profile is left empty.
+    bool parse(const char *text);
+
+    /// Returns number of entries
+    int size() const
+    {
+        return numEntries;
+    }
+
+    /// Returns entry 'i', 0 <= i < size()
+    const Entry &getEntry(int i) const
+    {
+        return entries[i];
+    }
+
+    /// Selects the cheapest entry for 'content' at 'tempo' whose quality is at
+    /// least 'minQuality', or the best quality entry if none reaches it. Tempos
+    /// outside the table's range use the nearest range. Doesn't allocate memory.
+    ///
+    /// \return the entry, or NULL if no entry for 'content' covers the tempo.
+    const Entry *select(int content, double tempo, double minQuality) const;
+
+    /// Returns name of content type 'content' as used in the text format
+    static const char *contentName(int content);
+
+    /// Returns the content type called 'name', or -1 if unknown
+    static int contentFromName(const char *name);
+};
+
+}
+
+#endif
@@ -309,12 +309,17 @@ FIRFilterMMX::~FIRFilterMMX()
 void FIRFilterMMX::setCoefficients(const short *coeffs, uint newLength, uint uResultDivFactor)
 {
     uint i;
+    bool bResize = (newLength != length) || (filterCoeffsUnalign == NULL);
+
     FIRFilter::setCoefficients(coeffs, newLength, uResultDivFactor);
 
     // Ensure that filter coeffs array is aligned to 16-byte boundary
-    delete[] filterCoeffsUnalign;
-    filterCoeffsUnalign = new short[2 * newLength + 8];
-    filterCoeffsAlign = (short *)SOUNDTOUCH_ALIGN_POINTER_16(filterCoeffsUnalign);
+    if (bResize)
+    {
+        delete[] filterCoeffsUnalign;
+        filterCoeffsUnalign = new short[2 * newLength + 8];
+        filterCoeffsAlign = (short *)SOUNDTOUCH_ALIGN_POINTER_16(filterCoeffsUnalign);
+    }
 
     // rearrange the filter coefficients for mmx routines 
     for (i = 0;i < length; i += 4) 
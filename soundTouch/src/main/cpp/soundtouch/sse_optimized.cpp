@@ -213,15 +213,19 @@ void FIRFilterSSE::setCoefficients(const float *coeffs, uint newLength, uint uRe
 {
     uint i;
     float fDivider;
+    bool bResize = (newLength != length) || (filterCoeffsUnalign == NULL);
 
     FIRFilter::setCoefficients(coeffs, newLength, uResultDivFactor);
 
     // Scale the filter coefficients so that it won't be necessary to scale the filtering result
     // also rearrange coefficients suitably for SSE
     // Ensure that filter coeffs array is aligned to 16-byte boundary
-    delete[] filterCoeffsUnalign;
-    filterCoeffsUnalign = new float[2 * newLength + 4];
-    filterCoeffsAlign = (float *)SOUNDTOUCH_ALIGN_POINTER_16(filterCoeffsUnalign);
+    if (bResize)
+    {
+        delete[] filterCoeffsUnalign;
+        filterCoeffsUnalign = new float[2 * newLength + 4];
+        filterCoeffsAlign = (float *)SOUNDTOUCH_ALIGN_POINTER_16(filterCoeffsUnalign);
+    }
 
     fDivider = (float)resultDivider;
 
@@ -0,0 +1,75 @@
+package me.shetj.ndk.soundtouch
+
+/**
+ * SoundTouch BPM（节拍速度）检测的Kotlin封装类
+ *
+ * 基于SoundTouch的BPMDetect实现，支持流式输入PCM数据：
+ * 可以分段多次调用[putSamples]，随时通过[getBpm]读取当前的BPM估计值，
+ * 通过[getBeats]读取已检测到的节拍位置。
+ *
+ * 使用示例：
+ * ```kotlin
+ * val detector = BPMDetect()
+ * val handle = detector.newInstance(2, 44100)
+ * while (读取PCM) {
+ *     detector.putSamples(handle, buffer, len)
+ * }
+ * val bpm = detector.getBpm(handle)
+ * detector.deleteInstance(handle)
+ * ```
+ */
+class BPMDetect {
+
+    companion object {
+        init {
+            System.loadLibrary("soundTouch")
+        }
+    }
+
+    /**
+     * 创建新的BPM检测实例
+     *
+     * @param channels 声道数：1=单声道，2=立体声
+     * @param sampleRate 采样率，不能低于8000 Hz
+     * @return 实例句柄，创建失败返回0，错误信息通过[SoundTouch.getErrorString]获取
+     */
+    external fun newInstance(channels: Int, sampleRate: Int): Long
+
+    /**
+     * 删除BPM检测实例，释放内存资源
+     *
+     * @param handle 实例句柄
+     */
+    external fun deleteInstance(handle: Long)
+
+    /**
+     * 输入音频采样数据进行分析，可以分段多次调用
+     *
+     * @param handle 实例句柄
+     * @param samples 音频采样数据数组（16位PCM格式，多声道交错存放）
+     * @param len 有效采样数据长度（以采样点为单位，不是字节数）
+     */
+    external fun putSamples(handle: Long, samples: ShortArray, len: Int)
+
+    /**
+     * 获取BPM检测结果
+     *
+     * 读取结果不会影响分析状态，可以在流式输入过程中随时调用获取当前估计值。
+     *
+     * @param handle 实例句柄
+     * @return 每分钟节拍数，检测失败返回0
+     */
+    external fun getBpm(handle: Long): Float
+
+    /**
+     * 获取已检测到的节拍位置
+     *
+     * 传入null可以只查询节拍数量，用于分配数组大小。
+     *
+     * @param handle 实例句柄
+     * @param pos 接收节拍位置（秒）
+     * @param strength 接收节拍强度，强度很低的节拍可以由调用方自行过滤
+     * @return pos/strength为null时返回节拍总数，否则返回实际写入数组的节拍数
+     */
+    external fun getBeats(handle: Long, pos: FloatArray?, strength: FloatArray?): Int
+}
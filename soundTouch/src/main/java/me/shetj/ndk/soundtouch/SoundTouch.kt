@@ -42,6 +42,56 @@ class SoundTouch {
         const val MAX_RATE_CHANGE = 100.0f
         const val MIN_TEMPO_CHANGE = -50.0f
         const val MAX_TEMPO_CHANGE = 100.0f
+
+        // setSetting/getSetting 可用的设置项，与 SoundTouch.h 中 SETTING_* 定义一致
+        /** 开关变调抗混叠滤波器（0=关闭） */
+        const val SETTING_USE_AA_FILTER = 0
+        /** 抗混叠滤波器长度（8..128，默认32） */
+        const val SETTING_AA_FILTER_LENGTH = 1
+        /** 开关快速查找算法，降低CPU占用但音质略有损失 */
+        const val SETTING_USE_QUICKSEEK = 2
+        /** 时间拉伸处理序列长度（毫秒，0=自动） */
+        const val SETTING_SEQUENCE_MS = 3
+        /** 时间拉伸查找窗口长度（毫秒，0=自动） */
+        const val SETTING_SEEKWINDOW_MS = 4
+        /** 时间拉伸重叠长度（毫秒） */
+        const val SETTING_OVERLAP_MS = 5
+        /** 只读：每批处理的名义输入采样数 */
+        const val SETTING_NOMINAL_INPUT_SEQUENCE = 6
+        /** 只读：每批处理的名义输出采样数 */
+        const val SETTING_NOMINAL_OUTPUT_SEQUENCE = 7
+        /** 只读：初始处理延迟（采样数） */
+        const val SETTING_INITIAL_LATENCY = 8
+        /** 开关FFT查找算法，结果与完整查找相同，高采样率下CPU占用更低；与快速查找同时开启时以快速查找为准 */
+        const val SETTING_USE_FFTSEEK = 9
+        /** 变速插值算法，取值见 ALGORITHM_* 常量；每个实例独立设置，建议在处理前设置 */
+        const val SETTING_INTERPOLATION_ALGORITHM = 10
+        /** 按调优配置选择参数时的内容类型，取值见 CONTENT_* 常量，见[loadTuningProfile] */
+        const val SETTING_CONTENT_TYPE = 11
+        /** 按调优配置选择参数时的质量目标（质量分的10倍，tuning_benchmark 生成的配置中单位为0.1dB），0=最省CPU */
+        const val SETTING_QUALITY_TARGET = 12
+        /** 实时监听的低延迟模式：取值为[processBlock]的块大小（64~256帧），0=关闭；请在设置声道数和采样率之后开启 */
+        const val SETTING_LOW_LATENCY = 13
+        /** 只读：低延迟模式下固定的端到端延迟（帧数），不随音调变化；未开启时为0 */
+        const val SETTING_LIVE_LATENCY = 14
+        /** 开关共振峰保持：变调时校正被移动的频谱包络，人声不再有"花栗鼠"音色；不增加延迟 */
+        const val SETTING_FORMANT_PRESERVE = 15
+
+        // SETTING_INTERPOLATION_ALGORITHM 的取值
+        /** 线性插值：开销最低，适合预览（整数版本默认值） */
+        const val ALGORITHM_LINEAR = 0
+        /** 三次插值：开销与音质折中（浮点版本默认值） */
+        const val ALGORITHM_CUBIC = 1
+        /** Shannon插值：音质最好，适合导出 */
+        const val ALGORITHM_SHANNON = 2
+
+        // SETTING_CONTENT_TYPE 的取值
+        /** 音乐（默认值） */
+        const val CONTENT_MUSIC = 0
+        /** 语音 */
+        const val CONTENT_SPEECH = 1
+        /** 打击乐等瞬态较多的内容 */
+        const val CONTENT_PERCUSSIVE = 2
     }
 
     /**
@@ -156,6 +206,21 @@ class SoundTouch {
      */
     external fun setTempoChange(handle: Long, tempoChange: Float)
 
+    /**
+     * 平滑调整节拍和音调
+     *
+     * 在接下来输入的[rampFrames]帧内，把节拍和音调从当前值线性过渡到目标值，
+     * 处理过程中每64帧更新一次参数，避免直接设置参数带来的突变。
+     * 调用不分配内存，可以在音频回调线程中使用，例如跟随UI滑块连续调整音调。
+     * 新的过渡会替换正在进行的过渡，调用[setTempoChange]、[setPitchSemiTones]等方法会取消过渡。
+     *
+     * @param handle SoundTouch实例句柄
+     * @param tempoChange 目标节拍变化百分比，范围[-50, 100]
+     * @param pitchSemiTones 目标音调变化半音数，范围[-12, 12]
+     * @param rampFrames 过渡时长（输入帧数），0表示立即生效
+     */
+    external fun rampTempoAndPitch(handle: Long, tempoChange: Float, pitchSemiTones: Float, rampFrames: Int)
+
     /**
      * 设置播放节拍倍率
      * 
@@ -213,6 +278,86 @@ class SoundTouch {
      */
     external fun setPitch(handle: Long, pitch: Float)
 
+    /**
+     * 修改处理参数设置
+     *
+     * @param handle SoundTouch实例句柄
+     * @param settingId 设置项，见 SETTING_* 常量
+     * @param value 设置值
+     * @return 设置成功返回true
+     */
+    external fun setSetting(handle: Long, settingId: Int, value: Int): Boolean
+
+    /**
+     * 读取处理参数设置
+     *
+     * @param handle SoundTouch实例句柄
+     * @param settingId 设置项，见 SETTING_* 常量
+     * @return 设置值
+     */
+    external fun getSetting(handle: Long, settingId: Int): Int
+
+    /**
+     * 加载参数调优配置表
+     *
+     * 配置表由 host 端 tuning_benchmark 在语料上测量生成，记录各内容类型、节拍范围下
+     * 不同时间拉伸参数的CPU耗时和质量分。加载后，SoundTouch 按当前节拍、[SETTING_CONTENT_TYPE]
+     * 和 [SETTING_QUALITY_TARGET] 自动选择达到质量目标的最省CPU参数
+     * （[SETTING_SEQUENCE_MS]、[SETTING_SEEKWINDOW_MS]、[SETTING_OVERLAP_MS]、[SETTING_USE_QUICKSEEK]），
+     * 节拍进入另一个范围时自动切换。
+     *
+     * 请在设置声道数和采样率之后、开始处理之前加载：加载时会按配置中最大的需求预分配缓冲区，
+     * 之后切换参数不再分配内存。
+     *
+     * @param handle SoundTouch实例句柄
+     * @param profile 配置表文本，null或空字符串表示卸载配置并恢复默认参数
+     * @return 加载成功返回true，格式错误返回false（保留原配置）
+     */
+    external fun loadTuningProfile(handle: Long, profile: String?): Boolean
+
+    /**
+     * 低延迟模式下处理一块音频，适合戴耳机实时监听变调后的人声
+     *
+     * 先用 setSetting([SETTING_LOW_LATENCY], 块大小) 开启低延迟模式：缩短时间拉伸的分段、
+     * 查找、重叠窗口和抗混叠滤波器长度，延迟从默认参数的几十毫秒降到十几毫秒。
+     * 每次输入一块、输出同样长度的一块，输出为处理后的音频延迟固定的
+     * [SETTING_LIVE_LATENCY] 帧（开头为静音），改变音调不影响延迟。
+     * 只能改变音调（±1个八度内），速度和速率需保持1.0，否则输出长度会与输入不同，调用返回-1；
+     * 不分配内存，可在音频回调线程中调用。
+     *
+     * @param handle SoundTouch实例句柄
+     * @param input 输入数据，一块即 块大小×声道数 个采样点
+     * @param output 输出缓冲区，至少 块大小×声道数 个采样点
+     * @return 因处理跟不上而补静音的采样点数，正常为0（快速的音调渐变时可能有少量补齐）；出错返回-1
+     */
+    external fun processBlock(handle: Long, input: ShortArray, output: ShortArray): Int
+
+    /**
+     * 关联片段分析缓存，加速同一片段以不同速度反复渲染（如拖动速度滑块时重新渲染）
+     *
+     * 首次调用（缓存未命中）时分析整个片段并按 clipId 缓存到进程内；之后同一片段的每次渲染
+     * 直接复用分析结果，时间拉伸查找重叠位置时先在降采样信号上粗查、再在最佳候选附近精查，
+     * 渲染耗时约为默认全量查找的一半，质量与全量查找基本一致。分析结果与速度和拉伸参数无关，
+     * 一次分析可用于所有速度。
+     *
+     * 调用会清空处理管道，之后请从片段第一帧开始 putSamples；clear 或 flush 之后重新从第一帧开始。
+     * 仅在音调和速率保持不变且速率不小于1.0时生效（即只改速度的渲染），改变音调或速率会自动解除关联。
+     *
+     * @param handle SoundTouch实例句柄
+     * @param clipId 片段标识，片段内容变化时请使用新的标识（如文件路径加编辑版本号），null表示解除关联
+     * @param clip 片段的全部采样数据，null表示只查缓存
+     * @param size 片段长度（以采样点为单位，即 帧数×声道数）
+     * @return 已关联返回true；clip为null且缓存中没有该片段，或速率小于1.0时返回false
+     */
+    external fun setClipAnalysis(handle: Long, clipId: String?, clip: ShortArray?, size: Int): Boolean
+
+    /**
+     * 从片段分析缓存中移除片段（如片段被编辑后），正在使用的实例不受影响
+     *
+     * @param clipId 片段标识，null表示清空整个缓存
+     */
+    external fun removeClipAnalysis(clipId: String?)
+
     /**
      * 设置播放速率倍率
      * 
@@ -0,0 +1,74 @@
+package me.shetj.ndk.soundtouch
+
+/**
+ * 多路SoundTouch批量处理的Kotlin封装类
+ *
+ * 适用于同时处理很多路短音频流的场景（例如多人语音聊天的变声）：
+ * 每路音频仍然是一个独立的[SoundTouch]实例，但一次[process]调用即可完成所有实例的
+ * 输入和输出，内部线程池并行处理，避免每路每次 put/receive 都走一次JNI。
+ *
+ * 输入输出都按实例顺序紧密排列在一个数组中：第 i 路的输入占用 `inputLengths[i]` 个采样点，
+ * 输出区域占用 `outputCapacities[i]` 个采样点，紧接在前一路之后。
+ *
+ * 使用示例：
+ * ```kotlin
+ * val batch = SoundTouchBatch()
+ * val batchHandle = batch.newInstance(0)   // 0=按CPU核数创建线程
+ * val voices = LongArray(n) { soundTouch.newInstance().also { h -> soundTouch.init(h, 1, 48000, 1f, 4f, 1f) } }
+ * val inLen = IntArray(n) { 480 }          // 每路10ms单声道
+ * val outCap = IntArray(n) { 960 }
+ * val outLen = IntArray(n)
+ * batch.process(batchHandle, voices, input, inLen, output, outCap, outLen)
+ * batch.deleteInstance(batchHandle)
+ * ```
+ */
+class SoundTouchBatch {
+
+    companion object {
+        init {
+            System.loadLibrary("soundTouch")
+        }
+    }
+
+    /**
+     * 创建批量处理引擎
+     *
+     * @param numThreads 处理线程数（包括调用[process]的线程），0=按CPU核数
+     * @return 引擎句柄，创建失败返回0，错误信息通过[SoundTouch.getErrorString]获取
+     */
+    external fun newInstance(numThreads: Int): Long
+
+    /**
+     * 删除批量处理引擎，停止内部线程。不会删除传入过的SoundTouch实例
+     *
+     * @param handle 引擎句柄
+     */
+    external fun deleteInstance(handle: Long)
+
+    /**
+     * 一次处理一批SoundTouch实例，所有实例处理完成后返回
+     *
+     * 每个实例先输入自己的采样数据，再接收最多`outputCapacities[i]`个采样点的输出，
+     * 超出的部分保留在实例中，下一次调用时继续输出。同一批中同一实例只能出现一次，
+     * 处理期间不能在其他线程中使用这些实例。
+     *
+     * @param handle 引擎句柄
+     * @param voices SoundTouch实例句柄数组，实例需已完成初始化，不能重复，重复时返回-1
+     * @param input 所有实例的输入采样数据，按实例顺序紧密排列（16位PCM，多声道交错存放）
+     * @param inputLengths 每个实例的输入采样点数，需为声道数的整数倍
+     * @param output 所有实例的输出缓冲区，按实例顺序划分
+     * @param outputCapacities 每个实例的输出区域大小（采样点数），需为声道数的整数倍
+     * @param outputLengths 接收每个实例实际输出的采样点数
+     * @return 所有实例的输出采样点总数，参数错误或处理出错返回-1，
+     *         错误信息通过[SoundTouch.getErrorString]获取，出错时其余实例的输出仍然有效
+     */
+    external fun process(
+        handle: Long,
+        voices: LongArray,
+        input: ShortArray,
+        inputLengths: IntArray,
+        output: ShortArray,
+        outputCapacities: IntArray,
+        outputLengths: IntArray
+    ): Int
+}
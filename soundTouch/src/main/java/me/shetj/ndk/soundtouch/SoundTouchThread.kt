@@ -0,0 +1,146 @@
+package me.shetj.ndk.soundtouch
+
+/**
+ * SoundTouch独立处理线程的Kotlin封装类
+ *
+ * 直接在AudioRecord/AudioTrack线程中调用[SoundTouch.putSamples]/[SoundTouch.receiveSamples]时，
+ * 全部变速变调计算都发生在音频回调里。本类在native层启动一个专用处理线程：
+ * 音频线程只把数据写入无锁输入环形缓冲区、从输出环形缓冲区读取处理结果，
+ * 每次调用只有一次内存拷贝，不会阻塞，因此可以使用计算量更大的设置而不影响音频线程。
+ *
+ * 运行期间不要再直接调用对应SoundTouch实例的方法，调整参数请使用[setTempoAndPitch]。
+ *
+ * 使用示例：
+ * ```kotlin
+ * val rt = SoundTouchThread()
+ * val rtHandle = rt.newInstance(soundTouchHandle, 16384)
+ * rt.start(rtHandle)
+ * // 音频线程中
+ * rt.putSamples(rtHandle, recordBuffer, len)
+ * val n = rt.receiveSamples(rtHandle, playBuffer)   // 不足部分需要补静音
+ * // 结束
+ * rt.stop(rtHandle)
+ * rt.deleteInstance(rtHandle)
+ * ```
+ */
+class SoundTouchThread {
+
+    companion object {
+        init {
+            System.loadLibrary("soundTouch")
+        }
+
+        // getStatistics 返回数组中各项的位置
+        /** 输出欠载次数：首次完整读取后，读取到的数据少于请求量的次数 */
+        const val STAT_UNDERRUNS = 0
+        /** 输入溢出：输入环形缓冲区已满而丢弃的帧数 */
+        const val STAT_OVERFLOWS = 1
+        /** 处理余量：处理线程空闲时间占比，0..1 */
+        const val STAT_HEADROOM = 2
+        /** 任意100ms内处理线程的最高负载，0..1 */
+        const val STAT_PEAK_LOAD = 3
+    }
+
+    /**
+     * 创建处理线程实例（不会立即启动）
+     *
+     * @param soundTouchHandle 已设置声道数和采样率的SoundTouch实例句柄，删除本实例前不能删除
+     * @param ringFrames 输入、输出环形缓冲区的最小容量（帧数），会向上取整为2的幂
+     * @return 实例句柄，创建失败返回0，错误信息通过[SoundTouch.getErrorString]获取
+     */
+    external fun newInstance(soundTouchHandle: Long, ringFrames: Int): Long
+
+    /**
+     * 停止处理线程并删除实例，不会删除SoundTouch实例
+     *
+     * @param handle 实例句柄
+     */
+    external fun deleteInstance(handle: Long)
+
+    /**
+     * 启动处理线程
+     *
+     * @param handle 实例句柄
+     */
+    external fun start(handle: Long)
+
+    /**
+     * 停止处理线程，缓冲区中的数据会保留，可以再次[start]继续处理
+     *
+     * @param handle 实例句柄
+     */
+    external fun stop(handle: Long)
+
+    /**
+     * 获取使处理线程退出的错误信息（例如SoundTouch实例未设置采样率），
+     * 处理线程出错后[putSamples]、[receiveSamples]返回-1，再次[start]会清除错误
+     *
+     * @param handle 实例句柄
+     * @return 错误信息字符串，没有错误时返回空字符串
+     */
+    external fun getErrorString(handle: Long): String
+
+    /**
+     * 写入待处理的音频数据，不会阻塞，适合在音频线程中调用
+     *
+     * 只能在一个线程中调用。输入缓冲区已满时多余数据会被丢弃并计入溢出统计。
+     *
+     * @param handle 实例句柄
+     * @param samples 音频采样数据数组（16位PCM格式，多声道交错存放）
+     * @param len 有效采样数据长度（以采样点为单位）
+     * @return 实际写入的采样点数，参数错误或处理线程已出错退出时返回-1，
+     *         处理线程的错误信息通过[getErrorString]获取
+     */
+    external fun putSamples(handle: Long, samples: ShortArray, len: Int): Int
+
+    /**
+     * 读取处理后的音频数据，不会阻塞，适合在音频线程中调用
+     *
+     * 只能在一个线程中调用。
+     *
+     * @param handle 实例句柄
+     * @param output 接收数据的数组，最多填满整个数组
+     * @return 实际读取的采样点数，处理线程已出错退出时返回-1，错误信息通过[getErrorString]获取
+     */
+    external fun receiveSamples(handle: Long, output: ShortArray): Int
+
+    /**
+     * 获取输出缓冲区中已处理好的采样点数，可用于开始播放前预先缓冲
+     *
+     * @param handle 实例句柄
+     */
+    external fun numSamples(handle: Long): Int
+
+    /**
+     * 在处理线程中平滑调整节拍和音调，参数含义同[SoundTouch.rampTempoAndPitch]，可在任意线程调用
+     *
+     * @param handle 实例句柄
+     * @param tempoChange 节拍变化百分比
+     * @param pitchSemiTones 音调变化半音数
+     * @param rampFrames 过渡帧数，0=立即生效
+     */
+    external fun setTempoAndPitch(handle: Long, tempoChange: Float, pitchSemiTones: Float, rampFrames: Int)
+
+    /**
+     * 请求处理线程在处理完已输入数据后刷新SoundTouch，输出剩余数据（例如音频流结束时）
+     *
+     * @param handle 实例句柄
+     */
+    external fun flush(handle: Long)
+
+    /**
+     * 读取处理统计，各项位置见 STAT_* 常量
+     *
+     * @param handle 实例句柄
+     * @param stats 接收统计值的数组
+     * @return 写入的统计项数量
+     */
+    external fun getStatistics(handle: Long, stats: DoubleArray): Int
+
+    /**
+     * 清零处理统计
+     *
+     * @param handle 实例句柄
+     */
+    external fun resetStatistics(handle: Long)
+}
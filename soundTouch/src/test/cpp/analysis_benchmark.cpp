@@ -0,0 +1,250 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for rendering the same clip repeatedly at different tempos with
+/// the cached clip analysis (SoundTouch::setClipAnalysis): compares the render
+/// time without the analysis (full and quick seek) with a cold cache, where
+/// the render includes analysing the clip, and with a warm cache.
+///
+/// Quality is measured per processing sequence as in seek_benchmark: the
+/// normalized correlation between the overlapped sequences at the chosen
+/// offset, and the share of offsets identical to those of the full seek. Fails
+/// if the analysed seek quality is more than 1% below the full seek, or if cold
+/// & warm renders differ. The render times are only reported, as they depend on
+/// the machine load.
+/// Also fails if, with the clip passed through the rate transposer at rate 1.0
+/// as in SoundTouch, fewer than 98% of the analysed seek offsets of a speech
+/// clip equal those of the full seek, i.e. if the analysis isn't aligned.
+///
+/// Usage: analysis_benchmark [seconds of audio, default 20]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SoundTouch.h"
+#include "TDStretch.h"
+#include "RateTransposer.h"
+#include "StretchAnalysis.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 44100;
+static const int CHANNELS = 2;
+static const int BLOCK = 4096;
+static const char *CLIP_ID = "analysis_benchmark";
+static const char *SPEECH_ID = "analysis_benchmark speech";
+
+enum Mode { MODE_FULL, MODE_QUICK, MODE_COLD, MODE_WARM, NUM_MODES };
+
+
+/// TDStretch that runs the full, quick and analysed seeks on each sequence and
+/// records how well the chosen offsets match. The stream proceeds with the full
+/// seek result.
+class AnalysisProbe : public TDStretch
+{
+public:
+    int numSeeks;
+    int numSame[NUM_MODES];
+    double sumMatch[NUM_MODES];
+
+    AnalysisProbe()
+    {
+        numSeeks = 0;
+        for (int m = 0; m < NUM_MODES; m ++)
+        {
+            numSame[m] = 0;
+            sumMatch[m] = 0;
+        }
+    }
+
+    /// normalized correlation between 'pMidBuffer' and 'refPos' at offset 'offs'
+    double match(const SAMPLETYPE *refPos, int offs) const
+    {
+        const SAMPLETYPE *pos = refPos + channels * offs;
+        double corr = 0, n1 = 0, n2 = 0;
+        for (int i = 0; i < channels * overlapLength; i ++)
+        {
+            corr += (double)pos[i] * pMidBuffer[i];
+            n1 += (double)pos[i] * pos[i];
+            n2 += (double)pMidBuffer[i] * pMidBuffer[i];
+        }
+        return (n1 * n2 > 0) ? corr / sqrt(n1 * n2) : 0;
+    }
+
+    int seekBestOverlapPosition(const SAMPLETYPE *refPos)
+    {
+        int offs[NUM_MODES];
+
+        offs[MODE_FULL] = seekBestOverlapPositionFull(refPos);
+        offs[MODE_QUICK] = seekBestOverlapPositionQuick(refPos);
+        // the analysed seek where the analysis covers the seek range
+        offs[MODE_WARM] = TDStretch::seekBestOverlapPosition(refPos);
+
+        numSeeks ++;
+        for (int m = 0; m < NUM_MODES; m ++)
+        {
+            if (m == MODE_COLD) continue;
+            if (offs[m] == offs[MODE_FULL]) numSame[m] ++;
+            sumMatch[m] += match(refPos, offs[m]);
+        }
+        return offs[MODE_FULL];
+    }
+};
+
+
+// Renders the whole clip at 'tempo', returns the time including the analysis
+static double render(SoundTouch &st, Mode mode, double tempo, const std::vector<SAMPLETYPE> &clip,
+                     std::vector<SAMPLETYPE> &output)
+{
+    const int numFrames = (int)(clip.size() / CHANNELS);
+    uint received = 0;
+
+    st.setTempo(tempo);
+    st.setSetting(SETTING_USE_QUICKSEEK, mode == MODE_QUICK);
+    output.resize((size_t)(numFrames / tempo + 4 * BLOCK) * CHANNELS);
+
+    double t0 = bench::now();
+    if ((mode == MODE_COLD) || (mode == MODE_WARM))
+    {
+        if (!st.setClipAnalysis(CLIP_ID, &clip[0], numFrames))
+        {
+            fprintf(stderr, "analysis_benchmark: setClipAnalysis failed\n");
+            exit(1);
+        }
+    }
+    else
+    {
+        st.setClipAnalysis(NULL, NULL, 0);
+    }
+
+    for (int pos = 0; pos < numFrames; pos += BLOCK)
+    {
+        int n = (numFrames - pos < BLOCK) ? numFrames - pos : BLOCK;
+        st.putSamples(&clip[(size_t)pos * CHANNELS], n);
+        received += st.receiveSamples(&output[(size_t)received * CHANNELS], (uint)(output.size() / CHANNELS) - received);
+    }
+    st.flush();
+    received += st.receiveSamples(&output[(size_t)received * CHANNELS], (uint)(output.size() / CHANNELS) - received);
+    double elapsed = bench::now() - t0;
+
+    output.resize((size_t)received * CHANNELS);
+    return elapsed;
+}
+
+
+// Runs the seek algorithms side by side on the clip at 'tempo'. With
+// 'transposed' the clip goes through a rate transposer at rate 1.0 first, as in
+// SoundTouch at rate 1.0, so the analysis must still line up with the input.
+static void probe(AnalysisProbe &probe, double tempo, const char *clipId, const std::vector<SAMPLETYPE> &clip,
+                  bool transposed)
+{
+    const int numFrames = (int)(clip.size() / CHANNELS);
+    std::shared_ptr<const StretchAnalysis> analysis =
+        StretchAnalysisCache::get(clipId, &clip[0], (uint)numFrames, CHANNELS);
+    RateTransposer transposer;
+
+    transposer.setChannels(CHANNELS);
+    transposer.setRate(1.0);
+    transposer.clear();
+    probe.setChannels(CHANNELS);
+    probe.setParameters(SAMPLE_RATE);
+    probe.setTempo(tempo);
+    probe.clear();
+    probe.setAnalysis(analysis.get());
+    for (int pos = 0; pos < numFrames; pos += BLOCK)
+    {
+        int n = (numFrames - pos < BLOCK) ? numFrames - pos : BLOCK;
+        if (transposed)
+        {
+            transposer.putSamples(&clip[(size_t)pos * CHANNELS], n);
+            probe.moveSamples(transposer);
+        }
+        else
+        {
+            probe.putSamples(&clip[(size_t)pos * CHANNELS], n);
+        }
+        probe.receiveSamples(probe.numSamples());
+    }
+    probe.setAnalysis(NULL);
+}
+
+
+int main(int argc, char **argv)
+{
+    static const double tempos[] = { 0.5, 0.8, 0.9, 1.1, 1.25, 1.5, 2.0 };
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    bool ok = true;
+    std::vector<SAMPLETYPE> clip = bench::makeMusic(SAMPLE_RATE, CHANNELS, seconds);
+    std::vector<SAMPLETYPE> output[NUM_MODES];
+
+    // analysis cost alone
+    StretchAnalysisCache::clear();
+    double t0 = bench::now();
+    StretchAnalysisCache::get(CLIP_ID, &clip[0], (uint)(clip.size() / CHANNELS), CHANNELS);
+    double analysisTime = bench::now() - t0;
+
+    printf("analysis_benchmark [%s]: %.1f s stereo music at %d Hz\n", bench::simdName(), seconds, SAMPLE_RATE);
+    printf("analysis: %.2f ms, %.1f kB\n", 1000.0 * analysisTime, StretchAnalysisCache::getSize() / 1024.0);
+    printf("%6s %9s %9s %9s %9s %8s %11s %12s %12s\n", "tempo", "full ms", "quick ms", "cold ms", "warm ms",
+           "speedup", "full match", "quick match", "warm match");
+
+    SoundTouch st;
+    st.setChannels(CHANNELS);
+    st.setSampleRate(SAMPLE_RATE);
+
+    for (size_t t = 0; t < sizeof(tempos) / sizeof(tempos[0]); t ++)
+    {
+        double elapsed[NUM_MODES];
+
+        for (int mode = 0; mode < NUM_MODES; mode ++)
+        {
+            if (mode == MODE_COLD) StretchAnalysisCache::clear();
+            elapsed[mode] = render(st, (Mode)mode, tempos[t], clip, output[mode]);
+        }
+
+        AnalysisProbe quality;
+        probe(quality, tempos[t], CLIP_ID, clip, false);
+        double fullMatch = quality.sumMatch[MODE_FULL] / quality.numSeeks;
+        double quickMatch = quality.sumMatch[MODE_QUICK] / quality.numSeeks;
+        double warmMatch = quality.sumMatch[MODE_WARM] / quality.numSeeks;
+
+        printf("%6.2f %9.2f %9.2f %9.2f %9.2f %7.1fx %11.4f %6.4f %4.0f%% %6.4f %4.0f%%\n", tempos[t],
+               1000.0 * elapsed[MODE_FULL], 1000.0 * elapsed[MODE_QUICK], 1000.0 * elapsed[MODE_COLD],
+               1000.0 * elapsed[MODE_WARM], elapsed[MODE_FULL] / elapsed[MODE_WARM], fullMatch,
+               quickMatch, 100.0 * quality.numSame[MODE_QUICK] / quality.numSeeks,
+               warmMatch, 100.0 * quality.numSame[MODE_WARM] / quality.numSeeks);
+
+        if ((warmMatch < 0.99 * fullMatch) || (output[MODE_COLD] != output[MODE_WARM]))
+        {
+            fprintf(stderr, "analysis_benchmark: tempo %.2f: analysed render worse than expected\n",
+                    tempos[t]);
+            ok = false;
+        }
+    }
+
+    // At rate 1.0 SoundTouch runs the rate transposer before the tempo changer.
+    // A speech clip, unlike the stationary music, makes the analysed seek miss
+    // the full seek offsets if the analysis is shifted from the input by even
+    // a few frames.
+    std::vector<SAMPLETYPE> speech = bench::makeSpeech(SAMPLE_RATE, CHANNELS, seconds);
+    int numSeeks = 0, numSame = 0;
+    for (size_t t = 0; t < sizeof(tempos) / sizeof(tempos[0]); t ++)
+    {
+        AnalysisProbe aligned;
+        probe(aligned, tempos[t], SPEECH_ID, speech, true);
+        numSeeks += aligned.numSeeks;
+        numSame += aligned.numSame[MODE_WARM];
+    }
+    printf("rate 1.0 speech: %.1f%% of analysed offsets equal to the full seek\n", 100.0 * numSame / numSeeks);
+    if (numSame < 0.98 * numSeeks)
+    {
+        fprintf(stderr, "analysis_benchmark: analysis not aligned with the tempo changer input at rate 1.0\n");
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for parameter automation: simulates an audio callback processing
+/// 256-frame blocks while a UI slider sweeps pitch and tempo at 60 Hz, and
+/// measures the callback processing time and heap allocations.
+///
+/// Compares setting the parameters directly at every UI update with ramping
+/// them with rampTempoAndPitch(), and ramping them with the FFT seek enabled.
+/// Fails if processing allocates memory in any mode.
+///
+/// Usage: automation_benchmark [seconds of audio per case, default 60]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <new>
+
+#include "SoundTouch.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 48000;
+static const int CHANNELS = 2;
+static const int BLOCK_FRAMES = 256;
+static const int UI_RATE = 60;
+static const double SWEEP_SECONDS = 4.0;
+
+// count heap allocations of the whole process, including the SoundTouch core
+static unsigned long numAllocs = 0;
+
+void *operator new(size_t size)
+{
+    numAllocs ++;
+    void *p = malloc(size ? size : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 60.0;
+    if (seconds < 2 * SWEEP_SECONDS) seconds = 2 * SWEEP_SECONDS;
+
+    bool ok = true;
+    std::vector<SAMPLETYPE> input = bench::makeMusic(SAMPLE_RATE, CHANNELS, seconds);
+    int numFrames = (int)(input.size() / CHANNELS);
+    std::vector<SAMPLETYPE> out(16 * BLOCK_FRAMES * CHANNELS);
+    const int uiFrames = SAMPLE_RATE / UI_RATE;
+    const int warmupFrames = (int)(SWEEP_SECONDS * SAMPLE_RATE);
+
+    printf("automation_benchmark [%s]: %.1f s stereo audio at %d Hz, %d-frame callbacks (%.2f ms), "
+           "pitch +-12 st & tempo 0.5..2.0 sweep, %d Hz UI updates\n",
+           bench::simdName(), seconds, SAMPLE_RATE, BLOCK_FRAMES,
+           1000.0 * BLOCK_FRAMES / SAMPLE_RATE, UI_RATE);
+    printf("%-9s %10s %10s %10s %10s %14s\n", "mode", "mean us", "p99 us", "max us", "allocs", "after warmup");
+
+    static const char *modeNames[] = { "direct", "ramp", "ramp fft" };
+    for (int mode = 0; mode < 3; mode ++)
+    {
+        const bool ramp = (mode > 0);
+        std::vector<double> times;
+        unsigned long allocsStart, allocsWarm = 0;
+
+        times.reserve(numFrames / BLOCK_FRAMES + 1);
+
+        SoundTouch st;
+        st.setChannels(CHANNELS);
+        st.setSampleRate(SAMPLE_RATE);
+        st.setSetting(SETTING_USE_FFTSEEK, mode == 2);
+
+        allocsStart = numAllocs;
+        int nextUi = 0;
+        for (int pos = 0; pos + BLOCK_FRAMES <= numFrames; pos += BLOCK_FRAMES)
+        {
+            if (pos == warmupFrames) allocsWarm = numAllocs;
+
+            double t0 = bench::now();
+            if (pos >= nextUi)
+            {
+                // slider position follows a sine sweep
+                double phase = sin(2 * M_PI * pos / (SWEEP_SECONDS * SAMPLE_RATE));
+                double semitones = 12.0 * phase;
+                double tempo = pow(2.0, phase);
+                if (ramp)
+                {
+                    st.rampTempoAndPitch(tempo, pow(2.0, semitones / 12.0), uiFrames);
+                }
+                else
+                {
+                    st.setTempo(tempo);
+                    st.setPitchSemiTones(semitones);
+                }
+                nextUi += uiFrames;
+            }
+            st.putSamples(&input[(size_t)pos * CHANNELS], BLOCK_FRAMES);
+            while (st.receiveSamples(&out[0], (uint)(out.size() / CHANNELS)) > 0) {}
+            times.push_back(bench::now() - t0);
+        }
+        unsigned long allocs = numAllocs - allocsStart;
+        unsigned long allocsAfterWarmup = numAllocs - allocsWarm;
+
+        double sum = 0;
+        for (size_t i = 0; i < times.size(); i ++) sum += times[i];
+        std::sort(times.begin(), times.end());
+        double p99 = times[(size_t)(0.99 * (times.size() - 1))];
+
+        printf("%-9s %10.1f %10.1f %10.1f %10lu %14lu\n", modeNames[mode],
+               1e6 * sum / times.size(), 1e6 * p99, 1e6 * times.back(), allocs, allocsAfterWarmup);
+
+        if (allocs > 0)
+        {
+            fprintf(stderr, "automation_benchmark: %lu allocations during %s sweep\n",
+                    allocs, modeNames[mode]);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for SoundTouchBatch: processes 1 to 64 independent mono voice
+/// streams in 10 ms blocks, once by calling each SoundTouch instance in turn
+/// on one thread and once with one SoundTouchBatch::process() call per block.
+/// Reports total throughput and the 99th percentile latency of a block.
+///
+/// Fails if the batched output of any voice differs from the sequential one.
+///
+/// Usage: batch_benchmark [seconds of audio per voice, default 10] [threads, default CPU cores]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "SoundTouch.h"
+#include "SoundTouchBatch.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 48000;
+static const int BLOCK_FRAMES = SAMPLE_RATE / 100;
+static const int OUTPUT_CAPACITY = 2 * BLOCK_FRAMES;
+static const uint STREAMS[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+
+/// Voices of one test run, each with its own pitch shift
+struct Voices
+{
+    std::vector<SoundTouch *> st;
+    std::vector<unsigned long long> checksum;
+
+    Voices(uint num)
+    {
+        for (uint i = 0; i < num; i ++)
+        {
+            SoundTouch *v = new SoundTouch();
+            v->setChannels(1);
+            v->setSampleRate(SAMPLE_RATE);
+            v->setPitchSemiTones(-6.0 + (double)(i % 13));
+            st.push_back(v);
+            checksum.push_back(0);
+        }
+    }
+
+    ~Voices()
+    {
+        for (size_t i = 0; i < st.size(); i ++) delete st[i];
+    }
+
+    void addOutput(uint i, const SAMPLETYPE *p, uint n)
+    {
+        for (uint k = 0; k < n; k ++)
+        {
+            checksum[i] = checksum[i] * 1099511628211ULL + (unsigned long long)(long long)(p[k] * 1024);
+        }
+    }
+};
+
+
+static double percentile99(std::vector<double> &times)
+{
+    std::sort(times.begin(), times.end());
+    return times[(size_t)(0.99 * (times.size() - 1))];
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    if (seconds <= 0) seconds = 10.0;
+    int threads = (argc > 2) ? atoi(argv[2]) : 0;
+
+    bool ok = true;
+    std::vector<SAMPLETYPE> music = bench::makeMusic(SAMPLE_RATE, 1, seconds + 1.0);
+    int numBlocks = (int)(seconds * SAMPLE_RATE) / BLOCK_FRAMES;
+    SoundTouchBatch batch(threads);
+
+    printf("batch_benchmark [%s]: %.1f s mono audio per voice at %d Hz, 10 ms blocks, %d threads\n",
+           bench::simdName(), seconds, SAMPLE_RATE, batch.numThreads());
+    printf("%7s %14s %12s %14s %12s %8s\n",
+           "streams", "seq x rt", "seq p99 ms", "batch x rt", "batch p99 ms", "speedup");
+
+    for (size_t si = 0; si < sizeof(STREAMS) / sizeof(STREAMS[0]); si ++)
+    {
+        uint num = STREAMS[si];
+        Voices seq(num), bat(num);
+        std::vector<SAMPLETYPE> input((size_t)num * BLOCK_FRAMES);
+        std::vector<SAMPLETYPE> output((size_t)num * OUTPUT_CAPACITY);
+        std::vector<uint> inFrames(num, BLOCK_FRAMES), outCapacity(num, OUTPUT_CAPACITY), outFrames(num);
+        std::vector<double> seqTimes, batchTimes;
+        double seqTotal = 0, batchTotal = 0;
+
+        for (int b = 0; b < numBlocks; b ++)
+        {
+            // each voice reads the test signal at a different offset
+            for (uint i = 0; i < num; i ++)
+            {
+                size_t start = ((size_t)b * BLOCK_FRAMES + i * 997) % (music.size() - BLOCK_FRAMES);
+                std::copy(&music[start], &music[start] + BLOCK_FRAMES, &input[(size_t)i * BLOCK_FRAMES]);
+            }
+
+            double t0 = bench::now();
+            for (uint i = 0; i < num; i ++)
+            {
+                SAMPLETYPE *out = &output[(size_t)i * OUTPUT_CAPACITY];
+                seq.st[i]->putSamples(&input[(size_t)i * BLOCK_FRAMES], BLOCK_FRAMES);
+                outFrames[i] = seq.st[i]->receiveSamples(out, OUTPUT_CAPACITY);
+            }
+            double t1 = bench::now();
+            for (uint i = 0; i < num; i ++)
+            {
+                seq.addOutput(i, &output[(size_t)i * OUTPUT_CAPACITY], outFrames[i]);
+            }
+
+            double t2 = bench::now();
+            batch.process(&bat.st[0], num, &input[0], &inFrames[0], &output[0], &outCapacity[0], &outFrames[0]);
+            double t3 = bench::now();
+            for (uint i = 0; i < num; i ++)
+            {
+                bat.addOutput(i, &output[(size_t)i * OUTPUT_CAPACITY], outFrames[i]);
+            }
+
+            seqTimes.push_back(t1 - t0);
+            batchTimes.push_back(t3 - t2);
+            seqTotal += t1 - t0;
+            batchTotal += t3 - t2;
+        }
+
+        double audio = (double)num * numBlocks * BLOCK_FRAMES / SAMPLE_RATE;
+        printf("%7u %14.1f %12.3f %14.1f %12.3f %7.2fx\n", num,
+               audio / seqTotal, 1000.0 * percentile99(seqTimes),
+               audio / batchTotal, 1000.0 * percentile99(batchTimes), seqTotal / batchTotal);
+
+        for (uint i = 0; i < num; i ++)
+        {
+            if (seq.checksum[i] != bat.checksum[i])
+            {
+                fprintf(stderr, "batch_benchmark: %u streams: output of voice %u differs\n", num, i);
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Helpers shared by the host-side SoundTouch benchmarks: wall clock timer,
+/// test signal generators and the name of the active SIMD code path.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "STTypes.h"
+#include "STSimd.h"
+
+namespace bench
+{
+
+using soundtouch::SAMPLETYPE;
+
+/// Seconds elapsed since an arbitrary fixed point
+inline double now()
+{
+    using namespace std::chrono;
+    return duration_cast<duration<double> >(steady_clock::now().time_since_epoch()).count();
+}
+
+
+/// Name of the SIMD path compiled into the SoundTouch core
+inline const char *simdName()
+{
+#if ST_SIMD_NEON
+    return "neon";
+#elif ST_SIMD_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+
+/// Converts a value in range [-1, 1] to the sample type
+inline SAMPLETYPE toSample(double v)
+{
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    if (v > 1.0) v = 1.0;
+    if (v < -1.0) v = -1.0;
+    return (SAMPLETYPE)(v * 32767.0);
+#else
+    return (SAMPLETYPE)v;
+#endif
+}
+
+
+/// Deterministic pseudo-random value in range [-1, 1]
+inline double noise(unsigned int &seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (double)(seed >> 8) / (double)(1 << 23) - 1.0;
+}
+
+
+/// Generates interleaved drum-like track: decaying low-frequency kicks at 'bpm'
+/// beat rate with a little noise on top.
+inline std::vector<SAMPLETYPE> makeClickTrack(int sampleRate, int channels, double seconds, double bpm)
+{
+    const int numFrames = (int)(seconds * sampleRate);
+    const int beatLen = (int)(60.0 * sampleRate / bpm);
+    std::vector<SAMPLETYPE> data((size_t)numFrames * channels);
+    unsigned int seed = 12345;
+
+    for (int i = 0; i < numFrames; i ++)
+    {
+        double t = (double)(i % beatLen) / sampleRate;
+        double v = 0.8 * exp(-t / 0.08) * sin(2 * M_PI * 60.0 * t) + 0.05 * noise(seed);
+        for (int c = 0; c < channels; c ++)
+        {
+            data[(size_t)i * channels + c] = toSample(v);
+        }
+    }
+    return data;
+}
+
+
+/// Generates interleaved music-like test signal: a few harmonic tones with
+/// slow amplitude modulation plus a little noise, each channel slightly detuned.
+inline std::vector<SAMPLETYPE> makeMusic(int sampleRate, int channels, double seconds)
+{
+    const int numFrames = (int)(seconds * sampleRate);
+    std::vector<SAMPLETYPE> data((size_t)numFrames * channels);
+    unsigned int seed = 4711;
+
+    for (int i = 0; i < numFrames; i ++)
+    {
+        double t = (double)i / sampleRate;
+        double am = 0.5 + 0.5 * sin(2 * M_PI * 2.0 * t);
+        for (int c = 0; c < channels; c ++)
+        {
+            double f = 196.0 * (1.0 + 0.01 * c);
+            double v = 0.3 * sin(2 * M_PI * f * t)
+                     + 0.15 * am * sin(2 * M_PI * 2.5 * f * t)
+                     + 0.1 * sin(2 * M_PI * 3.0 * f * t)
+                     + 0.1 * noise(seed);
+            data[(size_t)i * channels + c] = toSample(v);
+        }
+    }
+    return data;
+}
+
+
+/// Generates interleaved speech-like test signal: a glottal pulse train with a
+/// gliding pitch around 'f0' Hz through two formant resonators that move
+/// between vowels, in syllables of 200 ms with short pauses between words.
+inline std::vector<SAMPLETYPE> makeSpeech(int sampleRate, int channels, double seconds, double f0 = 120.0)
+{
+    // formant frequencies (F1, F2) of the vowels /a/, /i/, /u/, /e/, /o/
+    static const double formants[5][2] = { { 730, 1090 }, { 270, 2290 }, { 300, 870 }, { 530, 1840 }, { 570, 840 } };
+    const int numFrames = (int)(seconds * sampleRate);
+    std::vector<SAMPLETYPE> data((size_t)numFrames * channels);
+    unsigned int seed = 8191;
+    double phase = 0, y1[2] = { 0, 0 }, y2[2] = { 0, 0 };
+
+    for (int i = 0; i < numFrames; i ++)
+    {
+        double t = (double)i / sampleRate;
+        int syllable = (int)(t / 0.2);
+        double st = t - 0.2 * syllable;
+        // every fourth syllable is a pause, the others rise and decay
+        double env = (syllable % 4 == 3) ? 0.0 : sin(M_PI * st / 0.2);
+        double f = f0 * (1.0 + 0.15 * sin(2 * M_PI * 0.7 * t) - 0.3 * st);
+        double excitation;
+
+        phase += f / sampleRate;
+        if (phase >= 1.0)
+        {
+            phase -= 1.0;
+            excitation = 1.0;
+        }
+        else
+        {
+            excitation = 0.0;
+        }
+        excitation += 0.02 * noise(seed);
+
+        // two-pole resonators at the formants of the current vowel
+        const double *fm = formants[syllable % 5];
+        double v = 0;
+        for (int k = 0; k < 2; k ++)
+        {
+            double r = exp(-M_PI * 80.0 / sampleRate);
+            double y = excitation + 2 * r * cos(2 * M_PI * fm[k] / sampleRate) * y1[k] - r * r * y2[k];
+            y2[k] = y1[k];
+            y1[k] = y;
+            v += y;
+        }
+        v *= 0.02 * env;
+        for (int c = 0; c < channels; c ++)
+        {
+            data[(size_t)i * channels + c] = toSample(v);
+        }
+    }
+    return data;
+}
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for BPMDetect as used in batch analysis: analyzes a set of
+/// synthetic click tracks at different tempos one after another and reports
+/// the throughput in minutes of audio analyzed per CPU second, along with the
+/// analysis time per minute of audio. Fails if a detected tempo is off by more
+/// than 1 BPM, or if BPMDetect accepts an illegal number of channels.
+///
+/// Usage: bpm_benchmark [minutes of audio per track, default 3]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <stdexcept>
+
+#include "BPMDetect.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 44100;
+static const int CHANNELS = 2;
+static const double TRACK_BPM[] = { 90.0, 120.0, 128.0, 140.0 };
+static const int NUM_TRACKS = (int)(sizeof(TRACK_BPM) / sizeof(TRACK_BPM[0]));
+
+// feed the detector in chunks as a streaming client would
+static const int CHUNK_FRAMES = 4096;
+
+int main(int argc, char **argv)
+{
+    double minutes = (argc > 1) ? atof(argv[1]) : 3.0;
+    if (minutes <= 0) minutes = 3.0;
+
+    std::vector<SAMPLETYPE> tracks[NUM_TRACKS];
+    for (int t = 0; t < NUM_TRACKS; t ++)
+    {
+        tracks[t] = bench::makeClickTrack(SAMPLE_RATE, CHANNELS, 60.0 * minutes, TRACK_BPM[t]);
+    }
+
+    printf("bpm_benchmark [%s]: %d tracks of %.1f min audio\n", bench::simdName(), NUM_TRACKS, minutes);
+
+    bool ok = true;
+    double elapsed = 0;
+    clock_t cpuStart = clock();
+
+    for (int t = 0; t < NUM_TRACKS; t ++)
+    {
+        const std::vector<SAMPLETYPE> &track = tracks[t];
+        int numFrames = (int)(track.size() / CHANNELS);
+        double start = bench::now();
+
+        BPMDetect bpm(CHANNELS, SAMPLE_RATE);
+        for (int pos = 0; pos < numFrames; pos += CHUNK_FRAMES)
+        {
+            int n = (numFrames - pos < CHUNK_FRAMES) ? numFrames - pos : CHUNK_FRAMES;
+            bpm.inputSamples(&track[(size_t)pos * CHANNELS], n);
+        }
+        float result = bpm.getBpm();
+        int numBeats = bpm.getBeats(NULL, NULL, 0);
+
+        double trackTime = bench::now() - start;
+        elapsed += trackTime;
+
+        printf("  %5.1f BPM track: bpm %.2f, %d beats, %.2f ms per minute of audio\n",
+               TRACK_BPM[t], result, numBeats, 1000.0 * trackTime / minutes);
+
+        if (fabs(result - TRACK_BPM[t]) > 1.0)
+        {
+            fprintf(stderr, "bpm_benchmark: detected %.2f BPM, expected %.0f\n", result, TRACK_BPM[t]);
+            ok = false;
+        }
+    }
+
+    double cpuTime = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+    printf("total: %.2f ms per minute of audio, %.1f minutes of audio per CPU second\n",
+           1000.0 * elapsed / (NUM_TRACKS * minutes), NUM_TRACKS * minutes / cpuTime);
+
+    // the channel count comes unchecked from the java side
+    static const int badChannels[] = { 0, -1, SOUNDTOUCH_MAX_CHANNELS + 1 };
+    for (size_t c = 0; c < sizeof(badChannels) / sizeof(badChannels[0]); c ++)
+    {
+        bool refused = true;
+        try
+        {
+            BPMDetect bpm(badChannels[c], SAMPLE_RATE);
+            refused = false;
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+        if (!refused)
+        {
+            fprintf(stderr, "bpm_benchmark: BPMDetect accepted %d channels\n", badChannels[c]);
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,329 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Regression suite and benchmark of the SoundTouch core: TDStretch at a slower
+/// and a faster tempo, RateTransposer with each interpolation algorithm,
+/// AAFilter and FIRFilter, each for 1, 2 and 6 channels.
+///
+/// For each case reports the cost per sample and channel, and a checksum of
+/// the output for a fixed 2 second test signal. The results can be written as
+/// JSON, and compared against golden results written by a known good build of
+/// the same variant (sample type & SIMD path): the golden directory holds
+/// core_<samples>_<simd>.json files. Fails if a checksum differs from the
+/// golden one; variants without a golden file are only reported.
+///
+/// Usage: core_benchmark [seconds of audio per case, default 10]
+///                       [--json results.json] [--golden directory]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#include "TDStretch.h"
+#include "RateTransposer.h"
+#include "AAFilter.h"
+#include "FIRFilter.h"
+#include "FIFOSampleBuffer.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 44100;
+static const int CHANNELS[] = { 1, 2, 6 };
+static const int NUM_CH = sizeof(CHANNELS) / sizeof(CHANNELS[0]);
+static const int BLOCK_FRAMES = 4096;
+static const double GOLDEN_SECONDS = 2.0;
+static const double RATE = 1.1225;
+static const int FIR_LENGTH = 32;
+
+enum Kernel
+{
+    TDSTRETCH_SLOW, TDSTRETCH_FAST, RATE_LINEAR, RATE_CUBIC, RATE_SHANNON,
+    AA_FILTER, FIR_FILTER, NUM_KERNELS
+};
+
+static const char *kernelNames[NUM_KERNELS] =
+{
+    "tdstretch-0.80", "tdstretch-1.25", "rate-linear", "rate-cubic", "rate-shannon",
+    "aafilter", "firfilter"
+};
+
+struct Result
+{
+    Kernel kernel;
+    int channels;
+    double ns;
+    unsigned long frames;
+    unsigned long long checksum;
+};
+
+
+/// 64-bit FNV-1a hash of the output samples
+static unsigned long long checksum(const std::vector<SAMPLETYPE> &data)
+{
+    const unsigned char *bytes = (const unsigned char *)(data.empty() ? NULL : &data[0]);
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < data.size() * sizeof(SAMPLETYPE); i ++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+/// Band-pass coefficients for FIRFilter, scaled by 2^14
+static void firCoefficients(SAMPLETYPE *coeffs)
+{
+    for (int i = 0; i < FIR_LENGTH; i ++)
+    {
+        double t = i - (FIR_LENGTH - 1) / 2.0;
+        double window = 0.54 - 0.46 * cos(2 * M_PI * i / (FIR_LENGTH - 1));
+        double h = (0.4 * sin(0.4 * M_PI * t) - 0.1 * sin(0.1 * M_PI * t)) / (M_PI * t * 0.5) * window;
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+        coeffs[i] = (SAMPLETYPE)floor(h * 16384.0 * 0.5 + 0.5);
+#else
+        coeffs[i] = (SAMPLETYPE)(h * 16384.0 * 0.5);
+#endif
+    }
+}
+
+
+/// Moves all samples of 'pipe' to the end of 'out'
+static void drain(FIFOSamplePipe &pipe, std::vector<SAMPLETYPE> &out, int ch)
+{
+    uint n = pipe.numSamples();
+    if (n == 0) return;
+    size_t pos = out.size();
+    out.resize(pos + (size_t)n * ch);
+    pipe.receiveSamples(&out[pos], n);
+}
+
+
+/// Runs 'kernel' over 'input' of 'ch' channels in blocks, collects the output
+/// in 'out' and returns the processing time
+static double run(Kernel kernel, int ch, const std::vector<SAMPLETYPE> &input, std::vector<SAMPLETYPE> &out)
+{
+    const uint numFrames = (uint)(input.size() / ch);
+    double start, elapsed;
+
+    out.clear();
+    out.reserve(input.size() * 2);
+
+    if ((kernel == TDSTRETCH_SLOW) || (kernel == TDSTRETCH_FAST))
+    {
+        TDStretch *stretch = TDStretch::newInstance();
+        stretch->setChannels(ch);
+        stretch->setParameters(SAMPLE_RATE);
+        stretch->setTempo((kernel == TDSTRETCH_SLOW) ? 0.8 : 1.25);
+
+        start = bench::now();
+        for (uint pos = 0; pos < numFrames; pos += BLOCK_FRAMES)
+        {
+            uint n = (numFrames - pos < (uint)BLOCK_FRAMES) ? numFrames - pos : BLOCK_FRAMES;
+            stretch->putSamples(&input[(size_t)pos * ch], n);
+            drain(*stretch, out, ch);
+        }
+        elapsed = bench::now() - start;
+        delete stretch;
+    }
+    else if (kernel <= RATE_SHANNON)
+    {
+        RateTransposer transposer;
+        transposer.setAlgorithm((TransposerBase::ALGORITHM)(kernel - RATE_LINEAR));
+        transposer.setChannels(ch);
+        transposer.setRate(RATE);
+
+        start = bench::now();
+        for (uint pos = 0; pos < numFrames; pos += BLOCK_FRAMES)
+        {
+            uint n = (numFrames - pos < (uint)BLOCK_FRAMES) ? numFrames - pos : BLOCK_FRAMES;
+            transposer.putSamples(&input[(size_t)pos * ch], n);
+            drain(transposer, out, ch);
+        }
+        elapsed = bench::now() - start;
+    }
+    else
+    {
+        // both filters output 'length' frames less than their input, so the
+        // blocks overlap by the filter length
+        AAFilter aa(64);
+        FIRFilter *fir = FIRFilter::newInstance();
+        SAMPLETYPE coeffs[FIR_LENGTH];
+        const uint length = (kernel == AA_FILTER) ? 64 : FIR_LENGTH;
+
+        aa.setCutoffFreq(0.5 / RATE);
+        firCoefficients(coeffs);
+        fir->setCoefficients(coeffs, FIR_LENGTH, 14);
+        out.resize(input.size());
+
+        uint numOut = 0;
+        start = bench::now();
+        for (uint pos = 0; pos + length < numFrames; pos += BLOCK_FRAMES - length)
+        {
+            uint n = (numFrames - pos < (uint)BLOCK_FRAMES) ? numFrames - pos : BLOCK_FRAMES;
+            if (kernel == AA_FILTER)
+            {
+                numOut += aa.evaluate(&out[(size_t)numOut * ch], &input[(size_t)pos * ch], n, ch);
+            }
+            else
+            {
+                numOut += fir->evaluate(&out[(size_t)numOut * ch], &input[(size_t)pos * ch], n, ch);
+            }
+        }
+        elapsed = bench::now() - start;
+        out.resize((size_t)numOut * ch);
+        delete fir;
+    }
+    return elapsed;
+}
+
+
+static std::string variantName()
+{
+    return std::string("core_") + ((sizeof(SAMPLETYPE) == 2) ? "int16" : "float") + "_" + bench::simdName();
+}
+
+
+static bool writeJson(const char *path, double seconds, const std::vector<Result> &results)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) return false;
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"variant\": \"%s\",\n", variantName().c_str());
+    fprintf(f, "  \"seconds\": %.1f,\n", seconds);
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i ++)
+    {
+        const Result &r = results[i];
+        // one result per line, read back by readGolden()
+        fprintf(f, "    {\"kernel\": \"%s\", \"channels\": %d, \"ns_per_sample\": %.3f, "
+                   "\"frames\": %lu, \"checksum\": \"%016llx\"}%s\n",
+                kernelNames[r.kernel], r.channels, r.ns, r.frames, r.checksum,
+                (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+
+/// Reads the checksums of a JSON file written by writeJson(). Returns false if
+/// the file doesn't exist.
+static bool readGolden(const char *path, std::vector<Result> &golden)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return false;
+
+    char line[512];
+    while (fgets(line, sizeof(line), f))
+    {
+        const char *k = strstr(line, "\"kernel\": \"");
+        const char *c = strstr(line, "\"channels\": ");
+        const char *s = strstr(line, "\"checksum\": \"");
+        if (!k || !c || !s) continue;
+
+        Result r;
+        k += strlen("\"kernel\": \"");
+        for (r.kernel = (Kernel)0; r.kernel < NUM_KERNELS; r.kernel = (Kernel)(r.kernel + 1))
+        {
+            size_t len = strlen(kernelNames[r.kernel]);
+            if ((strncmp(k, kernelNames[r.kernel], len) == 0) && (k[len] == '"')) break;
+        }
+        if (r.kernel == NUM_KERNELS) continue;
+        r.channels = atoi(c + strlen("\"channels\": "));
+        r.checksum = strtoull(s + strlen("\"checksum\": \""), NULL, 16);
+        golden.push_back(r);
+    }
+    fclose(f);
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = 10.0;
+    const char *jsonPath = NULL;
+    const char *goldenDir = NULL;
+
+    for (int i = 1; i < argc; i ++)
+    {
+        if ((strcmp(argv[i], "--json") == 0) && (i + 1 < argc)) jsonPath = argv[++ i];
+        else if ((strcmp(argv[i], "--golden") == 0) && (i + 1 < argc)) goldenDir = argv[++ i];
+        else seconds = atof(argv[i]);
+    }
+    if (seconds <= 0) seconds = 10.0;
+
+    std::vector<Result> results;
+
+    printf("core_benchmark [%s]: %.1f s audio per case, ns per sample and channel\n",
+           variantName().c_str(), seconds);
+    printf("%-16s %4s %10s %10s %18s\n", "kernel", "ch", "ns", "frames", "checksum");
+
+    for (int c = 0; c < NUM_CH; c ++)
+    {
+        const int ch = CHANNELS[c];
+        std::vector<SAMPLETYPE> input = bench::makeMusic(SAMPLE_RATE, ch, seconds);
+        std::vector<SAMPLETYPE> golden = bench::makeMusic(SAMPLE_RATE, ch, GOLDEN_SECONDS);
+        std::vector<SAMPLETYPE> out;
+
+        for (int k = 0; k < NUM_KERNELS; k ++)
+        {
+            Result r;
+            r.kernel = (Kernel)k;
+            r.channels = ch;
+            r.ns = 1e9 * run(r.kernel, ch, input, out) / (double)input.size();
+
+            run(r.kernel, ch, golden, out);
+            r.frames = (unsigned long)(out.size() / ch);
+            r.checksum = checksum(out);
+            results.push_back(r);
+
+            printf("%-16s %4d %10.3f %10lu   %016llx\n", kernelNames[k], ch, r.ns, r.frames, r.checksum);
+        }
+    }
+
+    if (jsonPath && !writeJson(jsonPath, seconds, results))
+    {
+        fprintf(stderr, "core_benchmark: can't write %s\n", jsonPath);
+        return 1;
+    }
+
+    if (goldenDir == NULL) return 0;
+
+    std::string goldenPath = std::string(goldenDir) + "/" + variantName() + ".json";
+    std::vector<Result> golden;
+    if (!readGolden(goldenPath.c_str(), golden))
+    {
+        printf("no golden results for %s, checksums not verified\n", variantName().c_str());
+        return 0;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < results.size(); i ++)
+    {
+        const Result &r = results[i];
+        size_t g;
+        for (g = 0; g < golden.size(); g ++)
+        {
+            if ((golden[g].kernel == r.kernel) && (golden[g].channels == r.channels)) break;
+        }
+        if (g == golden.size())
+        {
+            fprintf(stderr, "core_benchmark: %s %d ch missing from %s\n", kernelNames[r.kernel], r.channels,
+                    goldenPath.c_str());
+            ok = false;
+        }
+        else if (golden[g].checksum != r.checksum)
+        {
+            fprintf(stderr, "core_benchmark: %s %d ch output differs from %s\n", kernelNames[r.kernel],
+                    r.channels, goldenPath.c_str());
+            ok = false;
+        }
+    }
+    if (ok) printf("checksums match %s\n", goldenPath.c_str());
+    return ok ? 0 : 1;
+}
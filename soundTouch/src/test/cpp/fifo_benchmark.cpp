@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for the sample buffers of the SoundTouch processing pipeline:
+/// measures throughput of the full tempo + pitch chain and counts buffer
+/// allocations and bytes moved when rewinding the FIFO buffers.
+///
+/// Fails if the buffers still reallocate after the first second of audio,
+/// i.e. in steady state processing.
+///
+/// Usage: fifo_benchmark [seconds of audio per case, default 30]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SoundTouch.h"
+#include "FIFOSampleBuffer.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 44100;
+static const int CHANNELS = 2;
+
+struct Case
+{
+    int blockFrames;
+    double tempo;
+    double pitchSemiTones;
+};
+
+static const Case CASES[] =
+{
+    {  256, 1.1,  2.0 },
+    { 1024, 1.1,  2.0 },
+    { 4096, 1.1,  2.0 },
+    { 1024, 0.8, -3.0 },
+    { 1024, 1.5,  0.0 },
+};
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 30.0;
+    if (seconds <= 0) seconds = 30.0;
+
+    bool ok = true;
+    std::vector<SAMPLETYPE> input = bench::makeMusic(SAMPLE_RATE, CHANNELS, seconds);
+    int numFrames = (int)(input.size() / CHANNELS);
+    std::vector<SAMPLETYPE> out(8 * 4096 * CHANNELS);
+
+    printf("fifo_benchmark [%s]: %.1f s stereo audio per case\n", bench::simdName(), seconds);
+    printf("%6s %6s %6s %12s %10s %10s %14s\n",
+           "block", "tempo", "pitch", "x realtime", "allocs", "steady", "moved KB/s");
+
+    for (size_t ci = 0; ci < sizeof(CASES) / sizeof(CASES[0]); ci ++)
+    {
+        const Case &c = CASES[ci];
+        unsigned long long allocs, steadyAllocs = 0, moved;
+
+        FIFOSampleBuffer::resetStatistics();
+
+        SoundTouch st;
+        st.setChannels(CHANNELS);
+        st.setSampleRate(SAMPLE_RATE);
+        st.setTempo(c.tempo);
+        st.setPitchSemiTones(c.pitchSemiTones);
+
+        double start = bench::now();
+        for (int pos = 0; pos < numFrames; pos += c.blockFrames)
+        {
+            int n = (numFrames - pos < c.blockFrames) ? numFrames - pos : c.blockFrames;
+            st.putSamples(&input[(size_t)pos * CHANNELS], n);
+            while (st.receiveSamples(&out[0], (uint)(out.size() / CHANNELS)) > 0) {}
+
+            if (pos < SAMPLE_RATE && pos + n >= SAMPLE_RATE)
+            {
+                FIFOSampleBuffer::getStatistics(&steadyAllocs, NULL);
+            }
+        }
+        double elapsed = bench::now() - start;
+
+        FIFOSampleBuffer::getStatistics(&allocs, &moved);
+        steadyAllocs = allocs - steadyAllocs;
+
+        printf("%6d %6.2f %6.1f %12.1f %10llu %10llu %14.1f\n", c.blockFrames, c.tempo, c.pitchSemiTones,
+               seconds / elapsed, allocs, steadyAllocs, moved / 1024.0 / seconds);
+
+        if (steadyAllocs > 0)
+        {
+            fprintf(stderr, "fifo_benchmark: block %d: %llu allocations in steady state\n",
+                    c.blockFrames, steadyAllocs);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
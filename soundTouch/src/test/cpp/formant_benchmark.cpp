@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for formant preservation (SETTING_FORMANT_PRESERVE): shifts the
+/// pitch of a speech-like signal with plain setPitchSemiTones() and with the
+/// formant correction enabled, and compares the processing time and how far
+/// the spectral envelope of the output moved from the input.
+///
+/// The envelope distance is the RMS difference in dB between the long-term
+/// average LPC envelopes of the input and the output over 100 Hz .. 5 kHz,
+/// with the levels aligned. Fails if the correction doesn't reduce the
+/// distance at a shift of 4 semitones or more.
+///
+/// Usage: formant_benchmark [seconds of audio per case, default 20]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SoundTouch.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 44100;
+static const int CHANNELS = 2;
+static const int FRAME = 1024;
+static const int ORDER = 20;
+static const int BANDS = 256;
+
+// Long-term average LPC envelope of the first channel in dB at BANDS
+// frequencies over 0 .. SAMPLE_RATE / 2, averaged over non-silent frames
+static std::vector<double> averageEnvelope(const std::vector<SAMPLETYPE> &data)
+{
+    const int numFrames = (int)(data.size() / CHANNELS);
+    std::vector<double> sum(BANDS, 0.0);
+    double x[FRAME];
+    int count = 0;
+
+    for (int pos = 0; pos + FRAME <= numFrames; pos += FRAME / 2)
+    {
+        double r[ORDER + 1], a[ORDER + 1], tmp[ORDER + 1];
+
+        for (int i = 0; i < FRAME; i ++)
+        {
+            x[i] = (double)data[(size_t)(pos + i) * CHANNELS] * (0.5 - 0.5 * cos(2 * M_PI * (i + 0.5) / FRAME));
+        }
+        for (int m = 0; m <= ORDER; m ++)
+        {
+            r[m] = 0;
+            for (int i = m; i < FRAME; i ++) r[m] += x[i] * x[i - m];
+        }
+        if (r[0] < 1e-6 * FRAME) continue;
+        r[0] *= 1.0001;
+
+        // Levinson-Durbin recursion
+        double err = r[0];
+        a[0] = 1;
+        for (int i = 1; i <= ORDER; i ++)
+        {
+            double acc = r[i];
+            for (int j = 1; j < i; j ++) acc += a[j] * r[i - j];
+            double k = -acc / err;
+            for (int j = 1; j < i; j ++) tmp[j] = a[j] + k * a[i - j];
+            for (int j = 1; j < i; j ++) a[j] = tmp[j];
+            a[i] = k;
+            err *= 1 - k * k;
+        }
+
+        for (int b = 0; b < BANDS; b ++)
+        {
+            double w = M_PI * (b + 0.5) / BANDS, re = 0, im = 0;
+            for (int i = 0; i <= ORDER; i ++)
+            {
+                re += a[i] * cos(w * i);
+                im -= a[i] * sin(w * i);
+            }
+            sum[b] += err / (re * re + im * im);
+        }
+        count ++;
+    }
+
+    for (int b = 0; b < BANDS; b ++) sum[b] = 10 * log10(sum[b] / (count ? count : 1) + 1e-30);
+    return sum;
+}
+
+
+// RMS difference in dB of two envelopes over 100 Hz .. 5 kHz, levels aligned
+static double envelopeDistance(const std::vector<double> &a, const std::vector<double> &b)
+{
+    int lo = (int)(100.0 * 2 * BANDS / SAMPLE_RATE);
+    int hi = (int)(5000.0 * 2 * BANDS / SAMPLE_RATE);
+    double mean = 0, sum = 0;
+
+    for (int i = lo; i < hi; i ++) mean += a[i] - b[i];
+    mean /= hi - lo;
+    for (int i = lo; i < hi; i ++)
+    {
+        double d = a[i] - b[i] - mean;
+        sum += d * d;
+    }
+    return sqrt(sum / (hi - lo));
+}
+
+
+// Processes 'input' in 512-frame blocks, returns the processing time
+static double process(SoundTouch &st, const std::vector<SAMPLETYPE> &input, std::vector<SAMPLETYPE> &output)
+{
+    const int numFrames = (int)(input.size() / CHANNELS);
+    const int block = 512;
+    int received = 0;
+
+    double t0 = bench::now();
+    for (int pos = 0; pos + block <= numFrames; pos += block)
+    {
+        st.putSamples(&input[(size_t)pos * CHANNELS], block);
+        received += st.receiveSamples(&output[(size_t)received * CHANNELS], numFrames - received);
+    }
+    double elapsed = bench::now() - t0;
+
+    output.resize((size_t)received * CHANNELS);
+    return elapsed;
+}
+
+
+int main(int argc, char **argv)
+{
+    static const double semitones[] = { -7, -4, -2, 2, 4, 7, 12 };
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    bool ok = true;
+    std::vector<SAMPLETYPE> input = bench::makeSpeech(SAMPLE_RATE, CHANNELS, seconds);
+    std::vector<double> inputEnv = averageEnvelope(input);
+
+    printf("formant_benchmark [%s]: %.1f s stereo speech at %d Hz\n", bench::simdName(), seconds, SAMPLE_RATE);
+    printf("%9s %12s %12s %10s %12s %12s\n", "semitones", "plain ms/s", "formant ms/s", "overhead",
+           "plain dB", "formant dB");
+
+    for (size_t i = 0; i < sizeof(semitones) / sizeof(semitones[0]); i ++)
+    {
+        double elapsed[2], distance[2];
+
+        for (int formant = 0; formant <= 1; formant ++)
+        {
+            SoundTouch st;
+            std::vector<SAMPLETYPE> output(input.size());
+
+            st.setChannels(CHANNELS);
+            st.setSampleRate(SAMPLE_RATE);
+            st.setPitchSemiTones(semitones[i]);
+            st.setSetting(SETTING_FORMANT_PRESERVE, formant);
+
+            elapsed[formant] = process(st, input, output);
+            distance[formant] = envelopeDistance(inputEnv, averageEnvelope(output));
+        }
+
+        printf("%+9.0f %12.2f %12.2f %9.0f%% %12.2f %12.2f\n", semitones[i],
+               1000.0 * elapsed[0] / seconds, 1000.0 * elapsed[1] / seconds,
+               100.0 * (elapsed[1] - elapsed[0]) / elapsed[0], distance[0], distance[1]);
+
+        if ((fabs(semitones[i]) >= 4) && (distance[1] >= distance[0]))
+        {
+            fprintf(stderr, "formant_benchmark: correction doesn't reduce envelope distance at %+.0f semitones\n",
+                    semitones[i]);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for the rate transposer interpolation algorithms: cost per output
+/// sample versus quality for linear, cubic and shannon interpolation.
+///
+/// Quality is the signal-to-noise ratio of a transposed pure sine: the output is
+/// least squares fitted to a sine of the expected frequency, and the residual is
+/// counted as noise. Also checks that two SoundTouch instances keep separate
+/// algorithm settings.
+///
+/// Usage: interp_benchmark [seconds of audio per case, default 10]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SoundTouch.h"
+#include "RateTransposer.h"
+#include "FIFOSampleBuffer.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 44100;
+static const double RATE = 1.1225;      // two semitones up
+static const double TONES[] = { 1000.0, 8000.0 };
+
+static const char *algorithmNames[] = { "linear", "cubic", "shannon" };
+
+
+/// Generates interleaved sine of 'freq' Hz with amplitude 0.5 in all channels
+static std::vector<SAMPLETYPE> makeSine(int channels, double freq, double seconds)
+{
+    int numFrames = (int)(seconds * SAMPLE_RATE);
+    std::vector<SAMPLETYPE> data((size_t)numFrames * channels);
+    for (int i = 0; i < numFrames; i ++)
+    {
+        SAMPLETYPE v = bench::toSample(0.5 * sin(2 * M_PI * freq * i / SAMPLE_RATE));
+        for (int c = 0; c < channels; c ++)
+        {
+            data[(size_t)i * channels + c] = v;
+        }
+    }
+    return data;
+}
+
+
+/// Transposes 'input' in blocks of 4096 frames, returns elapsed time in seconds.
+/// If 'keep' is false, output of each block is discarded and only counted.
+static double run(TransposerBase &interp, const std::vector<SAMPLETYPE> &input, int channels,
+                  FIFOSampleBuffer &output, bool keep, long &numOutput)
+{
+    const int blockFrames = 4096;
+    int numFrames = (int)(input.size() / channels);
+    FIFOSampleBuffer src(channels);
+
+    interp.setChannels(channels);
+    interp.setRate(RATE);
+    output.setChannels(channels);
+    output.clear();
+    numOutput = 0;
+
+    double start = bench::now();
+    for (int pos = 0; pos < numFrames; pos += blockFrames)
+    {
+        int n = (numFrames - pos < blockFrames) ? numFrames - pos : blockFrames;
+        src.putSamples(&input[(size_t)pos * channels], n);
+        numOutput += interp.transpose(output, src);
+        if (!keep) output.clear();
+    }
+    return bench::now() - start;
+}
+
+
+/// SNR in dB of the first channel of 'output' against a sine of normalized
+/// angular frequency 'w', fitted with least squares for amplitude and phase
+static double sineSnr(FIFOSampleBuffer &output, int channels, double w)
+{
+    const SAMPLETYPE *p = output.ptrBegin();
+    int n = (int)output.numSamples();
+    double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+
+    for (int i = 16; i < n; i ++)
+    {
+        double s = sin(w * i), c = cos(w * i), y = p[i * channels];
+        ss += s * s; sc += s * c; cc += c * c;
+        ys += y * s; yc += y * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+
+    double sig = 0, err = 0;
+    for (int i = 16; i < n; i ++)
+    {
+        double fit = a * sin(w * i) + b * cos(w * i);
+        double e = p[i * channels] - fit;
+        sig += fit * fit;
+        err += e * e;
+    }
+    return 10.0 * log10(sig / (err + 1e-30));
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    if (seconds <= 0) seconds = 10.0;
+
+    bool ok = true;
+
+    printf("interp_benchmark [%s, %s samples]: rate %.4f, %.1f s audio per case\n",
+           bench::simdName(), (sizeof(SAMPLETYPE) == 2) ? "int16" : "float", RATE, seconds);
+    printf("%-8s %12s %12s %10s %10s\n", "algo", "mono ns/smp", "stereo ns/smp", "SNR 1k", "SNR 8k");
+
+    for (int a = TransposerBase::LINEAR; a <= TransposerBase::SHANNON; a ++)
+    {
+        double nsPerSample[2];
+        double snr[2];
+
+        for (int ch = 1; ch <= 2; ch ++)
+        {
+            std::vector<SAMPLETYPE> input = makeSine(ch, TONES[0], seconds);
+            TransposerBase *interp = TransposerBase::newInstance((TransposerBase::ALGORITHM)a);
+            FIFOSampleBuffer output;
+            long numOutput;
+
+            double t = run(*interp, input, ch, output, false, numOutput);
+            nsPerSample[ch - 1] = 1e9 * t / ((double)numOutput * ch);
+            delete interp;
+        }
+
+        for (int k = 0; k < 2; k ++)
+        {
+            std::vector<SAMPLETYPE> input = makeSine(1, TONES[k], 1.0);
+            TransposerBase *interp = TransposerBase::newInstance((TransposerBase::ALGORITHM)a);
+            FIFOSampleBuffer output;
+            long numOutput;
+
+            run(*interp, input, 1, output, true, numOutput);
+            snr[k] = sineSnr(output, 1, 2 * M_PI * TONES[k] * RATE / SAMPLE_RATE);
+            delete interp;
+        }
+
+        printf("%-8s %12.2f %12.2f %9.1f %9.1f\n", algorithmNames[a],
+               nsPerSample[0], nsPerSample[1], snr[0], snr[1]);
+    }
+
+    // algorithm is a per-instance setting
+    SoundTouch preview, exportSt;
+    preview.setSetting(SETTING_INTERPOLATION_ALGORITHM, TransposerBase::LINEAR);
+    exportSt.setSetting(SETTING_INTERPOLATION_ALGORITHM, TransposerBase::SHANNON);
+    if (preview.getSetting(SETTING_INTERPOLATION_ALGORITHM) != TransposerBase::LINEAR ||
+        exportSt.getSetting(SETTING_INTERPOLATION_ALGORITHM) != TransposerBase::SHANNON ||
+        preview.setSetting(SETTING_INTERPOLATION_ALGORITHM, 3))
+    {
+        fprintf(stderr, "interp_benchmark: per-instance algorithm setting not kept\n");
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
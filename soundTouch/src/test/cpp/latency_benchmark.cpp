@@ -0,0 +1,266 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for the low-latency mode (SETTING_LOW_LATENCY): compares the
+/// end-to-end latency and the CPU cost per block of the default settings with
+/// the low-latency mode at block sizes of 64, 128 and 256 frames.
+///
+/// The latency is measured by cross-correlating the envelopes of a pitch
+/// shifted click track and the output. For the default settings the latency
+/// is the output delay a callback needs for never running out of samples.
+/// Also counts frames padded with silence during random pitch ramps.
+///
+/// Fails if the low-latency mode runs out of samples at a constant pitch, or
+/// if its output differs from SETTING_LIVE_LATENCY frames of silence followed
+/// by the output of putSamples() / receiveSamples() with the same settings,
+/// or if processBlock() accepts a tempo, rate or tempo ramp other than 1.0.
+/// Also fails if a loaded tuning profile replaces the low-latency settings
+/// when the pitch changes, or isn't applied again once the mode is disabled.
+///
+/// Usage: latency_benchmark [seconds of audio per case, default 20]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "SoundTouch.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 48000;
+static const int CHANNELS = 2;
+static const double PITCH_SEMITONES = 5.0;
+static const int MAX_LATENCY = SAMPLE_RATE / 10;
+static const int CORRELATION_FRAMES = 3 * SAMPLE_RATE;
+
+// Smoothed magnitude envelope of the first channel
+static std::vector<float> envelope(const SAMPLETYPE *data, int numFrames)
+{
+    std::vector<float> env(numFrames);
+    float y = 0;
+    for (int i = 0; i < numFrames; i ++)
+    {
+        y += 0.02f * ((float)fabs((double)data[(size_t)i * CHANNELS]) - y);
+        env[i] = y;
+    }
+    return env;
+}
+
+
+// Delay of 'out' relative to 'in' in frames, by envelope cross-correlation
+static int measureDelay(const std::vector<SAMPLETYPE> &in, const std::vector<SAMPLETYPE> &out, int numFrames)
+{
+    std::vector<float> a = envelope(&in[0], numFrames);
+    std::vector<float> b = envelope(&out[0], numFrames);
+    double best = -1;
+    int bestDelay = 0;
+
+    for (int d = 0; d < MAX_LATENCY; d ++)
+    {
+        double c = 0;
+        for (int i = d; i < numFrames; i ++) c += (double)a[i - d] * b[i];
+        if (c > best)
+        {
+            best = c;
+            bestDelay = d;
+        }
+    }
+    return bestDelay;
+}
+
+
+static void setup(SoundTouch &st, int block)
+{
+    st.setChannels(CHANNELS);
+    st.setSampleRate(SAMPLE_RATE);
+    if (block) st.setSetting(SETTING_LOW_LATENCY, block);
+}
+
+
+int main(int argc, char **argv)
+{
+    static const int blocks[] = { 0, 64, 128, 256 };
+    static const double pitches[] = { -12, -5, 0, 7, 12 };
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    bool ok = true;
+    std::vector<SAMPLETYPE> input = bench::makeClickTrack(SAMPLE_RATE, CHANNELS, seconds, 100);
+    std::vector<SAMPLETYPE> speech = bench::makeSpeech(SAMPLE_RATE, CHANNELS, seconds);
+    const int numFrames = (int)(input.size() / CHANNELS);
+    std::vector<SAMPLETYPE> output(input.size());
+    std::vector<SAMPLETYPE> ref(input.size());
+
+    printf("latency_benchmark [%s]: %.1f s stereo audio at %d Hz, pitch %+.0f st\n",
+           bench::simdName(), seconds, SAMPLE_RATE, PITCH_SEMITONES);
+    printf("%-8s %10s %10s %10s %10s %10s %14s\n", "block", "reported", "measured", "ms",
+           "mean us", "p99 us", "ramp padding");
+
+    for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b ++)
+    {
+        const int block = blocks[b];
+        const int callback = block ? block : 256;
+        std::vector<double> times;
+        int reported, measured;
+
+        times.reserve(numFrames / callback + 1);
+
+        // end-to-end latency and CPU cost at a constant pitch
+        SoundTouch st;
+        setup(st, block);
+        st.setPitchSemiTones(PITCH_SEMITONES);
+        if (block)
+        {
+            for (int pos = 0; pos + block <= numFrames; pos += block)
+            {
+                double t0 = bench::now();
+                st.processBlock(&input[(size_t)pos * CHANNELS], &output[(size_t)pos * CHANNELS]);
+                times.push_back(bench::now() - t0);
+            }
+            reported = st.getSetting(SETTING_LIVE_LATENCY);
+        }
+        else
+        {
+            // a callback using the default settings has to delay the output
+            // by the largest shortfall of output against input
+            int received = 0;
+            reported = 0;
+            for (int pos = 0; pos + callback <= numFrames; pos += callback)
+            {
+                double t0 = bench::now();
+                st.putSamples(&input[(size_t)pos * CHANNELS], callback);
+                received += st.receiveSamples(&ref[(size_t)received * CHANNELS], numFrames - received);
+                times.push_back(bench::now() - t0);
+                reported = std::max(reported, pos + callback - received);
+            }
+            std::fill(output.begin(), output.end(), 0);
+            std::copy(ref.begin(), ref.begin() + (size_t)(numFrames - reported) * CHANNELS,
+                      output.begin() + (size_t)reported * CHANNELS);
+        }
+        measured = measureDelay(input, output, std::min(numFrames, CORRELATION_FRAMES));
+
+        double sum = 0;
+        for (size_t i = 0; i < times.size(); i ++) sum += times[i];
+        std::sort(times.begin(), times.end());
+        double p99 = times[(size_t)(0.99 * (times.size() - 1))];
+
+        // frames padded with silence during random pitch ramps of 50 ms
+        long padded = 0;
+        if (block)
+        {
+            SoundTouch rs;
+            unsigned int seed = 1;
+            setup(rs, block);
+            for (int pos = 0, n = 0; pos + block <= numFrames; pos += block, n ++)
+            {
+                if (n % (SAMPLE_RATE / block / 4) == 0)
+                {
+                    double semitones = 12.0 * bench::noise(seed);
+                    rs.rampTempoAndPitch(1.0, pow(2.0, semitones / 12.0), SAMPLE_RATE / 20);
+                }
+                padded += rs.processBlock(&speech[(size_t)pos * CHANNELS], &output[(size_t)pos * CHANNELS]);
+            }
+        }
+
+        char name[16], padding[16];
+        snprintf(name, sizeof(name), block ? "%d" : "default", block);
+        snprintf(padding, sizeof(padding), block ? "%ld" : "-", padded);
+        printf("%-8s %10d %10d %10.1f %10.1f %10.1f %14s\n", name, reported, measured,
+               1000.0 * measured / SAMPLE_RATE, 1e6 * sum / times.size(), 1e6 * p99, padding);
+
+        if (block == 0) continue;
+
+        // at constant pitches the output is the delayed stream without gaps
+        for (size_t p = 0; p < sizeof(pitches) / sizeof(pitches[0]); p ++)
+        {
+            SoundTouch live, plain;
+            setup(live, block);
+            setup(plain, block);
+            live.setPitchSemiTones(pitches[p]);
+            plain.setPitchSemiTones(pitches[p]);
+
+            uint underrun = 0;
+            int received = 0;
+            for (int pos = 0; pos + block <= numFrames; pos += block)
+            {
+                underrun += live.processBlock(&speech[(size_t)pos * CHANNELS], &output[(size_t)pos * CHANNELS]);
+                plain.putSamples(&speech[(size_t)pos * CHANNELS], block);
+                received += plain.receiveSamples(&ref[(size_t)received * CHANNELS], numFrames - received);
+            }
+
+            const int latency = live.getSetting(SETTING_LIVE_LATENCY);
+            const int checked = numFrames / block * block;
+            bool same = true;
+            for (int i = 0; (i < checked) && same; i ++)
+            {
+                for (int c = 0; c < CHANNELS; c ++)
+                {
+                    SAMPLETYPE expected = (i < latency) ? 0 : ref[(size_t)(i - latency) * CHANNELS + c];
+                    if (output[(size_t)i * CHANNELS + c] != expected) same = false;
+                }
+            }
+            if ((underrun > 0) || !same)
+            {
+                fprintf(stderr, "latency_benchmark: block %d pitch %+.0f st: %u frames padded, output %s\n",
+                        block, pitches[p], underrun, same ? "matches" : "differs from the delayed stream");
+                ok = false;
+            }
+        }
+    }
+
+    // a tuning profile is suspended in the low-latency mode: changing the pitch
+    // moves the tempo of the tempo changer, which must not select an entry
+    {
+        static const char *profile = "music 0.1 10.0 90 20 12 1 0 0\n";
+        SoundTouch st;
+        setup(st, 256);
+        st.loadTuningProfile(profile);
+        st.setPitchSemiTones(PITCH_SEMITONES);
+
+        uint underrun = 0;
+        for (int pos = 0; pos + 256 <= numFrames; pos += 256)
+        {
+            underrun += st.processBlock(&speech[(size_t)pos * CHANNELS], &output[(size_t)pos * CHANNELS]);
+        }
+        const int liveSequence = st.getSetting(SETTING_SEQUENCE_MS);
+        st.setSetting(SETTING_LOW_LATENCY, 0);
+        const int restoredSequence = st.getSetting(SETTING_SEQUENCE_MS);
+        if ((underrun > 0) || (liveSequence == 90) || (restoredSequence != 90))
+        {
+            fprintf(stderr, "latency_benchmark: with a tuning profile %u frames padded, sequence %d ms "
+                    "in the low-latency mode and %d ms after it\n", underrun, liveSequence, restoredSequence);
+            ok = false;
+        }
+    }
+
+    // settings that would change the length of the stream are refused
+    for (int c = 0; c < 3; c ++)
+    {
+        static const char *names[] = { "tempo", "rate", "tempo ramp" };
+        SoundTouch st;
+        setup(st, 128);
+        if (c == 0) st.setTempo(1.1);
+        else if (c == 1) st.setRate(0.9);
+        else st.rampTempoAndPitch(1.2, 1.0, SAMPLE_RATE);
+
+        bool refused = !st.canProcessBlock();
+        try
+        {
+            st.processBlock(&input[0], &output[0]);
+            refused = false;
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+        if (!refused)
+        {
+            fprintf(stderr, "latency_benchmark: processBlock accepted a %s other than 1.0\n", names[c]);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for the processing kernels per channel count: cost per sample and
+/// channel of the TDStretch overlap-add, the anti-alias FIR filter, each rate
+/// transposer interpolation algorithm and the full SoundTouch chain, for 1, 2,
+/// 4, 6 and 8 channels, and the multichannel cost relative to stereo.
+///
+/// Fails if a multichannel kernel gives for any channel a different result
+/// than the generic kernel of one channel more, e.g. 6 against 7 channels.
+///
+/// Usage: multich_benchmark [seconds of audio per case, default 10]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SoundTouch.h"
+#include "TDStretch.h"
+#include "AAFilter.h"
+#include "RateTransposer.h"
+#include "FIFOSampleBuffer.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 44100;
+static const double RATE = 1.1225;
+static const int CHANNELS[] = { 1, 2, 4, 6, 8 };
+static const int NUM_CH = sizeof(CHANNELS) / sizeof(CHANNELS[0]);
+static const int BLOCK_FRAMES = 4096;
+
+static const char *algorithmNames[] = { "linear", "cubic", "shannon" };
+
+
+/// Exposes the overlap-add routines of TDStretch
+class OverlapBench : public TDStretch
+{
+public:
+    OverlapBench(int ch)
+    {
+        setChannels(ch);
+        setParameters(SAMPLE_RATE, 40, 15, 8);
+    }
+
+    int getOverlapLength() const
+    {
+        return overlapLength;
+    }
+
+    void setMidBuffer(const SAMPLETYPE *src)
+    {
+        memcpy(pMidBuffer, src, sizeof(SAMPLETYPE) * channels * overlapLength);
+    }
+
+    void run(SAMPLETYPE *out, const SAMPLETYPE *in) const
+    {
+        if (channels == 1) overlapMono(out, in);
+        else if (channels == 2) overlapStereo(out, in);
+        else overlapMulti(out, in);
+    }
+};
+
+
+/// Returns ns per sample & channel of overlapping 'seconds' of audio, and the
+/// output of one overlap in 'out'
+static double runOverlap(int ch, const std::vector<SAMPLETYPE> &input, double seconds, std::vector<SAMPLETYPE> &out)
+{
+    OverlapBench ovl(ch);
+    int len = ovl.getOverlapLength();
+    int reps = (int)(seconds * SAMPLE_RATE / len);
+    out.resize((size_t)len * ch);
+    ovl.setMidBuffer(&input[0]);
+
+    double start = bench::now();
+    for (int r = 0; r < reps; r ++)
+    {
+        ovl.run(&out[0], &input[(size_t)(r & 7) * ch * len]);
+    }
+    double t = bench::now() - start;
+    ovl.run(&out[0], &input[0]);
+    return 1e9 * t / ((double)reps * len * ch);
+}
+
+
+/// Returns ns per sample & channel of anti-alias filtering, output in 'out'
+static double runFilter(int ch, const std::vector<SAMPLETYPE> &input, std::vector<SAMPLETYPE> &out)
+{
+    AAFilter filter(64);
+    filter.setCutoffFreq(0.5 / RATE);
+    uint numFrames = (uint)(input.size() / ch);
+    uint numOut = 0;
+    out.resize(input.size());
+
+    double start = bench::now();
+    for (uint pos = 0; pos + BLOCK_FRAMES <= numFrames; pos += BLOCK_FRAMES - 64)
+    {
+        numOut += filter.evaluate(&out[(size_t)pos * ch], &input[(size_t)pos * ch], BLOCK_FRAMES, ch);
+    }
+    return 1e9 * (bench::now() - start) / ((double)numOut * ch);
+}
+
+
+/// Returns ns per sample & channel of transposing with algorithm 'a', output in 'out'
+static double runTransposer(int a, int ch, const std::vector<SAMPLETYPE> &input, FIFOSampleBuffer &out)
+{
+    TransposerBase *interp = TransposerBase::newInstance((TransposerBase::ALGORITHM)a);
+    FIFOSampleBuffer src(ch);
+    uint numFrames = (uint)(input.size() / ch);
+    long numOut = 0;
+
+    interp->setChannels(ch);
+    interp->setRate(RATE);
+    out.setChannels(ch);
+    out.clear();
+    out.reserve((uint)(numFrames / RATE) + BLOCK_FRAMES);
+
+    double start = bench::now();
+    for (uint pos = 0; pos < numFrames; pos += BLOCK_FRAMES)
+    {
+        uint n = (numFrames - pos < (uint)BLOCK_FRAMES) ? numFrames - pos : BLOCK_FRAMES;
+        src.putSamples(&input[(size_t)pos * ch], n);
+        numOut += interp->transpose(out, src);
+    }
+    double t = bench::now() - start;
+    delete interp;
+    return 1e9 * t / ((double)numOut * ch);
+}
+
+
+/// Returns ns per input sample & channel of the full SoundTouch chain
+static double runSoundTouch(int ch, const std::vector<SAMPLETYPE> &input)
+{
+    SoundTouch st;
+    std::vector<SAMPLETYPE> out(8 * BLOCK_FRAMES * ch);
+    uint numFrames = (uint)(input.size() / ch);
+
+    st.setChannels(ch);
+    st.setSampleRate(SAMPLE_RATE);
+    st.setTempo(1.1);
+    st.setPitchSemiTones(2.0);
+
+    double start = bench::now();
+    for (uint pos = 0; pos < numFrames; pos += BLOCK_FRAMES)
+    {
+        uint n = (numFrames - pos < (uint)BLOCK_FRAMES) ? numFrames - pos : BLOCK_FRAMES;
+        st.putSamples(&input[(size_t)pos * ch], n);
+        while (st.receiveSamples(&out[0], 8 * BLOCK_FRAMES) > 0) {}
+    }
+    return 1e9 * (bench::now() - start) / ((double)numFrames * ch);
+}
+
+
+/// Copies the first 'ch' channels of 'wide' interleaved data of 'ch + 1' channels
+static std::vector<SAMPLETYPE> narrow(const SAMPLETYPE *wide, size_t frames, int ch)
+{
+    std::vector<SAMPLETYPE> data(frames * ch);
+    for (size_t i = 0; i < frames; i ++)
+    {
+        memcpy(&data[i * ch], wide + i * (ch + 1), sizeof(SAMPLETYPE) * ch);
+    }
+    return data;
+}
+
+
+static bool same(const char *what, int ch, const SAMPLETYPE *a, const std::vector<SAMPLETYPE> &b)
+{
+    if (memcmp(a, &b[0], sizeof(SAMPLETYPE) * b.size()) == 0) return true;
+    fprintf(stderr, "multich_benchmark: %s with %d channels differs from the generic kernel\n", what, ch);
+    return false;
+}
+
+
+static void printRow(const char *name, const double *ns)
+{
+    printf("%-10s", name);
+    for (int i = 0; i < NUM_CH; i ++) printf(" %8.3f", ns[i]);
+    for (int i = 2; i < NUM_CH; i ++) printf(" %7.2fx", ns[i] / ns[1]);
+    printf("\n");
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    if (seconds <= 0) seconds = 10.0;
+
+    bool ok = true;
+    double ovlNs[NUM_CH], firNs[NUM_CH], interpNs[3][NUM_CH], stNs[NUM_CH];
+
+    printf("multich_benchmark [%s, %s samples]: %.1f s audio per case, ns per sample and channel\n",
+           bench::simdName(), (sizeof(SAMPLETYPE) == 2) ? "int16" : "float", seconds);
+    printf("%-10s", "kernel");
+    for (int i = 0; i < NUM_CH; i ++) printf(" %7dch", CHANNELS[i]);
+    for (int i = 2; i < NUM_CH; i ++) printf(" %2dch/st", CHANNELS[i]);
+    printf("\n");
+
+    for (int i = 0; i < NUM_CH; i ++)
+    {
+        int ch = CHANNELS[i];
+        std::vector<SAMPLETYPE> input = bench::makeMusic(SAMPLE_RATE, ch, seconds);
+        std::vector<SAMPLETYPE> out;
+        FIFOSampleBuffer outBuf;
+
+        ovlNs[i] = runOverlap(ch, input, seconds, out);
+        firNs[i] = runFilter(ch, input, out);
+        for (int a = TransposerBase::LINEAR; a <= TransposerBase::SHANNON; a ++)
+        {
+            interpNs[a][i] = runTransposer(a, ch, input, outBuf);
+        }
+        stNs[i] = runSoundTouch(ch, input);
+
+        if (ch <= 2) continue;
+
+        // results must equal the generic kernel of one channel more
+        std::vector<SAMPLETYPE> wide = bench::makeMusic(SAMPLE_RATE, ch + 1, 1.0);
+        std::vector<SAMPLETYPE> in = narrow(&wide[0], wide.size() / (ch + 1), ch);
+        std::vector<SAMPLETYPE> outWide;
+
+        runOverlap(ch, in, 0.01, out);
+        runOverlap(ch + 1, wide, 0.01, outWide);
+        ok &= same("overlap", ch, &out[0], narrow(&outWide[0], out.size() / ch, ch));
+
+        runFilter(ch, in, out);
+        runFilter(ch + 1, wide, outWide);
+        ok &= same("FIR filter", ch, &out[0], narrow(&outWide[0], out.size() / ch, ch));
+
+        for (int a = TransposerBase::LINEAR; a <= TransposerBase::SHANNON; a ++)
+        {
+            FIFOSampleBuffer outNarrow, outWideBuf;
+            runTransposer(a, ch, in, outNarrow);
+            runTransposer(a, ch + 1, wide, outWideBuf);
+            ok &= (outNarrow.numSamples() == outWideBuf.numSamples()) &&
+                  same(algorithmNames[a], ch, outNarrow.ptrBegin(),
+                       narrow(outWideBuf.ptrBegin(), outWideBuf.numSamples(), ch));
+        }
+    }
+
+    printRow("overlap", ovlNs);
+    printRow("aa-filter", firNs);
+    for (int a = TransposerBase::LINEAR; a <= TransposerBase::SHANNON; a ++)
+    {
+        printRow(algorithmNames[a], interpNs[a]);
+    }
+    printRow("soundtouch", stNs);
+
+    return ok ? 0 : 1;
+}
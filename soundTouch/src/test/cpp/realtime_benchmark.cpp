@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for SoundTouchThread: simulates a real-time audio callback of
+/// 256 frames at 48 kHz, paced by the wall clock, with heavy SoundTouch
+/// settings (shannon interpolation, full overlap seek). Measures the callback
+/// time when processing directly in the callback and when only exchanging
+/// samples with the processing thread, and reports underruns and headroom
+/// of the processing thread.
+///
+/// Fails if the threaded output differs from the direct output, if input
+/// overflows the ring, or if a processing thread that stops on an error doesn't
+/// report it.
+///
+/// Usage: realtime_benchmark [seconds of audio per mode, default 10]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "SoundTouch.h"
+#include "SoundTouchThread.h"
+#include "RateTransposer.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 48000;
+static const int CHANNELS = 2;
+static const int BLOCK_FRAMES = 256;
+static const int RING_FRAMES = 16384;
+
+/// Output frames buffered in the threaded mode before the playback starts
+static const uint PRIME_FRAMES = 4096;
+
+
+static void configure(SoundTouch &st)
+{
+    st.setChannels(CHANNELS);
+    st.setSampleRate(SAMPLE_RATE);
+    st.setPitchSemiTones(3.0);
+    st.setSetting(SETTING_INTERPOLATION_ALGORITHM, TransposerBase::SHANNON);
+    st.setSetting(SETTING_USE_QUICKSEEK, 0);
+    st.setSetting(SETTING_AA_FILTER_LENGTH, 64);
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    if (seconds <= 0) seconds = 10.0;
+
+    bool ok = true;
+    std::vector<SAMPLETYPE> input = bench::makeMusic(SAMPLE_RATE, CHANNELS, seconds);
+    int numFrames = (int)(input.size() / CHANNELS);
+    std::vector<SAMPLETYPE> output[2];
+    std::vector<SAMPLETYPE> buf(16 * BLOCK_FRAMES * CHANNELS);
+    SoundTouchThread::Statistics stats = SoundTouchThread::Statistics();
+
+    printf("realtime_benchmark [%s]: %.1f s stereo audio at %d Hz, %d-frame callbacks (%.2f ms), "
+           "shannon interpolation, full seek\n",
+           bench::simdName(), seconds, SAMPLE_RATE, BLOCK_FRAMES, 1000.0 * BLOCK_FRAMES / SAMPLE_RATE);
+    printf("%-8s %10s %10s %10s %10s %10s %10s %10s\n",
+           "mode", "mean us", "p99 us", "max us", "underruns", "overflows", "headroom", "peak load");
+
+    for (int threaded = 0; threaded <= 1; threaded ++)
+    {
+        SoundTouch st;
+        configure(st);
+        SoundTouchThread thread(&st, RING_FRAMES);
+        std::vector<double> times;
+        bool primed = false;
+
+        times.reserve(numFrames / BLOCK_FRAMES + 1);
+        output[threaded].reserve(input.size() + 4096 * CHANNELS);
+        if (threaded) thread.start();
+
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        for (int pos = 0; pos + BLOCK_FRAMES <= numFrames; pos += BLOCK_FRAMES)
+        {
+            std::this_thread::sleep_until(next);
+            next += std::chrono::microseconds(1000000 * BLOCK_FRAMES / SAMPLE_RATE);
+
+            const SAMPLETYPE *in = &input[(size_t)pos * CHANNELS];
+            uint n;
+            double t0 = bench::now();
+            if (threaded)
+            {
+                thread.putSamples(in, BLOCK_FRAMES);
+                if (!primed && thread.numSamples() >= PRIME_FRAMES) primed = true;
+                n = primed ? thread.receiveSamples(&buf[0], BLOCK_FRAMES) : 0;
+                output[1].insert(output[1].end(), buf.begin(), buf.begin() + n * CHANNELS);
+            }
+            else
+            {
+                st.putSamples(in, BLOCK_FRAMES);
+                while ((n = st.receiveSamples(&buf[0], (uint)(buf.size() / CHANNELS))) > 0)
+                {
+                    output[0].insert(output[0].end(), buf.begin(), buf.begin() + n * CHANNELS);
+                }
+            }
+            times.push_back(bench::now() - t0);
+        }
+
+        if (threaded)
+        {
+            thread.getStatistics(&stats);
+            thread.stop();
+        }
+
+        double sum = 0;
+        for (size_t i = 0; i < times.size(); i ++) sum += times[i];
+        std::sort(times.begin(), times.end());
+        double p99 = times[(size_t)(0.99 * (times.size() - 1))];
+
+        if (threaded)
+        {
+            printf("%-8s %10.1f %10.1f %10.1f %10llu %10llu %9.1f%% %9.1f%%\n", "thread",
+                   1e6 * sum / times.size(), 1e6 * p99, 1e6 * times.back(),
+                   stats.underruns, stats.overflows, 100.0 * (1.0 - stats.load), 100.0 * stats.peakLoad);
+        }
+        else
+        {
+            printf("%-8s %10.1f %10.1f %10.1f %10s %10s %10s %10s\n", "direct",
+                   1e6 * sum / times.size(), 1e6 * p99, 1e6 * times.back(), "-", "-", "-", "-");
+        }
+    }
+
+    size_t common = std::min(output[0].size(), output[1].size());
+    if (common == 0 || !std::equal(output[0].begin(), output[0].begin() + common, output[1].begin()))
+    {
+        fprintf(stderr, "realtime_benchmark: threaded output differs from direct output\n");
+        ok = false;
+    }
+    if (stats.overflows > 0)
+    {
+        fprintf(stderr, "realtime_benchmark: %llu frames overflowed the input ring\n", stats.overflows);
+        ok = false;
+    }
+
+    // without the sample rate the processing thread stops at the first input
+    {
+        SoundTouch broken;
+        broken.setChannels(CHANNELS);
+        SoundTouchThread thread(&broken, RING_FRAMES);
+        std::vector<SAMPLETYPE> block(BLOCK_FRAMES * CHANNELS, 0);
+
+        thread.start();
+        thread.putSamples(&block[0], BLOCK_FRAMES);
+        for (int i = 0; (i < 1000) && !thread.hasFailed(); i ++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (!thread.hasFailed() || thread.isRunning() || (thread.getErrorString()[0] == 0) ||
+            (thread.putSamples(&block[0], BLOCK_FRAMES) != 0))
+        {
+            fprintf(stderr, "realtime_benchmark: processing thread error not reported\n");
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
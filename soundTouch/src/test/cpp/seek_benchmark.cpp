@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for TDStretch overlap seeking: compares the full, quick and FFT
+/// seek algorithms for speed and for quality at 44.1, 48 and 96 kHz.
+///
+/// Quality is measured per processing sequence as the normalized correlation
+/// (-1 .. 1) between the overlapped sequences at the chosen offset, and as the
+/// share of offsets identical to those of the full seek. Fails if the FFT seek
+/// quality falls behind the full seek.
+///
+/// Usage: seek_benchmark [seconds of audio per rate, default 20]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "TDStretch.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int CHANNELS = 2;
+static const double TEMPO = 1.2;
+
+enum SeekMode { SEEK_FULL, SEEK_QUICK, SEEK_FFT, NUM_SEEK_MODES };
+static const char *modeNames[NUM_SEEK_MODES] = { "full", "quick", "fft" };
+
+
+/// TDStretch that runs all seek algorithms on each sequence and records how well
+/// the chosen offsets match. The stream proceeds with the full seek result.
+class SeekProbe : public TDStretch
+{
+public:
+    int numSeeks;
+    int numSame[NUM_SEEK_MODES];
+    double sumMatch[NUM_SEEK_MODES];
+
+    SeekProbe()
+    {
+        // allocates the FFT tables used by seekBestOverlapPositionFFT()
+        enableFFTSeek(true);
+        numSeeks = 0;
+        for (int m = 0; m < NUM_SEEK_MODES; m ++)
+        {
+            numSame[m] = 0;
+            sumMatch[m] = 0;
+        }
+    }
+
+    /// normalized correlation between 'pMidBuffer' and 'refPos' at offset 'offs'
+    double match(const SAMPLETYPE *refPos, int offs) const
+    {
+        const SAMPLETYPE *pos = refPos + channels * offs;
+        double corr = 0, n1 = 0, n2 = 0;
+        for (int i = 0; i < channels * overlapLength; i ++)
+        {
+            corr += (double)pos[i] * pMidBuffer[i];
+            n1 += (double)pos[i] * pos[i];
+            n2 += (double)pMidBuffer[i] * pMidBuffer[i];
+        }
+        return (n1 * n2 > 0) ? corr / sqrt(n1 * n2) : 0;
+    }
+
+    int seekBestOverlapPosition(const SAMPLETYPE *refPos)
+    {
+        int offs[NUM_SEEK_MODES];
+
+        offs[SEEK_FULL] = seekBestOverlapPositionFull(refPos);
+        offs[SEEK_QUICK] = seekBestOverlapPositionQuick(refPos);
+        offs[SEEK_FFT] = seekBestOverlapPositionFFT(refPos);
+
+        numSeeks ++;
+        for (int m = 0; m < NUM_SEEK_MODES; m ++)
+        {
+            if (offs[m] == offs[SEEK_FULL]) numSame[m] ++;
+            sumMatch[m] += match(refPos, offs[m]);
+        }
+        return offs[SEEK_FULL];
+    }
+};
+
+
+static void process(TDStretch *pStretch, const std::vector<SAMPLETYPE> &input)
+{
+    const int chunk = 4096;
+    const int numFrames = (int)(input.size() / CHANNELS);
+    for (int pos = 0; pos < numFrames; pos += chunk)
+    {
+        int n = (numFrames - pos < chunk) ? numFrames - pos : chunk;
+        pStretch->putSamples(&input[(size_t)pos * CHANNELS], n);
+        pStretch->receiveSamples(pStretch->numSamples());
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    static const int rates[] = { 44100, 48000, 96000 };
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    if (seconds <= 0) seconds = 20.0;
+    int failed = 0;
+
+    printf("seek_benchmark [%s]: %.0f s stereo audio per rate, tempo %.2f\n", bench::simdName(), seconds, TEMPO);
+    printf("%8s %6s %12s %10s %10s\n", "rate", "seek", "ms/s audio", "match", "same%");
+
+    for (int r = 0; r < 3; r ++)
+    {
+        const int rate = rates[r];
+        std::vector<SAMPLETYPE> input = bench::makeMusic(rate, CHANNELS, seconds);
+
+        // quality: run all algorithms side by side on the same stream
+        SeekProbe probe;
+        probe.setChannels(CHANNELS);
+        probe.setParameters(rate);
+        probe.setTempo(TEMPO);
+        process(&probe, input);
+
+        for (int m = 0; m < NUM_SEEK_MODES; m ++)
+        {
+            TDStretch *pStretch = TDStretch::newInstance();
+            pStretch->setChannels(CHANNELS);
+            pStretch->setParameters(rate);
+            pStretch->setTempo(TEMPO);
+            pStretch->enableQuickSeek(m == SEEK_QUICK);
+            pStretch->enableFFTSeek(m == SEEK_FFT);
+
+            double start = bench::now();
+            process(pStretch, input);
+            double elapsed = bench::now() - start;
+            delete pStretch;
+
+            printf("%8d %6s %12.3f %10.4f %10.1f\n", rate, modeNames[m],
+                   1000.0 * elapsed / seconds,
+                   probe.sumMatch[m] / probe.numSeeks,
+                   100.0 * probe.numSame[m] / probe.numSeeks);
+        }
+
+        // FFT seek evaluates the same measure as full seek, allow only rounding differences
+        if (probe.sumMatch[SEEK_FFT] < probe.sumMatch[SEEK_FULL] - 0.001 * probe.numSeeks)
+        {
+            fprintf(stderr, "seek_benchmark: FFT seek quality below full seek at %d Hz\n", rate);
+            failed = 1;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for InterpolateShannon: compares the polyphase table implementation
+/// against the exact sinc evaluation it replaced, for speed and for deviation
+/// of the output samples, with mono, stereo and 6-channel audio.
+///
+/// Fails if any output sample deviates from the exact result by more than
+/// MAX_DEVIATION, i.e. 2 LSB at 16bit resolution.
+///
+/// Usage: shannon_benchmark [seconds of audio per case, default 10]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "InterpolateShannon.h"
+#include "FIFOSampleBuffer.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int SAMPLE_RATE = 44100;
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+static const double MAX_DEVIATION = 2.0;
+#else
+static const double MAX_DEVIATION = 2.0 / 32768.0;
+#endif
+
+static const double RATES[] = { 0.7937, 1.0, 1.1225, 1.4983 };
+static const int CHANNELS[] = { 1, 2, 6 };
+
+
+/// Kaiser window with beta = 2.0, as in InterpolateShannon.cpp
+static const double _kaiser8[8] =
+{
+   0.41778693317814,
+   0.64888025049173,
+   0.83508562409944,
+   0.93887857733412,
+   0.93887857733412,
+   0.83508562409944,
+   0.64888025049173,
+   0.41778693317814
+};
+
+#define PI 3.1415926536
+#define sinc(x) (sin(PI * (x)) / (PI * (x)))
+
+
+/// The original Shannon interpolation evaluating the sinc function for every
+/// output sample, extended to any channel count. Used as the reference result.
+class ShannonReference : public TransposerBase
+{
+protected:
+    double fract;
+
+    int transposeMono(SAMPLETYPE *pdest, const SAMPLETYPE *psrc, int &srcSamples)
+    {
+        return transposeMulti(pdest, psrc, srcSamples);
+    }
+
+    int transposeStereo(SAMPLETYPE *pdest, const SAMPLETYPE *psrc, int &srcSamples)
+    {
+        return transposeMulti(pdest, psrc, srcSamples);
+    }
+
+    int transposeMulti(SAMPLETYPE *pdest, const SAMPLETYPE *psrc, int &srcSamples)
+    {
+        int i = 0;
+        int srcSampleEnd = srcSamples - 8;
+        int srcCount = 0;
+
+        while (srcCount < srcSampleEnd)
+        {
+            double w[8];
+            for (int k = 0; k < 8; k ++)
+            {
+                w[k] = (k == 3 && fract < 1e-6) ? _kaiser8[3] : sinc((k - 3) - fract) * _kaiser8[k];
+            }
+            for (int c = 0; c < numChannels; c ++)
+            {
+                double out = 0;
+                for (int k = 0; k < 8; k ++)
+                {
+                    out += psrc[k * numChannels + c] * w[k];
+                }
+                pdest[numChannels * i + c] = (SAMPLETYPE)out;
+            }
+            i ++;
+
+            fract += rate;
+            int whole = (int)fract;
+            fract -= whole;
+            psrc += numChannels * whole;
+            srcCount += whole;
+        }
+        srcSamples = srcCount;
+        return i;
+    }
+
+public:
+    ShannonReference()
+    {
+        fract = 0;
+    }
+
+    void resetRegisters()
+    {
+        fract = 0;
+    }
+
+    int getLatency() const
+    {
+        return 3;
+    }
+};
+
+
+/// Transposes 'input' in blocks of 4096 frames, returns elapsed time in seconds
+static double run(TransposerBase &interp, const std::vector<SAMPLETYPE> &input, int channels,
+                  double rate, FIFOSampleBuffer &output)
+{
+    const int blockFrames = 4096;
+    int numFrames = (int)(input.size() / channels);
+    FIFOSampleBuffer src(channels);
+
+    interp.setChannels(channels);
+    interp.setRate(rate);
+    interp.resetRegisters();
+    output.setChannels(channels);
+    output.clear();
+
+    double start = bench::now();
+    for (int pos = 0; pos < numFrames; pos += blockFrames)
+    {
+        int n = (numFrames - pos < blockFrames) ? numFrames - pos : blockFrames;
+        src.putSamples(&input[(size_t)pos * channels], n);
+        interp.transpose(output, src);
+    }
+    return bench::now() - start;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    if (seconds <= 0) seconds = 10.0;
+
+    bool ok = true;
+
+    printf("shannon_benchmark [%s, %s samples]: %.1f s audio per case, ms per second of audio\n",
+           bench::simdName(), (sizeof(SAMPLETYPE) == 2) ? "int16" : "float", seconds);
+    printf("%4s %8s %10s %10s %8s %12s\n", "ch", "rate", "exact", "table", "speedup", "max dev");
+
+    for (size_t ci = 0; ci < sizeof(CHANNELS) / sizeof(CHANNELS[0]); ci ++)
+    {
+        int channels = CHANNELS[ci];
+        std::vector<SAMPLETYPE> input = bench::makeMusic(SAMPLE_RATE, channels, seconds);
+
+        for (size_t ri = 0; ri < sizeof(RATES) / sizeof(RATES[0]); ri ++)
+        {
+            double rate = RATES[ri];
+            ShannonReference exact;
+            InterpolateShannon table;
+            FIFOSampleBuffer outExact, outTable;
+
+            double tExact = run(exact, input, channels, rate, outExact);
+            double tTable = run(table, input, channels, rate, outTable);
+
+            double maxDev = 0;
+            uint n = (outExact.numSamples() < outTable.numSamples()) ? outExact.numSamples() : outTable.numSamples();
+            const SAMPLETYPE *a = outExact.ptrBegin();
+            const SAMPLETYPE *b = outTable.ptrBegin();
+            for (uint i = 0; i < n * channels; i ++)
+            {
+                double d = fabs((double)a[i] - (double)b[i]);
+                if (d > maxDev) maxDev = d;
+            }
+
+            printf("%4d %8.4f %10.3f %10.3f %7.2fx %12.6g\n", channels, rate,
+                   1000.0 * tExact / seconds, 1000.0 * tTable / seconds, tExact / tTable, maxDev);
+
+            if (outExact.numSamples() != outTable.numSamples() || maxDev > MAX_DEVIATION)
+            {
+                fprintf(stderr, "shannon_benchmark: %d ch rate %.4f: %u vs %u frames, max deviation %g (limit %g)\n",
+                        channels, rate, outExact.numSamples(), outTable.numSamples(), maxDev, MAX_DEVIATION);
+                ok = false;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,498 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Tuning harness for the time-stretch settings: processes a corpus with every
+/// combination of SETTING_SEQUENCE_MS, SETTING_SEEKWINDOW_MS, SETTING_OVERLAP_MS
+/// and SETTING_USE_QUICKSEEK at a representative tempo of each tempo range,
+/// and records the CPU time and an objective quality score of each run.
+///
+/// The quality score is the spectral SNR in dB between the output and the
+/// input: for each 1024-sample frame of the output, the magnitude spectrum is
+/// compared with the best matching input frame around the corresponding input
+/// time, and the score is 10 * log10(|X|^2 / |X - Y|^2) averaged over frames.
+///
+/// Writes the non-dominated settings of each content type and tempo range
+/// (no other settings are both cheaper and better) as a tuning profile that
+/// SoundTouch::loadTuningProfile() accepts, and prints how much CPU time the
+/// profile saves over the default automatic settings at the same quality.
+/// Fails if SoundTouch doesn't load the profile or applies other settings
+/// than selected from it.
+///
+/// Usage: tuning_benchmark [seconds of audio per clip, default 10]
+///                         [profile output file] [content:file.wav ...]
+///
+/// 'content' is "music", "speech" or "percussive". Without WAV files, synthetic
+/// clips of each content type are used.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "SoundTouch.h"
+#include "TuningProfile.h"
+#include "WavFile.h"
+#include "bench_util.h"
+
+using namespace soundtouch;
+
+static const int CHANNELS = 2;
+static const int BLOCK_FRAMES = 4096;
+
+static const int SEQUENCE_MS[] = { 30, 50, 70, 90 };
+static const int SEEKWINDOW_MS[] = { 8, 15, 25 };
+static const int OVERLAP_MS[] = { 4, 8, 12 };
+static const int NUM_SEQ = sizeof(SEQUENCE_MS) / sizeof(SEQUENCE_MS[0]);
+static const int NUM_SEEK = sizeof(SEEKWINDOW_MS) / sizeof(SEEKWINDOW_MS[0]);
+static const int NUM_OVL = sizeof(OVERLAP_MS) / sizeof(OVERLAP_MS[0]);
+
+/// Tempo ranges of the profile
+static const double TEMPO_EDGES[] = { 0.5, 0.8, 0.95, 1.05, 1.3, 2.01 };
+static const int NUM_RANGES = sizeof(TEMPO_EDGES) / sizeof(TEMPO_EDGES[0]) - 1;
+
+/// Spectrum analysis frame length and hop, and how many hops around the
+/// nominal input position are searched for the best matching input frame
+static const int FFT_LEN = 1024;
+static const int FFT_HOP = 512;
+static const int MATCH_HOPS = 2;
+
+/// Upper limit of the per-frame quality score in dB
+static const double MAX_FRAME_SNR = 40.0;
+
+
+struct Clip
+{
+    std::string name;
+    int content;
+    int sampleRate;
+    std::vector<SAMPLETYPE> samples;    ///< interleaved, CHANNELS channels
+    std::vector<std::vector<float> > spectra;
+};
+
+
+struct Settings
+{
+    int sequenceMs;
+    int seekWindowMs;
+    int overlapMs;
+    int quickSeek;
+};
+
+
+struct Result
+{
+    Settings settings;
+    double quality;
+    double cost;
+};
+
+
+/// In-place radix-2 FFT of FFT_LEN complex values
+static void fft(std::vector<double> &re, std::vector<double> &im)
+{
+    static std::vector<double> wr, wi;
+    const int n = FFT_LEN;
+
+    if (wr.empty())
+    {
+        for (int k = 0; k < n / 2; k ++)
+        {
+            wr.push_back(cos(-2 * M_PI * k / n));
+            wi.push_back(sin(-2 * M_PI * k / n));
+        }
+    }
+
+    for (int i = 1, j = 0; i < n; i ++)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j)
+        {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        int step = n / len;
+        for (int i = 0; i < n; i += len)
+        {
+            for (int k = 0; k < len / 2; k ++)
+            {
+                int a = i + k, b = i + k + len / 2;
+                double xr = re[b] * wr[k * step] - im[b] * wi[k * step];
+                double xi = re[b] * wi[k * step] + im[b] * wr[k * step];
+                re[b] = re[a] - xr;
+                im[b] = im[a] - xi;
+                re[a] += xr;
+                im[a] += xi;
+            }
+        }
+    }
+}
+
+
+/// Magnitude spectra of the first channel of 'samples', one per FFT_HOP frames
+static std::vector<std::vector<float> > spectra(const std::vector<SAMPLETYPE> &samples)
+{
+    std::vector<std::vector<float> > result;
+    std::vector<double> re(FFT_LEN), im(FFT_LEN), window(FFT_LEN);
+    int numFrames = (int)(samples.size() / CHANNELS);
+
+    for (int i = 0; i < FFT_LEN; i ++) window[i] = 0.5 - 0.5 * cos(2 * M_PI * i / FFT_LEN);
+    for (int pos = 0; pos + FFT_LEN <= numFrames; pos += FFT_HOP)
+    {
+        for (int i = 0; i < FFT_LEN; i ++)
+        {
+            re[i] = window[i] * samples[(size_t)(pos + i) * CHANNELS];
+            im[i] = 0;
+        }
+        fft(re, im);
+        std::vector<float> mag(FFT_LEN / 2);
+        for (int k = 0; k < FFT_LEN / 2; k ++)
+        {
+            mag[k] = (float)sqrt(re[k] * re[k] + im[k] * im[k]);
+        }
+        result.push_back(mag);
+    }
+    return result;
+}
+
+
+/// Spectral SNR of output frame 'out' against input frame 'in' in dB
+static double frameSnr(const std::vector<float> &in, const std::vector<float> &out)
+{
+    double sig = 0, err = 0;
+    for (size_t k = 0; k < in.size(); k ++)
+    {
+        double d = (double)in[k] - out[k];
+        sig += (double)in[k] * in[k];
+        err += d * d;
+    }
+    if (err <= sig * pow(10.0, -MAX_FRAME_SNR / 10)) return MAX_FRAME_SNR;
+    return 10 * log10(sig / err);
+}
+
+
+/// Quality score of time-stretched output 'output' of 'clip' at 'tempo'
+static double quality(const Clip &clip, double tempo, const std::vector<SAMPLETYPE> &output)
+{
+    std::vector<std::vector<float> > outSpectra = spectra(output);
+    const std::vector<std::vector<float> > &inSpectra = clip.spectra;
+    double inEnergy = 0;
+    double sum = 0;
+    int count = 0;
+
+    for (size_t k = 0; k < inSpectra.size(); k ++)
+    {
+        for (size_t i = 0; i < inSpectra[k].size(); i ++) inEnergy += (double)inSpectra[k][i] * inSpectra[k][i];
+    }
+    inEnergy /= inSpectra.size();
+
+    // skip the first and last frames affected by the stream start and flush
+    for (int j = MATCH_HOPS; j < (int)outSpectra.size() - MATCH_HOPS; j ++)
+    {
+        int center = (int)(j * tempo + 0.5);
+        double best = -MAX_FRAME_SNR;
+        double energy = 0;
+
+        if (center + MATCH_HOPS >= (int)inSpectra.size()) break;
+        for (size_t i = 0; i < inSpectra[center].size(); i ++) energy += (double)inSpectra[center][i] * inSpectra[center][i];
+        if (energy < 0.01 * inEnergy) continue;     // pause
+
+        for (int k = center - MATCH_HOPS; k <= center + MATCH_HOPS; k ++)
+        {
+            if (k < 0) continue;
+            double snr = frameSnr(inSpectra[k], outSpectra[j]);
+            if (snr > best) best = snr;
+        }
+        sum += best;
+        count ++;
+    }
+    return (count > 0) ? sum / count : 0;
+}
+
+
+/// Processes 'clip' at 'tempo' with 'settings' (NULL = defaults), returns the
+/// quality score and the cost in CPU milliseconds per second of audio
+static Result run(const Clip &clip, double tempo, const Settings *settings)
+{
+    SoundTouch st;
+    std::vector<SAMPLETYPE> output;
+    std::vector<SAMPLETYPE> buf((size_t)BLOCK_FRAMES * CHANNELS);
+    int numFrames = (int)(clip.samples.size() / CHANNELS);
+    Result r;
+
+    st.setChannels(CHANNELS);
+    st.setSampleRate(clip.sampleRate);
+    st.setTempo(tempo);
+    if (settings)
+    {
+        st.setSetting(SETTING_SEQUENCE_MS, settings->sequenceMs);
+        st.setSetting(SETTING_SEEKWINDOW_MS, settings->seekWindowMs);
+        st.setSetting(SETTING_OVERLAP_MS, settings->overlapMs);
+        st.setSetting(SETTING_USE_QUICKSEEK, settings->quickSeek);
+        r.settings = *settings;
+    }
+    output.reserve((size_t)(clip.samples.size() / tempo) + 2 * buf.size());
+
+    double time = 0;
+    for (int pos = 0; pos < numFrames; pos += BLOCK_FRAMES)
+    {
+        uint n = (numFrames - pos < BLOCK_FRAMES) ? numFrames - pos : BLOCK_FRAMES;
+        uint m;
+        double t0 = bench::now();
+
+        st.putSamples(&clip.samples[(size_t)pos * CHANNELS], n);
+        if (pos + BLOCK_FRAMES >= numFrames) st.flush();
+        while ((m = st.receiveSamples(&buf[0], BLOCK_FRAMES)) > 0)
+        {
+            time += bench::now() - t0;
+            output.insert(output.end(), buf.begin(), buf.begin() + m * CHANNELS);
+            t0 = bench::now();
+        }
+        time += bench::now() - t0;
+    }
+
+    r.quality = quality(clip, tempo, output);
+    r.cost = 1000.0 * time * clip.sampleRate / numFrames;
+    return r;
+}
+
+
+/// Reads 'content:file.wav' into 'clip', converting to CHANNELS channels
+static bool readClip(const char *arg, Clip &clip)
+{
+    const char *colon = strchr(arg, ':');
+    if (colon == NULL) return false;
+
+    std::string content(arg, colon - arg);
+    clip.name = colon + 1;
+    clip.content = TuningProfile::contentFromName(content.c_str());
+    if (clip.content < 0) return false;
+
+    WavInFile wav(colon + 1);
+    int ch = (int)wav.getNumChannels();
+    std::vector<SAMPLETYPE> buf(BLOCK_FRAMES * ch);
+
+    clip.sampleRate = (int)wav.getSampleRate();
+    while (!wav.eof())
+    {
+        int n = wav.read(&buf[0], (int)buf.size()) / ch;
+        for (int i = 0; i < n; i ++)
+        {
+            for (int c = 0; c < CHANNELS; c ++)
+            {
+                clip.samples.push_back(buf[i * ch + ((c < ch) ? c : ch - 1)]);
+            }
+        }
+    }
+    return true;
+}
+
+
+static Clip syntheticClip(int content, double seconds)
+{
+    static const int SAMPLE_RATE = 44100;
+    Clip clip;
+
+    clip.content = content;
+    clip.name = std::string("synthetic ") + TuningProfile::contentName(content);
+    clip.sampleRate = SAMPLE_RATE;
+    if (content == CONTENT_MUSIC) clip.samples = bench::makeMusic(SAMPLE_RATE, CHANNELS, seconds);
+    else if (content == CONTENT_SPEECH) clip.samples = bench::makeSpeech(SAMPLE_RATE, CHANNELS, seconds);
+    else clip.samples = bench::makeClickTrack(SAMPLE_RATE, CHANNELS, seconds, 128.0);
+    return clip;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    if (seconds <= 0) seconds = 10.0;
+    const char *outFile = (argc > 2) ? argv[2] : NULL;
+
+    std::vector<Clip> clips;
+    for (int i = 3; i < argc; i ++)
+    {
+        Clip clip;
+        try
+        {
+            if (!readClip(argv[i], clip)) throw std::runtime_error("expected content:file.wav");
+        }
+        catch (const std::runtime_error &e)
+        {
+            fprintf(stderr, "tuning_benchmark: %s: %s\n", argv[i], e.what());
+            return 1;
+        }
+        clips.push_back(clip);
+    }
+    if (clips.empty())
+    {
+        for (int c = 0; c < NUM_CONTENT_TYPES; c ++) clips.push_back(syntheticClip(c, seconds));
+    }
+    for (size_t i = 0; i < clips.size(); i ++) clips[i].spectra = spectra(clips[i].samples);
+
+    printf("tuning_benchmark [%s]: %d clips, %d settings x %d tempo ranges\n",
+           bench::simdName(), (int)clips.size(), NUM_SEQ * NUM_SEEK * NUM_OVL * 2, NUM_RANGES);
+    printf("%-11s %-11s %17s %17s %-20s %8s\n", "content", "tempo", "auto dB / ms/s",
+           "profile dB / ms/s", "seq/seek/ovl/quick", "saving");
+
+    std::string profile = "# SoundTouch tuning profile written by tuning_benchmark\n"
+                          "# content tempo_min tempo_max sequence_ms seekwindow_ms overlap_ms quickseek quality cost\n";
+    // per content type and range: quality of the automatic settings, used as
+    // the quality target when checking the profile
+    double autoQuality[NUM_CONTENT_TYPES][NUM_RANGES];
+    bool hasContent[NUM_CONTENT_TYPES] = { false, false, false };
+
+    for (int content = 0; content < NUM_CONTENT_TYPES; content ++)
+    {
+        for (int r = 0; r < NUM_RANGES; r ++)
+        {
+            double tempo = sqrt(TEMPO_EDGES[r] * TEMPO_EDGES[r + 1]);
+            std::vector<Result> results;
+            Result autoResult = { { 0, 0, 0, 0 }, 0, 0 };
+            int numClips = 0;
+
+            // average over the clips of this content type
+            for (size_t i = 0; i < clips.size(); i ++)
+            {
+                if (clips[i].content != content) continue;
+
+                Result a = run(clips[i], tempo, NULL);
+                autoResult.quality += a.quality;
+                autoResult.cost += a.cost;
+
+                int n = 0;
+                for (int seq = 0; seq < NUM_SEQ; seq ++)
+                for (int seek = 0; seek < NUM_SEEK; seek ++)
+                for (int ovl = 0; ovl < NUM_OVL; ovl ++)
+                for (int quick = 0; quick <= 1; quick ++)
+                {
+                    Settings s = { SEQUENCE_MS[seq], SEEKWINDOW_MS[seek], OVERLAP_MS[ovl], quick };
+                    Result res = run(clips[i], tempo, &s);
+                    if (numClips == 0)
+                    {
+                        results.push_back(res);
+                    }
+                    else
+                    {
+                        results[n].quality += res.quality;
+                        results[n].cost += res.cost;
+                    }
+                    n ++;
+                }
+                numClips ++;
+            }
+            if (numClips == 0) break;
+            hasContent[content] = true;
+
+            autoResult.quality /= numClips;
+            autoResult.cost /= numClips;
+            autoQuality[content][r] = autoResult.quality;
+            for (size_t i = 0; i < results.size(); i ++)
+            {
+                results[i].quality /= numClips;
+                results[i].cost /= numClips;
+            }
+
+            // keep the settings that no other settings beat in both cost and quality
+            const Result *match = NULL;
+            for (size_t i = 0; i < results.size(); i ++)
+            {
+                bool dominated = false;
+                for (size_t j = 0; j < results.size() && !dominated; j ++)
+                {
+                    dominated = (j != i) &&
+                                (results[j].cost <= results[i].cost) && (results[j].quality >= results[i].quality) &&
+                                ((results[j].cost < results[i].cost) || (results[j].quality > results[i].quality));
+                }
+                if (dominated) continue;
+
+                const Settings &s = results[i].settings;
+                char line[160];
+                snprintf(line, sizeof(line), "%-10s %4.2f %4.2f %3d %3d %3d %d %6.2f %7.3f\n",
+                         TuningProfile::contentName(content), TEMPO_EDGES[r], TEMPO_EDGES[r + 1],
+                         s.sequenceMs, s.seekWindowMs, s.overlapMs, s.quickSeek,
+                         results[i].quality, results[i].cost);
+                profile += line;
+
+                if ((results[i].quality >= autoResult.quality) && (!match || results[i].cost < match->cost))
+                {
+                    match = &results[i];
+                }
+            }
+
+            char range[32];
+            snprintf(range, sizeof(range), "%.2f-%.2f", TEMPO_EDGES[r], TEMPO_EDGES[r + 1]);
+            printf("%-11s %-11s %7.2f / %7.3f", TuningProfile::contentName(content), range,
+                   autoResult.quality, autoResult.cost);
+            if (match)
+            {
+                char s[32];
+                snprintf(s, sizeof(s), "%d/%d/%d/%d", match->settings.sequenceMs, match->settings.seekWindowMs,
+                         match->settings.overlapMs, match->settings.quickSeek);
+                printf(" %7.2f / %7.3f %-20s %7.1f%%\n", match->quality, match->cost, s,
+                       100.0 * (1.0 - match->cost / autoResult.cost));
+            }
+            else
+            {
+                printf(" %17s %-20s %8s\n", "-", "-", "-");
+            }
+        }
+    }
+
+    if (outFile)
+    {
+        FILE *f = fopen(outFile, "w");
+        if (f == NULL || fputs(profile.c_str(), f) < 0)
+        {
+            fprintf(stderr, "tuning_benchmark: can't write %s\n", outFile);
+            return 1;
+        }
+        fclose(f);
+        printf("profile written to %s\n", outFile);
+    }
+
+    // SoundTouch must load the profile and apply the settings selected from it
+    bool ok = true;
+    TuningProfile table;
+    SoundTouch st;
+
+    st.setChannels(CHANNELS);
+    st.setSampleRate(44100);
+    if (!table.parse(profile.c_str()) || !st.loadTuningProfile(profile.c_str()))
+    {
+        fprintf(stderr, "tuning_benchmark: SoundTouch rejected the profile\n");
+        return 1;
+    }
+    for (int content = 0; content < NUM_CONTENT_TYPES; content ++)
+    {
+        if (!hasContent[content]) continue;
+        for (int r = 0; r < NUM_RANGES; r ++)
+        {
+            double tempo = sqrt(TEMPO_EDGES[r] * TEMPO_EDGES[r + 1]);
+            int target = (int)(10 * autoQuality[content][r]);
+            const TuningProfile::Entry *e = table.select(content, tempo, 0.1 * target);
+
+            st.setSetting(SETTING_CONTENT_TYPE, content);
+            st.setSetting(SETTING_QUALITY_TARGET, target);
+            st.setTempo(tempo);
+            if ((e == NULL) ||
+                (st.getSetting(SETTING_SEQUENCE_MS) != e->sequenceMs) ||
+                (st.getSetting(SETTING_SEEKWINDOW_MS) != e->seekWindowMs) ||
+                (st.getSetting(SETTING_OVERLAP_MS) != e->overlapMs) ||
+                (st.getSetting(SETTING_USE_QUICKSEEK) != e->quickSeek))
+            {
+                fprintf(stderr, "tuning_benchmark: %s at tempo %.2f doesn't use the profile settings\n",
+                        TuningProfile::contentName(content), tempo);
+                ok = false;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -5,6 +5,8 @@
 #include <android/log.h>
 
 #include "webrtc_ns/noise_suppressor.h"
+#include "ns_file.h"
+#include "ns_session.h"
 
 //添加日志输出
 #define LogD(...) __android_log_print(ANDROID_LOG_DEBUG,"WebRTC-NS" ,__VA_ARGS__)
@@ -17,16 +19,7 @@ JNIEXPORT jlong JNICALL
 Java_com_shetj_webrtc_ns_WebRtcNs_webRtcNsCreate(JNIEnv *env, jobject thiz, jint sampleRate,
                                                  jint num_channels, jint level) {
 
-    NsConfig cfg;
-    if (level == 0)
-        cfg.target_level = NsConfig::SuppressionLevel::k6dB;
-    else if (level == 1)
-        cfg.target_level = NsConfig::SuppressionLevel::k12dB;
-    else if (level == 2)
-        cfg.target_level = NsConfig::SuppressionLevel::k18dB;
-    else if (level == 3)
-        cfg.target_level = NsConfig::SuppressionLevel::k21dB;
-    auto ns = new NoiseSuppressor(cfg, sampleRate, num_channels);
+    auto ns = new NoiseSuppressor(NsConfigForLevel(level), sampleRate, num_channels);
     return (jlong) ns;
 }
 
@@ -121,7 +114,233 @@ Java_com_shetj_webrtc_ns_WebRtcNs_webRtcNsFree(JNIEnv *env, jobject thiz, jlong
     auto *ns = (NoiseSuppressor *) ns_handler;
     auto *audio = (AudioBuffer *) ab_handler;
     auto *stream_config = (StreamConfig *) sc_handler;
-    free(ns);
-    free(audio);
-    free(stream_config);
-}
\ No newline at end of file
+    // 三个对象都是 new 出来的，必须 delete 才会执行析构、释放内部的 vector 和重采样器
+    delete ns;
+    delete audio;
+    delete stream_config;
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_createSession(JNIEnv *env, jobject thiz, jint sample_rate,
+                                                jint num_channels, jint level) {
+
+    if (!SupportedRate(sample_rate) || num_channels <= 0) {
+        LogD("createSession: invalid sampleRate %d or num_channels %d", sample_rate, num_channels);
+        return 0;
+    }
+    auto *session = new NsSession(sample_rate, (size_t) num_channels, level);
+    return (jlong) session;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_processFrame(JNIEnv *env, jobject thiz, jlong handle,
+                                               jshortArray frame) {
+
+    auto *session = (NsSession *) handle;
+    if (session == nullptr) {
+        LogD("processFrame: session is NULL, call createSession first");
+        return -1;
+    }
+    jsize length = env->GetArrayLength(frame);
+    if ((size_t) length < session->FrameSize() * session->NumChannels()) {
+        LogD("processFrame: need %d samples, got %d",
+             (int) (session->FrameSize() * session->NumChannels()), (int) length);
+        return -1;
+    }
+    jshort *input = env->GetShortArrayElements(frame, NULL);
+    session->ProcessFrame(input);
+    env->ReleaseShortArrayElements(frame, input, 0);
+    return (jint) session->FrameSize();
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_processBuffer(JNIEnv *env, jobject thiz, jlong handle,
+                                                jobject buffer, jint num_frames) {
+
+    auto *session = (NsSession *) handle;
+    if (session == nullptr) {
+        LogD("processBuffer: session is NULL, call createSession first");
+        return -1;
+    }
+    // DirectByteBuffer 直接访问，不需要复制或 pin 数组
+    auto *data = (int16_t *) env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    jlong bytes = (jlong) num_frames * (jlong) session->NumChannels() * (jlong) sizeof(int16_t);
+    if (data == nullptr || num_frames < 0 || capacity < bytes) {
+        LogD("processBuffer: need a direct buffer of at least %lld bytes", (long long) bytes);
+        return -1;
+    }
+    session->ProcessBuffer(data, (size_t) num_frames);
+    return num_frames;
+}
+
+// NsFrameStats 按 3 个 float 直接写入 Java 的 FloatArray
+static_assert(sizeof(NsFrameStats) == 3 * sizeof(jfloat), "NsFrameStats must be 3 floats");
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_processFrameStats(JNIEnv *env, jobject thiz, jlong handle,
+                                                    jshortArray frame, jfloatArray stats) {
+
+    auto *session = (NsSession *) handle;
+    if (session == nullptr) {
+        LogD("processFrameStats: session is NULL, call createSession first");
+        return -1;
+    }
+    jsize length = env->GetArrayLength(frame);
+    jsize stats_length = env->GetArrayLength(stats);
+    if ((size_t) length < session->FrameSize() * session->NumChannels() ||
+        (size_t) stats_length < 3 * session->NumChannels()) {
+        LogD("processFrameStats: need %d samples and %d stats, got %d and %d",
+             (int) (session->FrameSize() * session->NumChannels()),
+             (int) (3 * session->NumChannels()), (int) length, (int) stats_length);
+        return -1;
+    }
+    jshort *input = env->GetShortArrayElements(frame, NULL);
+    jfloat *output = env->GetFloatArrayElements(stats, NULL);
+    session->ProcessFrame(input, (NsFrameStats *) output);
+    env->ReleaseFloatArrayElements(stats, output, 0);
+    env->ReleaseShortArrayElements(frame, input, 0);
+    return (jint) session->FrameSize();
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_processBufferStats(JNIEnv *env, jobject thiz, jlong handle,
+                                                     jobject buffer, jint num_frames,
+                                                     jfloatArray stats) {
+
+    auto *session = (NsSession *) handle;
+    if (session == nullptr) {
+        LogD("processBufferStats: session is NULL, call createSession first");
+        return -1;
+    }
+    auto *data = (int16_t *) env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    jlong bytes = (jlong) num_frames * (jlong) session->NumChannels() * (jlong) sizeof(int16_t);
+    if (data == nullptr || num_frames < 0 || capacity < bytes) {
+        LogD("processBufferStats: need a direct buffer of at least %lld bytes", (long long) bytes);
+        return -1;
+    }
+    // 本次最多凑满 num_frames / FrameSize() + 1 个 10ms 帧
+    jlong max_stats = ((jlong) num_frames / (jlong) session->FrameSize() + 1) * 3 *
+                      (jlong) session->NumChannels();
+    if (env->GetArrayLength(stats) < max_stats) {
+        LogD("processBufferStats: need %lld stats", (long long) max_stats);
+        return -1;
+    }
+    jfloat *output = env->GetFloatArrayElements(stats, NULL);
+    size_t processed = session->ProcessBuffer(data, (size_t) num_frames, (NsFrameStats *) output);
+    env->ReleaseFloatArrayElements(stats, output, 0);
+    return (jint) processed;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_processFrameFloat(JNIEnv *env, jobject thiz, jlong handle,
+                                                    jfloatArray frame) {
+
+    auto *session = (NsSession *) handle;
+    if (session == nullptr) {
+        LogD("processFrameFloat: session is NULL, call createSession first");
+        return -1;
+    }
+    jsize length = env->GetArrayLength(frame);
+    if ((size_t) length < session->FrameSize() * session->NumChannels()) {
+        LogD("processFrameFloat: need %d samples, got %d",
+             (int) (session->FrameSize() * session->NumChannels()), (int) length);
+        return -1;
+    }
+    jfloat *input = env->GetFloatArrayElements(frame, NULL);
+    session->ProcessFrame((float *) input);
+    env->ReleaseFloatArrayElements(frame, input, 0);
+    return (jint) session->FrameSize();
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_processBufferFloat(JNIEnv *env, jobject thiz, jlong handle,
+                                                     jobject buffer, jint num_frames) {
+
+    auto *session = (NsSession *) handle;
+    if (session == nullptr) {
+        LogD("processBufferFloat: session is NULL, call createSession first");
+        return -1;
+    }
+    auto *data = (float *) env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    jlong bytes = (jlong) num_frames * (jlong) session->NumChannels() * (jlong) sizeof(float);
+    if (data == nullptr || num_frames < 0 || capacity < bytes) {
+        LogD("processBufferFloat: need a direct buffer of at least %lld bytes", (long long) bytes);
+        return -1;
+    }
+    session->ProcessBuffer(data, (size_t) num_frames);
+    return num_frames;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_processBufferPlanar(JNIEnv *env, jobject thiz, jlong handle,
+                                                      jobject buffer, jint num_frames) {
+
+    auto *session = (NsSession *) handle;
+    if (session == nullptr) {
+        LogD("processBufferPlanar: session is NULL, call createSession first");
+        return -1;
+    }
+    auto *data = (float *) env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    jlong bytes = (jlong) num_frames * (jlong) session->NumChannels() * (jlong) sizeof(float);
+    if (data == nullptr || num_frames < 0 || capacity < bytes) {
+        LogD("processBufferPlanar: need a direct buffer of at least %lld bytes", (long long) bytes);
+        return -1;
+    }
+    // 各声道依次存放，每个声道 num_frames 个采样
+    session->ProcessBufferPlanar(data, (size_t) num_frames);
+    return num_frames;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_freeSession(JNIEnv *env, jobject thiz, jlong handle) {
+
+    auto *session = (NsSession *) handle;
+    delete session;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_setNumThreads(JNIEnv *env, jobject thiz, jlong handle,
+                                                jint num_threads) {
+
+    auto *session = (NsSession *) handle;
+    if (session == nullptr || num_threads <= 0) {
+        LogD("setNumThreads: invalid session or num_threads %d", num_threads);
+        return -1;
+    }
+    session->SetNumThreads((size_t) num_threads);
+    return (jint) session->NumThreads();
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_shetj_webrtc_ns_WebRtcNs_denoiseFile(JNIEnv *env, jobject thiz, jstring input_file,
+                                              jstring output_file, jint level, jint num_threads) {
+
+    if (input_file == nullptr || output_file == nullptr || num_threads < 0) {
+        LogD("denoiseFile: invalid file or num_threads %d", num_threads);
+        return kNsFileOpenFailed;
+    }
+    const char *in_path = env->GetStringUTFChars(input_file, NULL);
+    const char *out_path = env->GetStringUTFChars(output_file, NULL);
+    int result = DenoiseFile(in_path, out_path, level, (size_t) num_threads);
+    if (result != kNsFileOk) {
+        LogD("denoiseFile: %s -> %s failed: %d", in_path, out_path, result);
+    }
+    env->ReleaseStringUTFChars(input_file, in_path);
+    env->ReleaseStringUTFChars(output_file, out_path);
+    return result;
+}
@@ -0,0 +1,263 @@
+#include "ns_file.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "ns_session.h"
+#include "webrtc_ns/ns_thread_pool.h"
+
+namespace webrtc {
+
+    namespace {
+
+        const uint16_t kWavFormatPcm = 1;
+        const uint16_t kWavFormatExtensible = 0xFFFE;
+        const size_t kWavHeaderSize = 44;
+
+        uint16_t ReadLe16(const uint8_t *p) {
+            return (uint16_t) (p[0] | (p[1] << 8));
+        }
+
+        uint32_t ReadLe32(const uint8_t *p) {
+            return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) |
+                   ((uint32_t) p[3] << 24);
+        }
+
+        void WriteLe16(uint8_t *p, uint16_t v) {
+            p[0] = (uint8_t) v;
+            p[1] = (uint8_t) (v >> 8);
+        }
+
+        void WriteLe32(uint8_t *p, uint32_t v) {
+            WriteLe16(p, (uint16_t) v);
+            WriteLe16(p + 2, (uint16_t) (v >> 16));
+        }
+
+        struct FileCloser {
+            void operator()(FILE *f) const { fclose(f); }
+        };
+
+        typedef std::unique_ptr<FILE, FileCloser> FilePtr;
+
+        // 一段：[begin, end) 个 10ms 帧，预热从 warmup_begin 帧开始
+        struct Segment {
+            size_t warmup_begin;
+            size_t begin;
+            size_t end;
+            // 预热用的原始输入，处理前先拷出来，前一段会原地改写这部分数据
+            std::vector<int16_t> warmup;
+            // 输出前移降噪延迟后落在前一段范围内的开头几帧，前一段还要读这部分输入，
+            // 先暂存，各段都处理完再写回
+            std::vector<int16_t> head;
+        };
+
+    }  // namespace
+
+
+    int ReadWav(const char *path, WavData *wav) {
+        FilePtr file(fopen(path, "rb"));
+        if (!file) {
+            return kNsFileOpenFailed;
+        }
+        uint8_t riff[12];
+        if (fread(riff, 1, sizeof(riff), file.get()) != sizeof(riff)) {
+            return kNsFileBadFormat;
+        }
+        if (memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+            return kNsFileBadFormat;
+        }
+
+        bool have_format = false;
+        uint16_t format = 0, channels = 0, bits = 0;
+        uint32_t rate = 0;
+        uint8_t chunk[8];
+        // 依次跳过 fmt/data 以外的块（LIST、fact 等），块长度为奇数时有一个填充字节
+        while (fread(chunk, 1, sizeof(chunk), file.get()) == sizeof(chunk)) {
+            uint32_t size = ReadLe32(chunk + 4);
+            if (memcmp(chunk, "fmt ", 4) == 0) {
+                uint8_t fmt[40] = {0};
+                if (size < 16 || fread(fmt, 1, std::min<size_t>(size, sizeof(fmt)), file.get()) !=
+                                 std::min<size_t>(size, sizeof(fmt))) {
+                    return kNsFileBadFormat;
+                }
+                format = ReadLe16(fmt);
+                channels = ReadLe16(fmt + 2);
+                rate = ReadLe32(fmt + 4);
+                bits = ReadLe16(fmt + 14);
+                // WAVE_FORMAT_EXTENSIBLE 的实际格式在子格式 GUID 的前两个字节
+                if (format == kWavFormatExtensible && size >= 40) {
+                    format = ReadLe16(fmt + 24);
+                }
+                if (size > sizeof(fmt) && fseek(file.get(), (long) (size - sizeof(fmt)), SEEK_CUR) != 0) {
+                    return kNsFileBadFormat;
+                }
+                have_format = true;
+            } else if (memcmp(chunk, "data", 4) == 0) {
+                if (!have_format) {
+                    return kNsFileBadFormat;
+                }
+                if (format != kWavFormatPcm || bits != 16 || channels == 0 ||
+                    !SupportedRate((int) rate)) {
+                    return kNsFileUnsupported;
+                }
+                // 录音中断的文件 data 长度可能没写或偏大，不超过文件剩余长度
+                long begin = ftell(file.get());
+                if (begin < 0 || fseek(file.get(), 0, SEEK_END) != 0) {
+                    return kNsFileOpenFailed;
+                }
+                long end = ftell(file.get());
+                if (end < begin || fseek(file.get(), begin, SEEK_SET) != 0) {
+                    return kNsFileOpenFailed;
+                }
+                size_t bytes = std::min<size_t>(size, (size_t) (end - begin));
+                wav->sample_rate_hz = (int) rate;
+                wav->num_channels = channels;
+                wav->samples.resize(bytes / sizeof(int16_t));
+                size_t read = fread(wav->samples.data(), sizeof(int16_t), wav->samples.size(), file.get());
+                if (read < wav->samples.size()) {
+                    return kNsFileOpenFailed;
+                }
+                // 只保留完整的帧。采样按小端直接读入，Android 各 ABI 都是小端
+                wav->samples.resize(wav->NumFrames() * channels);
+                return kNsFileOk;
+            } else if (fseek(file.get(), (long) (size + (size & 1)), SEEK_CUR) != 0) {
+                return kNsFileBadFormat;
+            }
+        }
+        return kNsFileBadFormat;
+    }
+
+
+    int WriteWav(const char *path, const WavData &wav) {
+        const size_t data_bytes = wav.samples.size() * sizeof(int16_t);
+        if (data_bytes > 0xFFFFFFFFu - (kWavHeaderSize - 8)) {
+            return kNsFileWriteFailed;
+        }
+        uint8_t header[kWavHeaderSize];
+        const uint16_t block_align = (uint16_t) (wav.num_channels * sizeof(int16_t));
+        memcpy(header, "RIFF", 4);
+        WriteLe32(header + 4, (uint32_t) (kWavHeaderSize - 8 + data_bytes));
+        memcpy(header + 8, "WAVEfmt ", 8);
+        WriteLe32(header + 16, 16);
+        WriteLe16(header + 20, kWavFormatPcm);
+        WriteLe16(header + 22, (uint16_t) wav.num_channels);
+        WriteLe32(header + 24, (uint32_t) wav.sample_rate_hz);
+        WriteLe32(header + 28, (uint32_t) wav.sample_rate_hz * block_align);
+        WriteLe16(header + 32, block_align);
+        WriteLe16(header + 34, 16);
+        memcpy(header + 36, "data", 4);
+        WriteLe32(header + 40, (uint32_t) data_bytes);
+
+        FilePtr file(fopen(path, "wb"));
+        if (!file) {
+            return kNsFileWriteFailed;
+        }
+        if (fwrite(header, 1, sizeof(header), file.get()) != sizeof(header) ||
+            fwrite(wav.samples.data(), sizeof(int16_t), wav.samples.size(), file.get()) !=
+            wav.samples.size()) {
+            return kNsFileWriteFailed;
+        }
+        // 关闭时才写完缓冲，失败也要报告
+        return fclose(file.release()) == 0 ? kNsFileOk : kNsFileWriteFailed;
+    }
+
+
+    void DenoiseInterleaved(int16_t *data, size_t num_frames, int sample_rate_hz,
+                            size_t num_channels, int level, size_t num_threads,
+                            size_t warmup_blocks) {
+        const size_t frame_size = (size_t) sample_rate_hz / 100;
+        const size_t frame_samples = frame_size * num_channels;
+        const size_t num_blocks = (num_frames + frame_size - 1) / frame_size;
+        if (num_blocks == 0) {
+            return;
+        }
+        if (num_threads == 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // 按 kDenoisePhaseBlocks 的粒度尽量平均地分给各线程
+        const size_t num_units = (num_blocks + kDenoisePhaseBlocks - 1) / kDenoisePhaseBlocks;
+        const size_t num_segments = std::min(num_threads, num_units);
+        std::vector<Segment> segments(num_segments);
+        for (size_t i = 0; i < num_segments; ++i) {
+            Segment &segment = segments[i];
+            segment.begin = i * num_units / num_segments * kDenoisePhaseBlocks;
+            segment.end = std::min((i + 1) * num_units / num_segments * kDenoisePhaseBlocks, num_blocks);
+            size_t warmup = std::min(segment.begin, warmup_blocks);
+            segment.warmup_begin = (segment.begin - warmup) / kDenoisePhaseBlocks * kDenoisePhaseBlocks;
+            segment.warmup.assign(data + segment.warmup_begin * frame_samples,
+                                  data + segment.begin * frame_samples);
+        }
+
+        auto process_segment = [&](size_t index) {
+            Segment &segment = segments[index];
+            NsSession session(sample_rate_hz, num_channels, level);
+            // 预热：结果丢弃，只为了建立噪声估计等状态
+            for (size_t offset = 0; offset < segment.warmup.size(); offset += frame_samples) {
+                session.ProcessFrame(segment.warmup.data() + offset);
+            }
+            std::vector<int16_t>().swap(segment.warmup);
+
+            // 第 block 个 10ms 帧的输出对应输入的 [block * frame_size - delay, ...)，
+            // 最后一段多处理一个补零的帧，把最后 delay 帧输入的结果也送出来
+            const size_t delay = session.DelayFrames();
+            const size_t begin = segment.begin * frame_size;
+            const size_t head_begin = begin - std::min(delay, begin);
+            const size_t end = (index + 1 == segments.size()) ? segment.end + 1 : segment.end;
+            segment.head.resize((begin - head_begin) * num_channels);
+            std::vector<int16_t> frame(frame_samples);
+
+            for (size_t block = segment.begin; block < end; ++block) {
+                // 先把输入拷出来，输出写回的位置都在已读过的输入上
+                size_t first = block * frame_size;
+                size_t valid = first < num_frames ? std::min(frame_size, num_frames - first) : 0;
+                std::copy(data + first * num_channels, data + (first + valid) * num_channels, frame.begin());
+                std::fill(frame.begin() + valid * num_channels, frame.end(), 0);
+                session.ProcessFrame(frame.data());
+
+                // 输出帧 [first - delay, first + frame_size - delay) 中落在 [0, num_frames) 的部分
+                size_t skip = (first < delay) ? delay - first : 0;
+                size_t out = first + skip - delay;
+                size_t count = std::min(frame_size - skip, num_frames - std::min(out, num_frames));
+                const int16_t *src = frame.data() + skip * num_channels;
+                if (out < begin) {
+                    size_t n = std::min(count, begin - out);
+                    std::copy(src, src + n * num_channels,
+                              segment.head.begin() + (out - head_begin) * num_channels);
+                    src += n * num_channels;
+                    out += n;
+                    count -= n;
+                }
+                std::copy(src, src + count * num_channels, data + out * num_channels);
+            }
+        };
+
+        if (num_segments == 1) {
+            process_segment(0);
+        } else {
+            NsThreadPool pool(num_segments);
+            pool.ParallelFor(num_segments, process_segment);
+        }
+        for (const Segment &segment : segments) {
+            std::copy(segment.head.begin(), segment.head.end(),
+                      data + segment.begin * frame_samples - segment.head.size());
+        }
+    }
+
+
+    int DenoiseFile(const char *in_path, const char *out_path, int level, size_t num_threads) {
+        WavData wav;
+        int result = ReadWav(in_path, &wav);
+        if (result != kNsFileOk) {
+            return result;
+        }
+        DenoiseInterleaved(wav.samples.data(), wav.NumFrames(), wav.sample_rate_hz,
+                           wav.num_channels, level, num_threads);
+        return WriteWav(out_path, wav);
+    }
+
+}  // namespace webrtc
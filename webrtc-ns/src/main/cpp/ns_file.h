@@ -0,0 +1,65 @@
+#ifndef NS_FILE_H_
+#define NS_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace webrtc {
+
+    // DenoiseFile 的返回值
+    enum NsFileResult {
+        kNsFileOk = 0,
+        kNsFileOpenFailed = -1,     // 输入文件打不开或读取失败
+        kNsFileBadFormat = -2,      // 不是 RIFF/WAVE，或缺少 fmt/data 块
+        kNsFileUnsupported = -3,    // 不是 16bit PCM，或采样率不是 16/32/48kHz
+        kNsFileWriteFailed = -4     // 输出文件创建或写入失败
+    };
+
+    // 分段边界的粒度，单位 10ms 帧（10 秒）。取 kLongStartupPhaseBlocks 和
+    // kFeatureUpdateWindowSize 的公倍数，预热从该粒度的整数倍处开始，分位数噪声估计的
+    // 更新周期和特征直方图的统计窗口就与整段单遍处理对齐。
+    constexpr size_t kDenoisePhaseBlocks = 1000;
+
+    // 每段开始前至少用前面这么多个 10ms 帧预热降噪器，不少于 kLongStartupPhaseBlocks
+    constexpr size_t kDenoiseWarmupBlocks = 1000;
+
+    // 16bit PCM 的 WAV 文件内容，samples 为交错数据
+    struct WavData {
+        int sample_rate_hz = 0;
+        size_t num_channels = 0;
+        std::vector<int16_t> samples;
+
+        size_t NumFrames() const { return num_channels ? samples.size() / num_channels : 0; }
+    };
+
+    // 读 16bit PCM WAV，返回 NsFileResult
+    int ReadWav(const char *path, WavData *wav);
+
+    int WriteWav(const char *path, const WavData &wav);
+
+    // 离线整段降噪，原地处理 num_frames 帧交错数据，采样率须为 16/32/48kHz。
+    //
+    // 数据按 10ms 帧切成若干段，由 num_threads 个线程并行处理，每段一个独立的 NsSession。
+    // 除第一段外，每段先把前面至少 warmup_blocks 个 10ms 帧的原始输入送进降噪器并丢弃结果，
+    // 使噪声估计、语音概率模型和滤波器组状态接近单遍处理到该位置时的状态（warmup_blocks
+    // 为 0 时不预热，只用于对比）。
+    // 段边界和预热起点都是 kDenoisePhaseBlocks 的整数倍。num_threads 为 1 或数据不够分段时
+    // 就是单遍处理，结果与逐帧调用 NsSession::ProcessFrame 并去掉延迟完全一致。
+    //
+    // 降噪器本身的延迟（NsSession::DelayFrames）在这里补偿掉：末尾多处理一个补零的 10ms 帧，
+    // 输出整体前移 DelayFrames 帧，与输入对齐、等长，结尾的音频不会丢失。
+    // 不足 10ms 的尾部同样补零处理。
+    // num_threads 为 0 时使用 CPU 核数。
+    void DenoiseInterleaved(int16_t *data, size_t num_frames, int sample_rate_hz,
+                            size_t num_channels, int level, size_t num_threads,
+                            size_t warmup_blocks = kDenoiseWarmupBlocks);
+
+    // 读 WAV、DenoiseInterleaved、写 WAV，返回 NsFileResult。
+    // 输入输出可以是同一路径。
+    int DenoiseFile(const char *in_path, const char *out_path, int level, size_t num_threads);
+
+}  // namespace webrtc
+
+#endif  // NS_FILE_H_
@@ -0,0 +1,198 @@
+#include "ns_session.h"
+
+#include <algorithm>
+
+namespace webrtc {
+
+    NsConfig NsConfigForLevel(int level) {
+        NsConfig cfg;
+        if (level == 0)
+            cfg.target_level = NsConfig::SuppressionLevel::k6dB;
+        else if (level == 1)
+            cfg.target_level = NsConfig::SuppressionLevel::k12dB;
+        else if (level == 2)
+            cfg.target_level = NsConfig::SuppressionLevel::k18dB;
+        else if (level == 3)
+            cfg.target_level = NsConfig::SuppressionLevel::k21dB;
+        return cfg;
+    }
+
+
+    bool SupportedRate(int sample_rate_hz) {
+        return sample_rate_hz == 16000 || sample_rate_hz == 32000 || sample_rate_hz == 48000;
+    }
+
+
+    NsSession::NsSession(int sample_rate_hz, size_t num_channels, int level)
+            : stream_config_(sample_rate_hz, num_channels),
+              audio_(sample_rate_hz, num_channels,
+                     sample_rate_hz, num_channels,
+                     sample_rate_hz, num_channels),
+              ns_(NsConfigForLevel(level), sample_rate_hz, num_channels),
+              // 16kHz 以上需要分频带处理，采样率不会变，只判断一次
+              split_bands_(sample_rate_hz > 16000),
+              staging_(stream_config_.num_samples(), 0),
+              float_staging_(stream_config_.num_frames(), num_channels),
+              planar_channels_(num_channels, nullptr) {}
+
+
+    size_t NsSession::DelayFrames() const {
+        const size_t num_bands = FrameSize() / kNsFrameSize;
+        size_t delay = kOverlapSize * num_bands;
+        if (num_bands == 3) {
+            // ThreeBandFilterBank 分析和合成各 24 个采样
+            delay += 2 * 24;
+        }
+        return delay;
+    }
+
+
+    void NsSession::Suppress(NsFrameStats *stats) {
+        if (split_bands_) {
+            audio_.SplitIntoFrequencyBands();
+        }
+        ns_.Analyze(audio_);
+        ns_.Process(&audio_, stats);
+        if (split_bands_) {
+            audio_.MergeFrequencyBands();
+        }
+    }
+
+
+    void NsSession::ProcessFrame(int16_t *interleaved, NsFrameStats *stats) {
+        audio_.CopyFrom(interleaved, stream_config_);
+        Suppress(stats);
+        audio_.CopyTo(stream_config_, interleaved);
+    }
+
+
+    void NsSession::ProcessFrame(float *const *channels, NsFrameStats *stats) {
+        audio_.CopyFrom(channels, stream_config_);
+        Suppress(stats);
+        audio_.CopyTo(stream_config_, channels);
+    }
+
+
+    void NsSession::ProcessFrame(float *interleaved, NsFrameStats *stats) {
+        audio_.CopyFrom(interleaved, stream_config_);
+        Suppress(stats);
+        audio_.CopyTo(stream_config_, interleaved);
+    }
+
+
+    size_t NsSession::ProcessBuffer(int16_t *interleaved, size_t num_frames, NsFrameStats *stats) {
+        const size_t frame_size = FrameSize();
+        const size_t num_channels = NumChannels();
+        size_t processed = 0;
+
+        while (num_frames > 0) {
+            // 输入换入暂存帧，同位置上一帧的处理结果换出到输出
+            size_t count = std::min(frame_size - staged_, num_frames);
+            int16_t *staged = staging_.data() + staged_ * num_channels;
+            std::swap_ranges(interleaved, interleaved + count * num_channels, staged);
+
+            interleaved += count * num_channels;
+            num_frames -= count;
+            staged_ += count;
+
+            if (staged_ == frame_size) {
+                ProcessFrame(staging_.data(), stats ? stats + processed * num_channels : nullptr);
+                staged_ = 0;
+                ++processed;
+            }
+        }
+        return processed;
+    }
+
+
+    void NsSession::SetNumThreads(size_t num_threads) {
+        num_threads = std::min(num_threads, NumChannels());
+        if (num_threads == NumThreads()) {
+            return;
+        }
+        // 先解除 NoiseSuppressor 对旧线程池的引用再释放
+        ns_.SetThreadPool(nullptr);
+        thread_pool_.reset();
+        if (num_threads > 1) {
+            thread_pool_ = std::make_unique<NsThreadPool>(num_threads);
+            ns_.SetThreadPool(thread_pool_.get());
+        }
+    }
+
+
+    size_t NsSession::ProcessBuffer(float *interleaved, size_t num_frames, NsFrameStats *stats) {
+        const size_t frame_size = FrameSize();
+        const size_t num_channels = NumChannels();
+        float *const *staging = float_staging_.channels();
+        size_t processed = 0;
+
+        while (num_frames > 0) {
+            // 同 16bit 版本，交换时顺便在交错和平面格式之间转换
+            size_t count = std::min(frame_size - float_staged_, num_frames);
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t ch = 0; ch < num_channels; ++ch) {
+                    std::swap(interleaved[ch], staging[ch][float_staged_ + i]);
+                }
+                interleaved += num_channels;
+            }
+
+            num_frames -= count;
+            float_staged_ += count;
+
+            if (float_staged_ == frame_size) {
+                ProcessFrame(staging, stats ? stats + processed * num_channels : nullptr);
+                float_staged_ = 0;
+                ++processed;
+            }
+        }
+        return processed;
+    }
+
+
+    size_t NsSession::ProcessBuffer(float *const *channels, size_t num_frames, NsFrameStats *stats) {
+        const size_t frame_size = FrameSize();
+        const size_t num_channels = NumChannels();
+        float *const *staging = float_staging_.channels();
+        size_t offset = 0;
+        size_t processed = 0;
+
+        while (num_frames > 0) {
+            size_t count = std::min(frame_size - float_staged_, num_frames);
+            for (size_t ch = 0; ch < num_channels; ++ch) {
+                float *data = channels[ch] + offset;
+                std::swap_ranges(data, data + count, staging[ch] + float_staged_);
+            }
+
+            offset += count;
+            num_frames -= count;
+            float_staged_ += count;
+
+            if (float_staged_ == frame_size) {
+                ProcessFrame(staging, stats ? stats + processed * num_channels : nullptr);
+                float_staged_ = 0;
+                ++processed;
+            }
+        }
+        return processed;
+    }
+
+
+    size_t NsSession::ProcessBufferPlanar(float *data, size_t num_frames, NsFrameStats *stats) {
+        for (size_t ch = 0; ch < planar_channels_.size(); ++ch) {
+            planar_channels_[ch] = data + ch * num_frames;
+        }
+        return ProcessBuffer(planar_channels_.data(), num_frames, stats);
+    }
+
+
+    void NsSession::Reset() {
+        std::fill(staging_.begin(), staging_.end(), 0);
+        staged_ = 0;
+        for (size_t ch = 0; ch < NumChannels(); ++ch) {
+            std::fill(float_staging_.channels()[ch],
+                      float_staging_.channels()[ch] + FrameSize(), 0.f);
+        }
+        float_staged_ = 0;
+    }
+
+}  // namespace webrtc
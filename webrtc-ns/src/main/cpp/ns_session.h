@@ -0,0 +1,112 @@
+#ifndef NS_SESSION_H_
+#define NS_SESSION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "webrtc_ns/channel_buffer.h"
+#include "webrtc_ns/noise_suppressor.h"
+#include "webrtc_ns/ns_thread_pool.h"
+
+namespace webrtc {
+
+    // level: 0 = k6dB, 1 = k12dB, 2 = k18dB, 3 = k21dB，其他值使用默认值
+    NsConfig NsConfigForLevel(int level);
+
+    // 降噪器支持的采样率：16/32/48kHz。8kHz 和 44.1kHz 等其他采样率不能分频带处理，
+    // 创建会话前须先检查
+    bool SupportedRate(int sample_rate_hz);
+
+    // 一路降噪会话：持有 NoiseSuppressor、AudioBuffer、StreamConfig 和暂存帧，
+    // 按 10ms 帧做降噪。构造时分配好全部内存，处理过程中不再分配。
+    // 不依赖 JNI，JNI 入口和 host 端测试共用。
+    class NsSession {
+    public:
+        // sample_rate_hz 须满足 SupportedRate
+        NsSession(int sample_rate_hz, size_t num_channels, int level);
+
+        NsSession(const NsSession &) = delete;
+
+        NsSession &operator=(const NsSession &) = delete;
+
+        // 原地处理正好一个 10ms 帧（FrameSize() 帧）的交错数据。
+        // stats 不为空时写入该帧每个声道的统计（语音概率、信噪比、增益），共 NumChannels() 项
+        void ProcessFrame(int16_t *interleaved, NsFrameStats *stats = nullptr);
+
+        // 浮点版本，采样范围 [-1, 1]，省去 16bit 与浮点之间的转换。
+        // 平面格式：channels[c] 指向第 c 声道的 FrameSize() 个采样
+        void ProcessFrame(float *const *channels, NsFrameStats *stats = nullptr);
+
+        // 浮点交错格式
+        void ProcessFrame(float *interleaved, NsFrameStats *stats = nullptr);
+
+        // 原地处理任意长度的交错数据，num_frames 为帧数（每帧含全部声道）。
+        // 不足 10ms 的尾部暂存在内部，和下次调用的数据拼成整帧，
+        // 因此输出固定比输入晚一个 10ms 帧（前 LatencyFrames() 帧输出为静音）。
+        //
+        // 返回本次调用凑满并处理的 10ms 帧数，最多 num_frames / FrameSize() + 1。
+        // stats 不为空时按顺序写入这些帧的统计，每帧 NumChannels() 项
+        size_t ProcessBuffer(int16_t *interleaved, size_t num_frames, NsFrameStats *stats = nullptr);
+
+        // 浮点交错/平面格式的 ProcessBuffer，延迟相同。两种浮点格式共用一份暂存帧，
+        // 可以混用；暂存与 16bit 版本分开，同一会话不要混用 16bit 和浮点版本
+        size_t ProcessBuffer(float *interleaved, size_t num_frames, NsFrameStats *stats = nullptr);
+
+        size_t ProcessBuffer(float *const *channels, size_t num_frames, NsFrameStats *stats = nullptr);
+
+        // 各声道依次存放的平面数据（每个声道 num_frames 个采样），
+        // 声道指针使用构造时分配好的数组，不在处理时分配
+        size_t ProcessBufferPlanar(float *data, size_t num_frames, NsFrameStats *stats = nullptr);
+
+        // 10ms 帧的帧数
+        size_t FrameSize() const { return stream_config_.num_frames(); }
+
+        size_t NumChannels() const { return stream_config_.num_channels(); }
+
+        // ProcessBuffer 暂存带来的固定延迟，单位帧，降噪本身的延迟 DelayFrames() 另计
+        size_t LatencyFrames() const { return FrameSize(); }
+
+        // 降噪本身的固定延迟（每个频带的重叠相加，以及 48kHz 三频带滤波器组的线性相位延迟），
+        // 单位帧：16kHz 96、32kHz 192、48kHz 336。输出比输入晚这么多帧，与 ProcessFrame
+        // 还是 ProcessBuffer 无关。32kHz 的 QMF 是 IIR 全通滤波器，没有固定延迟（语音频段
+        // 约 4 帧），不计在内
+        size_t DelayFrames() const;
+
+        // 清空暂存数据，之后的 ProcessBuffer 重新从静音开始输出
+        void Reset();
+
+        // 多声道时把各声道的降噪分给 num_threads 个线程（含调用线程）并行处理，
+        // 输出与单线程逐位一致。num_threads 不超过声道数，1 为单线程（默认）。
+        // 线程池在这里创建，处理过程中不再创建线程。
+        void SetNumThreads(size_t num_threads);
+
+        size_t NumThreads() const { return thread_pool_ ? thread_pool_->NumThreads() : 1; }
+
+    private:
+        // 对 audio_ 中已拷入的一帧做分频带、降噪和合并
+        void Suppress(NsFrameStats *stats);
+
+        const StreamConfig stream_config_;
+        AudioBuffer audio_;
+        NoiseSuppressor ns_;
+        const bool split_bands_;
+        std::unique_ptr<NsThreadPool> thread_pool_;
+
+        // 暂存帧：前 staged_ 帧是尚未处理的输入，其余是上一帧的处理结果
+        std::vector<int16_t> staging_;
+        size_t staged_ = 0;
+
+        // 浮点 ProcessBuffer 的暂存帧，平面格式，含义同 staging_
+        ChannelBuffer<float> float_staging_;
+        size_t float_staged_ = 0;
+
+        // ProcessBufferPlanar 的声道指针
+        std::vector<float *> planar_channels_;
+    };
+
+}  // namespace webrtc
+
+#endif  // NS_SESSION_H_
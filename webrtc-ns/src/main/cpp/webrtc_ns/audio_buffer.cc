@@ -12,6 +12,7 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 
@@ -26,7 +27,6 @@ namespace webrtc {
 
         constexpr size_t kSamplesPer32kHzChannel = 320;
         constexpr size_t kSamplesPer48kHzChannel = 480;
-        constexpr size_t kMaxSamplesPerChannel = AudioBuffer::kMaxSampleRate / 100;
 
         size_t NumBandsFromFramesPerChannel(size_t num_frames) {
             if (num_frames == kSamplesPer32kHzChannel) {
@@ -75,7 +75,8 @@ namespace webrtc {
               num_bands_(NumBandsFromFramesPerChannel(buffer_num_frames_)),
               num_split_frames_(CheckedDivExact(buffer_num_frames_, num_bands_)),
               data_(
-                      new ChannelBuffer<float>(buffer_num_frames_, buffer_num_channels_)) {
+                      new ChannelBuffer<float>(buffer_num_frames_, buffer_num_channels_)),
+              scratch_(std::max(input_num_frames_, output_num_frames_)) {
         RTC_DCHECK_GT(input_num_frames_, 0);
         RTC_DCHECK_GT(buffer_num_frames_, 0);
         RTC_DCHECK_GT(output_num_frames_, 0);
@@ -130,9 +131,7 @@ namespace webrtc {
         const bool resampling_needed = input_num_frames_ != buffer_num_frames_;
 
         if (downmix_needed) {
-            RTC_DCHECK_GE(kMaxSamplesPerChannel, input_num_frames_);
-
-            std::array<float, kMaxSamplesPerChannel> downmix{};
+            float *const downmix = scratch_.data();
             if (downmix_by_averaging_) {
                 const float kOneByNumChannels = 1.f / input_num_channels_;
                 for (size_t i = 0; i < input_num_frames_; ++i) {
@@ -144,7 +143,7 @@ namespace webrtc {
                 }
             }
             const float *downmixed_data = downmix_by_averaging_
-                                          ? downmix.data()
+                                          ? downmix
                                           : stacked_data[channel_for_downmixing_];
 
             if (resampling_needed) {
@@ -197,6 +196,132 @@ namespace webrtc {
         }
     }
 
+    void AudioBuffer::CopyFrom(const float *const interleaved_data,
+                               const StreamConfig &stream_config) {
+        RTC_DCHECK_EQ(stream_config.num_channels(), input_num_channels_);
+        RTC_DCHECK_EQ(stream_config.num_frames(), input_num_frames_);
+        RestoreNumChannels();
+
+        const bool resampling_required = input_num_frames_ != buffer_num_frames_;
+
+        const float *interleaved = interleaved_data;
+        if (num_channels_ == 1 && input_num_channels_ > 1) {
+            float *const float_buffer = scratch_.data();
+            float *downmixed_data =
+                    resampling_required ? float_buffer : data_->channels()[0];
+            if (downmix_by_averaging_) {
+                const float kOneByNumChannels = 1.f / input_num_channels_;
+                for (size_t j = 0, k = 0; j < input_num_frames_; ++j) {
+                    float sum = 0.f;
+                    for (size_t i = 0; i < input_num_channels_; ++i, ++k) {
+                        sum += interleaved[k];
+                    }
+                    downmixed_data[j] = sum * kOneByNumChannels;
+                }
+            } else {
+                for (size_t j = 0, k = channel_for_downmixing_; j < input_num_frames_;
+                     ++j, k += input_num_channels_) {
+                    downmixed_data[j] = interleaved[k];
+                }
+            }
+
+            if (resampling_required) {
+                input_resamplers_[0]->Resample(downmixed_data, input_num_frames_,
+                                               data_->channels()[0],
+                                               buffer_num_frames_);
+            }
+            FloatToFloatS16(data_->channels()[0], buffer_num_frames_,
+                            data_->channels()[0]);
+        } else {
+            // Deinterleaves and scales to the S16 range in one pass.
+            auto deinterleave_channel = [](size_t channel, size_t num_channels,
+                                           size_t samples_per_channel, const float *x,
+                                           float *y) {
+                for (size_t j = 0, k = channel; j < samples_per_channel;
+                     ++j, k += num_channels) {
+                    y[j] = FloatToFloatS16(x[k]);
+                }
+            };
+
+            if (num_channels_ == 1 && !resampling_required) {
+                FloatToFloatS16(interleaved, input_num_frames_, data_->channels()[0]);
+            } else if (resampling_required) {
+                float *const float_buffer = scratch_.data();
+                for (size_t i = 0; i < num_channels_; ++i) {
+                    deinterleave_channel(i, num_channels_, input_num_frames_, interleaved,
+                                         float_buffer);
+                    input_resamplers_[i]->Resample(float_buffer, input_num_frames_,
+                                                   data_->channels()[i],
+                                                   buffer_num_frames_);
+                }
+            } else {
+                for (size_t i = 0; i < num_channels_; ++i) {
+                    deinterleave_channel(i, num_channels_, input_num_frames_, interleaved,
+                                         data_->channels()[i]);
+                }
+            }
+        }
+    }
+
+    void AudioBuffer::CopyTo(const StreamConfig &stream_config,
+                             float *const interleaved_data) {
+        const size_t config_num_channels = stream_config.num_channels();
+
+        RTC_DCHECK(config_num_channels == num_channels_ || num_channels_ == 1);
+        RTC_DCHECK_EQ(stream_config.num_frames(), output_num_frames_);
+
+        const bool resampling_required = buffer_num_frames_ != output_num_frames_;
+
+        float *interleaved = interleaved_data;
+        if (num_channels_ == 1) {
+            float *const float_buffer = scratch_.data();
+
+            if (resampling_required) {
+                output_resamplers_[0]->Resample(data_->channels()[0], buffer_num_frames_,
+                                                float_buffer, output_num_frames_);
+            }
+            const float *deinterleaved =
+                    resampling_required ? float_buffer : data_->channels()[0];
+
+            if (config_num_channels == 1) {
+                FloatS16ToFloat(deinterleaved, output_num_frames_, interleaved);
+            } else {
+                for (size_t i = 0, k = 0; i < output_num_frames_; ++i) {
+                    float tmp = FloatS16ToFloat(deinterleaved[i]);
+                    for (size_t j = 0; j < config_num_channels; ++j, ++k) {
+                        interleaved[k] = tmp;
+                    }
+                }
+            }
+        } else {
+            // Scales back to [-1, 1] and interleaves in one pass.
+            auto interleave_channel = [](size_t channel, size_t num_channels,
+                                         size_t samples_per_channel, const float *x,
+                                         float *y) {
+                for (size_t k = 0, j = channel; k < samples_per_channel;
+                     ++k, j += num_channels) {
+                    y[j] = FloatS16ToFloat(x[k]);
+                }
+            };
+
+            if (resampling_required) {
+                for (size_t i = 0; i < num_channels_; ++i) {
+                    float *const float_buffer = scratch_.data();
+                    output_resamplers_[i]->Resample(data_->channels()[i],
+                                                    buffer_num_frames_, float_buffer,
+                                                    output_num_frames_);
+                    interleave_channel(i, config_num_channels, output_num_frames_,
+                                       float_buffer, interleaved);
+                }
+            } else {
+                for (size_t i = 0; i < num_channels_; ++i) {
+                    interleave_channel(i, config_num_channels, output_num_frames_,
+                                       data_->channels()[i], interleaved);
+                }
+            }
+        }
+    }
+
     void AudioBuffer::CopyTo(AudioBuffer *buffer) const {
         RTC_DCHECK_EQ(buffer->num_frames(), output_num_frames_);
 
@@ -251,18 +376,18 @@ namespace webrtc {
         if (num_channels_ == 1) {
             if (input_num_channels_ == 1) {
                 if (resampling_required) {
-                    std::array<float, kMaxSamplesPerChannel> float_buffer{};
-                    S16ToFloatS16(interleaved, input_num_frames_, float_buffer.data());
-                    input_resamplers_[0]->Resample(float_buffer.data(), input_num_frames_,
+                    float *const float_buffer = scratch_.data();
+                    S16ToFloatS16(interleaved, input_num_frames_, float_buffer);
+                    input_resamplers_[0]->Resample(float_buffer, input_num_frames_,
                                                    data_->channels()[0],
                                                    buffer_num_frames_);
                 } else {
                     S16ToFloatS16(interleaved, input_num_frames_, data_->channels()[0]);
                 }
             } else {
-                std::array<float, kMaxSamplesPerChannel> float_buffer{};
+                float *const float_buffer = scratch_.data();
                 float *downmixed_data =
-                        resampling_required ? float_buffer.data() : data_->channels()[0];
+                        resampling_required ? float_buffer : data_->channels()[0];
                 if (downmix_by_averaging_) {
                     for (size_t j = 0, k = 0; j < input_num_frames_; ++j) {
                         int32_t sum = 0;
@@ -295,11 +420,11 @@ namespace webrtc {
             };
 
             if (resampling_required) {
-                std::array<float, kMaxSamplesPerChannel> float_buffer{};
+                float *const float_buffer = scratch_.data();
                 for (size_t i = 0; i < num_channels_; ++i) {
                     deinterleave_channel(i, num_channels_, input_num_frames_, interleaved,
-                                         float_buffer.data());
-                    input_resamplers_[i]->Resample(float_buffer.data(), input_num_frames_,
+                                         float_buffer);
+                    input_resamplers_[i]->Resample(float_buffer, input_num_frames_,
                                                    data_->channels()[i],
                                                    buffer_num_frames_);
                 }
@@ -323,14 +448,14 @@ namespace webrtc {
 
         int16_t *interleaved = interleaved_data;
         if (num_channels_ == 1) {
-            std::array<float, kMaxSamplesPerChannel> float_buffer{};
+            float *const float_buffer = scratch_.data();
 
             if (resampling_required) {
                 output_resamplers_[0]->Resample(data_->channels()[0], buffer_num_frames_,
-                                                float_buffer.data(), output_num_frames_);
+                                                float_buffer, output_num_frames_);
             }
             const float *deinterleaved =
-                    resampling_required ? float_buffer.data() : data_->channels()[0];
+                    resampling_required ? float_buffer : data_->channels()[0];
 
             if (config_num_channels == 1) {
                 for (size_t j = 0; j < output_num_frames_; ++j) {
@@ -356,12 +481,12 @@ namespace webrtc {
 
             if (resampling_required) {
                 for (size_t i = 0; i < num_channels_; ++i) {
-                    std::array<float, kMaxSamplesPerChannel> float_buffer{};
+                    float *const float_buffer = scratch_.data();
                     output_resamplers_[i]->Resample(data_->channels()[i],
-                                                    buffer_num_frames_, float_buffer.data(),
+                                                    buffer_num_frames_, float_buffer,
                                                     output_num_frames_);
                     interleave_channel(i, config_num_channels, output_num_frames_,
-                                       float_buffer.data(), interleaved);
+                                       float_buffer, interleaved);
                 }
             } else {
                 for (size_t i = 0; i < num_channels_; ++i) {
@@ -191,12 +191,17 @@ namespace webrtc {
         void CopyFrom(const float *const *stacked_data,
                       const StreamConfig &stream_config);
 
+        void CopyFrom(const float *const interleaved_data,
+                      const StreamConfig &stream_config);
+
         // Copies data from the buffer.
         void CopyTo(const StreamConfig &stream_config,
                     int16_t *const interleaved_data);
 
         void CopyTo(const StreamConfig &stream_config, float *const *stacked_data);
 
+        void CopyTo(const StreamConfig &stream_config, float *const interleaved_data);
+
         void CopyTo(AudioBuffer *buffer) const;
 
         // Splits the buffer data into frequency bands.
@@ -256,6 +261,10 @@ namespace webrtc {
         std::vector<std::unique_ptr<PushSincResampler>> output_resamplers_;
         bool downmix_by_averaging_ = true;
         size_t channel_for_downmixing_ = 0;
+        // Per-frame conversion scratch for one channel at the input or output
+        // rate, allocated once instead of zeroing a kMaxSampleRate / 100 stack
+        // array in every CopyFrom/CopyTo call.
+        std::vector<float> scratch_;
     };
 
 }  // namespace webrtc
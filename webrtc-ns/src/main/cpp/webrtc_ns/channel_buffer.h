@@ -11,10 +11,12 @@
 #ifndef COMMON_AUDIO_CHANNEL_BUFFER_H_
 #define COMMON_AUDIO_CHANNEL_BUFFER_H_
 
+#include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
 #include <memory>
-#include <vector>
+#include <new>
 
 #include "array_view.h"
 #include "audio_util.h"
@@ -27,6 +29,9 @@ namespace webrtc {
 // bands, with access to a pointer arrays of the deinterleaved channels and
 // bands. The buffer is zero initialized at creation.
 //
+// The data, the pointer arrays and the array views share one allocation, so a
+// buffer costs a single heap block however many channels and bands it has.
+//
 // The buffer structure is showed below for a 2 channel and 2 bands case:
 //
 // |data_|:
@@ -43,36 +48,44 @@ namespace webrtc {
     class ChannelBuffer {
     public:
         ChannelBuffer(size_t num_frames, size_t num_channels, size_t num_bands = 1)
-                : data_(new T[num_frames * num_channels]()),
-                  channels_(new T *[num_channels * num_bands]),
-                  bands_(new T *[num_channels * num_bands]),
-                  num_frames_(num_frames),
+                : num_frames_(num_frames),
                   num_frames_per_band_(num_frames / num_bands),
                   num_allocated_channels_(num_channels),
                   num_channels_(num_channels),
-                  num_bands_(num_bands),
-                  bands_view_(num_allocated_channels_,
-                              std::vector<rtc::ArrayView<T>>(num_bands_)),
-                  channels_view_(
-                          num_bands_,
-                          std::vector<rtc::ArrayView<T>>(num_allocated_channels_)) {
-            // Temporarily cast away const_ness to allow populating the array views.
-            auto *bands_view =
-                    const_cast<std::vector<std::vector<rtc::ArrayView<T>>> *>(&bands_view_);
-            auto *channels_view =
-                    const_cast<std::vector<std::vector<rtc::ArrayView<T>>> *>(
-                            &channels_view_);
+                  num_bands_(num_bands) {
+            // Layout of |storage_|: data, |channels_|, |bands_|, |channels_view_|
+            // and |bands_view_|. The data comes first and keeps the alignment of
+            // operator new.
+            const size_t num_pointers = num_channels * num_bands;
+            const size_t channels_offset =
+                    AlignUp(num_frames * num_channels * sizeof(T), alignof(T *));
+            const size_t bands_offset = channels_offset + num_pointers * sizeof(T *);
+            const size_t views_offset = AlignUp(bands_offset + num_pointers * sizeof(T *),
+                                                alignof(rtc::ArrayView<T>));
+            const size_t bands_view_offset =
+                    views_offset + num_pointers * sizeof(rtc::ArrayView<T>);
+            storage_.reset(
+                    new uint8_t[bands_view_offset + num_pointers * sizeof(rtc::ArrayView<T>)]);
+
+            data_ = reinterpret_cast<T *>(storage_.get());
+            channels_ = reinterpret_cast<T **>(storage_.get() + channels_offset);
+            bands_ = reinterpret_cast<T **>(storage_.get() + bands_offset);
+            channels_view_ =
+                    reinterpret_cast<rtc::ArrayView<T> *>(storage_.get() + views_offset);
+            bands_view_ =
+                    reinterpret_cast<rtc::ArrayView<T> *>(storage_.get() + bands_view_offset);
+            std::fill(data_, data_ + num_frames * num_channels, T());
 
             for (size_t ch = 0; ch < num_allocated_channels_; ++ch) {
                 for (size_t band = 0; band < num_bands_; ++band) {
-                    (*channels_view)[band][ch] = rtc::ArrayView<T>(
+                    rtc::ArrayView<T> view(
                             &data_[ch * num_frames_ + band * num_frames_per_band_],
                             num_frames_per_band_);
-                    (*bands_view)[ch][band] = channels_view_[band][ch];
-                    channels_[band * num_allocated_channels_ + ch] =
-                            channels_view_[band][ch].data();
-                    bands_[ch * num_bands_ + band] =
-                            channels_[band * num_allocated_channels_ + ch];
+                    new(&channels_view_[band * num_allocated_channels_ + ch])
+                            rtc::ArrayView<T>(view);
+                    new(&bands_view_[ch * num_bands_ + band]) rtc::ArrayView<T>(view);
+                    channels_[band * num_allocated_channels_ + ch] = view.data();
+                    bands_[ch * num_bands_ + band] = view.data();
                 }
             }
         }
@@ -101,11 +114,13 @@ namespace webrtc {
         }
 
         rtc::ArrayView<const rtc::ArrayView<T>> channels_view(size_t band = 0) {
-            return channels_view_[band];
+            return rtc::ArrayView<const rtc::ArrayView<T>>(
+                    &channels_view_[band * num_allocated_channels_], num_allocated_channels_);
         }
 
         rtc::ArrayView<const rtc::ArrayView<T>> channels_view(size_t band = 0) const {
-            return channels_view_[band];
+            return rtc::ArrayView<const rtc::ArrayView<T>>(
+                    &channels_view_[band * num_allocated_channels_], num_allocated_channels_);
         }
 
         // Returns a pointer array to the bands for a specific channel.
@@ -127,11 +142,13 @@ namespace webrtc {
         }
 
         rtc::ArrayView<const rtc::ArrayView<T>> bands_view(size_t channel) {
-            return bands_view_[channel];
+            return rtc::ArrayView<const rtc::ArrayView<T>>(&bands_view_[channel * num_bands_],
+                                                           num_bands_);
         }
 
         rtc::ArrayView<const rtc::ArrayView<T>> bands_view(size_t channel) const {
-            return bands_view_[channel];
+            return rtc::ArrayView<const rtc::ArrayView<T>>(&bands_view_[channel * num_bands_],
+                                                           num_bands_);
         }
 
         // Sets the |slice| pointers to the |start_frame| position for each channel.
@@ -165,13 +182,14 @@ namespace webrtc {
 
         void SetDataForTesting(const T *data, size_t size) {
             RTC_CHECK_EQ(size, this->size());
-            memcpy(data_.get(), data, size * sizeof(*data));
+            memcpy(data_, data, size * sizeof(*data));
         }
 
     private:
-        std::unique_ptr<T[]> data_;
-        std::unique_ptr<T *[]> channels_;
-        std::unique_ptr<T *[]> bands_;
+        static size_t AlignUp(size_t offset, size_t alignment) {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+
         const size_t num_frames_;
         const size_t num_frames_per_band_;
         // Number of channels the internal buffer holds.
@@ -179,8 +197,14 @@ namespace webrtc {
         // Number of channels the user sees.
         size_t num_channels_;
         const size_t num_bands_;
-        const std::vector<std::vector<rtc::ArrayView<T>>> bands_view_;
-        const std::vector<std::vector<rtc::ArrayView<T>>> channels_view_;
+        std::unique_ptr<uint8_t[]> storage_;
+        T *data_;
+        T **channels_;
+        T **bands_;
+        // |num_bands_| rows of |num_allocated_channels_| views.
+        rtc::ArrayView<T> *channels_view_;
+        // |num_allocated_channels_| rows of |num_bands_| views.
+        rtc::ArrayView<T> *bands_view_;
     };
 
 }  // namespace webrtc
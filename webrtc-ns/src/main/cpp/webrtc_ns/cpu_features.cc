@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Parts of this file derived from Chromium's base/cpu.cc.
+
+#include "cpu_features_wrapper.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include <cpuid.h>
+#include <stdint.h>
+#endif
+
+namespace webrtc {
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    namespace {
+
+        // Reads the extended control register 0, which tells which register
+        // states the OS saves on a context switch.
+        uint64_t xgetbv(uint32_t xcr) {
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(xcr));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+        }
+
+    }  // namespace
+#endif
+
+    int WebRtc_GetCPUInfo(CPUFeature feature) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return 0;
+        }
+        if (feature == kSSE2) {
+            return 0 != (edx & 0x04000000);
+        }
+        if (feature == kSSE3) {
+            return 0 != (ecx & 0x00000001);
+        }
+        if (feature == kFMA3) {
+            return 0 != (ecx & 0x00001000);
+        }
+        if (feature == kAVX2) {
+            // AVX2 needs the OSXSAVE and AVX bits, the OS saving the XMM and YMM
+            // states, and the AVX2 bit of leaf 7.
+            constexpr unsigned int kOsXsaveAndAvx = 0x08000000 | 0x10000000;
+            if ((ecx & kOsXsaveAndAvx) != kOsXsaveAndAvx || (xgetbv(0) & 6) != 6) {
+                return 0;
+            }
+            unsigned int eax7 = 0, ebx7 = 0, ecx7 = 0, edx7 = 0;
+            if (!__get_cpuid_count(7, 0, &eax7, &ebx7, &ecx7, &edx7)) {
+                return 0;
+            }
+            return 0 != (ebx7 & 0x00000020);
+        }
+#endif
+        (void) feature;
+        return 0;
+    }
+
+}  // namespace webrtc
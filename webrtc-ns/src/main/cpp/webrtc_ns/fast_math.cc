@@ -58,7 +58,11 @@ namespace webrtc {
     }
 
     void LogApproximation(rtc::ArrayView<const float> x, rtc::ArrayView<float> y) {
-        for (size_t k = 0; k < x.size(); ++k) {
+        size_t k = 0;
+        for (; k + 4 <= x.size(); k += 4) {
+            Store4(&y[k], LogApproximation(Load4(&x[k])));
+        }
+        for (; k < x.size(); ++k) {
             y[k] = LogApproximation(x[k]);
         }
     }
@@ -69,14 +73,22 @@ namespace webrtc {
     }
 
     void ExpApproximation(rtc::ArrayView<const float> x, rtc::ArrayView<float> y) {
-        for (size_t k = 0; k < x.size(); ++k) {
+        size_t k = 0;
+        for (; k + 4 <= x.size(); k += 4) {
+            Store4(&y[k], ExpApproximation(Load4(&x[k])));
+        }
+        for (; k < x.size(); ++k) {
             y[k] = ExpApproximation(x[k]);
         }
     }
 
     void ExpApproximationSignFlip(rtc::ArrayView<const float> x,
                                   rtc::ArrayView<float> y) {
-        for (size_t k = 0; k < x.size(); ++k) {
+        size_t k = 0;
+        for (; k + 4 <= x.size(); k += 4) {
+            Store4(&y[k], ExpApproximation(Sub4(Set4(0.f), Load4(&x[k]))));
+        }
+        for (; k < x.size(); ++k) {
             y[k] = ExpApproximation(-x[k]);
         }
     }
@@ -12,6 +12,7 @@
 #define MODULES_AUDIO_PROCESSING_NS_FAST_MATH_H_
 
 #include "array_view.h"
+#include "ns_simd.h"
 
 namespace webrtc {
 
@@ -36,6 +37,50 @@ namespace webrtc {
 
     void ExpApproximationSignFlip(rtc::ArrayView<const float> x,
                                   rtc::ArrayView<float> y);
+
+// 4-wide versions of the approximations for the per-bin loops. The log is
+// computed exactly as the scalar version; 2^x uses a polynomial instead of
+// powf, with a relative error below 2e-7.
+    inline Float4 Log2Approximation(Float4 x) {
+        // See FastLog2f in fast_math.cc.
+        return Sub4(Mul4(BitsToFloat4(x), Set4(1.1920929e-7f)), Set4(126.942695f));
+    }
+
+    inline Float4 LogApproximation(Float4 x) {
+        constexpr float kLogOf2 = 0.69314718056f;
+        return Mul4(Log2Approximation(x), Set4(kLogOf2));
+    }
+
+    inline Float4 Pow2Approximation(Float4 p) {
+        // 2^p = 2^n * 2^f with the integer n nearest to p and |f| <= 1/2. 2^n is
+        // formed from two halves to cover the denormal and overflow ranges.
+        p = Min4(Max4(p, Set4(-252.f)), Set4(254.f));
+        const Float4 n = Floor4(Add4(p, Set4(0.5f)));
+        const Float4 f = Sub4(p, n);
+        Float4 poly = Set4(1.535336188319500e-4f);
+        poly = Add4(Mul4(poly, f), Set4(1.339887440266574e-3f));
+        poly = Add4(Mul4(poly, f), Set4(9.618437357674640e-3f));
+        poly = Add4(Mul4(poly, f), Set4(5.550332471162809e-2f));
+        poly = Add4(Mul4(poly, f), Set4(2.402264791363012e-1f));
+        poly = Add4(Mul4(poly, f), Set4(6.931472028550421e-1f));
+        poly = Add4(Mul4(poly, f), Set4(1.f));
+        const Float4 n1 = Floor4(Mul4(n, Set4(0.5f)));
+        return Mul4(Mul4(poly, Pow2Int4(n1)), Pow2Int4(Sub4(n, n1)));
+    }
+
+    inline Float4 PowApproximation(Float4 x, Float4 p) {
+        return Pow2Approximation(Mul4(p, Log2Approximation(x)));
+    }
+
+    inline Float4 ExpApproximation(Float4 x) {
+        // Same base conversion as the scalar version, including the error of
+        // FastLog2f(10).
+        constexpr float kLog10Ofe = 0.4342944819f;
+        // FastLog2f(10.f): the bits of 10.f are 130.25 * 2^23.
+        constexpr float kFastLog2Of10 = 130.25f - 126.942695f;
+        return Pow2Approximation(
+                Mul4(Mul4(x, Set4(kLog10Ofe)), Set4(kFastLog2Of10)));
+    }
 }  // namespace webrtc
 
 #endif  // MODULES_AUDIO_PROCESSING_NS_FAST_MATH_H_
@@ -13,6 +13,7 @@
 #include <algorithm>
 
 #include "fast_math.h"
+#include "ns_simd.h"
 #include "checks.h"
 
 namespace webrtc {
@@ -65,18 +66,24 @@ namespace webrtc {
         if (num_analyzed_frames < kShortStartupPhaseBlocks) {
             // Compute simplified noise model during startup.
             const size_t kStartBand = 5;
-            float sum_log_i_log_magn = 0.f;
-            float sum_log_i = 0.f;
-            float sum_log_i_square = 0.f;
-            float sum_log_magn = 0.f;
-            for (size_t i = kStartBand; i < kFftSizeBy2Plus1; ++i) {
-                float log_i = log_table[i];
-                sum_log_i += log_i;
-                sum_log_i_square += log_i * log_i;
-                float log_signal = LogApproximation(signal_spectrum[i]);
-                sum_log_magn += log_signal;
-                sum_log_i_log_magn += log_i * log_signal;
+            static_assert((kFftSizeBy2Plus1 - kStartBand) % 4 == 0, "");
+            Float4 sum_log_i_log_magn4 = Set4(0.f);
+            Float4 sum_log_i4 = Set4(0.f);
+            Float4 sum_log_i_square4 = Set4(0.f);
+            Float4 sum_log_magn4 = Set4(0.f);
+            for (size_t i = kStartBand; i < kFftSizeBy2Plus1; i += 4) {
+                const Float4 log_i = Load4(&log_table[i]);
+                sum_log_i4 = Add4(sum_log_i4, log_i);
+                sum_log_i_square4 = Add4(sum_log_i_square4, Mul4(log_i, log_i));
+                const Float4 log_signal = LogApproximation(Load4(&signal_spectrum[i]));
+                sum_log_magn4 = Add4(sum_log_magn4, log_signal);
+                sum_log_i_log_magn4 =
+                        Add4(sum_log_i_log_magn4, Mul4(log_i, log_signal));
             }
+            float sum_log_i_log_magn = Sum4(sum_log_i_log_magn4);
+            float sum_log_i = Sum4(sum_log_i4);
+            float sum_log_i_square = Sum4(sum_log_i_square4);
+            float sum_log_magn = Sum4(sum_log_magn4);
 
             // Estimate the parameter for the level of the white noise.
             constexpr float kOneByFftSizeBy2Plus1 = 1.f / kFftSizeBy2Plus1;
@@ -120,18 +127,31 @@ namespace webrtc {
 
             constexpr float kOneByShortStartupPhaseBlocks =
                     1.f / kShortStartupPhaseBlocks;
-            for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
-                // Estimate the background noise using the white and pink noise
-                // parameters.
-                if (pink_noise_exp_ == 0.f) {
-                    // Use white noise estimate.
-                    parametric_noise_spectrum_[i] = white_noise_level_;
-                } else {
-                    // Use pink noise estimate.
-                    float use_band = i < kStartBand ? kStartBand : i;
-                    float denom = PowApproximation(use_band, parametric_exp);
-                    RTC_DCHECK_NE(denom, 0.f);
-                    parametric_noise_spectrum_[i] = parametric_num / denom;
+            if (pink_noise_exp_ == 0.f) {
+                // Use white noise estimate.
+                parametric_noise_spectrum_.fill(white_noise_level_);
+            } else {
+                // Use pink noise estimate.
+                const float denom = PowApproximation(kStartBand, parametric_exp);
+                RTC_DCHECK_NE(denom, 0.f);
+                std::fill(parametric_noise_spectrum_.begin(),
+                          parametric_noise_spectrum_.begin() + kStartBand,
+                          parametric_num / denom);
+
+                const Float4 exp4 = Set4(parametric_exp);
+                const Float4 num4 = Set4(parametric_num);
+                const Float4 step = Set4(4.f);
+                const float first_bands[4] = {kStartBand, kStartBand + 1,
+                                              kStartBand + 2, kStartBand + 3};
+                Float4 band = Load4(first_bands);
+                size_t i = kStartBand;
+                for (; i + 4 <= kFftSizeBy2Plus1; i += 4, band = Add4(band, step)) {
+                    Store4(&parametric_noise_spectrum_[i],
+                           Div4(num4, PowApproximation(band, exp4)));
+                }
+                for (; i < kFftSizeBy2Plus1; ++i) {
+                    parametric_noise_spectrum_[i] =
+                            parametric_num / PowApproximation(i, parametric_exp);
                 }
             }
 
@@ -152,8 +172,53 @@ namespace webrtc {
         // Time-avg parameter for noise_spectrum update.
         constexpr float kNoiseUpdate = 0.9f;
 
-        float gamma = kNoiseUpdate;
-        for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+        // Increase gamma for frame likely to be seech.
+        constexpr float kProbRange = .2f;
+
+        // The time constant of a bin follows from the speech probability of the
+        // previous bin; the first bin uses kNoiseUpdate.
+        const float first_probs[4] = {0.f, speech_probability[0],
+                                      speech_probability[1], speech_probability[2]};
+        const Float4 prob_range = Set4(kProbRange);
+        const Float4 noise_update = Set4(kNoiseUpdate);
+        const Float4 speech_update = Set4(.99f);
+        size_t i = 0;
+        for (; i + 4 <= kFftSizeBy2Plus1; i += 4) {
+            const Float4 prob_speech = Load4(&speech_probability[i]);
+            const Float4 prob_speech_prev =
+                    i == 0 ? Load4(first_probs) : Load4(&speech_probability[i - 1]);
+            const Float4 gamma_old = Select4(Greater4(prob_speech_prev, prob_range),
+                                             speech_update, noise_update);
+            const Float4 gamma = Select4(Greater4(prob_speech, prob_range),
+                                         speech_update, noise_update);
+            const Float4 signal = Load4(&signal_spectrum[i]);
+            const Float4 prev_noise = Load4(&prev_noise_spectrum_[i]);
+            const Float4 mix = Add4(Mul4(Sub4(Set4(1.f), prob_speech), signal),
+                                    Mul4(prob_speech, prev_noise));
+
+            const Float4 noise_update_tmp =
+                    Add4(Mul4(gamma_old, prev_noise),
+                         Mul4(Sub4(Set4(1.f), gamma_old), mix));
+
+            // Conservative noise_spectrum update.
+            const Float4 conservative = Load4(&conservative_noise_spectrum_[i]);
+            Store4(&conservative_noise_spectrum_[i],
+                   Select4(Less4(prob_speech, prob_range),
+                           Add4(conservative,
+                                Mul4(Set4(0.05f), Sub4(signal, conservative))),
+                           conservative));
+
+            // Noise_spectrum update, allowing downwards updates when the time
+            // constant changes.
+            const Float4 noise = Add4(Mul4(gamma, prev_noise),
+                                      Mul4(Sub4(Set4(1.f), gamma), mix));
+            Store4(&noise_spectrum_[i],
+                   Select4(Equal4(gamma, gamma_old), noise_update_tmp,
+                           Min4(noise, noise_update_tmp)));
+        }
+
+        float gamma = speech_probability[i - 1] > kProbRange ? .99f : kNoiseUpdate;
+        for (; i < kFftSizeBy2Plus1; ++i) {
             const float prob_speech = speech_probability[i];
             const float prob_non_speech = 1.f - prob_speech;
 
@@ -167,8 +232,6 @@ namespace webrtc {
             // Time-constant based on speech/noise_spectrum state.
             float gamma_old = gamma;
 
-            // Increase gamma for frame likely to be seech.
-            constexpr float kProbRange = .2f;
             gamma = prob_speech > kProbRange ? .99f : kNoiseUpdate;
 
             // Conservative noise_spectrum update.
@@ -14,8 +14,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <algorithm>
+#include <new>
 
 #include "fast_math.h"
+#include "ns_profile.h"
+#include "ns_simd.h"
 #include "checks.h"
 
 namespace webrtc {
@@ -163,7 +166,23 @@ namespace webrtc {
                         rtc::ArrayView<const float> noise_spectrum,
                         rtc::ArrayView<float> prior_snr,
                         rtc::ArrayView<float> post_snr) {
-            for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+            size_t i = 0;
+            for (; i + 4 <= kFftSizeBy2Plus1; i += 4) {
+                const Float4 prev_estimate =
+                        Mul4(Div4(Load4(&prev_signal_spectrum[i]),
+                                  Add4(Load4(&prev_noise_spectrum[i]), Set4(0.0001f))),
+                             Load4(&filter[i]));
+                const Float4 signal = Load4(&signal_spectrum[i]);
+                const Float4 noise = Load4(&noise_spectrum[i]);
+                const Float4 post = Select4(
+                        Greater4(signal, noise),
+                        Sub4(Div4(signal, Add4(noise, Set4(0.0001f))), Set4(1.f)),
+                        Set4(0.f));
+                Store4(&post_snr[i], post);
+                Store4(&prior_snr[i], Add4(Mul4(Set4(0.98f), prev_estimate),
+                                           Mul4(Set4(1.f - 0.98f), post)));
+            }
+            for (; i < kFftSizeBy2Plus1; ++i) {
                 // Previous post SNR.
                 // Previous estimate: based on previous frame with gain filter.
                 float prev_estimate = prev_signal_spectrum[i] /
@@ -228,10 +247,10 @@ namespace webrtc {
     }  // namespace
     NoiseSuppressor::ChannelState::ChannelState(
             const SuppressionParams &suppression_params,
-            size_t num_bands)
+            rtc::ArrayView<std::array<float, kOverlapSize>> delay_memory)
             : wiener_filter(suppression_params),
               noise_estimator(suppression_params),
-              process_delay_memory(num_bands > 1 ? num_bands - 1 : 0) {
+              process_delay_memory(delay_memory) {
         analyze_analysis_memory.fill(0.f);
         prev_analysis_signal_spectrum.fill(1.f);
         process_analysis_memory.fill(0.f);
@@ -250,22 +269,39 @@ namespace webrtc {
               filter_bank_states_heap_(NumChannelsOnHeap(num_channels_)),
               upper_band_gains_heap_(NumChannelsOnHeap(num_channels_)),
               energies_before_filtering_heap_(NumChannelsOnHeap(num_channels_)),
-              gain_adjustments_heap_(NumChannelsOnHeap(num_channels_)),
-              channels_(num_channels_) {
+              gain_adjustments_heap_(NumChannelsOnHeap(num_channels_)) {
+        using DelayMemory = std::array<float, kOverlapSize>;
+        const size_t num_delay_memories = num_bands_ > 1 ? num_bands_ - 1 : 0;
+        const size_t states_size = num_channels_ * sizeof(ChannelState);
+        channel_storage_.reset(static_cast<uint8_t *>(AlignedMalloc(
+                states_size + num_channels_ * num_delay_memories * sizeof(DelayMemory),
+                alignof(ChannelState))));
+        auto *states = reinterpret_cast<ChannelState *>(channel_storage_.get());
+        auto *delay_memories =
+                reinterpret_cast<DelayMemory *>(channel_storage_.get() + states_size);
         for (size_t ch = 0; ch < num_channels_; ++ch) {
-            channels_[ch] =
-                    std::make_unique<ChannelState>(suppression_params_, num_bands_);
+            new(&states[ch]) ChannelState(
+                    suppression_params_,
+                    rtc::ArrayView<DelayMemory>(&delay_memories[ch * num_delay_memories],
+                                                num_delay_memories));
+        }
+        channels_ = rtc::ArrayView<ChannelState>(states, num_channels_);
+    }
+
+    NoiseSuppressor::~NoiseSuppressor() {
+        for (ChannelState &channel: channels_) {
+            channel.~ChannelState();
         }
     }
 
     void NoiseSuppressor::AggregateWienerFilters(
             rtc::ArrayView<float, kFftSizeBy2Plus1> filter) const {
         rtc::ArrayView<const float, kFftSizeBy2Plus1> filter0 =
-                channels_[0]->wiener_filter.get_filter();
+                channels_[0].wiener_filter.get_filter();
         std::copy(filter0.begin(), filter0.end(), filter.begin());
         for (size_t ch = 1; ch < num_channels_; ++ch) {
             rtc::ArrayView<const float, kFftSizeBy2Plus1> filter_ch =
-                    channels_[ch]->wiener_filter.get_filter();
+                    channels_[ch].wiener_filter.get_filter();
             for (size_t k = 0; k < kFftSizeBy2Plus1; ++k) {
                 filter[k] = std::min(filter[k], filter_ch[k]);
             }
@@ -275,7 +311,7 @@ namespace webrtc {
     void NoiseSuppressor::Analyze(const AudioBuffer &audio) {
         // Prepare the noise estimator for the analysis stage.
         for (size_t ch = 0; ch < num_channels_; ++ch) {
-            channels_[ch]->noise_estimator.PrepareAnalysis();
+            channels_[ch].noise_estimator.PrepareAnalysis();
         }
         // Check for zero frames.
         bool zero_frame = true;
@@ -283,7 +319,7 @@ namespace webrtc {
             rtc::ArrayView<const float, kNsFrameSize> y_band0(
                     &audio.split_bands_const(ch)[0][0], kNsFrameSize);
             float energy = ComputeEnergyOfExtendedFrame(
-                    y_band0, channels_[ch]->analyze_analysis_memory);
+                    y_band0, channels_[ch].analyze_analysis_memory);
             if (energy > 0.f) {
                 zero_frame = false;
                 break;
@@ -305,13 +341,14 @@ namespace webrtc {
             num_analyzed_frames_ = 0;
         }
         // Analyze all channels.
-        for (size_t ch = 0; ch < num_channels_; ++ch) {
-            std::unique_ptr<ChannelState> &ch_p = channels_[ch];
+        auto analyze_channel = [&](size_t ch) {
+            NS_PROFILE_START(timer);
+            ChannelState &ch_p = channels_[ch];
             rtc::ArrayView<const float, kNsFrameSize> y_band0(
                     &audio.split_bands_const(ch)[0][0], kNsFrameSize);
             // Form an extended frame and apply analysis filter bank windowing.
             std::array<float, kFftSize> extended_frame;
-            FormExtendedFrame(y_band0, ch_p->analyze_analysis_memory, extended_frame);
+            FormExtendedFrame(y_band0, ch_p.analyze_analysis_memory, extended_frame);
             ApplyFilterBankWindow(extended_frame);
             // Compute the magnitude spectrum.
             std::array<float, kFftSize> real;
@@ -329,30 +366,36 @@ namespace webrtc {
             for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
                 signal_spectral_sum += signal_spectrum[i];
             }
+            NS_PROFILE_LAP(timer, kAnalysisFft);
             // Estimate the noise spectra and the probability estimates of speech
             // presence.
-            ch_p->noise_estimator.PreUpdate(num_analyzed_frames_, signal_spectrum,
+            ch_p.noise_estimator.PreUpdate(num_analyzed_frames_, signal_spectrum,
                                             signal_spectral_sum);
+            NS_PROFILE_LAP(timer, kNoiseEstimate);
             std::array<float, kFftSizeBy2Plus1> post_snr;
             std::array<float, kFftSizeBy2Plus1> prior_snr;
-            ComputeSnr(ch_p->wiener_filter.get_filter(),
-                       ch_p->prev_analysis_signal_spectrum, signal_spectrum,
-                       ch_p->noise_estimator.get_prev_noise_spectrum(),
-                       ch_p->noise_estimator.get_noise_spectrum(), prior_snr, post_snr);
-            ch_p->speech_probability_estimator.Update(
+            ComputeSnr(ch_p.wiener_filter.get_filter(),
+                       ch_p.prev_analysis_signal_spectrum, signal_spectrum,
+                       ch_p.noise_estimator.get_prev_noise_spectrum(),
+                       ch_p.noise_estimator.get_noise_spectrum(), prior_snr, post_snr);
+            NS_PROFILE_LAP(timer, kSnr);
+            ch_p.speech_probability_estimator.Update(
                     num_analyzed_frames_, prior_snr, post_snr,
-                    ch_p->noise_estimator.get_conservative_noise_spectrum(),
+                    ch_p.noise_estimator.get_conservative_noise_spectrum(),
                     signal_spectrum, signal_spectral_sum, signal_energy);
-            ch_p->noise_estimator.PostUpdate(
-                    ch_p->speech_probability_estimator.get_probability(), signal_spectrum);
+            NS_PROFILE_LAP(timer, kSpeechProbability);
+            ch_p.noise_estimator.PostUpdate(
+                    ch_p.speech_probability_estimator.get_probability(), signal_spectrum);
             // Store the magnitude spectrum to make it avalilable for the process
             // method.
             std::copy(signal_spectrum.begin(), signal_spectrum.end(),
-                      ch_p->prev_analysis_signal_spectrum.begin());
-        }
+                      ch_p.prev_analysis_signal_spectrum.begin());
+            NS_PROFILE_LAP(timer, kNoiseUpdate);
+        };
+        ForEachChannel(analyze_channel);
     }
 
-    void NoiseSuppressor::Process(AudioBuffer *audio) {
+    void NoiseSuppressor::Process(AudioBuffer *audio, NsFrameStats *stats) {
         // Select the space for storing data during the processing.
         std::array<FilterBankState, kMaxNumChannelsOnStack> filter_bank_states_stack;
         rtc::ArrayView<FilterBankState> filter_bank_states(
@@ -379,11 +422,12 @@ namespace webrtc {
                     rtc::ArrayView<float>(gain_adjustments_heap_.data(), num_channels_);
         }
         // Compute the suppression filters for all channels.
-        for (size_t ch = 0; ch < num_channels_; ++ch) {
+        auto compute_filter = [&](size_t ch) {
+            NS_PROFILE_START(timer);
             // Form an extended frame and apply analysis filter bank windowing.
             rtc::ArrayView<float, kNsFrameSize> y_band0(&audio->split_bands(ch)[0][0],
                                                         kNsFrameSize);
-            FormExtendedFrame(y_band0, channels_[ch]->process_analysis_memory,
+            FormExtendedFrame(y_band0, channels_[ch].process_analysis_memory,
                               filter_bank_states[ch].extended_frame);
             ApplyFilterBankWindow(filter_bank_states[ch].extended_frame);
             energies_before_filtering[ch] =
@@ -394,49 +438,64 @@ namespace webrtc {
             std::array<float, kFftSizeBy2Plus1> signal_spectrum;
             ComputeMagnitudeSpectrum(filter_bank_states[ch].real,
                                      filter_bank_states[ch].imag, signal_spectrum);
+            NS_PROFILE_LAP(timer, kProcessFft);
             // Compute the frequency domain gain filter for noise attenuation.
-            channels_[ch]->wiener_filter.Update(
+            channels_[ch].wiener_filter.Update(
                     num_analyzed_frames_,
-                    channels_[ch]->noise_estimator.get_noise_spectrum(),
-                    channels_[ch]->noise_estimator.get_prev_noise_spectrum(),
-                    channels_[ch]->noise_estimator.get_parametric_noise_spectrum(),
+                    channels_[ch].noise_estimator.get_noise_spectrum(),
+                    channels_[ch].noise_estimator.get_prev_noise_spectrum(),
+                    channels_[ch].noise_estimator.get_parametric_noise_spectrum(),
                     signal_spectrum);
             if (num_bands_ > 1) {
                 // Compute the time-domain gain for attenuating the noise in the upper
                 // bands.
                 upper_band_gains[ch] = ComputeUpperBandsGain(
                         suppression_params_.minimum_attenuating_gain,
-                        channels_[ch]->wiener_filter.get_filter(),
-                        channels_[ch]->speech_probability_estimator.get_probability(),
-                        channels_[ch]->prev_analysis_signal_spectrum, signal_spectrum);
+                        channels_[ch].wiener_filter.get_filter(),
+                        channels_[ch].speech_probability_estimator.get_probability(),
+                        channels_[ch].prev_analysis_signal_spectrum, signal_spectrum);
             }
-        }
+            if (stats != nullptr) {
+                rtc::ArrayView<const float, kFftSizeBy2Plus1> noise_spectrum =
+                        channels_[ch].noise_estimator.get_noise_spectrum();
+                float signal_energy = 0.f;
+                float noise_energy = 0.f;
+                for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+                    signal_energy += signal_spectrum[i] * signal_spectrum[i];
+                    noise_energy += noise_spectrum[i] * noise_spectrum[i];
+                }
+                stats[ch].speech_probability =
+                        channels_[ch].speech_probability_estimator.get_prior_probability();
+                stats[ch].snr_db =
+                        10.f * log10f((signal_energy + 1.f) / (noise_energy + 1.f));
+                stats[ch].gain = 1.f;
+            }
+            NS_PROFILE_LAP(timer, kWienerFilter);
+        };
+        ForEachChannel(compute_filter);
         // Only do the below processing if the output of the audio processing module
         // is used.
         if (!capture_output_used_) {
             return;
         }
+        NS_PROFILE_START(timer);
         // Aggregate the Wiener filters for all channels.
         std::array<float, kFftSizeBy2Plus1> filter_data;
         rtc::ArrayView<const float, kFftSizeBy2Plus1> filter = filter_data;
         if (num_channels_ == 1) {
-            filter = channels_[0]->wiener_filter.get_filter();
+            filter = channels_[0].wiener_filter.get_filter();
         } else {
             AggregateWienerFilters(filter_data);
         }
-        for (size_t ch = 0; ch < num_channels_; ++ch) {
+        auto synthesize_channel = [&](size_t ch) {
             // Apply the filter to the lower band.
             for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
                 filter_bank_states[ch].real[i] *= filter[i];
                 filter_bank_states[ch].imag[i] *= filter[i];
             }
-        }
-        // Perform filter bank synthesis
-        for (size_t ch = 0; ch < num_channels_; ++ch) {
+            // Perform filter bank synthesis
             fft_.Ifft(filter_bank_states[ch].real, filter_bank_states[ch].imag,
                       filter_bank_states[ch].extended_frame);
-        }
-        for (size_t ch = 0; ch < num_channels_; ++ch) {
             const float energy_after_filtering =
                     ComputeEnergyOfExtendedFrame(filter_bank_states[ch].extended_frame);
             // Apply synthesis window.
@@ -444,17 +503,28 @@ namespace webrtc {
             // Compute the adjustment of the noise attenuation filter based on the
             // effect of the attenuation.
             gain_adjustments[ch] =
-                    channels_[ch]->wiener_filter.ComputeOverallScalingFactor(
+                    channels_[ch].wiener_filter.ComputeOverallScalingFactor(
                             num_analyzed_frames_,
-                            channels_[ch]->speech_probability_estimator.get_prior_probability(),
+                            channels_[ch].speech_probability_estimator.get_prior_probability(),
                             energies_before_filtering[ch], energy_after_filtering);
-        }
+            if (stats != nullptr) {
+                // Completed by the common gain adjustment below.
+                stats[ch].gain = sqrtf(energy_after_filtering /
+                                       (energies_before_filtering[ch] + 1.f));
+            }
+        };
+        ForEachChannel(synthesize_channel);
         // Select and apply adjustment of the noise attenuation filter based on the
         // effect of the attenuation.
         float gain_adjustment = gain_adjustments[0];
         for (size_t ch = 1; ch < num_channels_; ++ch) {
             gain_adjustment = std::min(gain_adjustment, gain_adjustments[ch]);
         }
+        if (stats != nullptr) {
+            for (size_t ch = 0; ch < num_channels_; ++ch) {
+                stats[ch].gain *= gain_adjustment;
+            }
+        }
         for (size_t ch = 0; ch < num_channels_; ++ch) {
             for (size_t i = 0; i < kFftSize; ++i) {
                 filter_bank_states[ch].extended_frame[i] =
@@ -466,7 +536,7 @@ namespace webrtc {
             rtc::ArrayView<float, kNsFrameSize> y_band0(&audio->split_bands(ch)[0][0],
                                                         kNsFrameSize);
             OverlapAndAdd(filter_bank_states[ch].extended_frame,
-                          channels_[ch]->process_synthesis_memory, y_band0);
+                          channels_[ch].process_synthesis_memory, y_band0);
         }
         if (num_bands_ > 1) {
             // Select the noise attenuating gain to apply to the upper band.
@@ -482,7 +552,7 @@ namespace webrtc {
                     rtc::ArrayView<float, kNsFrameSize> y_band(
                             &audio->split_bands(ch)[b][0], kNsFrameSize);
                     std::array<float, kNsFrameSize> delayed_frame;
-                    DelaySignal(y_band, channels_[ch]->process_delay_memory[b - 1],
+                    DelaySignal(y_band, channels_[ch].process_delay_memory[b - 1],
                                 delayed_frame);
                     // Apply the time-domain noise-attenuating gain.
                     for (size_t j = 0; j < kNsFrameSize; j++) {
@@ -501,5 +571,6 @@ namespace webrtc {
                 }
             }
         }
+        NS_PROFILE_LAP(timer, kSynthesis);
     }
 } // namespace webrtc
\ No newline at end of file
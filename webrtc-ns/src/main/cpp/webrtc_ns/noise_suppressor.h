@@ -14,29 +14,47 @@
 #include <memory>
 #include <vector>
 
+#include "aligned_malloc.h"
 #include "array_view.h"
 #include "audio_buffer.h"
 #include "noise_estimator.h"
 #include "ns_common.h"
 #include "ns_config.h"
 #include "ns_fft.h"
+#include "ns_thread_pool.h"
 #include "speech_probability_estimator.h"
 #include "wiener_filter.h"
 
 namespace webrtc {
+// Per-frame statistics of the noise suppression of one channel, for voice
+// activity and silence decisions without a separate detector.
+    struct NsFrameStats {
+        // Prior speech probability of the frame in [0, 1], the frame level
+        // decision the suppressor itself uses. Smoothed over about 10 frames.
+        float speech_probability;
+        // A posteriori SNR of the lowest band in dB: energy of the input
+        // spectrum over the estimated noise spectrum. About 0 dB in noise.
+        float snr_db;
+        // Amplitude gain applied to the lowest band, including the overall
+        // scaling factor. 1 when the capture output is not used.
+        float gain;
+    };
+
 // Class for suppressing noise in a signal.
     class NoiseSuppressor {
     public:
         NoiseSuppressor(const NsConfig& config,
                         size_t sample_rate_hz,
                         size_t num_channels);
+        ~NoiseSuppressor();
         NoiseSuppressor(const NoiseSuppressor&) = delete;
         NoiseSuppressor& operator=(const NoiseSuppressor&) = delete;
         // Analyses the signal (typically applied before the AEC to avoid analyzing
         // any comfort noise signal).
         void Analyze(const AudioBuffer& audio);
-        // Applies noise suppression.
-        void Process(AudioBuffer* audio);
+        // Applies noise suppression. If |stats| is not null, also writes the
+        // statistics of the frame to |stats[ch]| for every channel.
+        void Process(AudioBuffer* audio, NsFrameStats* stats = nullptr);
         // Specifies whether the capture output will be used. The purpose of this is
         // to allow the noise suppressor to deactivate some of the processing when the
         // resulting output is anyway not used, for instance when the endpoint is
@@ -44,6 +62,12 @@ namespace webrtc {
         void SetCaptureOutputUsage(bool capture_output_used) {
             capture_output_used_ = capture_output_used;
         }
+        // Distributes the per-channel work of Analyze and Process over
+        // |thread_pool|, which is not owned and may be null for serial
+        // processing. The output is bit-exact with the serial processing.
+        void SetThreadPool(NsThreadPool* thread_pool) {
+            thread_pool_ = thread_pool;
+        }
 
     private:
         const size_t num_bands_;
@@ -52,8 +76,13 @@ namespace webrtc {
         int32_t num_analyzed_frames_ = -1;
         NrFft fft_;
         bool capture_output_used_ = true;
-        struct ChannelState {
-            ChannelState(const SuppressionParams& suppression_params, size_t num_bands);
+        NsThreadPool* thread_pool_ = nullptr;
+        // Cache line aligned, so that channels processed on different threads
+        // do not share cache lines.
+        struct alignas(64) ChannelState {
+            ChannelState(
+                    const SuppressionParams& suppression_params,
+                    rtc::ArrayView<std::array<float, kOverlapSize>> delay_memory);
             SpeechProbabilityEstimator speech_probability_estimator;
             WienerFilter wiener_filter;
             NoiseEstimator noise_estimator;
@@ -61,7 +90,8 @@ namespace webrtc {
             std::array<float, kFftSize - kNsFrameSize> analyze_analysis_memory;
             std::array<float, kOverlapSize> process_analysis_memory;
             std::array<float, kOverlapSize> process_synthesis_memory;
-            std::vector<std::array<float, kOverlapSize>> process_delay_memory;
+            // One memory per upper band, stored after the channel states.
+            rtc::ArrayView<std::array<float, kOverlapSize>> process_delay_memory;
         };
         struct FilterBankState {
             std::array<float, kFftSize> real;
@@ -72,10 +102,25 @@ namespace webrtc {
         std::vector<float> upper_band_gains_heap_;
         std::vector<float> energies_before_filtering_heap_;
         std::vector<float> gain_adjustments_heap_;
-        std::vector<std::unique_ptr<ChannelState>> channels_;
+        // The states of all channels followed by their delay memories, in one
+        // allocation: a stream's state is a single contiguous block.
+        std::unique_ptr<uint8_t, AlignedFreeDeleter> channel_storage_;
+        rtc::ArrayView<ChannelState> channels_;
         // Aggregates the Wiener filters into a single filter to use.
         void AggregateWienerFilters(
                 rtc::ArrayView<float, kFftSizeBy2Plus1> filter) const;
+        // Calls |body(ch)| for every channel, on the thread pool if there is one.
+        // Returns when all channels are done.
+        template <typename Body>
+        void ForEachChannel(Body& body) {
+            if (thread_pool_ != nullptr && num_channels_ > 1) {
+                thread_pool_->ParallelFor(num_channels_, body);
+            } else {
+                for (size_t ch = 0; ch < num_channels_; ++ch) {
+                    body(ch);
+                }
+            }
+        }
     };
 }  // namespace webrtc
 
@@ -10,6 +10,8 @@
 
 #include "ns_fft.h"
 
+#if defined(WEBRTC_NS_OOURA_FFT)
+
 #include "fft4g.h"
 
 namespace webrtc {
@@ -62,3 +64,247 @@ namespace webrtc {
     }
 
 }  // namespace webrtc
+
+#else  // !defined(WEBRTC_NS_OOURA_FFT)
+
+#include <math.h>
+#include <stdint.h>
+
+#include <array>
+
+#include "ns_simd.h"
+
+namespace webrtc {
+
+    namespace {
+
+        // The real 256 point FFT is computed as a complex FFT of this size on
+        // the even samples as real and the odd samples as imaginary parts.
+        constexpr size_t kCfftSize = kFftSize / 2;
+
+        // Like the Ooura rdft, the forward transform uses the kernel
+        // e^(+2 pi i n k / N), i.e. the imaginary parts have the opposite sign
+        // of the usual DFT definition.
+        struct FftTables {
+            // Bit reversed 7 bit indices.
+            std::array<uint8_t, kCfftSize> bit_reversal;
+            // Twiddles of the radix-2 stage with butterfly span h at [h, 2h):
+            // e^(+2 pi i j / (2 h)), j < h.
+            std::array<float, kCfftSize> stage_cos;
+            std::array<float, kCfftSize> stage_sin;
+            // Twiddles of the real split: e^(+2 pi i k / kFftSize), k <= kCfftSize.
+            std::array<float, kFftSizeBy2Plus1> split_cos;
+            std::array<float, kFftSizeBy2Plus1> split_sin;
+
+            FftTables() {
+                for (size_t n = 0; n < kCfftSize; ++n) {
+                    size_t r = 0;
+                    for (size_t b = 1; b < kCfftSize; b <<= 1) {
+                        r = (r << 1) | ((n & b) ? 1 : 0);
+                    }
+                    bit_reversal[n] = static_cast<uint8_t>(r);
+                }
+                stage_cos[0] = 1.f;
+                stage_sin[0] = 0.f;
+                for (size_t h = 1; h < kCfftSize; h <<= 1) {
+                    for (size_t j = 0; j < h; ++j) {
+                        const double phase = M_PI * j / h;
+                        stage_cos[h + j] = static_cast<float>(cos(phase));
+                        stage_sin[h + j] = static_cast<float>(sin(phase));
+                    }
+                }
+                for (size_t k = 0; k < kFftSizeBy2Plus1; ++k) {
+                    const double phase = 2.0 * M_PI * k / kFftSize;
+                    split_cos[k] = static_cast<float>(cos(phase));
+                    split_sin[k] = static_cast<float>(sin(phase));
+                }
+            }
+        };
+
+        const FftTables &Tables() {
+            static const FftTables tables;
+            return tables;
+        }
+
+        // In-place 128 point complex FFT of bit reversed input, with the kernel
+        // e^(+2 pi i n k / N), or e^(-2 pi i n k / N) if |kInverse|. Unscaled.
+        template<bool kInverse>
+        void ComplexFft(const FftTables &t, float *re, float *im) {
+            // The first two radix-2 stages as one radix-4 pass, where the only
+            // twiddles are 1 and +-i.
+            for (size_t b = 0; b < kCfftSize; b += 4) {
+                const float r0 = re[b] + re[b + 1];
+                const float i0 = im[b] + im[b + 1];
+                const float r1 = re[b] - re[b + 1];
+                const float i1 = im[b] - im[b + 1];
+                const float r2 = re[b + 2] + re[b + 3];
+                const float i2 = im[b + 2] + im[b + 3];
+                // (b + 2) - (b + 3) multiplied by +i, or -i for the inverse
+                const float r3 = kInverse ? im[b + 2] - im[b + 3] : im[b + 3] - im[b + 2];
+                const float i3 = kInverse ? re[b + 3] - re[b + 2] : re[b + 2] - re[b + 3];
+                re[b] = r0 + r2;
+                im[b] = i0 + i2;
+                re[b + 2] = r0 - r2;
+                im[b + 2] = i0 - i2;
+                re[b + 1] = r1 + r3;
+                im[b + 1] = i1 + i3;
+                re[b + 3] = r1 - r3;
+                im[b + 3] = i1 - i3;
+            }
+
+            // The remaining stages have at least 4 butterflies with consecutive
+            // twiddles per block.
+            for (size_t h = 4; h < kCfftSize; h <<= 1) {
+                for (size_t b = 0; b < kCfftSize; b += 2 * h) {
+                    for (size_t j = 0; j < h; j += 4) {
+                        const Float4 wr = Load4(&t.stage_cos[h + j]);
+                        const Float4 wi = Load4(&t.stage_sin[h + j]);
+                        const Float4 cr = Load4(re + b + h + j);
+                        const Float4 ci = Load4(im + b + h + j);
+                        Float4 tr, ti;
+                        if (kInverse) {
+                            tr = Add4(Mul4(cr, wr), Mul4(ci, wi));
+                            ti = Sub4(Mul4(ci, wr), Mul4(cr, wi));
+                        } else {
+                            tr = Sub4(Mul4(cr, wr), Mul4(ci, wi));
+                            ti = Add4(Mul4(ci, wr), Mul4(cr, wi));
+                        }
+                        const Float4 ar = Load4(re + b + j);
+                        const Float4 ai = Load4(im + b + j);
+                        Store4(re + b + j, Add4(ar, tr));
+                        Store4(im + b + j, Add4(ai, ti));
+                        Store4(re + b + h + j, Sub4(ar, tr));
+                        Store4(im + b + h + j, Sub4(ai, ti));
+                    }
+                }
+            }
+        }
+
+    }  // namespace
+
+    NrFft::NrFft() {
+        // Build the tables up front rather than in the first frame.
+        Tables();
+    }
+
+    void NrFft::Fft(rtc::ArrayView<float, kFftSize> time_data,
+                    rtc::ArrayView<float, kFftSize> real,
+                    rtc::ArrayView<float, kFftSize> imag) {
+        const FftTables &t = Tables();
+        alignas(16) float re[kCfftSize];
+        alignas(16) float im[kCfftSize];
+
+        for (size_t n = 0; n < kCfftSize; ++n) {
+            re[t.bit_reversal[n]] = time_data[2 * n];
+            im[t.bit_reversal[n]] = time_data[2 * n + 1];
+        }
+        ComplexFft<false>(t, re, im);
+
+        // Split the spectrum Z of the even/odd samples into the spectrum of the
+        // real signal: with A = Z[k] and B = conj(Z[N - k]), the spectra of the
+        // even and odd samples are E = (A + B) / 2 and O = -i (A - B) / 2, and
+        // X[k] = E + e^(+2 pi i k / kFftSize) O.
+        real[0] = re[0] + im[0];
+        imag[0] = 0.f;
+        real[kCfftSize] = re[0] - im[0];
+        imag[kCfftSize] = 0.f;
+
+        const Float4 half = Set4(0.5f);
+        size_t k = 1;
+        for (; k + 4 <= kCfftSize; k += 4) {
+            const Float4 ar = Load4(re + k);
+            const Float4 ai = Load4(im + k);
+            const Float4 br = Reverse4(Load4(re + kCfftSize - k - 3));
+            const Float4 bi = Reverse4(Load4(im + kCfftSize - k - 3));
+            // B is conjugated: its imaginary part enters with the opposite sign
+            const Float4 er = Mul4(Add4(ar, br), half);
+            const Float4 ei = Mul4(Sub4(ai, bi), half);
+            const Float4 orr = Mul4(Add4(ai, bi), half);
+            const Float4 oi = Mul4(Sub4(br, ar), half);
+            const Float4 wr = Load4(&t.split_cos[k]);
+            const Float4 wi = Load4(&t.split_sin[k]);
+            Store4(&real[k], Add4(er, Sub4(Mul4(wr, orr), Mul4(wi, oi))));
+            Store4(&imag[k], Add4(ei, Add4(Mul4(wr, oi), Mul4(wi, orr))));
+        }
+        for (; k < kCfftSize; ++k) {
+            const float ar = re[k];
+            const float ai = im[k];
+            const float br = re[kCfftSize - k];
+            const float bi = im[kCfftSize - k];
+            const float er = 0.5f * (ar + br);
+            const float ei = 0.5f * (ai - bi);
+            const float orr = 0.5f * (ai + bi);
+            const float oi = 0.5f * (br - ar);
+            real[k] = er + t.split_cos[k] * orr - t.split_sin[k] * oi;
+            imag[k] = ei + t.split_cos[k] * oi + t.split_sin[k] * orr;
+        }
+    }
+
+    void NrFft::Ifft(rtc::ArrayView<const float> real,
+                     rtc::ArrayView<const float> imag,
+                     rtc::ArrayView<float> time_data) {
+        const FftTables &t = Tables();
+        alignas(16) float zr[kCfftSize];
+        alignas(16) float zi[kCfftSize];
+        alignas(16) float re[kCfftSize];
+        alignas(16) float im[kCfftSize];
+
+        // Inverse of the split: with A = X[k] and B = conj(X[N - k]),
+        // E = (A + B) / 2, O = e^(-2 pi i k / kFftSize) (A - B) / 2 and the
+        // spectrum of the even/odd sample pairs is Z = E + i O. The 1 / N
+        // scaling of the inverse transform is applied here as well. The
+        // imaginary parts of the DC and Nyquist bins are ignored.
+        constexpr float kScaling = 0.5f / kCfftSize;
+        zr[0] = kScaling * (real[0] + real[kCfftSize]);
+        zi[0] = kScaling * (real[0] - real[kCfftSize]);
+
+        const Float4 scaling = Set4(kScaling);
+        size_t k = 1;
+        for (; k + 4 <= kCfftSize; k += 4) {
+            const Float4 ar = Load4(&real[k]);
+            const Float4 ai = Load4(&imag[k]);
+            const Float4 br = Reverse4(Load4(&real[kCfftSize - k - 3]));
+            const Float4 bi = Reverse4(Load4(&imag[kCfftSize - k - 3]));
+            const Float4 er = Add4(ar, br);
+            const Float4 ei = Sub4(ai, bi);
+            const Float4 dr = Sub4(ar, br);
+            const Float4 di = Add4(ai, bi);
+            const Float4 wr = Load4(&t.split_cos[k]);
+            const Float4 wi = Load4(&t.split_sin[k]);
+            const Float4 orr = Add4(Mul4(dr, wr), Mul4(di, wi));
+            const Float4 oi = Sub4(Mul4(di, wr), Mul4(dr, wi));
+            Store4(zr + k, Mul4(Sub4(er, oi), scaling));
+            Store4(zi + k, Mul4(Add4(ei, orr), scaling));
+        }
+        for (; k < kCfftSize; ++k) {
+            const float ar = real[k];
+            const float ai = imag[k];
+            const float br = real[kCfftSize - k];
+            const float bi = imag[kCfftSize - k];
+            const float er = ar + br;
+            const float ei = ai - bi;
+            const float dr = ar - br;
+            const float di = ai + bi;
+            const float orr = dr * t.split_cos[k] + di * t.split_sin[k];
+            const float oi = di * t.split_cos[k] - dr * t.split_sin[k];
+            zr[k] = kScaling * (er - oi);
+            zi[k] = kScaling * (ei + orr);
+        }
+
+        for (size_t n = 0; n < kCfftSize; ++n) {
+            re[t.bit_reversal[n]] = zr[n];
+            im[t.bit_reversal[n]] = zi[n];
+        }
+        ComplexFft<true>(t, re, im);
+
+        for (size_t n = 0; n < kCfftSize; n += 4) {
+            const Float4 r = Load4(re + n);
+            const Float4 i = Load4(im + n);
+            Store4(&time_data[2 * n], InterleaveLo4(r, i));
+            Store4(&time_data[2 * n + 4], InterleaveHi4(r, i));
+        }
+    }
+
+}  // namespace webrtc
+
+#endif  // defined(WEBRTC_NS_OOURA_FFT)
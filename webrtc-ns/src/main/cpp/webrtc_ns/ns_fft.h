@@ -19,6 +19,13 @@
 namespace webrtc {
 
 // Wrapper class providing 256 point FFT functionality.
+//
+// The transform is a 128 point complex FFT specialized for the fixed size,
+// vectorized with NEON/SSE2 (see ns_simd.h), plus the real split step that
+// writes the real and imaginary parts of the 129 bins straight to |real| and
+// |imag|. The result matches the layout and scaling of the Ooura rdft in
+// fft4g.cc, which is used instead when WEBRTC_NS_OOURA_FFT is defined. The
+// transforms keep no state, so one instance may be used from several threads.
     class NrFft {
     public:
         NrFft();
@@ -37,9 +44,11 @@ namespace webrtc {
                   rtc::ArrayView<const float> imag,
                   rtc::ArrayView<float> time_data);
 
+#if defined(WEBRTC_NS_OOURA_FFT)
     private:
         std::vector<size_t> bit_reversal_state_;
         std::vector<float> tables_;
+#endif
     };
 
 }  // namespace webrtc
@@ -0,0 +1,75 @@
+#ifndef MODULES_AUDIO_PROCESSING_NS_NS_PROFILE_H_
+#define MODULES_AUDIO_PROCESSING_NS_NS_PROFILE_H_
+
+// NoiseSuppressor 各阶段的耗时统计，仅在定义 WEBRTC_NS_PROFILE 时编译进去，
+// 供 host 端 ns_profile_benchmark 查看每帧时间花在哪里。默认构建中宏为空，没有开销。
+//
+// 用法：NS_PROFILE_START(timer) 开始计时，之后每个 NS_PROFILE_LAP(timer, kStage)
+// 把上一个计时点到当前的时间记到该阶段。统计是进程全局的，不是线程安全的，
+// 因此只在不设线程池（NoiseSuppressor::SetThreadPool）时使用。
+
+#if defined(WEBRTC_NS_PROFILE)
+
+#include <chrono>
+
+namespace webrtc {
+
+    class NsProfiler {
+    public:
+        enum Stage {
+            kAnalysisFft,         // Analyze：加窗、FFT、幅度谱和能量
+            kNoiseEstimate,       // Analyze：分位数噪声估计和启动阶段噪声模型
+            kSnr,                 // Analyze：先验/后验 SNR
+            kSpeechProbability,   // Analyze：特征、直方图、LRT 和语音概率
+            kNoiseUpdate,         // Analyze：噪声谱更新
+            kProcessFft,          // Process：加窗、FFT、幅度谱和能量
+            kWienerFilter,        // Process：维纳滤波器和高频带增益
+            kSynthesis,           // Process：滤波、IFFT、合成窗、重叠相加和高频带
+            kNumStages
+        };
+
+        static const char *StageName(int stage) {
+            static const char *const kNames[kNumStages] = {
+                    "analysis fft", "noise estimate", "snr", "speech probability",
+                    "noise update", "process fft", "wiener filter", "synthesis"};
+            return kNames[stage];
+        }
+
+        // 各阶段累计耗时，单位秒
+        static double *Totals() {
+            static double totals[kNumStages] = {};
+            return totals;
+        }
+
+        static void Reset() {
+            for (int i = 0; i < kNumStages; ++i) {
+                Totals()[i] = 0.0;
+            }
+        }
+
+        NsProfiler() : last_(Clock::now()) {}
+
+        void Lap(Stage stage) {
+            Clock::time_point now = Clock::now();
+            Totals()[stage] += std::chrono::duration<double>(now - last_).count();
+            last_ = now;
+        }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point last_;
+    };
+
+}  // namespace webrtc
+
+#define NS_PROFILE_START(timer) NsProfiler timer
+#define NS_PROFILE_LAP(timer, stage) timer.Lap(NsProfiler::stage)
+
+#else
+
+#define NS_PROFILE_START(timer)
+#define NS_PROFILE_LAP(timer, stage)
+
+#endif  // defined(WEBRTC_NS_PROFILE)
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NS_PROFILE_H_
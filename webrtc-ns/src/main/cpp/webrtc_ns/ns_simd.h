@@ -0,0 +1,186 @@
+#ifndef MODULES_AUDIO_PROCESSING_NS_NS_SIMD_H_
+#define MODULES_AUDIO_PROCESSING_NS_NS_SIMD_H_
+
+// 4 路 float 向量的最小封装，NS 的各个内核只写一遍，按编译目标选用
+// NEON（arm64 和开启 NEON 的 armeabi-v7a）、SSE2（x86/x86_64）或普通 C++。
+// 普通 C++ 版本用数组结构体实现，编译器可以自动向量化。
+// 定义 WEBRTC_NS_DISABLE_SIMD 可强制使用普通 C++ 版本，作为基准测试的对照。
+
+#if defined(WEBRTC_NS_DISABLE_SIMD)
+// 不使用 SIMD
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define WEBRTC_NS_SIMD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WEBRTC_NS_SIMD_SSE2 1
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace webrtc {
+
+#if defined(WEBRTC_NS_SIMD_NEON)
+    typedef float32x4_t Float4;
+
+    inline Float4 Load4(const float *p) { return vld1q_f32(p); }
+    inline void Store4(float *p, Float4 v) { vst1q_f32(p, v); }
+    inline Float4 Set4(float x) { return vdupq_n_f32(x); }
+    inline Float4 Add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+    inline Float4 Sub4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+    inline Float4 Mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+    // (a3, a2, a1, a0)
+    inline Float4 Reverse4(Float4 a) {
+        float32x4_t r = vrev64q_f32(a);
+        return vcombine_f32(vget_high_f32(r), vget_low_f32(r));
+    }
+    // (a0, b0, a1, b1), (a2, b2, a3, b3)
+    inline Float4 InterleaveLo4(Float4 a, Float4 b) { return vzipq_f32(a, b).val[0]; }
+    inline Float4 InterleaveHi4(Float4 a, Float4 b) { return vzipq_f32(a, b).val[1]; }
+    inline Float4 Div4(Float4 a, Float4 b) {
+#if defined(__aarch64__)
+        return vdivq_f32(a, b);
+#else
+        // armv7 没有向量除法：倒数估计加两次牛顿迭代
+        float32x4_t r = vrecpeq_f32(b);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        return vmulq_f32(a, r);
+#endif
+    }
+    inline Float4 Min4(Float4 a, Float4 b) { return vminq_f32(a, b); }
+    inline Float4 Max4(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+    inline Float4 Abs4(Float4 a) { return vabsq_f32(a); }
+    // 按 int32 解释 a 的位模式并转换为 float（a >= 0）
+    inline Float4 BitsToFloat4(Float4 a) { return vcvtq_f32_s32(vreinterpretq_s32_f32(a)); }
+    // 向下取整，|a| < 2^31
+    inline Float4 Floor4(Float4 a) {
+        float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(a));
+        return vsubq_f32(t, vreinterpretq_f32_u32(
+                vandq_u32(vcgtq_f32(t, a), vreinterpretq_u32_f32(vdupq_n_f32(1.f)))));
+    }
+    // 2^n，n 为 [-126, 127] 内的整数值
+    inline Float4 Pow2Int4(Float4 n) {
+        return vreinterpretq_f32_s32(
+                vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23));
+    }
+
+    typedef uint32x4_t Mask4;
+
+    inline Mask4 Greater4(Float4 a, Float4 b) { return vcgtq_f32(a, b); }
+    inline Mask4 Less4(Float4 a, Float4 b) { return vcltq_f32(a, b); }
+    inline Mask4 Equal4(Float4 a, Float4 b) { return vceqq_f32(a, b); }
+    // m ? a : b
+    inline Float4 Select4(Mask4 m, Float4 a, Float4 b) { return vbslq_f32(m, a, b); }
+    inline bool AnyTrue4(Mask4 m) {
+        uint32x2_t t = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+        return (vget_lane_u32(t, 0) | vget_lane_u32(t, 1)) != 0;
+    }
+    // a0 + a1 + a2 + a3
+    inline float Sum4(Float4 a) {
+        float32x2_t t = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+        return vget_lane_f32(vpadd_f32(t, t), 0);
+    }
+#elif defined(WEBRTC_NS_SIMD_SSE2)
+    typedef __m128 Float4;
+
+    inline Float4 Load4(const float *p) { return _mm_loadu_ps(p); }
+    inline void Store4(float *p, Float4 v) { _mm_storeu_ps(p, v); }
+    inline Float4 Set4(float x) { return _mm_set1_ps(x); }
+    inline Float4 Add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 Sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+    inline Float4 Mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    inline Float4 Reverse4(Float4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3)); }
+    inline Float4 InterleaveLo4(Float4 a, Float4 b) { return _mm_unpacklo_ps(a, b); }
+    inline Float4 InterleaveHi4(Float4 a, Float4 b) { return _mm_unpackhi_ps(a, b); }
+    inline Float4 Div4(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+    inline Float4 Min4(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+    inline Float4 Max4(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+    inline Float4 Abs4(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    inline Float4 BitsToFloat4(Float4 a) { return _mm_cvtepi32_ps(_mm_castps_si128(a)); }
+    inline Float4 Floor4(Float4 a) {
+        __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.f)));
+    }
+    inline Float4 Pow2Int4(Float4 n) {
+        return _mm_castsi128_ps(
+                _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23));
+    }
+
+    typedef __m128 Mask4;
+
+    inline Mask4 Greater4(Float4 a, Float4 b) { return _mm_cmpgt_ps(a, b); }
+    inline Mask4 Less4(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+    inline Mask4 Equal4(Float4 a, Float4 b) { return _mm_cmpeq_ps(a, b); }
+    inline Float4 Select4(Mask4 m, Float4 a, Float4 b) {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+    inline bool AnyTrue4(Mask4 m) { return _mm_movemask_ps(m) != 0; }
+    inline float Sum4(Float4 a) {
+        __m128 t = _mm_add_ps(a, _mm_movehl_ps(a, a));
+        t = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
+        return _mm_cvtss_f32(t);
+    }
+#else
+    struct Float4 {
+        float v[4];
+    };
+
+    inline Float4 Load4(const float *p) { return Float4{{p[0], p[1], p[2], p[3]}}; }
+    inline void Store4(float *p, Float4 v) { for (int i = 0; i < 4; ++i) p[i] = v.v[i]; }
+    inline Float4 Set4(float x) { return Float4{{x, x, x, x}}; }
+    inline Float4 Add4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+    inline Float4 Sub4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+    inline Float4 Mul4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+    inline Float4 Reverse4(Float4 a) { return Float4{{a.v[3], a.v[2], a.v[1], a.v[0]}}; }
+    inline Float4 InterleaveLo4(Float4 a, Float4 b) { return Float4{{a.v[0], b.v[0], a.v[1], b.v[1]}}; }
+    inline Float4 InterleaveHi4(Float4 a, Float4 b) { return Float4{{a.v[2], b.v[2], a.v[3], b.v[3]}}; }
+    inline Float4 Div4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+    inline Float4 Min4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; return a; }
+    inline Float4 Max4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i]; return a; }
+    inline Float4 Abs4(Float4 a) { for (int i = 0; i < 4; ++i) a.v[i] = fabsf(a.v[i]); return a; }
+    inline Float4 BitsToFloat4(Float4 a) {
+        for (int i = 0; i < 4; ++i) {
+            int32_t bits;
+            memcpy(&bits, &a.v[i], sizeof(bits));
+            a.v[i] = static_cast<float>(bits);
+        }
+        return a;
+    }
+    inline Float4 Floor4(Float4 a) { for (int i = 0; i < 4; ++i) a.v[i] = floorf(a.v[i]); return a; }
+    inline Float4 Pow2Int4(Float4 n) {
+        for (int i = 0; i < 4; ++i) {
+            int32_t bits = (static_cast<int32_t>(n.v[i]) + 127) << 23;
+            memcpy(&n.v[i], &bits, sizeof(bits));
+        }
+        return n;
+    }
+
+    struct Mask4 {
+        bool v[4];
+    };
+
+    inline Mask4 Greater4(Float4 a, Float4 b) { return Mask4{{a.v[0] > b.v[0], a.v[1] > b.v[1], a.v[2] > b.v[2], a.v[3] > b.v[3]}}; }
+    inline Mask4 Less4(Float4 a, Float4 b) { return Greater4(b, a); }
+    inline Mask4 Equal4(Float4 a, Float4 b) { return Mask4{{a.v[0] == b.v[0], a.v[1] == b.v[1], a.v[2] == b.v[2], a.v[3] == b.v[3]}}; }
+    inline Float4 Select4(Mask4 m, Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = m.v[i] ? a.v[i] : b.v[i]; return a; }
+    inline bool AnyTrue4(Mask4 m) { return m.v[0] || m.v[1] || m.v[2] || m.v[3]; }
+    inline float Sum4(Float4 a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+#endif
+
+    // 当前编译的 SIMD 路径名，用于基准测试输出
+    inline const char *SimdName() {
+#if defined(WEBRTC_NS_SIMD_NEON)
+        return "neon";
+#elif defined(WEBRTC_NS_SIMD_SSE2)
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NS_SIMD_H_
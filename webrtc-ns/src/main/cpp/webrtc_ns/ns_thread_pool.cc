@@ -0,0 +1,112 @@
+#include "ns_thread_pool.h"
+
+namespace webrtc {
+
+    namespace {
+
+        // 等待时先自旋的次数，每次让出一次 CPU。一帧内的几次屏障间隔只有几微秒，
+        // 自旋可以省掉休眠和唤醒的开销；帧与帧之间的间隔则进入休眠。
+        constexpr int kSpinCount = 200;
+
+    }  // namespace
+
+    NsThreadPool::NsThreadPool(size_t num_threads) {
+        for (size_t i = 1; i < num_threads; ++i) {
+            workers_.emplace_back(&NsThreadPool::WorkerLoop, this);
+        }
+    }
+
+    NsThreadPool::~NsThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+        start_cv_.notify_all();
+        for (std::thread &worker: workers_) {
+            worker.join();
+        }
+    }
+
+    void NsThreadPool::Run(size_t count, TaskProc proc, void *body) {
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        if (workers_.empty() || count < 2) {
+            for (size_t i = 0; i < count; ++i) {
+                proc(body, i);
+            }
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // 上一批次结束后才醒来的工作线程可能还在领取任务，等它退出后再重置 next_
+            done_cv_.wait(lock, [this] { return busy_.load(std::memory_order_relaxed) == 0; });
+            proc_ = proc;
+            body_ = body;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            pending_.store(count, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+        start_cv_.notify_all();
+
+        RunTasks(proc, body, count);
+
+        // 等其他线程手上的任务完成
+        for (int spin = 0; spin < kSpinCount; ++spin) {
+            if (pending_.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+    void NsThreadPool::RunTasks(TaskProc proc, void *body, size_t count) {
+        size_t index;
+        while ((index = next_.fetch_add(1, std::memory_order_relaxed)) < count) {
+            proc(body, index);
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void NsThreadPool::WorkerLoop() {
+        // 线程可能在第一个批次甚至析构开始之后才运行，因此从构造时的 0 开始比较，
+        // 不能取线程启动时的值
+        uint32_t seen = 0;
+        for (;;) {
+            for (int spin = 0; spin < kSpinCount; ++spin) {
+                if (generation_.load(std::memory_order_acquire) != seen) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+
+            TaskProc proc;
+            void *body;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [this, seen] {
+                    return stop_ || generation_.load(std::memory_order_relaxed) != seen;
+                });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_.load(std::memory_order_relaxed);
+                proc = proc_;
+                body = body_;
+                count = count_;
+                busy_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            RunTasks(proc, body, count);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_.fetch_sub(1, std::memory_order_relaxed);
+            done_cv_.notify_all();
+        }
+    }
+
+}  // namespace webrtc
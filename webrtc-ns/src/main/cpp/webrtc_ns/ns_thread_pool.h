@@ -0,0 +1,80 @@
+#ifndef MODULES_AUDIO_PROCESSING_NS_NS_THREAD_POOL_H_
+#define MODULES_AUDIO_PROCESSING_NS_NS_THREAD_POOL_H_
+
+// 多声道降噪用的常驻线程池：NoiseSuppressor 把每个声道的 Analyze/Process 工作
+// 分给池里的线程，ParallelFor 返回时所有声道都已完成，相当于一个屏障。
+//
+// 线程在构造时创建，之后处理过程中不再创建线程或分配内存。ParallelFor 的调用线程
+// 也参与处理，因此 num_threads 个线程只需创建 num_threads - 1 个工作线程。
+// 每帧有多次屏障，工作线程完成任务后先短暂自旋等待下一批任务，再进入休眠。
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace webrtc {
+
+    class NsThreadPool {
+    public:
+        // num_threads 为包括调用线程在内的线程数，小于 2 时 ParallelFor 直接串行执行
+        explicit NsThreadPool(size_t num_threads);
+
+        ~NsThreadPool();
+
+        NsThreadPool(const NsThreadPool &) = delete;
+
+        NsThreadPool &operator=(const NsThreadPool &) = delete;
+
+        size_t NumThreads() const { return workers_.size() + 1; }
+
+        // 对 0..count-1 的每个 index 调用一次 body(index)，全部完成后返回。
+        // 多个线程同时调用时依次执行，同一个池可以被多个会话共用。
+        template<typename Body>
+        void ParallelFor(size_t count, Body &body) {
+            Run(count, &Invoke<Body>, &body);
+        }
+
+    private:
+        typedef void (*TaskProc)(void *body, size_t index);
+
+        template<typename Body>
+        static void Invoke(void *body, size_t index) {
+            (*static_cast<Body *>(body))(index);
+        }
+
+        void Run(size_t count, TaskProc proc, void *body);
+
+        void WorkerLoop();
+
+        // 领取并执行当前批次的任务，直到全部领完
+        void RunTasks(TaskProc proc, void *body, size_t count);
+
+        std::vector<std::thread> workers_;
+        // 保证同一时刻只有一个 ParallelFor
+        std::mutex run_mutex_;
+
+        // 以下批次状态在 mutex_ 下修改
+        std::mutex mutex_;
+        std::condition_variable start_cv_;
+        std::condition_variable done_cv_;
+        std::atomic<uint32_t> generation_{0};
+        bool stop_ = false;
+        TaskProc proc_ = nullptr;
+        void *body_ = nullptr;
+        size_t count_ = 0;
+
+        std::atomic<size_t> next_{0};
+        // 尚未完成的任务数，为 0 时批次结束
+        std::atomic<size_t> pending_{0};
+        // 正在领取任务的工作线程数，为 0 时才能开始下一批次
+        std::atomic<size_t> busy_{0};
+    };
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NS_THREAD_POOL_H_
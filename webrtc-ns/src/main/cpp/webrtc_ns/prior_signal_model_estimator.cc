@@ -23,7 +23,7 @@ namespace webrtc {
 // Identifies the first of the two largest peaks in the histogram.
         void FindFirstOfTwoLargestPeaks(
                 float bin_size,
-                rtc::ArrayView<const int, kHistogramSize> spectral_flatness,
+                rtc::ArrayView<const HistogramCount, kHistogramSize> spectral_flatness,
                 float *peak_position,
                 int *peak_weight) {
             RTC_DCHECK(peak_position);
@@ -64,7 +64,7 @@ namespace webrtc {
             }
         }
 
-        void UpdateLrt(rtc::ArrayView<const int, kHistogramSize> lrt_histogram,
+        void UpdateLrt(rtc::ArrayView<const HistogramCount, kHistogramSize> lrt_histogram,
                        float *prior_model_lrt,
                        bool *low_lrt_fluctuations) {
             RTC_DCHECK(prior_model_lrt);
@@ -13,6 +13,7 @@
 #include <algorithm>
 
 #include "fast_math.h"
+#include "ns_simd.h"
 
 namespace webrtc {
 
@@ -38,7 +39,35 @@ namespace webrtc {
         for (int s = 0, k = 0; s < kSimult;
              ++s, k += static_cast<int>(kFftSizeBy2Plus1)) {
             const float one_by_counter_plus_1 = 1.f / (counter_[s] + 1.f);
-            for (int i = 0, j = k; i < static_cast<int>(kFftSizeBy2Plus1); ++i, ++j) {
+            constexpr float kWidth = 0.01f;
+            constexpr float kOneByWidthPlus2 = 1.f / (2.f * kWidth);
+            const Float4 one_by_counter_plus_1_4 = Set4(one_by_counter_plus_1);
+            const Float4 counter = Set4(static_cast<float>(counter_[s]));
+            int i = 0;
+            for (; i + 4 <= static_cast<int>(kFftSizeBy2Plus1); i += 4) {
+                const int j = k + i;
+                // Update log quantile estimate.
+                const Float4 density = Load4(&density_[j]);
+                const Float4 delta = Select4(Greater4(density, Set4(1.f)),
+                                             Div4(Set4(40.f), density), Set4(40.f));
+                const Float4 multiplier = Mul4(delta, one_by_counter_plus_1_4);
+                const Float4 log_signal = Load4(&log_spectrum[i]);
+                Float4 log_quantile = Load4(&log_quantile_[j]);
+                log_quantile = Select4(
+                        Greater4(log_signal, log_quantile),
+                        Add4(log_quantile, Mul4(Set4(0.25f), multiplier)),
+                        Sub4(log_quantile, Mul4(Set4(0.75f), multiplier)));
+                Store4(&log_quantile_[j], log_quantile);
+
+                // Update density estimate.
+                const Float4 updated_density =
+                        Mul4(Add4(Mul4(counter, density), Set4(kOneByWidthPlus2)),
+                             one_by_counter_plus_1_4);
+                Store4(&density_[j],
+                       Select4(Less4(Abs4(Sub4(log_signal, log_quantile)), Set4(kWidth)),
+                               updated_density, density));
+            }
+            for (int j = k + i; i < static_cast<int>(kFftSizeBy2Plus1); ++i, ++j) {
                 // Update log quantile estimate.
                 const float delta = density_[j] > 1.f ? 40.f / density_[j] : 40.f;
 
@@ -50,8 +79,6 @@ namespace webrtc {
                 }
 
                 // Update density estimate.
-                constexpr float kWidth = 0.01f;
-                constexpr float kOneByWidthPlus2 = 1.f / (2.f * kWidth);
                 if (fabs(log_spectrum[i] - log_quantile_[j]) < kWidth) {
                     density_[j] = (counter_[s] * density_[j] + kOneByWidthPlus2) *
                                   one_by_counter_plus_1;
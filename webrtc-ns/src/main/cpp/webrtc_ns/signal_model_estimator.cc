@@ -11,6 +11,7 @@
 #include "signal_model_estimator.h"
 
 #include "fast_math.h"
+#include "ns_simd.h"
 
 namespace webrtc {
 
@@ -29,19 +30,38 @@ namespace webrtc {
             // / var(magnAvgPause)
 
             // Compute average quantities.
-            float noise_average = 0.f;
-            for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+            Float4 noise_sum = Set4(0.f);
+            size_t i = 0;
+            for (; i + 4 <= kFftSizeBy2Plus1; i += 4) {
                 // Conservative smooth noise spectrum from pause frames.
+                noise_sum = Add4(noise_sum, Load4(&conservative_noise_spectrum[i]));
+            }
+            float noise_average = Sum4(noise_sum);
+            for (; i < kFftSizeBy2Plus1; ++i) {
                 noise_average += conservative_noise_spectrum[i];
             }
             noise_average = noise_average * kOneByFftSizeBy2Plus1;
             float signal_average = signal_spectral_sum * kOneByFftSizeBy2Plus1;
 
             // Compute variance and covariance quantities.
-            float covariance = 0.f;
-            float noise_variance = 0.f;
-            float signal_variance = 0.f;
-            for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+            const Float4 signal_average4 = Set4(signal_average);
+            const Float4 noise_average4 = Set4(noise_average);
+            Float4 covariance4 = Set4(0.f);
+            Float4 noise_variance4 = Set4(0.f);
+            Float4 signal_variance4 = Set4(0.f);
+            for (i = 0; i + 4 <= kFftSizeBy2Plus1; i += 4) {
+                const Float4 signal_diff =
+                        Sub4(Load4(&signal_spectrum[i]), signal_average4);
+                const Float4 noise_diff =
+                        Sub4(Load4(&conservative_noise_spectrum[i]), noise_average4);
+                covariance4 = Add4(covariance4, Mul4(signal_diff, noise_diff));
+                noise_variance4 = Add4(noise_variance4, Mul4(noise_diff, noise_diff));
+                signal_variance4 = Add4(signal_variance4, Mul4(signal_diff, signal_diff));
+            }
+            float covariance = Sum4(covariance4);
+            float noise_variance = Sum4(noise_variance4);
+            float signal_variance = Sum4(signal_variance4);
+            for (; i < kFftSizeBy2Plus1; ++i) {
                 float signal_diff = signal_spectrum[i] - signal_average;
                 float noise_diff = conservative_noise_spectrum[i] - noise_average;
                 covariance += signal_diff * noise_diff;
@@ -69,17 +89,18 @@ namespace webrtc {
             // Compute log of ratio of the geometric to arithmetic mean (handle the log(0)
             // separately).
             constexpr float kAveraging = 0.3f;
-            float avg_spect_flatness_num = 0.f;
-            for (size_t i = 1; i < kFftSizeBy2Plus1; ++i) {
-                if (signal_spectrum[i] == 0.f) {
+            // Bins 1 to kFftSizeBy2Plus1 - 1 are a multiple of 4.
+            static_assert((kFftSizeBy2Plus1 - 1) % 4 == 0, "");
+            Float4 log_sum = Set4(0.f);
+            for (size_t i = 1; i < kFftSizeBy2Plus1; i += 4) {
+                const Float4 signal = Load4(&signal_spectrum[i]);
+                if (AnyTrue4(Equal4(signal, Set4(0.f)))) {
                     *spectral_flatness -= kAveraging * (*spectral_flatness);
                     return;
                 }
+                log_sum = Add4(log_sum, LogApproximation(signal));
             }
-
-            for (size_t i = 1; i < kFftSizeBy2Plus1; ++i) {
-                avg_spect_flatness_num += LogApproximation(signal_spectrum[i]);
-            }
+            float avg_spect_flatness_num = Sum4(log_sum);
 
             float avg_spect_flatness_denom = signal_spectral_sum - signal_spectrum[0];
 
@@ -100,16 +121,29 @@ namespace webrtc {
                                float *lrt) {
             RTC_DCHECK(lrt);
 
-            for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+            Float4 sum = Set4(0.f);
+            size_t i = 0;
+            for (; i + 4 <= kFftSizeBy2Plus1; i += 4) {
+                const Float4 prior = Load4(&prior_snr[i]);
+                const Float4 tmp1 = Add4(Set4(1.f), Mul4(Set4(2.f), prior));
+                const Float4 tmp2 =
+                        Div4(Mul4(Set4(2.f), prior), Add4(tmp1, Set4(0.0001f)));
+                const Float4 bessel_tmp =
+                        Mul4(Add4(Load4(&post_snr[i]), Set4(1.f)), tmp2);
+                Float4 lrt_i = Load4(&avg_log_lrt[i]);
+                lrt_i = Add4(lrt_i, Mul4(Set4(.5f),
+                                         Sub4(Sub4(bessel_tmp, LogApproximation(tmp1)),
+                                              lrt_i)));
+                Store4(&avg_log_lrt[i], lrt_i);
+                sum = Add4(sum, lrt_i);
+            }
+            float log_lrt_time_avg_k_sum = Sum4(sum);
+            for (; i < kFftSizeBy2Plus1; ++i) {
                 float tmp1 = 1.f + 2.f * prior_snr[i];
                 float tmp2 = 2.f * prior_snr[i] / (tmp1 + 0.0001f);
                 float bessel_tmp = (post_snr[i] + 1.f) * tmp2;
                 avg_log_lrt[i] +=
                         .5f * (bessel_tmp - LogApproximation(tmp1) - avg_log_lrt[i]);
-            }
-
-            float log_lrt_time_avg_k_sum = 0.f;
-            for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
                 log_lrt_time_avg_k_sum += avg_log_lrt[i];
             }
             *lrt = log_lrt_time_avg_k_sum * kOneByFftSizeBy2Plus1;
@@ -94,6 +94,7 @@
 #include <limits>
 
 #include "checks.h"
+#include "cpu_features_wrapper.h"
 
 namespace webrtc {
 
@@ -119,31 +120,23 @@ namespace webrtc {
 
     const size_t SincResampler::kKernelSize;
 
-// If we know the minimum architecture at compile time, avoid CPU detection.
-#if defined(WEBRTC_ARCH_X86_FAMILY)
-#if defined(__SSE2__)
-#define CONVOLVE_FUNC Convolve_SSE
-    void SincResampler::InitializeCPUSpecificFeatures() {}
-#else
-    // x86 CPU detection required.  Function will be set by
-    // InitializeCPUSpecificFeatures().
-    // TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
-#define CONVOLVE_FUNC convolve_proc_
-
     void SincResampler::InitializeCPUSpecificFeatures() {
-      convolve_proc_ = WebRtc_GetCPUInfo(kSSE2) ? Convolve_SSE : Convolve_C;
-    }
-#endif
-#elif defined(WEBRTC_HAS_NEON)
-#define CONVOLVE_FUNC Convolve_NEON
-    void SincResampler::InitializeCPUSpecificFeatures() {}
+#if defined(WEBRTC_HAS_NEON)
+        convolve_proc_ = Convolve_NEON;
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+        // Using AVX2 instead of SSE2 when AVX2/FMA3 supported.
+        if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3)) {
+            convolve_proc_ = Convolve_AVX2;
+        } else if (WebRtc_GetCPUInfo(kSSE2)) {
+            convolve_proc_ = Convolve_SSE;
+        } else {
+            convolve_proc_ = Convolve_C;
+        }
 #else
-// Unknown architecture.
-#define CONVOLVE_FUNC Convolve_C
-
-    void SincResampler::InitializeCPUSpecificFeatures() {}
-
+        // Unknown architecture.
+        convolve_proc_ = Convolve_C;
 #endif
+    }
 
     SincResampler::SincResampler(double io_sample_rate_ratio,
                                  size_t request_frames,
@@ -152,24 +145,20 @@ namespace webrtc {
               read_cb_(read_cb),
               request_frames_(request_frames),
               input_buffer_size_(request_frames_ + kKernelSize),
-            // Create input buffers with a 16-byte alignment for SSE optimizations.
+            // Create input buffers with a 32-byte alignment for SIMD optimizations.
               kernel_storage_(static_cast<float *>(
-                                      AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+                                      AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
               kernel_pre_sinc_storage_(static_cast<float *>(
-                                               AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+                                               AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
               kernel_window_storage_(static_cast<float *>(
-                                             AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+                                             AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
               input_buffer_(static_cast<float *>(
-                                    AlignedMalloc(sizeof(float) * input_buffer_size_, 16))),
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
-            convolve_proc_(nullptr),
-#endif
+                                    AlignedMalloc(sizeof(float) * input_buffer_size_, 32))),
+              convolve_proc_(nullptr),
               r1_(input_buffer_.get()),
               r2_(input_buffer_.get() + kKernelSize / 2) {
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
         InitializeCPUSpecificFeatures();
         RTC_DCHECK(convolve_proc_);
-#endif
         RTC_DCHECK_GT(request_frames_, 0);
         Flush();
         RTC_DCHECK_GT(block_size_, kKernelSize);
@@ -302,10 +291,10 @@ namespace webrtc {
                 const float *const k1 = kernel_ptr + offset_idx * kKernelSize;
                 const float *const k2 = k1 + kKernelSize;
 
-                // Ensure |k1|, |k2| are 16-byte aligned for SIMD usage.  Should always be
-                // true so long as kKernelSize is a multiple of 16.
-                RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k1) % 16);
-                RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k2) % 16);
+                // Ensure |k1|, |k2| are 32-byte aligned for SIMD usage.  Should always be
+                // true so long as kKernelSize is a multiple of 32.
+                RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k1) % 32);
+                RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k2) % 32);
 
                 // Initialize input pointer based on quantized |virtual_source_idx_|.
                 const float *const input_ptr = r1_ + source_idx;
@@ -314,7 +303,7 @@ namespace webrtc {
                 const double kernel_interpolation_factor =
                         virtual_offset_idx - offset_idx;
                 *destination++ =
-                        CONVOLVE_FUNC(input_ptr, k1, k2, kernel_interpolation_factor);
+                        convolve_proc_(input_ptr, k1, k2, kernel_interpolation_factor);
 
                 // Advance the virtual index.
                 virtual_source_idx_ += current_io_ratio;
@@ -339,8 +328,6 @@ namespace webrtc {
         }
     }
 
-#undef CONVOLVE_FUNC
-
     size_t SincResampler::ChunkSize() const {
         return static_cast<size_t>(block_size_ / io_sample_rate_ratio_);
     }
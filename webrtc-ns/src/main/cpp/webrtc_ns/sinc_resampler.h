@@ -98,7 +98,8 @@ namespace webrtc {
         void UpdateRegions(bool second_load);
 
         // Selects runtime specific CPU features like SSE.  Must be called before
-        // using SincResampler.
+        // using SincResampler: NEON on ARM builds with WEBRTC_HAS_NEON, AVX2 or
+        // SSE on x86 depending on the CPU, else C.
         // TODO(ajm): Currently managed by the class internally. See the note with
         // |convolve_proc_| below.
         void InitializeCPUSpecificFeatures();
@@ -112,14 +113,19 @@ namespace webrtc {
                                 double kernel_interpolation_factor);
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
-        static float Convolve_SSE(const float* input_ptr,
-                                  const float* k1,
-                                  const float* k2,
+        static float Convolve_SSE(const float *input_ptr,
+                                  const float *k1,
+                                  const float *k2,
                                   double kernel_interpolation_factor);
+
+        static float Convolve_AVX2(const float *input_ptr,
+                                   const float *k1,
+                                   const float *k2,
+                                   double kernel_interpolation_factor);
 #elif defined(WEBRTC_HAS_NEON)
-        static float Convolve_NEON(const float* input_ptr,
-                                   const float* k1,
-                                   const float* k2,
+        static float Convolve_NEON(const float *input_ptr,
+                                   const float *k1,
+                                   const float *k2,
                                    double kernel_interpolation_factor);
 #endif
 
@@ -159,13 +165,11 @@ namespace webrtc {
 // TODO(ajm): Move to using a global static which must only be initialized
 // once by the user. We're not doing this initially, because we don't have
 // e.g. a LazyInstance helper in webrtc.
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
-        typedef float (*ConvolveProc)(const float*,
-                                      const float*,
-                                      const float*,
+        typedef float (*ConvolveProc)(const float *,
+                                      const float *,
+                                      const float *,
                                       double);
         ConvolveProc convolve_proc_;
-#endif
 
         // Pointers to the various regions inside |input_buffer_|.  See the diagram at
         // the top of the .cc file for more information.
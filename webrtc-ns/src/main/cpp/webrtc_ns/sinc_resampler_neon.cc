@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Modified from the Chromium original:
+// src/media/base/sinc_resampler.cc
+
+#include "sinc_resampler.h"
+
+#if defined(WEBRTC_HAS_NEON)
+
+#include <arm_neon.h>
+
+namespace webrtc {
+
+    float SincResampler::Convolve_NEON(const float *input_ptr,
+                                       const float *k1,
+                                       const float *k2,
+                                       double kernel_interpolation_factor) {
+        // Two accumulators per kernel halve the multiply-accumulate dependency
+        // chains over the kKernelSize taps.
+        float32x4_t m_sums1a = vmovq_n_f32(0);
+        float32x4_t m_sums1b = vmovq_n_f32(0);
+        float32x4_t m_sums2a = vmovq_n_f32(0);
+        float32x4_t m_sums2b = vmovq_n_f32(0);
+
+        static_assert(kKernelSize % 8 == 0, "kKernelSize must be a multiple of 8");
+        const float *upper = input_ptr + kKernelSize;
+        for (; input_ptr < upper; input_ptr += 8, k1 += 8, k2 += 8) {
+            const float32x4_t m_input_a = vld1q_f32(input_ptr);
+            const float32x4_t m_input_b = vld1q_f32(input_ptr + 4);
+#if defined(__aarch64__)
+            m_sums1a = vfmaq_f32(m_sums1a, m_input_a, vld1q_f32(k1));
+            m_sums1b = vfmaq_f32(m_sums1b, m_input_b, vld1q_f32(k1 + 4));
+            m_sums2a = vfmaq_f32(m_sums2a, m_input_a, vld1q_f32(k2));
+            m_sums2b = vfmaq_f32(m_sums2b, m_input_b, vld1q_f32(k2 + 4));
+#else
+            m_sums1a = vmlaq_f32(m_sums1a, m_input_a, vld1q_f32(k1));
+            m_sums1b = vmlaq_f32(m_sums1b, m_input_b, vld1q_f32(k1 + 4));
+            m_sums2a = vmlaq_f32(m_sums2a, m_input_a, vld1q_f32(k2));
+            m_sums2b = vmlaq_f32(m_sums2b, m_input_b, vld1q_f32(k2 + 4));
+#endif
+        }
+        float32x4_t m_sums1 = vaddq_f32(m_sums1a, m_sums1b);
+        float32x4_t m_sums2 = vaddq_f32(m_sums2a, m_sums2b);
+
+        // Linearly interpolate the two "convolutions".
+        m_sums1 = vmlaq_f32(
+                vmulq_f32(m_sums1,
+                          vmovq_n_f32(static_cast<float>(1.0 - kernel_interpolation_factor))),
+                m_sums2, vmovq_n_f32(static_cast<float>(kernel_interpolation_factor)));
+
+        // Sum components together.
+        float32x2_t m_half = vadd_f32(vget_high_f32(m_sums1), vget_low_f32(m_sums1));
+        return vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+    }
+
+}  // namespace webrtc
+
+#endif  // defined(WEBRTC_HAS_NEON)
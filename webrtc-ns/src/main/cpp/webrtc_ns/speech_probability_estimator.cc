@@ -14,6 +14,7 @@
 #include <algorithm>
 
 #include "fast_math.h"
+#include "ns_simd.h"
 #include "checks.h"
 
 namespace webrtc {
@@ -95,7 +96,14 @@ namespace webrtc {
 
         std::array<float, kFftSizeBy2Plus1> inv_lrt{};
         ExpApproximationSignFlip(model.avg_log_lrt, inv_lrt);
-        for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+        const Float4 gain_prior4 = Set4(gain_prior);
+        size_t i = 0;
+        for (; i + 4 <= kFftSizeBy2Plus1; i += 4) {
+            Store4(&speech_probability_[i],
+                   Div4(Set4(1.f),
+                        Add4(Set4(1.f), Mul4(gain_prior4, Load4(&inv_lrt[i])))));
+        }
+        for (; i < kFftSizeBy2Plus1; ++i) {
             speech_probability_[i] = 1.f / (1.f + gain_prior * inv_lrt[i]);
         }
     }
@@ -16,6 +16,7 @@
 #include <algorithm>
 
 #include "fast_math.h"
+#include "ns_simd.h"
 #include "checks.h"
 
 namespace webrtc {
@@ -33,7 +34,29 @@ namespace webrtc {
             rtc::ArrayView<const float, kFftSizeBy2Plus1> prev_noise_spectrum,
             rtc::ArrayView<const float, kFftSizeBy2Plus1> parametric_noise_spectrum,
             rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum) {
-        for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+        const Float4 over_subtraction_factor =
+                Set4(suppression_params_.over_subtraction_factor);
+        const Float4 minimum_attenuating_gain =
+                Set4(suppression_params_.minimum_attenuating_gain);
+        size_t i = 0;
+        for (; i + 4 <= kFftSizeBy2Plus1; i += 4) {
+            const Float4 prev_tsa =
+                    Mul4(Div4(Load4(&spectrum_prev_process_[i]),
+                              Add4(Load4(&prev_noise_spectrum[i]), Set4(0.0001f))),
+                         Load4(&filter_[i]));
+            const Float4 signal = Load4(&signal_spectrum[i]);
+            const Float4 noise = Load4(&noise_spectrum[i]);
+            const Float4 current_tsa = Select4(
+                    Greater4(signal, noise),
+                    Sub4(Div4(signal, Add4(noise, Set4(0.0001f))), Set4(1.f)), Set4(0.f));
+            const Float4 snr_prior = Add4(Mul4(Set4(0.98f), prev_tsa),
+                                          Mul4(Set4(1.f - 0.98f), current_tsa));
+            const Float4 filter =
+                    Div4(snr_prior, Add4(over_subtraction_factor, snr_prior));
+            Store4(&filter_[i],
+                   Max4(Min4(filter, Set4(1.f)), minimum_attenuating_gain));
+        }
+        for (; i < kFftSizeBy2Plus1; ++i) {
             // Previous estimate based on previous frame with gain filter.
             float prev_tsa = spectrum_prev_process_[i] /
                              (prev_noise_spectrum[i] + 0.0001f) * filter_[i];
@@ -1,5 +1,7 @@
 package com.shetj.webrtc.ns
 
+import java.nio.ByteBuffer
+
 object WebRtcNs {
 
 
@@ -19,22 +21,27 @@ object WebRtcNs {
      * 3 = SuppressionLevel::k21dB
      * @return
      */
+    @Deprecated("使用 createSession", ReplaceWith("createSession(sampleRate, num_channels, level)"))
     external fun webRtcNsCreate(sampleRate: Int, num_channels: Int, level: Int): Long
 
 
+    @Deprecated("使用 createSession")
     external fun createAudioBuffer(sampleRate: Int, num_channels: Int):Long
 
+    @Deprecated("使用 createSession")
     external fun createStreamConfig(sampleRate: Int, num_channels: Int):Long
 
     /**
      * 释放
      * @param nsHandler
      */
+    @Deprecated("使用 freeSession")
     external fun webRtcNsFree(nsHandler: Long,abHandler:Long,scHandler:Long)
 
     /**
      * 音频降噪
      */
+    @Deprecated("使用 processFrame 或 processBuffer")
     external fun noiseSuppressionByBytes(
         nsHandler: Long,
         abHandler:Long,scHandler:Long,
@@ -45,8 +52,128 @@ object WebRtcNs {
     /**
      * 音频降噪
      */
+    @Deprecated("使用 processFrame")
     external fun noiseSuppressionByShort(
         nsHandler: Long,abHandler:Long,scHandler:Long,
         inputbuffer: ShortArray,
     )
+
+    /**
+     * 创建降噪会话，会话持有降噪所需的全部对象，用完调用 [freeSession] 释放
+     * @param sampleRate 采样率，只支持 16000、32000、48000
+     * @param numChannels 声道数
+     * @param level 降噪强度 0 = k6dB，1 = k12dB，2 = k18dB，3 = k21dB
+     * @return 会话 handle，参数无效时返回 0
+     */
+    external fun createSession(sampleRate: Int, numChannels: Int, level: Int): Long
+
+    /**
+     * 原地降噪一个 10ms 帧（sampleRate / 100 帧，交错存放全部声道）
+     * @return 处理的帧数，参数无效时返回 -1
+     */
+    external fun processFrame(handle: Long, frame: ShortArray): Int
+
+    /**
+     * 批量音频降噪，一次 JNI 调用在 native 层循环处理所有完整的 10ms 帧
+     *
+     * 每次可传入任意帧数，不足 10ms 的尾部暂存在会话内，和下次传入的数据拼成整帧。
+     * 因此输出固定比输入晚 10ms（sampleRate / 100 帧），开头输出静音；
+     * 结束时再传入 10ms 的静音即可取出最后的数据。
+     *
+     * @param handle [createSession] 返回的会话
+     * @param buffer DirectByteBuffer，native 字节序的 16bit 交错 PCM，原地写回结果
+     * @param numFrames 帧数，每帧包含全部声道
+     * @return 处理的帧数，参数无效时返回 -1
+     */
+    external fun processBuffer(handle: Long, buffer: ByteBuffer, numFrames: Int): Int
+
+    /**
+     * 同 [processFrame]，同时输出该帧每个声道的降噪统计，可直接用作 VAD 和静音裁剪的依据
+     *
+     * 每个声道 3 个值，依次为：
+     * - 语音概率 [0, 1]（约 10 帧平滑）
+     * - 信噪比（dB，输入能量与估计噪声能量之比，纯噪声时约为 0）
+     * - 低频带（0 - 8kHz）实际施加的幅度增益
+     *
+     * @param stats 至少 3 * 声道数 个 float
+     * @return 处理的帧数，参数无效时返回 -1
+     */
+    external fun processFrameStats(handle: Long, frame: ShortArray, stats: FloatArray): Int
+
+    /**
+     * 同 [processBuffer]，同时按顺序输出本次凑满的每个 10ms 帧的统计，格式同 [processFrameStats]
+     *
+     * 统计对应本次凑满的输入帧；由于固定 10ms 的延迟，这些帧的降噪结果在输出中晚 10ms 出现。
+     *
+     * @param stats 至少 (numFrames / (sampleRate / 100) + 1) * 3 * 声道数 个 float
+     * @return 本次处理的 10ms 帧数（stats 中有效的帧数），参数无效时返回 -1
+     */
+    external fun processBufferStats(handle: Long, buffer: ByteBuffer, numFrames: Int, stats: FloatArray): Int
+
+    /**
+     * 浮点版本的 [processFrame]，采样范围 [-1, 1]，省去 16bit 与浮点之间的转换
+     * @param frame 一个 10ms 帧，交错存放全部声道
+     * @return 处理的帧数，参数无效时返回 -1
+     */
+    external fun processFrameFloat(handle: Long, frame: FloatArray): Int
+
+    /**
+     * 浮点版本的 [processBuffer]，延迟和尾部暂存规则相同
+     *
+     * 同一会话不要和 16bit 的 [processBuffer] 混用，两者的暂存数据是分开的。
+     *
+     * @param buffer DirectByteBuffer，native 字节序的 float 交错 PCM，范围 [-1, 1]，原地写回结果
+     * @param numFrames 帧数，每帧包含全部声道
+     * @return 处理的帧数，参数无效时返回 -1
+     */
+    external fun processBufferFloat(handle: Long, buffer: ByteBuffer, numFrames: Int): Int
+
+    /**
+     * 平面格式的 [processBufferFloat]：buffer 中各声道依次存放，
+     * 第 c 声道占第 c * numFrames 到 (c + 1) * numFrames - 1 个 float
+     *
+     * 可以和 [processBufferFloat] 混用，两者共用浮点暂存数据。
+     *
+     * @return 处理的帧数，参数无效时返回 -1
+     */
+    external fun processBufferPlanar(handle: Long, buffer: ByteBuffer, numFrames: Int): Int
+
+    /**
+     * 多声道会话的各声道分给多个线程并行降噪，输出与单线程完全一致
+     *
+     * 线程池在这里创建并常驻到 [freeSession]，处理时不再创建线程。
+     * 单声道或 numThreads 为 1 时按单线程处理。
+     *
+     * @param handle [createSession] 返回的会话
+     * @param numThreads 线程数（含调用线程），超过声道数时按声道数
+     * @return 实际使用的线程数，参数无效时返回 -1
+     */
+    external fun setNumThreads(handle: Long, numThreads: Int): Int
+
+    /**
+     * 离线降噪整个 WAV 文件（16bit PCM，16/32/48kHz，任意声道数），结果写入 outputFile
+     *
+     * 文件切成若干段由多个线程并行处理，每段先用前面约 10 秒的音频预热噪声估计，
+     * 与整段顺序处理的结果非常接近；短于 20 秒的文件只用一个线程。
+     * 降噪器本身的延迟（16kHz 为 6ms）已经补偿，输出与输入等长、对齐，结尾的音频不会丢失。
+     * 整个文件读入内存处理，耗时较长，不要在主线程调用。
+     *
+     * @param inputFile 输入 WAV 路径
+     * @param outputFile 输出 WAV 路径，可以与输入相同
+     * @param level 降噪强度，同 [createSession]
+     * @param numThreads 线程数，0 为 CPU 核数
+     * @return 0 成功；-1 输入读取失败，-2 不是有效的 WAV，-3 格式或采样率不支持，-4 输出写入失败
+     */
+    external fun denoiseFile(inputFile: String, outputFile: String, level: Int, numThreads: Int): Int
+
+    /**
+     * 使用全部 CPU 核的 [denoiseFile]
+     */
+    fun denoiseFile(inputFile: String, outputFile: String, level: Int): Int =
+        denoiseFile(inputFile, outputFile, level, 0)
+
+    /**
+     * 释放降噪会话
+     */
+    external fun freeSession(handle: Long)
 }
\ No newline at end of file
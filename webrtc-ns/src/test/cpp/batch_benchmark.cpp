@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for the batch NS entry point (NsSession::ProcessBuffer, JNI
+/// processBuffer) against the per-frame path of noiseSuppressionByShort, which
+/// handles one 10 ms frame per call and copies the frame in & out as
+/// Get/ReleaseShortArrayElements does.
+///
+/// The batch path is fed in chunks of varying, frame-unaligned sizes. Its
+/// output must equal the per-frame output delayed by one 10 ms frame. The JNI
+/// transition itself can't be measured on the host; the number of calls per
+/// hour of audio is printed instead.
+///
+/// Usage: batch_benchmark [seconds of audio, default 60]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ns_session.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+// chunk sizes the batch path is fed with, in frames
+static const size_t CHUNKS[] = { 4096, 997, 20000, 1, 480 * 7 + 3 };
+static const size_t NUM_CHUNKS = sizeof(CHUNKS) / sizeof(CHUNKS[0]);
+
+struct Pipeline
+{
+    NoiseSuppressor ns;
+    AudioBuffer audio;
+    StreamConfig config;
+
+    Pipeline(int sampleRate, int channels)
+        : ns(NsConfigForLevel(1), sampleRate, channels),
+          audio(sampleRate, channels, sampleRate, channels, sampleRate, channels),
+          config(sampleRate, channels)
+    {
+    }
+};
+
+
+// Same steps as noiseSuppressionByShort for one frame
+static void processFrame(Pipeline &p, int16_t *javaArray, int16_t *data)
+{
+    memcpy(javaArray, data, p.config.num_samples() * sizeof(int16_t));
+
+    bool split_bands = p.config.sample_rate_hz() > 16000;
+    p.audio.CopyFrom(javaArray, p.config);
+    if (split_bands)
+    {
+        p.audio.SplitIntoFrequencyBands();
+    }
+    p.ns.Analyze(p.audio);
+    p.ns.Process(&p.audio);
+    if (split_bands)
+    {
+        p.audio.MergeFrequencyBands();
+    }
+    p.audio.CopyTo(p.config, javaArray);
+
+    memcpy(data, javaArray, p.config.num_samples() * sizeof(int16_t));
+}
+
+
+static bool run(int sampleRate, int channels, double seconds)
+{
+    std::vector<int16_t> input = bench::makeNoisySpeech(sampleRate, channels, seconds);
+    const size_t numFrames = input.size() / channels;
+
+    // per-frame path
+    std::vector<int16_t> perFrame = input;
+    Pipeline p1(sampleRate, channels);
+    const size_t frameSize = p1.config.num_frames();
+    std::vector<int16_t> javaArray(p1.config.num_samples());
+
+    double t0 = bench::now();
+    for (size_t pos = 0; pos + frameSize <= numFrames; pos += frameSize)
+    {
+        processFrame(p1, javaArray.data(), &perFrame[pos * channels]);
+    }
+    double perFrameTime = bench::now() - t0;
+
+    // batch path
+    std::vector<int16_t> batch = input;
+    NsSession session(sampleRate, channels, 1);
+    size_t numCalls = 0;
+
+    t0 = bench::now();
+    for (size_t pos = 0; pos < numFrames; numCalls ++)
+    {
+        size_t n = CHUNKS[numCalls % NUM_CHUNKS];
+        if (n > numFrames - pos) n = numFrames - pos;
+        session.ProcessBuffer(&batch[pos * channels], n);
+        pos += n;
+    }
+    double batchTime = bench::now() - t0;
+
+    // batch output lags by one frame
+    const size_t latency = session.LatencyFrames() * channels;
+    const size_t compared = (numFrames / frameSize - 1) * frameSize * channels;
+    bool same = memcmp(&batch[latency], &perFrame[0], compared * sizeof(int16_t)) == 0;
+
+    const double minutes = seconds / 60.0;
+    printf("%6d Hz %d ch: per-frame %6.1f ms/min, %6.0f calls/h | batch %6.1f ms/min, %5.0f calls/h | %s\n",
+           sampleRate, channels, 1000.0 * perFrameTime / minutes, 3600.0 * 100.0,
+           1000.0 * batchTime / minutes, 3600.0 * numCalls / seconds,
+           same ? "identical" : "MISMATCH");
+
+    if (!same)
+    {
+        fprintf(stderr, "batch_benchmark: %d Hz %d ch: batch output differs from per-frame output\n",
+                sampleRate, channels);
+    }
+    return same;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 60.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    printf("batch_benchmark: %.1f s noisy speech\n", seconds);
+
+    bool ok = true;
+    ok &= run(16000, 1, seconds);
+    ok &= run(48000, 1, seconds);
+    ok &= run(48000, 2, seconds);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Helpers shared by the host-side NS benchmarks: wall clock timer and a noisy
+/// speech-like test signal.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NS_BENCH_UTIL_H
+#define NS_BENCH_UTIL_H
+
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+namespace bench
+{
+
+/// Seconds elapsed since an arbitrary fixed point
+inline double now()
+{
+    using namespace std::chrono;
+    return duration_cast<duration<double> >(steady_clock::now().time_since_epoch()).count();
+}
+
+
+/// Deterministic pseudo-random value in range [-1, 1]
+inline double noise(unsigned int &seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (double)(seed >> 8) / (double)(1 << 23) - 1.0;
+}
+
+
+/// Converts a value in range [-1, 1] to a 16bit sample
+inline int16_t toS16(double v)
+{
+    if (v > 1.0) v = 1.0;
+    if (v < -1.0) v = -1.0;
+    return (int16_t)(v * 32767.0);
+}
+
+
+/// Generates interleaved noisy speech-like test signal: a glottal pulse train
+/// through two formant resonators, in syllables of 200 ms with a pause after
+/// every third, plus stationary noise 'snrDb' below the speech level. Each
+/// channel has its own noise.
+inline std::vector<int16_t> makeNoisySpeech(int sampleRate, int channels, double seconds, double snrDb = 10.0)
+{
+    // formant frequencies (F1, F2) of the vowels /a/, /i/, /u/, /e/, /o/
+    static const double formants[5][2] = { { 730, 1090 }, { 270, 2290 }, { 300, 870 }, { 530, 1840 }, { 570, 840 } };
+    const int numFrames = (int)(seconds * sampleRate);
+    const double noiseLevel = 0.1 * pow(10.0, -snrDb / 20.0);
+    std::vector<int16_t> data((size_t)numFrames * channels);
+    unsigned int seed = 8191;
+    double phase = 0, y1[2] = { 0, 0 }, y2[2] = { 0, 0 };
+
+    for (int i = 0; i < numFrames; i ++)
+    {
+        double t = (double)i / sampleRate;
+        int syllable = (int)(t / 0.2);
+        double st = t - 0.2 * syllable;
+        double env = (syllable % 4 == 3) ? 0.0 : sin(M_PI * st / 0.2);
+        double f = 120.0 * (1.0 + 0.15 * sin(2 * M_PI * 0.7 * t) - 0.3 * st);
+        double excitation = 0;
+
+        phase += f / sampleRate;
+        if (phase >= 1.0)
+        {
+            phase -= 1.0;
+            excitation = 1.0;
+        }
+
+        const double *fm = formants[syllable % 5];
+        double v = 0;
+        for (int k = 0; k < 2; k ++)
+        {
+            double r = exp(-M_PI * 80.0 / sampleRate);
+            double y = excitation + 2 * r * cos(2 * M_PI * fm[k] / sampleRate) * y1[k] - r * r * y2[k];
+            y2[k] = y1[k];
+            y1[k] = y;
+            v += y;
+        }
+        v *= 0.01 * env;
+        for (int c = 0; c < channels; c ++)
+        {
+            data[(size_t)i * channels + c] = toS16(v + noiseLevel * noise(seed));
+        }
+    }
+    return data;
+}
+
+}
+
+#endif
@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for the offline file denoiser (DenoiseInterleaved/DenoiseFile,
+/// JNI denoiseFile): denoises the same noisy speech with 1, 2, 4 and 8
+/// segments processed in parallel, each segment warmed up on the audio before
+/// it.
+///
+/// Prints the throughput in multiples of realtime, the speedup over the
+/// sequential run and the deviation of the segmented output from the
+/// sequential output: maximum difference in LSBs and the output-to-difference
+/// ratio in dB, with the default warm-up and without any (segments starting
+/// from a fresh noise estimate) for comparison. The speedup depends on the
+/// cores of the host. Checks:
+/// - the sequential run is bit-identical to NsSession::ProcessFrame frame by
+///   frame, including the zero-padded partial frame at the end, with the
+///   output moved back by NsSession::DelayFrames,
+/// - the output is aligned with the input: the cross-correlation of the
+///   first channels peaks within MAX_LAG frames of no lag,
+/// - the warmed-up segmented output stays within MIN_SNR_DB of the sequential
+///   output,
+/// - a WAV file round trip through DenoiseFile gives the same output.
+///
+/// Usage: denoise_file_benchmark [seconds of audio, default 120]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "ns_file.h"
+#include "ns_session.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+static const size_t THREADS[] = { 1, 2, 4, 8 };
+static const int LEVEL = 2;
+// the input does not end on a 10 ms frame boundary
+static const size_t TAIL_FRAMES = 37;
+// output-to-difference ratio the warmed-up segments have to keep
+static const double MIN_SNR_DB = 30.0;
+// lag of the output the alignment check allows, in frames: the QMF of 32 kHz
+// delays speech by about 4 frames that DelayFrames does not count
+static const int MAX_LAG = 5;
+
+
+struct Deviation
+{
+    int maxDiff;
+    double snrDb;
+};
+
+
+static Deviation deviation(const std::vector<int16_t> &reference, const std::vector<int16_t> &output)
+{
+    Deviation d = { 0, INFINITY };
+    double signal = 0, error = 0;
+    for (size_t i = 0; i < reference.size(); i ++)
+    {
+        int diff = abs(output[i] - reference[i]);
+        d.maxDiff = std::max(d.maxDiff, diff);
+        signal += (double)reference[i] * reference[i];
+        error += (double)diff * diff;
+    }
+    if (error > 0) d.snrDb = 10.0 * log10(signal / error);
+    return d;
+}
+
+
+// Lag of 'output' behind 'input' in range [-2 * MAX_LAG, 2 * MAX_LAG] with the
+// highest cross-correlation, first channel
+static int lag(const std::vector<int16_t> &input, const std::vector<int16_t> &output, size_t channels)
+{
+    int best = 0;
+    double bestCorr = -INFINITY;
+    const int frames = (int)(input.size() / channels);
+    for (int l = -2 * MAX_LAG; l <= 2 * MAX_LAG; l ++)
+    {
+        double corr = 0;
+        for (int i = std::max(0, -l); i < std::min(frames, frames - l); i ++)
+        {
+            corr += (double)input[i * channels] * output[(i + l) * channels];
+        }
+        if (corr > bestCorr)
+        {
+            bestCorr = corr;
+            best = l;
+        }
+    }
+    return best;
+}
+
+
+// Denoises a copy of 'input' with DenoiseInterleaved, returns the elapsed seconds
+static double denoise(const WavData &input, size_t threads, size_t warmupBlocks, std::vector<int16_t> &output)
+{
+    output = input.samples;
+    double t0 = bench::now();
+    DenoiseInterleaved(output.data(), input.NumFrames(), input.sample_rate_hz, input.num_channels,
+                       LEVEL, threads, warmupBlocks);
+    return bench::now() - t0;
+}
+
+
+// Single session, frame by frame, the tail padded with zeros and one more
+// frame of zeros, the output moved back by the delay of the NS
+static std::vector<int16_t> processFrames(const WavData &input)
+{
+    NsSession session(input.sample_rate_hz, input.num_channels, LEVEL);
+    const size_t frameSamples = session.FrameSize() * input.num_channels;
+    const size_t delaySamples = session.DelayFrames() * input.num_channels;
+    std::vector<int16_t> output = input.samples;
+    output.resize((output.size() + frameSamples - 1) / frameSamples * frameSamples + frameSamples, 0);
+    for (size_t i = 0; i < output.size(); i += frameSamples)
+    {
+        session.ProcessFrame(&output[i]);
+    }
+    return std::vector<int16_t>(output.begin() + delaySamples, output.begin() + delaySamples + input.samples.size());
+}
+
+
+static bool run(int sampleRate, size_t channels, double seconds)
+{
+    WavData input;
+    input.sample_rate_hz = sampleRate;
+    input.num_channels = channels;
+    input.samples = bench::makeNoisySpeech(sampleRate, (int)channels, seconds);
+    input.samples.resize(input.samples.size() + TAIL_FRAMES * channels, 0);
+    const double duration = (double)input.NumFrames() / sampleRate;
+
+    std::vector<int16_t> sequential;
+    double sequentialTime = denoise(input, 1, kDenoiseWarmupBlocks, sequential);
+    bool ok = (sequential == processFrames(input));
+    if (!ok)
+    {
+        fprintf(stderr, "denoise_file_benchmark: %d Hz %zu ch: sequential run differs from ProcessFrame\n",
+                sampleRate, channels);
+    }
+
+    int outputLag = lag(input.samples, sequential, channels);
+    if (abs(outputLag) > MAX_LAG)
+    {
+        fprintf(stderr, "denoise_file_benchmark: %d Hz %zu ch: output lags the input by %d frames\n",
+                sampleRate, channels, outputLag);
+        ok = false;
+    }
+
+    printf("%5d Hz %zu ch, %.1f s, output lag %d frames\n", sampleRate, channels, duration, outputLag);
+    printf("  %7s %9s %8s %12s %12s %12s\n", "threads", "realtime", "speedup", "max diff", "SNR dB",
+           "no warm-up");
+    printf("  %7d %8.1fx %7.2fx\n", 1, duration / sequentialTime, 1.0);
+    for (size_t threads : THREADS)
+    {
+        if (threads == 1) continue;
+
+        std::vector<int16_t> output, cold;
+        double elapsed = denoise(input, threads, kDenoiseWarmupBlocks, output);
+        denoise(input, threads, 0, cold);
+        Deviation warm = deviation(sequential, output);
+        Deviation fresh = deviation(sequential, cold);
+
+        printf("  %7zu %8.1fx %7.2fx %8d LSB %12.1f %8.1f dB\n", threads, duration / elapsed,
+               sequentialTime / elapsed, warm.maxDiff, warm.snrDb, fresh.snrDb);
+        if (warm.snrDb < MIN_SNR_DB)
+        {
+            fprintf(stderr, "denoise_file_benchmark: %d Hz %zu ch: %zu threads deviate from sequential "
+                    "(%.1f dB)\n", sampleRate, channels, threads, warm.snrDb);
+            ok = false;
+        }
+    }
+
+    // WAV round trip, output written over the input file
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/denoise_file_benchmark_%d_%zu.wav", sampleRate, channels);
+    std::vector<int16_t> expected;
+    denoise(input, 2, kDenoiseWarmupBlocks, expected);
+    WavData result;
+    int status = WriteWav(path, input);
+    if (status == kNsFileOk) status = DenoiseFile(path, path, LEVEL, 2);
+    if (status == kNsFileOk) status = ReadWav(path, &result);
+    remove(path);
+    if ((status != kNsFileOk) || (result.sample_rate_hz != sampleRate) || (result.num_channels != channels) ||
+        (result.samples != expected))
+    {
+        fprintf(stderr, "denoise_file_benchmark: %d Hz %zu ch: WAV round trip failed (%d)\n",
+                sampleRate, channels, status);
+        ok = false;
+    }
+    return ok;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 120.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    printf("denoise_file_benchmark: %.1f s noisy speech, %u hardware threads\n", seconds,
+           std::thread::hardware_concurrency());
+    bool ok = true;
+    ok &= run(16000, 1, seconds);
+    ok &= run(32000, 1, seconds);
+    ok &= run(48000, 1, seconds);
+    ok &= run(48000, 2, seconds);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Accuracy test of the 256 point real FFT of the NS (NrFft) against the Ooura
+/// rdft of fft4g.cc, which NrFft used before and which defines the expected
+/// layout, signs and scaling.
+///
+/// Forward: random frames of several levels plus impulses and a DC/Nyquist
+/// frame, compared bin by bin. Inverse: random spectra compared with the
+/// inverse rdft, and forward + inverse round trips. Errors are relative to the
+/// peak magnitude of the frame or spectrum. Fails above 1e-5.
+///
+/// Usage: fft_test [number of random frames, default 10000]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <array>
+#include <vector>
+
+#include "fft4g.h"
+#include "ns_fft.h"
+#include "ns_simd.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+static const double MAX_ERROR = 1e-5;
+
+typedef std::array<float, kFftSize> Frame;
+
+// fft4g reference with the unpacking of the former NrFft
+class ReferenceFft
+{
+public:
+    ReferenceFft() : ip(kFftSize / 2), w(kFftSize / 2)
+    {
+        Frame tmp{};
+        ip[0] = 0;
+        WebRtc_rdft(kFftSize, 1, tmp.data(), ip.data(), w.data());
+    }
+
+    void fft(Frame x, Frame &real, Frame &imag)
+    {
+        WebRtc_rdft(kFftSize, 1, x.data(), ip.data(), w.data());
+        real[0] = x[0];
+        imag[0] = 0;
+        real[kFftSizeBy2Plus1 - 1] = x[1];
+        imag[kFftSizeBy2Plus1 - 1] = 0;
+        for (size_t i = 1; i < kFftSizeBy2Plus1 - 1; i ++)
+        {
+            real[i] = x[2 * i];
+            imag[i] = x[2 * i + 1];
+        }
+    }
+
+    void ifft(const Frame &real, const Frame &imag, Frame &x)
+    {
+        x[0] = real[0];
+        x[1] = real[kFftSizeBy2Plus1 - 1];
+        for (size_t i = 1; i < kFftSizeBy2Plus1 - 1; i ++)
+        {
+            x[2 * i] = real[i];
+            x[2 * i + 1] = imag[i];
+        }
+        WebRtc_rdft(kFftSize, -1, x.data(), ip.data(), w.data());
+        for (size_t i = 0; i < kFftSize; i ++)
+        {
+            x[i] *= 2.f / kFftSize;
+        }
+    }
+
+private:
+    std::vector<size_t> ip;
+    std::vector<float> w;
+};
+
+
+static double peak(const Frame &a, size_t n)
+{
+    double p = 0;
+    for (size_t i = 0; i < n; i ++)
+    {
+        p = fmax(p, fabs(a[i]));
+    }
+    return p > 0 ? p : 1;
+}
+
+
+static double error(const Frame &a, const Frame &b, size_t n)
+{
+    double e = 0;
+    for (size_t i = 0; i < n; i ++)
+    {
+        e = fmax(e, fabs((double)a[i] - b[i]));
+    }
+    return e;
+}
+
+
+int main(int argc, char **argv)
+{
+    int numFrames = (argc > 1) ? atoi(argv[1]) : 10000;
+    if (numFrames < 1) numFrames = 1;
+
+    NrFft fft;
+    ReferenceFft ref;
+    unsigned int seed = 1;
+    double maxForward = 0, maxInverse = 0, maxRoundTrip = 0;
+    std::vector<Frame> frames;
+
+    // impulses, DC and Nyquist
+    for (size_t pos : { 0, 1, 2, 127, 128, 255 })
+    {
+        Frame x{};
+        x[pos] = 1.f;
+        frames.push_back(x);
+    }
+    Frame dcNyquist;
+    for (size_t i = 0; i < kFftSize; i ++)
+    {
+        dcNyquist[i] = 0.5f + ((i & 1) ? -0.25f : 0.25f);
+    }
+    frames.push_back(dcNyquist);
+    for (int f = 0; f < numFrames; f ++)
+    {
+        // levels from about 1 to 32768 as for 16 bit audio in float
+        const double level = pow(2.0, f % 16);
+        Frame x;
+        for (size_t i = 0; i < kFftSize; i ++)
+        {
+            x[i] = (float)(level * bench::noise(seed));
+        }
+        frames.push_back(x);
+    }
+
+    for (const Frame &x : frames)
+    {
+        Frame real{}, imag{}, refReal{}, refImag{}, y{}, refY{};
+
+        // forward; NrFft may use the time data as scratch
+        Frame tmp = x;
+        fft.Fft(tmp, real, imag);
+        ref.fft(x, refReal, refImag);
+        double scale = fmax(peak(refReal, kFftSizeBy2Plus1), peak(refImag, kFftSizeBy2Plus1));
+        double e = fmax(error(real, refReal, kFftSizeBy2Plus1), error(imag, refImag, kFftSizeBy2Plus1));
+        maxForward = fmax(maxForward, e / scale);
+
+        fft.Ifft(real, imag, y);
+        maxRoundTrip = fmax(maxRoundTrip, error(x, y, kFftSize) / peak(x, kFftSize));
+
+        // inverse of a random spectrum; the imaginary parts of DC & Nyquist
+        // are ignored by both
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            real[i] = (float)(x[i] + x[kFftSize - 1 - i]);
+            imag[i] = (float)(x[i] - x[kFftSize - 1 - i]);
+        }
+        fft.Ifft(real, imag, y);
+        ref.ifft(real, imag, refY);
+        maxInverse = fmax(maxInverse, error(y, refY, kFftSize) / peak(refY, kFftSize));
+    }
+
+    printf("fft_test [%s]: %d frames\n", SimdName(), (int)frames.size());
+    printf("max relative error: forward %.2e, inverse %.2e, round trip %.2e\n",
+           maxForward, maxInverse, maxRoundTrip);
+
+    if ((maxForward > MAX_ERROR) || (maxInverse > MAX_ERROR) || (maxRoundTrip > MAX_ERROR))
+    {
+        fprintf(stderr, "fft_test: error above %.0e\n", MAX_ERROR);
+        return 1;
+    }
+    return 0;
+}
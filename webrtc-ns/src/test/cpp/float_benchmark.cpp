@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for the float NS entry points (NsSession::ProcessFrame/
+/// ProcessBuffer on float data, JNI processFrameFloat, processBufferFloat and
+/// processBufferPlanar) against a float pipeline going through the 16 bit
+/// entry point, which converts float -> s16 before and s16 -> float after each
+/// frame on top of the S16 conversions inside AudioBuffer.
+///
+/// Prints microseconds per 10 ms frame for the s16 round trip, the float
+/// interleaved and the float planar path, both for the whole frame and for
+/// the conversions into and out of AudioBuffer alone, which is what the float
+/// paths save on; the whole frame time is dominated by the NS. Checks:
+/// - interleaved and planar float output are bit-identical,
+/// - the float output differs from the s16 output only by the output rounding,
+///   as the test input is exactly representable in 16 bit,
+/// - the float ProcessBuffer, fed in frame-unaligned chunks, equals the
+///   per-frame output delayed by one frame.
+///
+/// Usage: float_benchmark [seconds of audio, default 20]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ns_session.h"
+#include "audio_util.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+static const int ROUNDS = 3;
+// chunk sizes the batch path is fed with, in frames
+static const size_t CHUNKS[] = { 4096, 997, 1, 480 * 7 + 3 };
+static const size_t NUM_CHUNKS = sizeof(CHUNKS) / sizeof(CHUNKS[0]);
+
+enum Path { PATH_S16, PATH_INTERLEAVED, PATH_PLANAR, NUM_PATHS };
+static const char *PATH_NAMES[NUM_PATHS] = { "s16 round trip", "float interleaved", "float planar" };
+
+
+// Processes 'input' (interleaved float) frame by frame along 'path', returns
+// the interleaved output and the time per frame in microseconds
+static double process(Path path, int sampleRate, int channels, const std::vector<float> &input,
+                      std::vector<float> &output)
+{
+    double best = 1e9;
+    for (int r = 0; r < ROUNDS; r ++)
+    {
+        NsSession session(sampleRate, channels, 1);
+        const size_t frameSize = session.FrameSize();
+        const size_t numFrames = input.size() / channels / frameSize;
+        std::vector<int16_t> s16(frameSize * channels);
+        ChannelBuffer<float> planar(frameSize, channels);
+
+        // the planar caller keeps its data planar all the way
+        std::vector<float> data = input;
+        if (path == PATH_PLANAR)
+        {
+            for (size_t f = 0; f < numFrames; f ++)
+            {
+                Deinterleave(&input[f * frameSize * channels], frameSize, channels, planar.channels());
+                for (int c = 0; c < channels; c ++)
+                {
+                    std::copy(planar.channels()[c], planar.channels()[c] + frameSize,
+                              &data[(f * channels + c) * frameSize]);
+                }
+            }
+        }
+
+        std::vector<float *> channelPtrs(channels);
+        double t0 = bench::now();
+        for (size_t f = 0; f < numFrames; f ++)
+        {
+            float *frame = &data[f * frameSize * channels];
+            switch (path)
+            {
+                case PATH_S16:
+                    FloatToS16(frame, frameSize * channels, s16.data());
+                    session.ProcessFrame(s16.data());
+                    S16ToFloat(s16.data(), frameSize * channels, frame);
+                    break;
+                case PATH_INTERLEAVED:
+                    session.ProcessFrame(frame);
+                    break;
+                case PATH_PLANAR:
+                    for (int c = 0; c < channels; c ++) channelPtrs[c] = frame + c * frameSize;
+                    session.ProcessFrame(channelPtrs.data());
+                    break;
+                default:
+                    break;
+            }
+        }
+        double elapsed = bench::now() - t0;
+        best = std::min(best, 1e6 * elapsed / numFrames);
+
+        output = data;
+        if (path == PATH_PLANAR)
+        {
+            for (size_t f = 0; f < numFrames; f ++)
+            {
+                for (int c = 0; c < channels; c ++) channelPtrs[c] = &data[(f * channels + c) * frameSize];
+                Interleave(channelPtrs.data(), frameSize, channels, &output[f * frameSize * channels]);
+            }
+        }
+    }
+    return best;
+}
+
+
+// Time per frame of the conversions alone, into and out of AudioBuffer along
+// 'path', without the NS: the part of the frame time the float paths save on
+static double conversionMicros(Path path, int sampleRate, int channels, const std::vector<float> &input)
+{
+    const int count = 20000;
+    StreamConfig config(sampleRate, channels);
+    AudioBuffer audio(sampleRate, channels, sampleRate, channels, sampleRate, channels);
+    const size_t frameSize = config.num_frames();
+    std::vector<float> frame(input.begin(), input.begin() + frameSize * channels);
+    std::vector<int16_t> s16(frameSize * channels);
+    ChannelBuffer<float> planar(frameSize, channels);
+
+    double best = 1e9;
+    for (int r = 0; r < ROUNDS; r ++)
+    {
+        double t0 = bench::now();
+        for (int i = 0; i < count; i ++)
+        {
+            switch (path)
+            {
+                case PATH_S16:
+                    FloatToS16(frame.data(), frame.size(), s16.data());
+                    audio.CopyFrom(s16.data(), config);
+                    audio.CopyTo(config, s16.data());
+                    S16ToFloat(s16.data(), s16.size(), frame.data());
+                    break;
+                case PATH_INTERLEAVED:
+                    audio.CopyFrom(frame.data(), config);
+                    audio.CopyTo(config, frame.data());
+                    break;
+                case PATH_PLANAR:
+                    audio.CopyFrom(planar.channels(), config);
+                    audio.CopyTo(config, planar.channels());
+                    break;
+                default:
+                    break;
+            }
+        }
+        best = std::min(best, 1e6 * (bench::now() - t0) / count);
+    }
+    return best;
+}
+
+
+// Feeds 'input' in frame-unaligned chunks to the float ProcessBuffer,
+// alternating interleaved and planar chunks (ProcessBufferPlanar, as JNI
+// processBufferPlanar), returns the output
+static std::vector<float> processBuffer(int sampleRate, int channels, const std::vector<float> &input)
+{
+    NsSession session(sampleRate, channels, 1);
+    std::vector<float> output = input;
+    const size_t numFrames = input.size() / channels;
+    std::vector<float> planar;
+    std::vector<float *> channelPtrs(channels);
+
+    size_t pos = 0;
+    for (size_t i = 0; pos < numFrames; i ++)
+    {
+        size_t n = std::min(CHUNKS[i % NUM_CHUNKS], numFrames - pos);
+        float *chunk = &output[pos * channels];
+        if (i % 2 == 0)
+        {
+            session.ProcessBuffer(chunk, n);
+        }
+        else
+        {
+            planar.resize(n * channels);
+            for (int c = 0; c < channels; c ++) channelPtrs[c] = &planar[c * n];
+            Deinterleave(chunk, n, channels, channelPtrs.data());
+            session.ProcessBufferPlanar(planar.data(), n);
+            Interleave(channelPtrs.data(), n, channels, chunk);
+        }
+        pos += n;
+    }
+    return output;
+}
+
+
+static bool run(int sampleRate, int channels, double seconds)
+{
+    std::vector<int16_t> s16 = bench::makeNoisySpeech(sampleRate, channels, seconds);
+    std::vector<float> input(s16.size());
+    S16ToFloat(s16.data(), s16.size(), input.data());
+
+    std::vector<float> output[NUM_PATHS];
+    double micros[NUM_PATHS];
+    for (int p = 0; p < NUM_PATHS; p ++)
+    {
+        micros[p] = process((Path)p, sampleRate, channels, input, output[p]);
+    }
+
+    // float output vs s16 output, in 16 bit LSBs
+    double maxDiff = 0;
+    for (size_t i = 0; i < output[PATH_S16].size(); i ++)
+    {
+        maxDiff = std::max(maxDiff, 32768.0 * fabs(output[PATH_INTERLEAVED][i] - output[PATH_S16][i]));
+    }
+    bool ok = (output[PATH_INTERLEAVED] == output[PATH_PLANAR]) && (maxDiff <= 1.0);
+
+    // batch output is the per-frame output delayed by one frame
+    std::vector<float> batch = processBuffer(sampleRate, channels, input);
+    const size_t latency = (size_t)(sampleRate / 100) * channels;
+    const size_t processed = output[PATH_INTERLEAVED].size() - latency;
+    bool batchOk = std::equal(output[PATH_INTERLEAVED].begin(), output[PATH_INTERLEAVED].begin() + processed,
+                              batch.begin() + latency);
+    for (size_t i = 0; i < latency; i ++)
+    {
+        batchOk &= (batch[i] == 0.f);
+    }
+    ok &= batchOk;
+
+    printf("%5d Hz %d ch: max diff %.2f LSB, batch %s\n", sampleRate, channels, maxDiff,
+           batchOk ? "ok" : "MISMATCH");
+    for (int p = 0; p < NUM_PATHS; p ++)
+    {
+        printf("  %-18s frame %7.2f us, conversions %5.2f us\n", PATH_NAMES[p], micros[p],
+               conversionMicros((Path)p, sampleRate, channels, input));
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "float_benchmark: %d Hz %d ch: float output mismatch\n", sampleRate, channels);
+    }
+    return ok;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    printf("float_benchmark: %.1f s noisy speech, time per 10 ms frame\n", seconds);
+    bool ok = true;
+    ok &= run(16000, 1, seconds);
+    ok &= run(16000, 2, seconds);
+    ok &= run(48000, 1, seconds);
+    ok &= run(48000, 2, seconds);
+    return ok ? 0 : 1;
+}
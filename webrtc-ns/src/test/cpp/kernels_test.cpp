@@ -0,0 +1,558 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Tolerance test of the vectorized NS kernels against their scalar versions:
+///
+/// - the 4-wide fast_math approximations (log, 2^x, x^p, e^x) and the array
+///   forms, against the scalar approximations & powf
+/// - WienerFilter::Update, SignalModelEstimator::Update (spectral flatness,
+///   spectral difference, LRT) and NoiseEstimator (quantile estimate, startup
+///   noise model, noise update), run frame by frame on random spectra against
+///   scalar reference copies of the former per-bin loops
+///
+/// The estimators are recursive, so their errors accumulate over the frames;
+/// the limits allow for that. Prints the largest errors, fails above a limit.
+///
+/// Usage: kernels_test [number of frames, default 400]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <array>
+
+#include "fast_math.h"
+#include "noise_estimator.h"
+#include "signal_model_estimator.h"
+#include "suppression_params.h"
+#include "wiener_filter.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+typedef std::array<float, kFftSizeBy2Plus1> Spectrum;
+
+static bool ok = true;
+
+
+static double relError(double value, double ref)
+{
+    return fabs(value - ref) / std::max(fabs(ref), 1e-30);
+}
+
+
+// Largest relative error of 'value' against 'ref', relative to the largest
+// magnitude in 'ref' so that bins near zero don't dominate
+static double maxError(const float *value, const float *ref, size_t n)
+{
+    double scale = 1e-30, e = 0;
+    for (size_t i = 0; i < n; i ++)
+    {
+        scale = std::max(scale, fabs((double)ref[i]));
+        e = std::max(e, fabs((double)value[i] - ref[i]));
+    }
+    return e / scale;
+}
+
+
+static void check(const char *name, double error, double limit)
+{
+    printf("  %-28s %.2e (limit %.0e)\n", name, error, limit);
+    if (!(error <= limit))
+    {
+        fprintf(stderr, "kernels_test: %s: error %.2e above %.0e\n", name, error, limit);
+        ok = false;
+    }
+}
+
+
+static float uniform(unsigned int &seed, float lo, float hi)
+{
+    return lo + (hi - lo) * (float)(0.5 * (bench::noise(seed) + 1.0));
+}
+
+
+// Magnitude spectrum of a frame with a random level and tilt, at least 1 as
+// ComputeMagnitudeSpectrum produces
+static void randomSpectrum(unsigned int &seed, Spectrum &s)
+{
+    const float level = powf(10.f, uniform(seed, 0.f, 4.f));
+    const float tilt = uniform(seed, -1.f, 0.f);
+    for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+    {
+        s[i] = 1.f + level * powf(i + 1.f, tilt) * fabsf((float)bench::noise(seed));
+    }
+}
+
+
+/*****************************************************************************
+ *
+ * fast_math
+ *
+ *****************************************************************************/
+
+static void testFastMath()
+{
+    unsigned int seed = 7;
+    double logError = 0, pow2Error = 0, powError = 0, expError = 0;
+
+    printf("fast_math:\n");
+    for (int n = 0; n < 100000; n ++)
+    {
+        alignas(16) float x[4], p[4], y[4];
+
+        // log over 1e-6 .. 1e10; absolute error as the log crosses zero
+        for (int k = 0; k < 4; k ++) x[k] = powf(10.f, uniform(seed, -6.f, 10.f));
+        Store4(y, LogApproximation(Load4(x)));
+        for (int k = 0; k < 4; k ++) logError = std::max(logError, fabs((double)y[k] - LogApproximation(x[k])));
+
+        // 2^p over the normal range, against powf
+        for (int k = 0; k < 4; k ++) p[k] = uniform(seed, -126.f, 127.f);
+        Store4(y, Pow2Approximation(Load4(p)));
+        for (int k = 0; k < 4; k ++) pow2Error = std::max(pow2Error, relError(y[k], powf(2.f, p[k])));
+
+        // x^p as used for the pink noise model
+        for (int k = 0; k < 4; k ++)
+        {
+            x[k] = uniform(seed, 1.f, 200.f);
+            p[k] = uniform(seed, 0.f, 3.f);
+        }
+        Store4(y, PowApproximation(Load4(x), Load4(p)));
+        for (int k = 0; k < 4; k ++) powError = std::max(powError, relError(y[k], PowApproximation(x[k], p[k])));
+
+        // e^x where the result is a normal float
+        for (int k = 0; k < 4; k ++) x[k] = uniform(seed, -85.f, 85.f);
+        Store4(y, ExpApproximation(Load4(x)));
+        for (int k = 0; k < 4; k ++) expError = std::max(expError, relError(y[k], ExpApproximation(x[k])));
+    }
+    check("log (absolute)", logError, 1e-5);
+    check("2^x", pow2Error, 1e-6);
+    check("x^p", powError, 2e-6);
+    check("e^x", expError, 2e-6);
+
+    // under- and overflow
+    alignas(16) float edge[4] = { -160.f, -140.f, 128.5f, 0.f }, y[4];
+    Store4(y, Pow2Approximation(Load4(edge)));
+    bool edgeOk = (y[0] == 0.f) && (y[1] > 0.f) && (relError(y[1], powf(2.f, -140.f)) < 1e-2) &&
+                  isinf(y[2]) && (y[3] == 1.f);
+    check("2^x under/overflow", edgeOk ? 0.0 : 1.0, 0.0);
+
+    // array forms incl. the scalar tail
+    Spectrum in, out, ref;
+    for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) in[i] = uniform(seed, -20.f, 20.f);
+    ExpApproximation(in, out);
+    for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) ref[i] = ExpApproximation(in[i]);
+    double arrayError = 0;
+    for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) arrayError = std::max(arrayError, relError(out[i], ref[i]));
+    ExpApproximationSignFlip(in, out);
+    for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) arrayError = std::max(arrayError, relError(out[i], ExpApproximation(-in[i])));
+    for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) in[i] = fabsf(in[i]) + 1e-3f;
+    LogApproximation(in, out);
+    for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) arrayError = std::max(arrayError, relError(out[i], LogApproximation(in[i])));
+    check("array forms", arrayError, 2e-6);
+}
+
+
+/*****************************************************************************
+ *
+ * WienerFilter
+ *
+ *****************************************************************************/
+
+// Scalar WienerFilter::Update
+class ReferenceWienerFilter
+{
+public:
+    Spectrum filter, initialEstimate, prevSpectrum;
+
+    explicit ReferenceWienerFilter(const SuppressionParams &p) : params(p)
+    {
+        filter.fill(1.f);
+        initialEstimate.fill(0.f);
+        prevSpectrum.fill(0.f);
+    }
+
+    void update(int frames, const Spectrum &noise, const Spectrum &prevNoise, const Spectrum &parametric,
+                const Spectrum &signal)
+    {
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            float prevTsa = prevSpectrum[i] / (prevNoise[i] + 0.0001f) * filter[i];
+            float currentTsa = signal[i] > noise[i] ? signal[i] / (noise[i] + 0.0001f) - 1.f : 0.f;
+            float snrPrior = 0.98f * prevTsa + (1.f - 0.98f) * currentTsa;
+            filter[i] = snrPrior / (params.over_subtraction_factor + snrPrior);
+            filter[i] = std::max(std::min(filter[i], 1.f), params.minimum_attenuating_gain);
+        }
+        if (frames < kShortStartupPhaseBlocks)
+        {
+            for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+            {
+                initialEstimate[i] += signal[i];
+                float initial = initialEstimate[i] - params.over_subtraction_factor * parametric[i];
+                initial /= initialEstimate[i] + 0.0001f;
+                initial = std::max(std::min(initial, 1.f), params.minimum_attenuating_gain);
+                initial *= kShortStartupPhaseBlocks - frames;
+                filter[i] *= frames;
+                filter[i] += initial;
+                filter[i] *= 1.f / kShortStartupPhaseBlocks;
+            }
+        }
+        prevSpectrum = signal;
+    }
+
+private:
+    const SuppressionParams &params;
+};
+
+
+static void testWienerFilter(int numFrames)
+{
+    SuppressionParams params(NsConfig::SuppressionLevel::k12dB);
+    WienerFilter filter(params);
+    ReferenceWienerFilter ref(params);
+    unsigned int seed = 11;
+    Spectrum noise, prevNoise, parametric, signal;
+    double error = 0;
+
+    randomSpectrum(seed, noise);
+    for (int f = 0; f < numFrames; f ++)
+    {
+        prevNoise = noise;
+        randomSpectrum(seed, noise);
+        randomSpectrum(seed, parametric);
+        randomSpectrum(seed, signal);
+        filter.Update(f, noise, prevNoise, parametric, signal);
+        ref.update(f, noise, prevNoise, parametric, signal);
+        error = std::max(error, maxError(filter.get_filter().data(), ref.filter.data(), kFftSizeBy2Plus1));
+    }
+    printf("WienerFilter::Update, %d frames:\n", numFrames);
+    check("filter", error, 1e-5);
+}
+
+
+/*****************************************************************************
+ *
+ * SignalModelEstimator
+ *
+ *****************************************************************************/
+
+static void testSignalModel(int numFrames)
+{
+    // the spectral difference normalization stays 0 without AdjustNormalization
+    // until the first histogram window ends
+    numFrames = std::min(numFrames, kFeatureUpdateWindowSize - 1);
+
+    SignalModelEstimator estimator;
+    unsigned int seed = 13;
+    float flatness = estimator.get_model().spectral_flatness;
+    float diff = estimator.get_model().spectral_diff;
+    Spectrum avgLogLrt = estimator.get_model().avg_log_lrt;
+    float lrt = 0;
+    double flatnessError = 0, diffError = 0, lrtError = 0, avgLogLrtError = 0;
+
+    for (int f = 0; f < numFrames; f ++)
+    {
+        Spectrum priorSnr, postSnr, conservative, signal;
+        randomSpectrum(seed, signal);
+        randomSpectrum(seed, conservative);
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            postSnr[i] = uniform(seed, 0.f, 50.f);
+            priorSnr[i] = uniform(seed, 0.f, 50.f);
+        }
+        float sum = 0, energy = 0;
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            sum += signal[i];
+            energy += signal[i] * signal[i];
+        }
+        estimator.Update(priorSnr, postSnr, conservative, signal, sum, energy);
+
+        // spectral flatness
+        float logSum = 0;
+        for (size_t i = 1; i < kFftSizeBy2Plus1; i ++) logSum += LogApproximation(signal[i]);
+        float geometric = ExpApproximation(logSum / kFftSizeBy2Plus1);
+        flatness += 0.3f * (geometric / ((sum - signal[0]) / kFftSizeBy2Plus1) - flatness);
+
+        // spectral difference
+        float noiseAverage = 0;
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) noiseAverage += conservative[i];
+        noiseAverage /= kFftSizeBy2Plus1;
+        float signalAverage = sum / kFftSizeBy2Plus1;
+        float covariance = 0, noiseVariance = 0, signalVariance = 0;
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            float s = signal[i] - signalAverage;
+            float n = conservative[i] - noiseAverage;
+            covariance += s * n;
+            noiseVariance += n * n;
+            signalVariance += s * s;
+        }
+        covariance /= kFftSizeBy2Plus1;
+        noiseVariance /= kFftSizeBy2Plus1;
+        signalVariance /= kFftSizeBy2Plus1;
+        float spectralDiff = (signalVariance - covariance * covariance / (noiseVariance + 0.0001f)) / 0.0001f;
+        diff += 0.3f * (spectralDiff - diff);
+
+        // LRT
+        float lrtSum = 0;
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            float tmp1 = 1.f + 2.f * priorSnr[i];
+            float tmp2 = 2.f * priorSnr[i] / (tmp1 + 0.0001f);
+            float bessel = (postSnr[i] + 1.f) * tmp2;
+            avgLogLrt[i] += .5f * (bessel - LogApproximation(tmp1) - avgLogLrt[i]);
+            lrtSum += avgLogLrt[i];
+        }
+        lrt = lrtSum / kFftSizeBy2Plus1;
+
+        const SignalModel &model = estimator.get_model();
+        flatnessError = std::max(flatnessError, relError(model.spectral_flatness, flatness));
+        diffError = std::max(diffError, relError(model.spectral_diff, diff));
+        lrtError = std::max(lrtError, relError(model.lrt, lrt));
+        avgLogLrtError = std::max(avgLogLrtError,
+                                  maxError(model.avg_log_lrt.data(), avgLogLrt.data(), kFftSizeBy2Plus1));
+    }
+    printf("SignalModelEstimator::Update, %d frames:\n", numFrames);
+    check("spectral flatness", flatnessError, 1e-5);
+    check("spectral difference", diffError, 1e-4);
+    check("lrt", lrtError, 1e-5);
+    check("avg log lrt", avgLogLrtError, 1e-5);
+}
+
+
+/*****************************************************************************
+ *
+ * NoiseEstimator
+ *
+ *****************************************************************************/
+
+// Scalar QuantileNoiseEstimator::Estimate
+class ReferenceQuantile
+{
+public:
+    ReferenceQuantile()
+    {
+        quantile.fill(0.f);
+        density.fill(0.3f);
+        logQuantile.fill(8.f);
+        for (int s = 0; s < kSimult; s ++)
+        {
+            counter[s] = (int)floor(kLongStartupPhaseBlocks * (s + 1.f) / kSimult);
+        }
+    }
+
+    void estimate(const Spectrum &signal, Spectrum &noise)
+    {
+        Spectrum logSpectrum;
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) logSpectrum[i] = LogApproximation(signal[i]);
+
+        int index = -1;
+        for (int s = 0, k = 0; s < kSimult; s ++, k += (int)kFftSizeBy2Plus1)
+        {
+            const float oneByCounter = 1.f / (counter[s] + 1.f);
+            for (int i = 0, j = k; i < (int)kFftSizeBy2Plus1; i ++, j ++)
+            {
+                const float delta = density[j] > 1.f ? 40.f / density[j] : 40.f;
+                const float multiplier = delta * oneByCounter;
+                if (logSpectrum[i] > logQuantile[j])
+                {
+                    logQuantile[j] += 0.25f * multiplier;
+                }
+                else
+                {
+                    logQuantile[j] -= 0.75f * multiplier;
+                }
+                if (fabs(logSpectrum[i] - logQuantile[j]) < 0.01f)
+                {
+                    density[j] = (counter[s] * density[j] + 1.f / (2.f * 0.01f)) * oneByCounter;
+                }
+            }
+            if (counter[s] >= kLongStartupPhaseBlocks)
+            {
+                counter[s] = 0;
+                if (numUpdates >= kLongStartupPhaseBlocks) index = k;
+            }
+            counter[s] ++;
+        }
+        if (numUpdates < kLongStartupPhaseBlocks)
+        {
+            index = kFftSizeBy2Plus1 * (kSimult - 1);
+            numUpdates ++;
+        }
+        if (index >= 0)
+        {
+            for (size_t i = 0; i < kFftSizeBy2Plus1; i ++) quantile[i] = ExpApproximation(logQuantile[index + i]);
+        }
+        noise = quantile;
+    }
+
+private:
+    std::array<float, kSimult * kFftSizeBy2Plus1> density, logQuantile;
+    Spectrum quantile;
+    std::array<int, kSimult> counter;
+    int numUpdates = 1;
+};
+
+
+// Scalar NoiseEstimator
+class ReferenceNoiseEstimator
+{
+public:
+    Spectrum noise, prevNoise, conservative, parametric;
+
+    explicit ReferenceNoiseEstimator(const SuppressionParams &p) : params(p)
+    {
+        noise.fill(0.f);
+        prevNoise.fill(0.f);
+        conservative.fill(0.f);
+        parametric.fill(0.f);
+    }
+
+    void prepareAnalysis()
+    {
+        prevNoise = noise;
+    }
+
+    void preUpdate(int frames, const Spectrum &signal, float signalSum)
+    {
+        quantileEstimator.estimate(signal, noise);
+        if (frames >= kShortStartupPhaseBlocks) return;
+
+        const size_t kStartBand = 5;
+        float sumLogILogMagn = 0, sumLogI = 0, sumLogISquare = 0, sumLogMagn = 0;
+        for (size_t i = kStartBand; i < kFftSizeBy2Plus1; i ++)
+        {
+            float logI = logf((float)i);
+            sumLogI += logI;
+            sumLogISquare += logI * logI;
+            float logSignal = LogApproximation(signal[i]);
+            sumLogMagn += logSignal;
+            sumLogILogMagn += logI * logSignal;
+        }
+        whiteNoiseLevel += signalSum / kFftSizeBy2Plus1 * params.over_subtraction_factor;
+
+        float denom = sumLogISquare * (kFftSizeBy2Plus1 - kStartBand) - sumLogI * sumLogI;
+        float num = sumLogISquare * sumLogMagn - sumLogI * sumLogILogMagn;
+        pinkNoiseNumerator += std::max(num / denom, 0.f);
+        num = sumLogI * sumLogMagn - (kFftSizeBy2Plus1 - kStartBand) * sumLogILogMagn;
+        pinkNoiseExp += std::max(std::min(num / denom, 1.f), 0.f);
+
+        const float oneByFrames = 1.f / (frames + 1.f);
+        float parametricExp = 0, parametricNum = 0;
+        if (pinkNoiseExp > 0.f)
+        {
+            parametricNum = ExpApproximation(pinkNoiseNumerator * oneByFrames) * (frames + 1.f);
+            parametricExp = pinkNoiseExp * oneByFrames;
+        }
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            if (pinkNoiseExp == 0.f)
+            {
+                parametric[i] = whiteNoiseLevel;
+            }
+            else
+            {
+                float band = i < kStartBand ? kStartBand : i;
+                parametric[i] = parametricNum / PowApproximation(band, parametricExp);
+            }
+        }
+        float w = (float)(kShortStartupPhaseBlocks - frames);
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            noise[i] *= frames;
+            noise[i] += parametric[i] * w * oneByFrames;
+            noise[i] *= 1.f / kShortStartupPhaseBlocks;
+        }
+    }
+
+    void postUpdate(const Spectrum &prob, const Spectrum &signal)
+    {
+        float gamma = 0.9f;
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            const float mix = (1.f - prob[i]) * signal[i] + prob[i] * prevNoise[i];
+            float tmp = gamma * prevNoise[i] + (1.f - gamma) * mix;
+            float gammaOld = gamma;
+            gamma = prob[i] > .2f ? .99f : 0.9f;
+            if (prob[i] < .2f)
+            {
+                conservative[i] += 0.05f * (signal[i] - conservative[i]);
+            }
+            if (gamma == gammaOld)
+            {
+                noise[i] = tmp;
+            }
+            else
+            {
+                noise[i] = std::min(gamma * prevNoise[i] + (1.f - gamma) * mix, tmp);
+            }
+        }
+    }
+
+private:
+    const SuppressionParams &params;
+    ReferenceQuantile quantileEstimator;
+    float whiteNoiseLevel = 0, pinkNoiseNumerator = 0, pinkNoiseExp = 0;
+};
+
+
+static void testNoiseEstimator(int numFrames)
+{
+    SuppressionParams params(NsConfig::SuppressionLevel::k12dB);
+    NoiseEstimator estimator(params);
+    ReferenceNoiseEstimator ref(params);
+    unsigned int seed = 17;
+    double noiseError = 0, parametricError = 0, conservativeError = 0;
+
+    for (int f = 0; f < numFrames; f ++)
+    {
+        Spectrum signal, prob;
+        randomSpectrum(seed, signal);
+        float sum = 0;
+        for (size_t i = 0; i < kFftSizeBy2Plus1; i ++)
+        {
+            sum += signal[i];
+            // around the 0.2 threshold of the time constant
+            prob[i] = std::max(0.f, std::min(1.f, uniform(seed, -0.2f, 0.6f)));
+        }
+
+        estimator.PrepareAnalysis();
+        ref.prepareAnalysis();
+        estimator.PreUpdate(f, signal, sum);
+        ref.preUpdate(f, signal, sum);
+        parametricError = std::max(parametricError,
+                                   maxError(estimator.get_parametric_noise_spectrum().data(),
+                                            ref.parametric.data(), kFftSizeBy2Plus1));
+        noiseError = std::max(noiseError,
+                              maxError(estimator.get_noise_spectrum().data(), ref.noise.data(), kFftSizeBy2Plus1));
+
+        estimator.PostUpdate(prob, signal);
+        ref.postUpdate(prob, signal);
+        noiseError = std::max(noiseError,
+                              maxError(estimator.get_noise_spectrum().data(), ref.noise.data(), kFftSizeBy2Plus1));
+        conservativeError = std::max(conservativeError,
+                                     maxError(estimator.get_conservative_noise_spectrum().data(),
+                                              ref.conservative.data(), kFftSizeBy2Plus1));
+    }
+    printf("NoiseEstimator, %d frames:\n", numFrames);
+    check("parametric noise", parametricError, 1e-5);
+    check("noise", noiseError, 1e-4);
+    check("conservative noise", conservativeError, 1e-5);
+}
+
+
+int main(int argc, char **argv)
+{
+    int numFrames = (argc > 1) ? atoi(argv[1]) : 400;
+    if (numFrames < 1) numFrames = 1;
+
+    printf("kernels_test [%s]\n", SimdName());
+    testFastMath();
+    testWienerFilter(numFrames);
+    testSignalModel(numFrames);
+    testNoiseEstimator(numFrames);
+    return ok ? 0 : 1;
+}
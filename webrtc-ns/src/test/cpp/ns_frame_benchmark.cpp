@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Per-frame CPU cost of the NS: microseconds per 10 ms frame for the whole
+/// NsSession::ProcessFrame, and microseconds per NrFft forward + inverse pair,
+/// which the NS runs three times per channel and frame (Analyze: Fft, Process:
+/// Fft + Ifft).
+///
+/// The same source is built against the NS with the SIMD FFT (ns_frame_benchmark)
+/// and with the Ooura fft4g (ns_frame_benchmark_ooura) for comparison. Each
+/// measurement is the best of several rounds, to reduce timer noise.
+///
+/// Usage: ns_frame_benchmark [seconds of audio, default 20]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <array>
+#include <vector>
+
+#include "ns_session.h"
+#include "ns_fft.h"
+#include "ns_simd.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+static const int ROUNDS = 5;
+
+#if defined(WEBRTC_NS_OOURA_FFT)
+static const char *FFT_NAME = "ooura fft4g";
+#else
+static const char *FFT_NAME = "256 point real";
+#endif
+
+
+static double fftMicros()
+{
+    const int count = 20000;
+    NrFft fft;
+    std::array<float, kFftSize> x, real, imag;
+    unsigned int seed = 1;
+    double best = 1e9;
+    float sink = 0;
+
+    for (size_t i = 0; i < kFftSize; i ++)
+    {
+        x[i] = (float)(1000.0 * bench::noise(seed));
+    }
+    for (int r = 0; r < ROUNDS; r ++)
+    {
+        double t0 = bench::now();
+        for (int i = 0; i < count; i ++)
+        {
+            fft.Fft(x, real, imag);
+            fft.Ifft(real, imag, x);
+            sink += x[i & 255];
+        }
+        double elapsed = bench::now() - t0;
+        if (elapsed < best) best = elapsed;
+    }
+    if (sink == 12345.f) printf(" ");
+    return 1e6 * best / count;
+}
+
+
+static double frameMicros(int sampleRate, int channels, double seconds)
+{
+    const std::vector<int16_t> input = bench::makeNoisySpeech(sampleRate, channels, seconds);
+    std::vector<int16_t> data;
+    double best = 1e9;
+    size_t numProcessed = 0;
+
+    for (int r = 0; r < ROUNDS; r ++)
+    {
+        NsSession session(sampleRate, channels, 1);
+        const size_t frameSamples = session.FrameSize() * channels;
+        data = input;
+        numProcessed = 0;
+
+        double t0 = bench::now();
+        for (size_t pos = 0; pos + frameSamples <= data.size(); pos += frameSamples)
+        {
+            session.ProcessFrame(&data[pos]);
+            numProcessed ++;
+        }
+        double elapsed = bench::now() - t0;
+        if (elapsed < best) best = elapsed;
+    }
+    return 1e6 * best / numProcessed;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    printf("ns_frame_benchmark [%s, %s]: %.1f s noisy speech\n", FFT_NAME, SimdName(), seconds);
+    printf("fft + ifft: %6.2f us\n", fftMicros());
+    printf("16000 Hz 1 ch: %6.1f us/frame\n", frameMicros(16000, 1, seconds));
+    printf("48000 Hz 1 ch: %6.1f us/frame\n", frameMicros(48000, 1, seconds));
+    printf("48000 Hz 2 ch: %6.1f us/frame\n", frameMicros(48000, 2, seconds));
+    return 0;
+}
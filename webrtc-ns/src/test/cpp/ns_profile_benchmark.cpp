@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Per-stage profile of the NS frame time: microseconds per 10 ms frame and
+/// share of the NsSession::ProcessFrame time for each stage of Analyze and
+/// Process (see ns_profile.h), plus the remainder spent outside of the
+/// NoiseSuppressor in the band split & merge and the 16 bit conversion.
+///
+/// Built against the NS with WEBRTC_NS_PROFILE defined; the timers add some
+/// overhead, so the totals are a bit above those of ns_frame_benchmark.
+///
+/// Usage: ns_profile_benchmark [seconds of audio, default 20]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "ns_session.h"
+#include "ns_profile.h"
+#include "ns_simd.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+
+static void profile(int sampleRate, int channels, double seconds)
+{
+    std::vector<int16_t> data = bench::makeNoisySpeech(sampleRate, channels, seconds);
+    NsSession session(sampleRate, channels, 1);
+    const size_t frameSamples = session.FrameSize() * channels;
+    size_t numFrames = 0;
+
+    NsProfiler::Reset();
+    double t0 = bench::now();
+    for (size_t pos = 0; pos + frameSamples <= data.size(); pos += frameSamples)
+    {
+        session.ProcessFrame(&data[pos]);
+        numFrames ++;
+    }
+    const double total = bench::now() - t0;
+
+    printf("%d Hz %d ch: %.1f us/frame\n", sampleRate, channels, 1e6 * total / numFrames);
+    double staged = 0;
+    for (int s = 0; s < NsProfiler::kNumStages; s ++)
+    {
+        const double t = NsProfiler::Totals()[s];
+        printf("  %-20s %7.2f us %5.1f%%\n", NsProfiler::StageName(s), 1e6 * t / numFrames, 100.0 * t / total);
+        staged += t;
+    }
+    printf("  %-20s %7.2f us %5.1f%%\n", "split, merge, s16", 1e6 * (total - staged) / numFrames,
+           100.0 * (total - staged) / total);
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    printf("ns_profile_benchmark [%s]: %.1f s noisy speech\n", SimdName(), seconds);
+    profile(16000, 1, seconds);
+    profile(48000, 2, seconds);
+    return 0;
+}
@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark for the per-frame statistics of the NS (NsFrameStats through
+/// NsSession::ProcessFrame/ProcessBuffer, JNI processFrameStats and
+/// processBufferStats): the speech probability, a posteriori SNR and gain
+/// that make a separate VAD pass over the same audio unnecessary.
+///
+/// Prints the time per 10 ms frame with and without the statistics and the
+/// overhead, plus the average statistics in the speech and in the pauses of
+/// the test signal. Checks:
+/// - the output is bit-identical with and without the statistics,
+/// - ProcessBuffer, fed in frame-unaligned chunks, reports the same
+///   statistics as ProcessFrame for every frame,
+/// - the statistics separate speech from the pauses: higher speech
+///   probability, SNR and gain in the speech.
+///
+/// Usage: ns_stats_benchmark [seconds of audio, default 20]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ns_session.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+static const int ROUNDS = 5;
+static const int LEVEL = 2;
+// chunk sizes the batch path is fed with, in frames
+static const size_t CHUNKS[] = { 4096, 997, 1, 480 * 7 + 3 };
+static const size_t NUM_CHUNKS = sizeof(CHUNKS) / sizeof(CHUNKS[0]);
+// frames left out of the speech/pause averages while the estimators start up
+static const size_t STARTUP_FRAMES = 200;
+
+
+// Processes 'input' frame by frame with or without statistics, returns the
+// time per frame in microseconds
+static double process(int sampleRate, size_t channels, const std::vector<int16_t> &input, bool withStats,
+                      std::vector<int16_t> &output, std::vector<NsFrameStats> &stats)
+{
+    NsSession session(sampleRate, channels, LEVEL);
+    const size_t frameSamples = session.FrameSize() * channels;
+    const size_t numFrames = input.size() / frameSamples;
+    output = input;
+    stats.assign(withStats ? numFrames * channels : 0, NsFrameStats());
+
+    double t0 = bench::now();
+    for (size_t f = 0; f < numFrames; f ++)
+    {
+        session.ProcessFrame(&output[f * frameSamples], withStats ? &stats[f * channels] : nullptr);
+    }
+    return 1e6 * (bench::now() - t0) / numFrames;
+}
+
+
+// Feeds 'input' in frame-unaligned chunks to ProcessBuffer, returns the
+// statistics of all frames
+static std::vector<NsFrameStats> processBuffer(int sampleRate, size_t channels, const std::vector<int16_t> &input)
+{
+    NsSession session(sampleRate, channels, LEVEL);
+    std::vector<int16_t> data = input;
+    const size_t numFrames = input.size() / channels;
+    std::vector<NsFrameStats> stats;
+    std::vector<NsFrameStats> chunkStats;
+
+    size_t pos = 0;
+    for (size_t i = 0; pos < numFrames; i ++)
+    {
+        size_t n = std::min(CHUNKS[i % NUM_CHUNKS], numFrames - pos);
+        chunkStats.resize((n / session.FrameSize() + 1) * channels);
+        size_t processed = session.ProcessBuffer(&data[pos * channels], n, chunkStats.data());
+        stats.insert(stats.end(), chunkStats.begin(), chunkStats.begin() + processed * channels);
+        pos += n;
+    }
+    return stats;
+}
+
+
+static bool sameStats(const std::vector<NsFrameStats> &a, const std::vector<NsFrameStats> &b)
+{
+    return (a.size() == b.size()) &&
+           ((a.empty()) || (memcmp(a.data(), b.data(), a.size() * sizeof(NsFrameStats)) == 0));
+}
+
+
+static bool run(int sampleRate, size_t channels, double seconds)
+{
+    const std::vector<int16_t> input = bench::makeNoisySpeech(sampleRate, (int)channels, seconds);
+    std::vector<int16_t> plain, withStats;
+    std::vector<NsFrameStats> none, stats;
+    // alternating rounds, so that both see the same load of the host
+    double plainMicros = 1e9, statsMicros = 1e9;
+    for (int r = 0; r < ROUNDS; r ++)
+    {
+        plainMicros = std::min(plainMicros, process(sampleRate, channels, input, false, plain, none));
+        statsMicros = std::min(statsMicros, process(sampleRate, channels, input, true, withStats, stats));
+    }
+
+    bool outputOk = (plain == withStats);
+    bool batchOk = sameStats(stats, processBuffer(sampleRate, channels, input));
+
+    // bench::makeNoisySpeech: 200 ms syllables, every fourth one silent. The
+    // frames in the middle of a syllable or a pause, channel 0
+    double speech[3] = { 0, 0, 0 }, pause[3] = { 0, 0, 0 };
+    int speechCount = 0, pauseCount = 0;
+    for (size_t f = STARTUP_FRAMES; f < stats.size() / channels; f ++)
+    {
+        size_t inSyllable = f % 20;
+        if ((inSyllable < 5) || (inSyllable >= 15)) continue;
+        const NsFrameStats &s = stats[f * channels];
+        bool isPause = ((f / 20) % 4 == 3);
+        double *sum = isPause ? pause : speech;
+        sum[0] += s.speech_probability;
+        sum[1] += s.snr_db;
+        sum[2] += s.gain;
+        if (isPause) pauseCount ++;
+        else speechCount ++;
+    }
+    for (int i = 0; i < 3; i ++)
+    {
+        speech[i] /= std::max(speechCount, 1);
+        pause[i] /= std::max(pauseCount, 1);
+    }
+    bool separates = (speech[0] > pause[0]) && (speech[1] > pause[1]) && (speech[2] > pause[2]);
+
+    printf("%5d Hz %zu ch: %7.2f us/frame plain, %7.2f us with stats (%+.1f%%), batch %s\n", sampleRate,
+           channels, plainMicros, statsMicros, 100.0 * (statsMicros / plainMicros - 1.0),
+           batchOk ? "ok" : "MISMATCH");
+    printf("  speech: probability %.2f, SNR %5.1f dB, gain %.2f\n", speech[0], speech[1], speech[2]);
+    printf("  pause:  probability %.2f, SNR %5.1f dB, gain %.2f\n", pause[0], pause[1], pause[2]);
+
+    if (!outputOk)
+    {
+        fprintf(stderr, "ns_stats_benchmark: %d Hz %zu ch: output changes with the statistics\n",
+                sampleRate, channels);
+    }
+    if (!separates)
+    {
+        fprintf(stderr, "ns_stats_benchmark: %d Hz %zu ch: statistics do not separate speech from pauses\n",
+                sampleRate, channels);
+    }
+    return outputOk && batchOk && separates;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    if (seconds < 4.0) seconds = 4.0;
+
+    printf("ns_stats_benchmark: %.1f s noisy speech, time per 10 ms frame\n", seconds);
+    bool ok = true;
+    ok &= run(16000, 1, seconds);
+    ok &= run(48000, 1, seconds);
+    ok &= run(48000, 2, seconds);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Footprint and cache benchmark for many concurrent NS streams, as run by a
+/// server-side transcoder: creates 1 to 4096 NsSession at a time and
+/// processes them round robin, one 10 ms frame per stream per step, so that
+/// every frame starts with the state of its stream evicted from the cache
+/// once the streams no longer fit.
+///
+/// Prints the heap bytes per stream (glibc only), the time per frame and,
+/// where the kernel gives access to the hardware counters (Linux
+/// perf_event_open), the cache misses per frame. The check is that stream 0
+/// of the largest run gives the same output as a session processed alone.
+///
+/// Usage: ns_streams_benchmark [frames per stream, default 100]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "ns_session.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+static const int RATES[] = { 16000, 48000 };
+static const size_t STREAMS[] = { 1, 16, 256, 4096 };
+static const int LEVEL = 2;
+// sessions the heap use per stream is averaged over, enough to hide the
+// chunks malloc caches per thread
+static const size_t FOOTPRINT_STREAMS = 1024;
+
+// Heap bytes in use, including the bookkeeping of malloc, or 0 where there is
+// no glibc to ask
+static size_t heapBytes()
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+
+// Hardware cache miss counter of this thread, unavailable in most VMs and
+// containers
+class CacheMissCounter
+{
+public:
+    CacheMissCounter()
+    {
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~CacheMissCounter()
+    {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool available() const { return fd >= 0; }
+
+    long long read() const
+    {
+        long long count = 0;
+#ifdef __linux__
+        if ((fd < 0) || (::read(fd, &count, sizeof(count)) != sizeof(count))) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+
+static bool run(int sampleRate, int frames, const CacheMissCounter &misses)
+{
+    const std::vector<int16_t> input = bench::makeNoisySpeech(sampleRate, 1, frames / 100.0);
+    const size_t frameSize = (size_t)sampleRate / 100;
+
+    // stream 0 processed alone, the reference for the largest run
+    std::vector<int16_t> solo = input;
+    {
+        NsSession session(sampleRate, 1, LEVEL);
+        for (int f = 0; f < frames; f ++) session.ProcessFrame(&solo[f * frameSize]);
+    }
+
+    {
+        std::vector<std::unique_ptr<NsSession> > sessions(FOOTPRINT_STREAMS);
+        size_t heapBefore = heapBytes();
+        for (size_t s = 0; s < FOOTPRINT_STREAMS; s ++)
+        {
+            sessions[s].reset(new NsSession(sampleRate, 1, LEVEL));
+        }
+        double bytesPerStream = (double)(heapBytes() - heapBefore) / FOOTPRINT_STREAMS;
+        printf("%5d Hz mono, %.0f heap bytes per stream\n", sampleRate, bytesPerStream);
+    }
+    printf("  %7s %12s %14s\n", "streams", "us/frame", "misses/frame");
+    bool ok = true;
+    for (size_t numStreams : STREAMS)
+    {
+        std::vector<std::unique_ptr<NsSession> > sessions(numStreams);
+        for (size_t s = 0; s < numStreams; s ++)
+        {
+            sessions[s].reset(new NsSession(sampleRate, 1, LEVEL));
+        }
+
+        std::vector<int16_t> output0 = input;
+        std::vector<int16_t> frame(frameSize);
+        long long missesBefore = misses.read();
+        double t0 = bench::now();
+        for (int f = 0; f < frames; f ++)
+        {
+            const int16_t *in = &input[f * frameSize];
+            for (size_t s = 0; s < numStreams; s ++)
+            {
+                int16_t *data = (s == 0) ? &output0[f * frameSize] : frame.data();
+                if (s != 0) memcpy(data, in, frameSize * sizeof(int16_t));
+                sessions[s]->ProcessFrame(data);
+            }
+        }
+        double elapsed = bench::now() - t0;
+        long long missCount = misses.read() - missesBefore;
+        const double totalFrames = (double)frames * numStreams;
+
+        printf("  %7zu %12.2f", numStreams, 1e6 * elapsed / totalFrames);
+        if (misses.available())
+        {
+            printf(" %14.1f\n", missCount / totalFrames);
+        }
+        else
+        {
+            printf(" %14s\n", "n/a");
+        }
+
+        if (output0 != solo)
+        {
+            fprintf(stderr, "ns_streams_benchmark: %d Hz: stream 0 of %zu differs from a single session\n",
+                    sampleRate, numStreams);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+
+int main(int argc, char **argv)
+{
+    int frames = (argc > 1) ? atoi(argv[1]) : 100;
+    if (frames < 1) frames = 1;
+
+    CacheMissCounter misses;
+    printf("ns_streams_benchmark: %d frames per stream, round robin over the streams\n", frames);
+    bool ok = true;
+    for (int sampleRate : RATES)
+    {
+        ok &= run(sampleRate, frames, misses);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Scaling benchmark for the multi-channel thread pool of NsSession
+/// (NsSession::SetNumThreads, JNI setNumThreads): processes the same noisy
+/// speech with 1 to 8 channels at 16 and 48 kHz, once serially and with 2, 4
+/// and 8 threads (as far as there are channels for them).
+///
+/// Prints the time per second of audio and the speedup over the serial run.
+/// The speedup depends on the cores of the host. The check is that every
+/// threaded output is bit-identical to the serial output.
+///
+/// Usage: ns_thread_benchmark [seconds of audio, default 10]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+
+#include "ns_session.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+static const int RATES[] = { 16000, 48000 };
+static const size_t CHANNELS[] = { 1, 2, 4, 6, 8 };
+static const size_t THREADS[] = { 1, 2, 4, 8 };
+static const int ROUNDS = 3;
+
+
+// Denoises 'input' with a fresh session, returns the best time of ROUNDS runs
+static double process(int sampleRate, size_t channels, size_t threads,
+                      const std::vector<int16_t> &input, std::vector<int16_t> &output)
+{
+    double best = 1e9;
+    for (int r = 0; r < ROUNDS; r ++)
+    {
+        NsSession session(sampleRate, channels, 1);
+        session.SetNumThreads(threads);
+        output = input;
+
+        double t0 = bench::now();
+        session.ProcessBuffer(output.data(), output.size() / channels);
+        double elapsed = bench::now() - t0;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    printf("ns_thread_benchmark: %.1f s noisy speech, %u hardware threads\n", seconds,
+           std::thread::hardware_concurrency());
+    printf("%6s %3s", "rate", "ch");
+    for (size_t threads : THREADS) printf("  %2zu thr ms/s speedup", threads);
+    printf("\n");
+
+    bool ok = true;
+    for (int sampleRate : RATES)
+    {
+        for (size_t channels : CHANNELS)
+        {
+            const std::vector<int16_t> input = bench::makeNoisySpeech(sampleRate, (int)channels, seconds);
+            std::vector<int16_t> serial;
+            double serialTime = 0;
+
+            printf("%6d %3zu", sampleRate, channels);
+            for (size_t threads : THREADS)
+            {
+                if ((threads > 1) && (threads > channels)) break;
+
+                std::vector<int16_t> output;
+                double elapsed = process(sampleRate, channels, threads, input, output);
+                if (threads == 1)
+                {
+                    serial = output;
+                    serialTime = elapsed;
+                }
+                printf("  %11.2f %6.2fx", 1000.0 * elapsed / seconds, serialTime / elapsed);
+
+                if (output != serial)
+                {
+                    fprintf(stderr, "\nns_thread_benchmark: %d Hz %zu ch: %zu threads differ from serial\n",
+                            sampleRate, channels, threads);
+                    ok = false;
+                }
+            }
+            printf("\n");
+        }
+    }
+    return ok ? 0 : 1;
+}
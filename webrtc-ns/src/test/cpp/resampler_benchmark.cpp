@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Benchmark & accuracy check of the SincResampler convolution paths: C, SSE
+/// and AVX2 on x86 (as far as the CPU supports them), NEON on ARM. Converts
+/// a test tone in 10 ms blocks as AudioBuffer does, for 44.1 <-> 48 kHz,
+/// 48 <-> 16 kHz and 8 <-> 16 kHz.
+///
+/// Per conversion and path it prints the CPU time per second of audio and
+/// the speedup over C. Accuracy is checked twice:
+/// - SNR of the resampled tone against a sine fitted at the tone frequency,
+///   which must stay above MIN_SNR_DB.
+/// - the largest difference of each SIMD path's output from the C output,
+///   relative to the tone amplitude, which must stay below MAX_SIMD_ERROR.
+///
+/// Usage: resampler_benchmark [seconds of audio, default 10]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "sinc_resampler.h"
+#include "cpu_features_wrapper.h"
+#include "bench_util.h"
+
+static const double MIN_SNR_DB = 60.0;
+static const double MAX_SIMD_ERROR = 1e-5;
+static const int ROUNDS = 3;
+
+namespace webrtc
+{
+
+/// Access to the convolve selection of SincResampler, through the friend
+/// declaration for the convolve benchmark
+class SincResamplerTest_ConvolveBenchmark_Test
+{
+public:
+    typedef SincResampler::ConvolveProc ConvolveProc;
+
+    struct Path
+    {
+        const char *name;
+        ConvolveProc proc;
+    };
+
+    /// Convolve paths usable on this CPU, C first
+    static std::vector<Path> paths()
+    {
+        std::vector<Path> result;
+        result.push_back({ "c", SincResampler::Convolve_C });
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+        if (WebRtc_GetCPUInfo(kSSE2))
+        {
+            result.push_back({ "sse", SincResampler::Convolve_SSE });
+        }
+        if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3))
+        {
+            result.push_back({ "avx2", SincResampler::Convolve_AVX2 });
+        }
+#elif defined(WEBRTC_HAS_NEON)
+        result.push_back({ "neon", SincResampler::Convolve_NEON });
+#endif
+        return result;
+    }
+
+    static void setPath(SincResampler &resampler, ConvolveProc proc)
+    {
+        resampler.convolve_proc_ = proc;
+    }
+};
+
+}
+
+using namespace webrtc;
+typedef SincResamplerTest_ConvolveBenchmark_Test Access;
+
+
+/// Feeds SincResampler from a buffer, zero padded at the end
+class BufferSource : public SincResamplerCallback
+{
+public:
+    explicit BufferSource(const std::vector<float> &data) : data(data), pos(0) {}
+
+    void Run(size_t frames, float *destination) override
+    {
+        size_t n = std::min(frames, data.size() - pos);
+        memcpy(destination, &data[pos], n * sizeof(float));
+        memset(destination + n, 0, (frames - n) * sizeof(float));
+        pos += n;
+    }
+
+private:
+    const std::vector<float> &data;
+    size_t pos;
+};
+
+
+// Resamples 'input' in 10 ms blocks with 'proc', returns the output
+static std::vector<float> resample(const std::vector<float> &input, int inRate, int outRate,
+                                   Access::ConvolveProc proc)
+{
+    const size_t inBlock = inRate / 100;
+    const size_t outBlock = outRate / 100;
+    const size_t numBlocks = input.size() / inBlock;
+
+    BufferSource source(input);
+    SincResampler resampler((double)inRate / outRate, inBlock, &source);
+    Access::setPath(resampler, proc);
+
+    std::vector<float> output(numBlocks * outBlock);
+    for (size_t b = 0; b < numBlocks; b ++)
+    {
+        resampler.Resample(outBlock, &output[b * outBlock]);
+    }
+    return output;
+}
+
+
+// SNR in dB of 'x' against the best fitting sine of frequency 'f' / 'rate',
+// skipping the start-up transient
+static double toneSnr(const std::vector<float> &x, double f, int rate)
+{
+    const size_t skip = rate / 10;
+    double ss = 0, sc = 0, cc = 0, xs = 0, xc = 0;
+    for (size_t i = skip; i < x.size(); i ++)
+    {
+        double s = sin(2 * M_PI * f * i / rate), c = cos(2 * M_PI * f * i / rate);
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        xs += x[i] * s;
+        xc += x[i] * c;
+    }
+    // least squares amplitudes a * sin + b * cos
+    double det = ss * cc - sc * sc;
+    double a = (xs * cc - xc * sc) / det;
+    double b = (xc * ss - xs * sc) / det;
+
+    double signal = 0, residual = 0;
+    for (size_t i = skip; i < x.size(); i ++)
+    {
+        double fit = a * sin(2 * M_PI * f * i / rate) + b * cos(2 * M_PI * f * i / rate);
+        signal += fit * fit;
+        residual += (x[i] - fit) * (x[i] - fit);
+    }
+    return 10.0 * log10(signal / std::max(residual, 1e-30));
+}
+
+
+static bool run(int inRate, int outRate, double seconds, const std::vector<Access::Path> &paths)
+{
+    // tone at a fifth of the lower Nyquist frequency, in the s16 range that
+    // AudioBuffer resamples
+    const double f = 0.1 * std::min(inRate, outRate);
+    const double amplitude = 10000.0;
+    std::vector<float> input((size_t)(seconds * inRate));
+    for (size_t i = 0; i < input.size(); i ++)
+    {
+        input[i] = (float)(amplitude * sin(2 * M_PI * f * i / inRate));
+    }
+
+    bool ok = true;
+    std::vector<float> reference;
+    double cTime = 0;
+
+    printf("%5d -> %5d Hz:", inRate, outRate);
+    for (const Access::Path &path : paths)
+    {
+        std::vector<float> output;
+        double best = 1e9;
+        for (int r = 0; r < ROUNDS; r ++)
+        {
+            double t0 = bench::now();
+            output = resample(input, inRate, outRate, path.proc);
+            best = std::min(best, bench::now() - t0);
+        }
+        if (reference.empty())
+        {
+            reference = output;
+            cTime = best;
+        }
+
+        double maxDiff = 0;
+        for (size_t i = 0; i < output.size(); i ++)
+        {
+            maxDiff = std::max(maxDiff, (double)fabsf(output[i] - reference[i]));
+        }
+        maxDiff /= amplitude;
+        const double snr = toneSnr(output, f, outRate);
+
+        printf(" | %s %6.0f us/s %4.1fx snr %5.1f dB diff %.0e", path.name, 1e6 * best / seconds,
+               cTime / best, snr, maxDiff);
+        if ((snr < MIN_SNR_DB) || (maxDiff > MAX_SIMD_ERROR))
+        {
+            ok = false;
+        }
+    }
+    printf("\n");
+    if (!ok)
+    {
+        fprintf(stderr, "resampler_benchmark: %d -> %d Hz: SNR below %.0f dB or SIMD error above %.0e\n",
+                inRate, outRate, MIN_SNR_DB, MAX_SIMD_ERROR);
+    }
+    return ok;
+}
+
+
+int main(int argc, char **argv)
+{
+    static const int rates[][2] = { { 44100, 48000 }, { 48000, 16000 }, { 8000, 16000 } };
+
+    double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+    if (seconds < 1.0) seconds = 1.0;
+
+    const std::vector<Access::Path> paths = Access::paths();
+    printf("resampler_benchmark: %.1f s tone, paths:", seconds);
+    for (const Access::Path &path : paths) printf(" %s", path.name);
+    printf("\n");
+
+    bool ok = true;
+    for (const auto &r : rates)
+    {
+        ok &= run(r[0], r[1], seconds, paths);
+        ok &= run(r[1], r[0], seconds, paths);
+    }
+    return ok ? 0 : 1;
+}
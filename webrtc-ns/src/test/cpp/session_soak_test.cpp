@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Soak test for the NsSession lifetime: creates a session, processes a few
+/// frames and destroys it, over and over, cycling through sample rates and
+/// channel counts. Fails if the resident memory grows by more than 4 MB after
+/// the warm-up, i.e. if a session leaks. Build with -DNS_SANITIZE=ON to have
+/// LeakSanitizer pinpoint a leak.
+///
+/// Usage: session_soak_test [number of sessions, default 100000]
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "ns_session.h"
+#include "bench_util.h"
+
+using namespace webrtc;
+
+static const int SAMPLE_RATES[] = { 16000, 32000, 48000 };
+static const int FRAMES_PER_SESSION = 3;
+static const size_t WARMUP = 1000;
+static const long MAX_GROWTH = 4L * 1024 * 1024;
+
+// Resident memory in bytes
+static long residentBytes()
+{
+    long pages = 0, resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f == NULL) return 0;
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+
+int main(int argc, char **argv)
+{
+    long numSessions = (argc > 1) ? atol(argv[1]) : 100000;
+    if (numSessions < (long)WARMUP) numSessions = WARMUP;
+
+    std::vector<int16_t> input = bench::makeNoisySpeech(48000, 2, 0.1);
+    std::vector<int16_t> frame(input.size());
+    long baseline = 0;
+
+    double t0 = bench::now();
+    for (long i = 0; i < numSessions; i ++)
+    {
+        int sampleRate = SAMPLE_RATES[i % 3];
+        size_t channels = 1 + (size_t)(i / 3) % 2;
+
+        NsSession *session = new NsSession(sampleRate, channels, (int)(i % 4));
+        for (int k = 0; k < FRAMES_PER_SESSION; k ++)
+        {
+            std::copy(input.begin(), input.begin() + session->FrameSize() * channels, frame.begin());
+            session->ProcessFrame(frame.data());
+        }
+        delete session;
+
+        if (i + 1 == (long)WARMUP) baseline = residentBytes();
+    }
+    double elapsed = bench::now() - t0;
+    long growth = residentBytes() - baseline;
+
+    printf("session_soak_test: %ld sessions, %.1f us per session, resident memory growth %.1f kB\n",
+           numSessions, 1e6 * elapsed / numSessions, growth / 1024.0);
+
+    if (growth > MAX_GROWTH)
+    {
+        fprintf(stderr, "session_soak_test: resident memory grew by %ld bytes\n", growth);
+        return 1;
+    }
+    return 0;
+}